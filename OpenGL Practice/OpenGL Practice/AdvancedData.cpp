@@ -38,8 +38,8 @@ AdvancedData::~AdvancedData()
 	buffer = 0;*/
 
 	// Deallocate the cube's VAO and VBO at the end of runtime
-	glDeleteBuffers(1, &cubeVBO);
-	glDeleteVertexArrays(1, &cubeVAO);
+	GLStateCache::DeleteBuffers(1, &cubeVBO);
+	GLStateCache::DeleteVertexArrays(1, &cubeVAO);
 }
 
 void AdvancedData::InitializeCubeVertices()
@@ -106,8 +106,8 @@ void AdvancedData::InitializeCubeVertices()
 	glGenVertexArrays(1, &cubeVAO);
 	glGenBuffers(1, &cubeVBO);
 
-	glBindVertexArray(cubeVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+	GLStateCache::BindVertexArray(cubeVAO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, cubeVBO);
 
 	glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), &cubeVertices, GL_STATIC_DRAW);
 
@@ -136,9 +136,9 @@ void AdvancedData::InitializeBufferObject()
 
 	// Create the uniform buffer
 	glGenBuffers(1, &uboMatrices);
-	glBindBuffer(GL_UNIFORM_BUFFER, uboMatrices);
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, uboMatrices);
 	glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), NULL, GL_STATIC_DRAW);
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	// The function glBindbufferBase expects a target, a binding point index and a uniform buffer object
 
@@ -151,9 +151,9 @@ void AdvancedData::InitializeBufferObject()
 
 	// Store the first half of the uniform buffer with the projection matrix once before rendering loop
 	glm::mat4 projectionMatrix = glm::perspective(45.0f, float(800 / 600), 0.1f, 100.0f);
-	glBindBuffer(GL_UNIFORM_BUFFER, uboMatrices);
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, uboMatrices);
 	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(projectionMatrix));
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 void AdvancedData::LoadCubesInfo()
@@ -161,19 +161,19 @@ void AdvancedData::LoadCubesInfo()
 	// Set the view and projection matrix in the uniform block (perform only once per loop iteration)
 	glm::mat4 viewMatrix = Camera::CameraLookAt();
 
-	glBindBuffer(GL_UNIFORM_BUFFER, uboMatrices);
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, uboMatrices);
 
 	/* Add all the data as a single byte array, or update parts of the buffer whenever we feel like it using 
 	glBufferSubData. To update the uniform variable boolean we could update the uniform buffer object as follows*/
 	glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(viewMatrix));
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, 0);
 
-	glBindVertexArray(cubeVAO);
+	GLStateCache::BindVertexArray(cubeVAO);
 }
 
 void AdvancedData::DrawRedCube()
 {
-	glUseProgram(redShader->shaderProgram);
+	GLStateCache::UseProgram(redShader->shaderProgram);
 
 	// RED cube
 	modelMatrix = glm::mat4(1.0f);
@@ -187,7 +187,7 @@ void AdvancedData::DrawRedCube()
 
 void AdvancedData::DrawGreenCube()
 {
-	glUseProgram(greenShader->shaderProgram);
+	GLStateCache::UseProgram(greenShader->shaderProgram);
 
 	modelMatrix = glm::mat4(1.0f);
 	modelMatrix = glm::translate(modelMatrix, glm::vec3(0.75f, 0.75f, 0.0f)); // move top-right
@@ -200,7 +200,7 @@ void AdvancedData::DrawGreenCube()
 
 void AdvancedData::DrawBlueCube()
 {
-	glUseProgram(blueShader->shaderProgram);
+	GLStateCache::UseProgram(blueShader->shaderProgram);
 
 	modelMatrix = glm::mat4(1.0f);
 	modelMatrix = glm::translate(modelMatrix, glm::vec3(0.75f, -0.75f, 0.0f)); // move bottom-right
@@ -213,7 +213,7 @@ void AdvancedData::DrawBlueCube()
 
 void AdvancedData::DrawYellowCube()
 {
-	glUseProgram(yellowShader->shaderProgram);
+	GLStateCache::UseProgram(yellowShader->shaderProgram);
 
 	modelMatrix = glm::mat4(1.0f);
 	modelMatrix = glm::translate(modelMatrix, glm::vec3(-0.75f, -0.75f, 0.0f)); // move bottom-left
@@ -25,8 +25,8 @@ isBlinnOn(false)
 
 AdvancedLighting::~AdvancedLighting()
 {
-    glDeleteVertexArrays(1, &planeVAO);
-    glDeleteBuffers(1, &planeVBO);
+    GLStateCache::DeleteVertexArrays(1, &planeVAO);
+    GLStateCache::DeleteBuffers(1, &planeVBO);
 }
 
 AdvancedLighting* AdvancedLighting::Instance()
@@ -42,9 +42,9 @@ AdvancedLighting* AdvancedLighting::Instance()
 
 void AdvancedLighting::InitializeVertices()
 {
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLStateCache::Enable(GL_DEPTH_TEST);
+    GLStateCache::Enable(GL_BLEND);
+    GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     advancedLightingShaderProgram->InitializeShaderProgram(new VertexShaderLoader("AdvancedLightingVertexShader.glsl"),
         new FragmentShaderLoader("AdvancedLightingFragmentShader.glsl"));
@@ -64,8 +64,8 @@ void AdvancedLighting::InitializeVertices()
     glGenVertexArrays(1, &planeVAO);
     glGenBuffers(1, &planeVBO);
 
-    glBindVertexArray(planeVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, planeVBO);
+    GLStateCache::BindVertexArray(planeVAO);
+    GLStateCache::BindBuffer(GL_ARRAY_BUFFER, planeVBO);
 
     glBufferData(GL_ARRAY_BUFFER, sizeof(planeVertices), &planeVertices, GL_STATIC_DRAW);
 
@@ -78,7 +78,7 @@ void AdvancedLighting::InitializeVertices()
     glEnableVertexAttribArray(2);
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
 
-    glBindVertexArray(0);
+    GLStateCache::BindVertexArray(0);
 }
 
 void AdvancedLighting::InitializeTextures()
@@ -99,7 +99,7 @@ void AdvancedLighting::InitializeTextures()
         else if (nrComponents == 4)
             format = GL_RGBA;
 
-        glBindTexture(GL_TEXTURE_2D, floorTexture);
+        GLStateCache::BindTexture(GL_TEXTURE_2D, floorTexture);
 
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
@@ -120,7 +120,7 @@ void AdvancedLighting::InitializeTextures()
     }
 
     // Use the shader program for the advanced lighting shaders to set the uniform texture
-    glUseProgram(advancedLightingShaderProgram->shaderProgram);
+    GLStateCache::UseProgram(advancedLightingShaderProgram->shaderProgram);
     glUniform1i(glGetUniformLocation(advancedLightingShaderProgram->shaderProgram, "floorTexture"), 0);
 
     // Lighting info
@@ -130,30 +130,18 @@ void AdvancedLighting::InitializeTextures()
 void AdvancedLighting::SetUpAdvancedLighting()
 {
     // Draw objects and set up some advanced lighting
-    glUseProgram(advancedLightingShaderProgram->shaderProgram);
-
-    glm::mat4 projection = perspective(glm::radians(Camera::fieldOfView), float(1280 / 960), 0.1f, 100.0f);
-    glm::mat4 view = Camera::CameraLookAt();
-
-    glUniformMatrix4fv(glGetUniformLocation(advancedLightingShaderProgram->shaderProgram, "projectionMatrix"), 1, 
-        GL_FALSE, value_ptr(projection));
-
-    glUniformMatrix4fv(glGetUniformLocation(advancedLightingShaderProgram->shaderProgram, "viewMatrix"), 1,
-        GL_FALSE, value_ptr(view));
+    GLStateCache::UseProgram(advancedLightingShaderProgram->shaderProgram);
 
     // Set some lighting uniforms
-    glUniform3fv(glGetUniformLocation(advancedLightingShaderProgram->shaderProgram, "viewPosition"), 1, 
-        value_ptr(Camera::cameraPosition));
-
     glUniform3fv(glGetUniformLocation(advancedLightingShaderProgram->shaderProgram, "lightPosition"), 1, 
         value_ptr(lightPosition));
 
     glUniform1i(glGetUniformLocation(advancedLightingShaderProgram->shaderProgram, "includeBlinnShading"), isBlinnOn);
 
     // Render the floor texture after setting it up
-    glBindVertexArray(planeVAO);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, floorTexture);
+    GLStateCache::BindVertexArray(planeVAO);
+    GLStateCache::ActiveTexture(GL_TEXTURE0);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, floorTexture);
     glDrawArrays(GL_TRIANGLES, 0, 6);
 
     std::cout << (isBlinnOn ? "Blinn-Phong" : "Phong") << std::endl;
@@ -9,7 +9,7 @@ in VS_OUT {
 
 uniform sampler2D floorTexture;
 uniform vec3 lightPosition;
-uniform vec3 viewPosition;
+#include "FrameUniforms.glsl"
 uniform bool includeBlinnShading;
 
 /* 
@@ -33,7 +33,7 @@ void main()
     vec3 diffuse = diff * color;
 
     // Specular
-    vec3 viewDir = normalize(viewPosition - fs_in.FragPosition);
+    vec3 viewDir = normalize(frame.cameraPosition.xyz - fs_in.FragPosition);
     vec3 reflectDir = reflect(-lightDir, normal);
     float spec = 0.0;
 
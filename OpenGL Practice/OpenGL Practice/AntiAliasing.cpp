@@ -28,13 +28,13 @@ antiAliasingPostShaderProgram(new ShaderProgram()), cubeVAO(NULL), cubeVBO(NULL)
 
 AntiAliasing::~AntiAliasing()
 {
-    glDeleteBuffers(1, &cubeVBO);
-    glDeleteVertexArrays(1, &cubeVAO);
+    GLStateCache::DeleteBuffers(1, &cubeVBO);
+    GLStateCache::DeleteVertexArrays(1, &cubeVAO);
 }
 
 void AntiAliasing::InitializeAntiAliasing()
 {
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::Enable(GL_DEPTH_TEST);
 
 	/* If we want to use MSAA (multi sampling anti aliasing) in OpenGL we need to use a buffer that is able to store more 
 	than one sample value per pixel. We need a new type of buffer that can store a given amount of multisamples and this is 
@@ -112,8 +112,8 @@ void AntiAliasing::InitializeAntiAliasing()
     glGenVertexArrays(1, &cubeVAO);
     glGenBuffers(1, &cubeVBO);
 
-    glBindVertexArray(cubeVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    GLStateCache::BindVertexArray(cubeVAO);
+    GLStateCache::BindBuffer(GL_ARRAY_BUFFER, cubeVBO);
 
     glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), &cubeVertices, GL_STATIC_DRAW);
 
@@ -124,8 +124,8 @@ void AntiAliasing::InitializeAntiAliasing()
     glGenVertexArrays(1, &quadVAO);
     glGenBuffers(1, &quadVBO);
 
-    glBindVertexArray(quadVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    GLStateCache::BindVertexArray(quadVAO);
+    GLStateCache::BindBuffer(GL_ARRAY_BUFFER, quadVBO);
 
     glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
 
@@ -137,20 +137,20 @@ void AntiAliasing::InitializeAntiAliasing()
 
     // Configure MSAA framebuffer
     glGenFramebuffers(1, &framebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
 
     // Create a multisampled color attachment texture
     glGenTextures(1, &textureColorBufferMultiSampled);
 
     /* To create a texture that supports storage of multiple sample points we use glTexImage2DMultisample instead of
     glTexImage2D that accepts GL_TEXTURE_2D_MULTISAMPLE as its texture target */
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, textureColorBufferMultiSampled);
+    GLStateCache::BindTexture(GL_TEXTURE_2D_MULTISAMPLE, textureColorBufferMultiSampled);
 
     /* The second argument sets the number of samples wed like the texture to have. If the last argument is set to GL_TRUE,
     the image will use identical sample locations and the same number of subsamples for each texel */
     glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_RGB, 1280, 960, GL_TRUE);
 
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+    GLStateCache::BindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
 
     /* To attach a multisampled texture to a framebuffer we use glFramebufferTexture2D, but this time with
     GL_TEXTURE_2D_MULTISAMPLE as the texture type */
@@ -172,15 +172,15 @@ void AntiAliasing::InitializeAntiAliasing()
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         cout << "ERROR::FRAMEBUFFER:: Framebuffer is not complete!" << endl;
     
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Configure second post-processing framebuffer
     glGenFramebuffers(1, &intermediateFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, intermediateFBO);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, intermediateFBO);
 
     // Create a color attachment texture
     glGenTextures(1, &screenTexture);
-    glBindTexture(GL_TEXTURE_2D, screenTexture);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, screenTexture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1280, 960, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -191,7 +191,7 @@ void AntiAliasing::InitializeAntiAliasing()
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         cout << "ERROR::FRAMEBUFFER:: Intermediate framebuffer is not complete!" << endl;
     
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Use anti aliasing post shader program to set the uniform of the sampler2D in the fragment shader
     //glUseProgram(antiAliasingPostShaderProgram->shaderProgram);
@@ -236,14 +236,14 @@ void AntiAliasing::RenderAntiAliasing()
     // Anti-Aliasing Part 2
     
     // Draw scene as normal in multisampled buffers
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);
+    GLStateCache::Enable(GL_DEPTH_TEST);
 
     // Set transformation matrices (Anti-Aliasing Part 1)
-    glUseProgram(antiAliasingShaderProgram->shaderProgram);
+    GLStateCache::UseProgram(antiAliasingShaderProgram->shaderProgram);
 
     mat4 projectionMatrix = perspective(radians(Camera::fieldOfView), float(1280 / 960), 0.1f, 1000.0f);
     mat4 viewMatrix = Camera::CameraLookAt();
@@ -258,7 +258,7 @@ void AntiAliasing::RenderAntiAliasing()
     glUniformMatrix4fv(glGetUniformLocation(antiAliasingShaderProgram->shaderProgram, "modelMatrix"), 1, GL_FALSE, 
         value_ptr(modelMatrix));
 
-    glBindVertexArray(cubeVAO);
+    GLStateCache::BindVertexArray(cubeVAO);
     glDrawArrays(GL_TRIANGLES, 0, 36);
 
     // Anti-Aliasing Part 2
@@ -273,23 +273,23 @@ void AntiAliasing::RenderAntiAliasing()
 
     // 1280 is screen width and 960 is screen height I set the window to
     // Blit multisampled buffer(s) to normal colorbuffer of intermediate FBO. Image is stored in screenTexture
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, intermediateFBO);
+    GLStateCache::BindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    GLStateCache::BindFramebuffer(GL_DRAW_FRAMEBUFFER, intermediateFBO);
     glBlitFramebuffer(0, 0, 1280, 960, 0, 0, 1280, 960, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 
     // Render quad with scene's visuals as its texture image
     // Since the scene is stored in 2D texture, we can use that for post-processing if necessary
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
-    glDisable(GL_DEPTH_TEST);
+    GLStateCache::Disable(GL_DEPTH_TEST);
 
     // Draw screen quad
-    glUseProgram(antiAliasingPostShaderProgram->shaderProgram);
+    GLStateCache::UseProgram(antiAliasingPostShaderProgram->shaderProgram);
 
-    glBindVertexArray(quadVAO);
-    glActiveTexture(GL_TEXTURE0);
+    GLStateCache::BindVertexArray(quadVAO);
+    GLStateCache::ActiveTexture(GL_TEXTURE0);
 
-    glBindTexture(GL_TEXTURE_2D, screenTexture); // use the now resolved color attachment as the quad's texture
+    GLStateCache::BindTexture(GL_TEXTURE_2D, screenTexture); // use the now resolved color attachment as the quad's texture
     glDrawArrays(GL_TRIANGLES, 0, 6);
 }
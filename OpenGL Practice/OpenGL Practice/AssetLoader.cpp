@@ -0,0 +1,447 @@
+#include "AssetLoader.h"
+#include "GLStateCache.h"
+
+#include <iostream>
+#include <chrono>
+
+// Instantiate static variables
+GLFWwindow* AssetLoader::loaderWindow = nullptr;
+thread AssetLoader::loaderThread;
+
+mutex AssetLoader::queueMutex;
+condition_variable AssetLoader::queueCondition;
+bool AssetLoader::stopping = false;
+
+deque<shared_ptr<AsyncTexture>> AssetLoader::queuedTextures;
+vector<shared_ptr<AsyncTexture>> AssetLoader::uploadedTextures;
+vector<shared_ptr<AsyncTexture>> AssetLoader::fencedTextures;
+
+unordered_map<string, shared_ptr<AsyncTexture>> AssetLoader::pendingTextures;
+
+deque<shared_ptr<AsyncBuffers>> AssetLoader::queuedBuffers;
+vector<shared_ptr<AsyncBuffers>> AssetLoader::uploadedBuffers;
+vector<shared_ptr<AsyncBuffers>> AssetLoader::fencedBuffers;
+
+unsigned int AssetLoader::pendingBufferCount = 0;
+
+unsigned int AssetLoader::placeholderTextures[2] = { 0, 0 };
+
+bool AssetLoader::Initialize(GLFWwindow* mainWindow)
+{
+	if (loaderWindow != nullptr)
+		return true;
+
+	/* The loader's window is never shown, it only exists for its context. Passing the main window as the share parameter
+	makes every texture, buffer and sync object visible to both contexts. The context version hints are still the ones
+	the main window was created with, and a shared context has to match them anyway */
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	loaderWindow = glfwCreateWindow(1, 1, "Asset Loader", NULL, mainWindow);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+	if (loaderWindow == nullptr)
+	{
+		cout << "ASSET_LOADER: Failed to create the shared context, textures are loaded on the main thread" << endl;
+		return false;
+	}
+
+	stopping = false;
+	loaderThread = thread(LoaderThread);
+
+	return true;
+}
+
+void AssetLoader::Shutdown()
+{
+	if (loaderWindow == nullptr)
+		return;
+
+	WaitAll();
+
+	{
+		lock_guard<mutex> lock(queueMutex);
+		stopping = true;
+	}
+
+	queueCondition.notify_all();
+	loaderThread.join();
+
+	glfwDestroyWindow(loaderWindow);
+	loaderWindow = nullptr;
+
+	for (unsigned int i = 0; i < 2; i++)
+	{
+		if (placeholderTextures[i] != 0)
+			GLStateCache::DeleteTextures(1, &placeholderTextures[i]);
+
+		placeholderTextures[i] = 0;
+	}
+}
+
+shared_ptr<AsyncTexture> AssetLoader::LoadTextureAsync(const string& filePath, const TextureLoadOptions& options,
+	AssetPlaceholder placeholder)
+{
+	shared_ptr<AsyncTexture> texture = make_shared<AsyncTexture>();
+	texture->filePath = filePath;
+	texture->options = options;
+	texture->requestCount = 1;
+	texture->releasedCount = 0;
+	texture->loadedTextureID = 0;
+	texture->width = texture->height = 0;
+	texture->fence = NULL;
+
+	// Already resident (or there's no loader thread), nothing to wait for
+	texture->textureID = TextureCache::AcquireTexture(filePath, options);
+
+	if (texture->textureID == 0 && loaderWindow == nullptr)
+		texture->textureID = TextureCache::LoadTexture(filePath, options);
+
+	if (texture->textureID != 0 || loaderWindow == nullptr)
+	{
+		texture->ready = true;
+		return texture;
+	}
+
+	// Somebody else asked for it already, share their request instead of loading the file a second time
+	string key = TextureCache::GetKey(filePath, options);
+	auto pending = pendingTextures.find(key);
+
+	if (pending != pendingTextures.end())
+	{
+		pending->second->requestCount++;
+		return pending->second;
+	}
+
+	texture->textureID = GetPlaceholderTexture(placeholder);
+	texture->ready = false;
+
+	pendingTextures[key] = texture;
+
+	{
+		lock_guard<mutex> lock(queueMutex);
+		queuedTextures.push_back(texture);
+	}
+
+	queueCondition.notify_one();
+
+	return texture;
+}
+
+void AssetLoader::ReleaseTexture(const shared_ptr<AsyncTexture>& texture)
+{
+	// The reference only exists once the texture arrives, FinishTexture gives it back then
+	if (!texture->ready)
+	{
+		texture->releasedCount++;
+		return;
+	}
+
+	// A placeholder (of a texture that failed to load) isn't in the texture cache, so this does nothing for it
+	TextureCache::ReleaseTexture(texture->textureID);
+}
+
+shared_ptr<AsyncBuffers> AssetLoader::LoadBuffersAsync(vector<unsigned char>&& vertexData,
+	vector<unsigned char>&& indexData)
+{
+	shared_ptr<AsyncBuffers> buffers = make_shared<AsyncBuffers>();
+	buffers->vertexData = move(vertexData);
+	buffers->indexData = move(indexData);
+	buffers->ready = false;
+	buffers->released = false;
+	buffers->vertexBuffer = buffers->indexBuffer = 0;
+	buffers->fence = NULL;
+
+	if (loaderWindow == nullptr)
+	{
+		LoadBuffers(*buffers);
+		return buffers;
+	}
+
+	pendingBufferCount++;
+
+	{
+		lock_guard<mutex> lock(queueMutex);
+		queuedBuffers.push_back(buffers);
+	}
+
+	queueCondition.notify_one();
+
+	return buffers;
+}
+
+void AssetLoader::ReleaseBuffers(const shared_ptr<AsyncBuffers>& buffers)
+{
+	// FinishBuffers deletes them once they arrive
+	if (!buffers->ready)
+	{
+		buffers->released = true;
+		return;
+	}
+
+	GLStateCache::DeleteBuffers(1, &buffers->vertexBuffer);
+	GLStateCache::DeleteBuffers(1, &buffers->indexBuffer);
+}
+
+void AssetLoader::Update()
+{
+	if (loaderWindow == nullptr)
+		return;
+
+	{
+		lock_guard<mutex> lock(queueMutex);
+
+		fencedTextures.insert(fencedTextures.end(), uploadedTextures.begin(), uploadedTextures.end());
+		uploadedTextures.clear();
+
+		fencedBuffers.insert(fencedBuffers.end(), uploadedBuffers.begin(), uploadedBuffers.end());
+		uploadedBuffers.clear();
+	}
+
+	for (unsigned int i = 0; i < fencedTextures.size();)
+	{
+		AsyncTexture& texture = *fencedTextures[i];
+
+		if (!IsFenceSignaled(texture.fence))
+		{
+			i++;
+			continue;
+		}
+
+		FinishTexture(texture);
+
+		fencedTextures.erase(fencedTextures.begin() + i);
+	}
+
+	for (unsigned int i = 0; i < fencedBuffers.size();)
+	{
+		AsyncBuffers& buffers = *fencedBuffers[i];
+
+		if (!IsFenceSignaled(buffers.fence))
+		{
+			i++;
+			continue;
+		}
+
+		FinishBuffers(buffers);
+
+		fencedBuffers.erase(fencedBuffers.begin() + i);
+	}
+}
+
+void AssetLoader::WaitAll()
+{
+	while (!pendingTextures.empty() || pendingBufferCount > 0)
+	{
+		Update();
+
+		if (!pendingTextures.empty() || pendingBufferCount > 0)
+			this_thread::sleep_for(chrono::milliseconds(1));
+	}
+}
+
+unsigned int AssetLoader::GetPlaceholderTexture(AssetPlaceholder placeholder)
+{
+	if (placeholderTextures[placeholder] != 0)
+		return placeholderTextures[placeholder];
+
+	// A single texel is enough, it's the same color no matter where it's sampled
+	unsigned char texel[4] = { 128, 128, 128, 255 };
+
+	if (placeholder == PLACEHOLDER_NORMAL)
+		texel[2] = 255; // (0, 0, 1) in tangent space, the surface's own normal
+
+	glGenTextures(1, &placeholderTextures[placeholder]);
+
+	GLStateCache::BindTexture(GL_TEXTURE_2D, placeholderTextures[placeholder]);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	return placeholderTextures[placeholder];
+}
+
+unsigned int AssetLoader::GetPendingCount()
+{
+	return static_cast<unsigned int>(pendingTextures.size()) + pendingBufferCount;
+}
+
+void AssetLoader::LoaderThread()
+{
+	// A context can only be current on one thread at a time, and this one is only ever current here
+	glfwMakeContextCurrent(loaderWindow);
+
+	while (true)
+	{
+		shared_ptr<AsyncTexture> texture;
+		shared_ptr<AsyncBuffers> buffers;
+
+		{
+			unique_lock<mutex> lock(queueMutex);
+			queueCondition.wait(lock, []() { return stopping || !queuedTextures.empty() || !queuedBuffers.empty(); });
+
+			// Only stop once the queues are empty, nobody should be left waiting for something that never comes
+			if (queuedTextures.empty() && queuedBuffers.empty())
+				break;
+
+			// A model can't draw anything at all without its buffers, while its textures have placeholders, so they go first
+			if (!queuedBuffers.empty())
+			{
+				buffers = queuedBuffers.front();
+				queuedBuffers.pop_front();
+			}
+
+			else
+			{
+				texture = queuedTextures.front();
+				queuedTextures.pop_front();
+			}
+		}
+
+		if (buffers != nullptr)
+		{
+			LoadBuffersOnLoaderThread(*buffers);
+
+			lock_guard<mutex> lock(queueMutex);
+			uploadedBuffers.push_back(buffers);
+
+			continue;
+		}
+
+		LoadOnLoaderThread(*texture);
+
+		{
+			lock_guard<mutex> lock(queueMutex);
+			uploadedTextures.push_back(texture);
+		}
+	}
+
+	glfwMakeContextCurrent(NULL);
+}
+
+void AssetLoader::LoadOnLoaderThread(AsyncTexture& texture)
+{
+	DecodedImage image;
+
+	if (!TextureCache::DecodeImage(texture.filePath, texture.options, image))
+		return;
+
+	texture.width = image.width;
+	texture.height = image.height;
+
+	// The state cache belongs to the main context, so the upload binds the texture directly
+	texture.loadedTextureID = TextureCache::UploadTexture(texture.options, image, false);
+
+	TextureCache::FreeImage(image);
+
+	/* The fence is signaled once the GPU has executed everything before it, the upload and the mipmaps included. Flushing
+	makes sure the commands (and the fence) actually reach the GPU, otherwise the main thread could wait on it forever */
+	texture.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();
+}
+
+void AssetLoader::LoadBuffersOnLoaderThread(AsyncBuffers& buffers)
+{
+	unsigned int bufferIDs[2];
+	glGenBuffers(2, bufferIDs);
+
+	/* The state cache belongs to the main context, so the buffers are bound directly. The copy target isn't part of any
+	vertex array's state, and this context never has a vertex array bound anyway */
+	glBindBuffer(GL_COPY_WRITE_BUFFER, bufferIDs[0]);
+	glBufferData(GL_COPY_WRITE_BUFFER, buffers.vertexData.size(), buffers.vertexData.data(), GL_STATIC_DRAW);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, bufferIDs[1]);
+	glBufferData(GL_COPY_WRITE_BUFFER, buffers.indexData.size(), buffers.indexData.data(), GL_STATIC_DRAW);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	buffers.vertexBuffer = bufferIDs[0];
+	buffers.indexBuffer = bufferIDs[1];
+
+	vector<unsigned char>().swap(buffers.vertexData);
+	vector<unsigned char>().swap(buffers.indexData);
+
+	// Same as for a texture, the main thread only uses the buffers once the GPU has actually filled them
+	buffers.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();
+}
+
+void AssetLoader::LoadBuffers(AsyncBuffers& buffers)
+{
+	unsigned int bufferIDs[2];
+	glGenBuffers(2, bufferIDs);
+
+	GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, bufferIDs[0]);
+	glBufferData(GL_COPY_WRITE_BUFFER, buffers.vertexData.size(), buffers.vertexData.data(), GL_STATIC_DRAW);
+
+	GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, bufferIDs[1]);
+	glBufferData(GL_COPY_WRITE_BUFFER, buffers.indexData.size(), buffers.indexData.data(), GL_STATIC_DRAW);
+
+	GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	buffers.vertexBuffer = bufferIDs[0];
+	buffers.indexBuffer = bufferIDs[1];
+
+	vector<unsigned char>().swap(buffers.vertexData);
+	vector<unsigned char>().swap(buffers.indexData);
+
+	buffers.ready = true;
+}
+
+bool AssetLoader::IsFenceSignaled(GLsync& fence)
+{
+	if (fence == NULL)
+		return true;
+
+	// A timeout of 0 only asks whether the fence was signaled, the loader thread already flushed it to the GPU
+	GLenum result = glClientWaitSync(fence, 0, 0);
+
+	if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+		return false;
+
+	glDeleteSync(fence);
+	fence = NULL;
+
+	return true;
+}
+
+void AssetLoader::FinishBuffers(AsyncBuffers& buffers)
+{
+	pendingBufferCount--;
+
+	buffers.ready = true;
+
+	// The model that asked for them is gone already
+	if (buffers.released)
+	{
+		GLStateCache::DeleteBuffers(1, &buffers.vertexBuffer);
+		GLStateCache::DeleteBuffers(1, &buffers.indexBuffer);
+	}
+}
+
+void AssetLoader::FinishTexture(AsyncTexture& texture)
+{
+	pendingTextures.erase(TextureCache::GetKey(texture.filePath, texture.options));
+
+	texture.ready = true;
+
+	// The placeholder stays in place for good
+	if (texture.loadedTextureID == 0)
+	{
+		cout << "Texture failed to load at path: " << texture.filePath << endl;
+		return;
+	}
+
+	// The first request's reference comes from adopting the texture, every other request adds one more
+	texture.textureID = TextureCache::AdoptTexture(texture.filePath, texture.options, texture.loadedTextureID,
+		texture.width, texture.height);
+
+	for (unsigned int i = 1; i < texture.requestCount; i++)
+	{
+		TextureCache::AddReference(texture.textureID);
+	}
+
+	for (unsigned int i = 0; i < texture.releasedCount; i++)
+	{
+		TextureCache::ReleaseTexture(texture.textureID);
+	}
+}
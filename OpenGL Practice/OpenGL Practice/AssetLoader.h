@@ -0,0 +1,170 @@
+#pragma once
+
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <glad/glad.h>
+#include <glfw3.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+
+#include "TextureCache.h"
+
+using namespace std;
+
+/* Decoding an image and uploading it with glTexImage2D (plus building its mipmaps) used to happen on the render thread, so
+startup stood still until every texture was on the GPU. The asset loader runs a thread of its own with a hidden window whose
+context shares its objects with the main window's context. Textures created on that context can be used by the main
+context as well, so the loader thread decodes the file, uploads it and builds the mipmaps without the render thread ever
+waiting for it.
+
+The only thing to be careful about is that the main context might sample a texture before the loader's commands have
+actually run. After every upload the loader inserts a fence and flushes, and the main thread only hands a texture out once
+its fence has been signaled (checked without blocking in Update, once per frame). Until then whoever asked for the texture
+draws with a placeholder.
+
+Buffers are shared between contexts as well, so a model's vertex and element buffers are created and filled on the
+loader thread behind a fence just like a texture. Vertex array objects are never shared though, so only the vertex array
+that describes the buffers is created on the main thread once they're ready (see MeshBuffer::AdoptBuffers). Model data
+is converted on worker threads already (see Model::ParallelFor) */
+
+// Used until the real texture is ready, a flat normal for normal maps and plain grey for everything else
+enum AssetPlaceholder
+{
+	PLACEHOLDER_COLOR,
+	PLACEHOLDER_NORMAL
+};
+
+// A texture requested from the loader, textureID is the placeholder until ready is set
+struct AsyncTexture
+{
+	string filePath;
+	TextureLoadOptions options;
+
+	unsigned int textureID;
+	bool ready;
+
+	// How many times this texture was requested while it was loading, each request owns one texture cache reference
+	unsigned int requestCount;
+
+	// Requests that were released before the texture arrived, their references are given back right away
+	unsigned int releasedCount;
+
+	// Filled in on the loader thread
+	unsigned int loadedTextureID;
+	int width, height;
+	GLsync fence;
+};
+
+// A vertex and an element buffer requested from the loader, the buffer IDs can only be used once ready is set
+struct AsyncBuffers
+{
+	// Given back as soon as the buffers are filled, glBufferData keeps a copy of its own
+	vector<unsigned char> vertexData, indexData;
+
+	bool ready;
+
+	// Set when the buffers were released before they arrived, they're deleted as soon as they do
+	bool released;
+
+	// Filled in on the loader thread
+	unsigned int vertexBuffer, indexBuffer;
+	GLsync fence;
+};
+
+class AssetLoader
+{
+public:
+	// Creates the hidden shared context and starts the loader thread, call once the main window's context is current
+	static bool Initialize(GLFWwindow* mainWindow);
+
+	// Finishes the textures that are still queued and stops the loader thread
+	static void Shutdown();
+
+	/* Returns the texture right away if the texture cache already has it, otherwise it's queued for the loader thread and
+	the returned texture is the placeholder until ready is set. Without a loader thread it's loaded on the spot */
+	static shared_ptr<AsyncTexture> LoadTextureAsync(const string& filePath, const TextureLoadOptions& options,
+		AssetPlaceholder placeholder = PLACEHOLDER_COLOR);
+
+	// Gives back a texture requested with LoadTextureAsync, even one that hasn't arrived yet
+	static void ReleaseTexture(const shared_ptr<AsyncTexture>& texture);
+
+	/* Queues a vertex and an element buffer with the given contents for the loader thread. Without a loader thread they're
+	created on the spot and are ready right away */
+	static shared_ptr<AsyncBuffers> LoadBuffersAsync(vector<unsigned char>&& vertexData,
+		vector<unsigned char>&& indexData);
+
+	// Deletes buffers requested with LoadBuffersAsync that nobody took over, even ones that haven't arrived yet
+	static void ReleaseBuffers(const shared_ptr<AsyncBuffers>& buffers);
+
+	/* Hands out every texture and buffer whose upload has finished on the GPU, never blocks. Call once per frame on the
+	main thread */
+	static void Update();
+
+	// Blocks until every queued texture and buffer is ready (benchmarks and shutdown)
+	static void WaitAll();
+
+	static unsigned int GetPlaceholderTexture(AssetPlaceholder placeholder);
+
+	// Number of textures and buffers queued or uploading on the loader thread
+	static unsigned int GetPendingCount();
+
+private:
+	AssetLoader() { }
+
+	static void LoaderThread();
+
+	// Decodes and uploads one texture on the loader thread
+	static void LoadOnLoaderThread(AsyncTexture& texture);
+
+	// Creates and fills the vertex and element buffer on the loader thread
+	static void LoadBuffersOnLoaderThread(AsyncBuffers& buffers);
+
+	// Creates and fills the buffers with the main context, when there's no loader thread
+	static void LoadBuffers(AsyncBuffers& buffers);
+
+	// Moves a finished texture into the texture cache, main thread only
+	static void FinishTexture(AsyncTexture& texture);
+
+	// Hands out finished buffers, or deletes them if they were released in the meantime. Main thread only
+	static void FinishBuffers(AsyncBuffers& buffers);
+
+	// Returns true once the loader thread's fence has been signaled (or if there's none), without waiting for it
+	static bool IsFenceSignaled(GLsync& fence);
+
+	static GLFWwindow* loaderWindow;
+	static thread loaderThread;
+
+	static mutex queueMutex;
+	static condition_variable queueCondition;
+	static bool stopping;
+
+	// Waiting for the loader thread, and uploaded on the loader thread but not handed out yet
+	static deque<shared_ptr<AsyncTexture>> queuedTextures;
+	static vector<shared_ptr<AsyncTexture>> uploadedTextures;
+
+	// Uploaded textures whose fence hasn't been signaled yet (main thread only)
+	static vector<shared_ptr<AsyncTexture>> fencedTextures;
+
+	// Every texture that isn't ready yet by its texture cache key, so the same file is only queued once (main thread only)
+	static unordered_map<string, shared_ptr<AsyncTexture>> pendingTextures;
+
+	// The same three stages for buffers
+	static deque<shared_ptr<AsyncBuffers>> queuedBuffers;
+	static vector<shared_ptr<AsyncBuffers>> uploadedBuffers;
+	static vector<shared_ptr<AsyncBuffers>> fencedBuffers;
+
+	// Buffers that aren't ready yet (main thread only)
+	static unsigned int pendingBufferCount;
+
+	static unsigned int placeholderTextures[2];
+};
+
+#endif
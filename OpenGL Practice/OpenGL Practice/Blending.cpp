@@ -62,13 +62,13 @@ void Blending::SetBlending()
 	glGenBuffers(1, &transparentVBO); // The & is a reference to the unsigned int of VBO and converts it to a GLuint pointer type
 
 	// This binds the buffers more than once at the same time as long as they're different buffer types
-	glBindBuffer(GL_ARRAY_BUFFER, transparentVBO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, transparentVBO);
 
 	// Copies the previously defined vertex data into the buffer's memory
 	glBufferData(GL_ARRAY_BUFFER, sizeof(transparentVertices), &transparentVertices, GL_STATIC_DRAW);
 
 	// Bind the vertex array object using its ID
-	glBindVertexArray(transparentVAO);
+	GLStateCache::BindVertexArray(transparentVAO);
 
 	// Set the position attribute's location to 0 like our vertex shader GLSL file
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
@@ -83,7 +83,7 @@ void Blending::SetBlending()
 	// Generate the specular texture in OpenGL first before binding it
 	glGenTextures(1, &transparentTexture);
 
-	glBindTexture(GL_TEXTURE_2D, transparentTexture);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, transparentTexture);
 
 	// Use GL_CLAMP_TO_EDGE if we use alpha textures that shouldn't repeated
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
@@ -117,11 +117,11 @@ void Blending::SetBlending()
 
 	// Bind the specular map texture here
 
-	glActiveTexture(GL_TEXTURE0); // Active the first texture unit
-	glBindTexture(GL_TEXTURE_2D, transparentTexture);
+	GLStateCache::ActiveTexture(GL_TEXTURE0); // Active the first texture unit
+	GLStateCache::BindTexture(GL_TEXTURE_2D, transparentTexture);
 
 	// Bind the vertex array object using its ID
-	glBindVertexArray(transparentVAO);
+	GLStateCache::BindVertexArray(transparentVAO);
 }
 
 void Blending::IncludeGrassBlending()
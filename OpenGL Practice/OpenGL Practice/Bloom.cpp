@@ -1,5 +1,6 @@
 #include "Bloom.h"
 #include "Camera.h"
+#include "TextureCache.h"
 
 Bloom* Bloom::bloomInstance = NULL;
 
@@ -34,7 +35,7 @@ Bloom* Bloom::Instance()
 
 void Bloom::InitializeBloom()
 {
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::Enable(GL_DEPTH_TEST);
 
 	// Bloom shader
 	bloomShaders[0]->InitializeShaderProgram(new VertexShaderLoader("BloomVertexShader.glsl"), 
@@ -57,14 +58,14 @@ void Bloom::InitializeBloom()
 
     // Initialize frame buffer (floating point)
     glGenFramebuffers(1, &hdrFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
 
     // Create 2 floating point color buffers (1 for normal rendering, other for brightness threshold values)
     glGenTextures(2, colorBuffers);
 
     for (unsigned int i = 0; i < 2; i++)
     {
-        glBindTexture(GL_TEXTURE_2D, colorBuffers[i]);
+        GLStateCache::BindTexture(GL_TEXTURE_2D, colorBuffers[i]);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, 1280, 960, 0, GL_RGBA, GL_FLOAT, NULL);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -95,7 +96,7 @@ void Bloom::InitializeBloom()
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         cout << "Framebuffer not complete!" << endl;
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // ping-pong-framebuffer for blurring
     glGenFramebuffers(2, pingpongFBO);
@@ -103,8 +104,8 @@ void Bloom::InitializeBloom()
 
     for (unsigned int i = 0; i < 2; i++)
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[i]);
-        glBindTexture(GL_TEXTURE_2D, pingpongColorbuffers[i]);
+        GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[i]);
+        GLStateCache::BindTexture(GL_TEXTURE_2D, pingpongColorbuffers[i]);
 
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, 1280, 960, 0, GL_RGBA, GL_FLOAT, NULL);
 
@@ -134,13 +135,13 @@ void Bloom::InitializeBloom()
     lightColors.push_back(vec3(0.0f, 0.0f, 15.0f));
     lightColors.push_back(vec3(0.0f, 5.0f, 0.0f));
 
-    glUseProgram(bloomShaders[0]->shaderProgram);
+    GLStateCache::UseProgram(bloomShaders[0]->shaderProgram);
     glUniform1i(glGetUniformLocation(bloomShaders[0]->shaderProgram, "diffuseTexture"), 0);
 
-    glUseProgram(bloomShaders[2]->shaderProgram);
+    GLStateCache::UseProgram(bloomShaders[2]->shaderProgram);
     glUniform1i(glGetUniformLocation(bloomShaders[2]->shaderProgram, "image"), 0);
 
-    glUseProgram(bloomShaders[3]->shaderProgram);
+    GLStateCache::UseProgram(bloomShaders[3]->shaderProgram);
     glUniform1i(glGetUniformLocation(bloomShaders[3]->shaderProgram, "scene"), 0);
     glUniform1i(glGetUniformLocation(bloomShaders[3]->shaderProgram, "bloomBlur"), 1);
 }
@@ -151,20 +152,15 @@ void Bloom::RenderBloom()
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     // Render scene into floating point framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glm::mat4 projection = glm::perspective(glm::radians(Camera::fieldOfView), float(1280 / 960), 0.1f, 100.0f);
-    glm::mat4 view = lookAt(Camera::cameraPosition, Camera::cameraPosition + Camera::cameraFront, Camera::cameraUp);
     glm::mat4 model = glm::mat4(1.0f);
     
-    glUseProgram(bloomShaders[0]->shaderProgram);
+    GLStateCache::UseProgram(bloomShaders[0]->shaderProgram);
 
-    glUniformMatrix4fv(glGetUniformLocation(bloomShaders[0]->shaderProgram, "projection"), 1, GL_FALSE, value_ptr(projection));
-    glUniformMatrix4fv(glGetUniformLocation(bloomShaders[0]->shaderProgram, "view"), 1, GL_FALSE, value_ptr(view));
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, woodTexture);
+    GLStateCache::ActiveTexture(GL_TEXTURE0);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, woodTexture);
 
     // Set lighting uniforms
     for (unsigned int i = 0; i < lightPositions.size(); i++)
@@ -176,8 +172,6 @@ void Bloom::RenderBloom()
             ("lights[" + std::to_string(i) + "].color").c_str()), 1, value_ptr(lightColors[i]));
     }
 
-    glUniform3fv(glGetUniformLocation(bloomShaders[0]->shaderProgram, "viewPos"), 1, value_ptr(Camera::cameraPosition));
-    
     // Create one large cube that acts as the floor
     model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(0.0f, -1.0f, 0.0));
@@ -187,7 +181,7 @@ void Bloom::RenderBloom()
     RenderCube();
 
     // then create multiple cubes as the scenery
-    glBindTexture(GL_TEXTURE_2D, containerTexture);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, containerTexture);
 
     model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(0.0f, 1.5f, 0.0));
@@ -233,9 +227,7 @@ void Bloom::RenderBloom()
     RenderCube();
 
     // Finally show all the light sources as bright cubes
-    glUseProgram(bloomShaders[1]->shaderProgram);
-    glUniformMatrix4fv(glGetUniformLocation(bloomShaders[1]->shaderProgram, "projection"), 1, GL_FALSE, value_ptr(projection));
-    glUniformMatrix4fv(glGetUniformLocation(bloomShaders[1]->shaderProgram, "view"), 1, GL_FALSE, value_ptr(view));
+    GLStateCache::UseProgram(bloomShaders[1]->shaderProgram);
 
     for (unsigned int i = 0; i < lightPositions.size(); i++)
     {
@@ -248,21 +240,21 @@ void Bloom::RenderBloom()
         RenderCube();
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Blur bright fragments with two-pass Gaussian Blur
     bool horizontal = true, first_iteration = true;
     unsigned int amount = 10;
 
-    glUseProgram(bloomShaders[2]->shaderProgram);
+    GLStateCache::UseProgram(bloomShaders[2]->shaderProgram);
 
     for (unsigned int i = 0; i < amount; i++)
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[horizontal]);
+        GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[horizontal]);
         glUniform1i(glGetUniformLocation(bloomShaders[2]->shaderProgram, "horizontal"), horizontal);
 
         // Bind texture of other framebuffer (or scene if first iteration)
-        glBindTexture(GL_TEXTURE_2D, first_iteration ? colorBuffers[1] : pingpongColorbuffers[!horizontal]);
+        GLStateCache::BindTexture(GL_TEXTURE_2D, first_iteration ? colorBuffers[1] : pingpongColorbuffers[!horizontal]);
         
         RenderQuad();
 
@@ -270,17 +262,17 @@ void Bloom::RenderBloom()
         if (first_iteration) first_iteration = false;
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Render floating point color buffer to 2D quad and tonemap HDR colors to default framebuffer's (clamped) color range
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glUseProgram(bloomShaders[3]->shaderProgram);
+    GLStateCache::UseProgram(bloomShaders[3]->shaderProgram);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, colorBuffers[0]);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, pingpongColorbuffers[!horizontal]);
+    GLStateCache::ActiveTexture(GL_TEXTURE0);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, colorBuffers[0]);
+    GLStateCache::ActiveTexture(GL_TEXTURE1);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, pingpongColorbuffers[!horizontal]);
 
     glUniform1i(glGetUniformLocation(bloomShaders[3]->shaderProgram, "bloom"), bloom);
     glUniform1f(glGetUniformLocation(bloomShaders[3]->shaderProgram, "exposure"), exposure);
@@ -341,23 +333,23 @@ void Bloom::RenderCube()
         glGenVertexArrays(1, &cubeVAO);
         glGenBuffers(1, &cubeVBO);
 
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+        GLStateCache::BindBuffer(GL_ARRAY_BUFFER, cubeVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
 
-        glBindVertexArray(cubeVAO);
+        GLStateCache::BindVertexArray(cubeVAO);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
         glEnableVertexAttribArray(2);
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+        GLStateCache::BindVertexArray(0);
     }
 
-    glBindVertexArray(cubeVAO);
+    GLStateCache::BindVertexArray(cubeVAO);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
+    GLStateCache::BindVertexArray(0);
 }
 
 void Bloom::RenderQuad()
@@ -375,8 +367,8 @@ void Bloom::RenderQuad()
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
 
-        glBindVertexArray(quadVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        GLStateCache::BindVertexArray(quadVAO);
+        GLStateCache::BindBuffer(GL_ARRAY_BUFFER, quadVBO);
 
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
 
@@ -386,54 +378,14 @@ void Bloom::RenderQuad()
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
     }
 
-    glBindVertexArray(quadVAO);
+    GLStateCache::BindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    glBindVertexArray(0);
+    GLStateCache::BindVertexArray(0);
 }
 
 unsigned int Bloom::LoadTexture(const char* path, bool gammaCorrection)
 {
-	unsigned int textureID;
-
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum internalFormat;
-        GLenum dataFormat;
-        if (nrComponents == 1)
-        {
-            internalFormat = dataFormat = GL_RED;
-        }
-        else if (nrComponents == 3)
-        {
-            internalFormat = gammaCorrection ? GL_SRGB : GL_RGB;
-            dataFormat = GL_RGB;
-        }
-        else if (nrComponents == 4)
-        {
-            internalFormat = gammaCorrection ? GL_SRGB_ALPHA : GL_RGBA;
-            dataFormat = GL_RGBA;
-        }
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, dataFormat, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-	return textureID;
+	// Shared with every other technique that loads the same file with the same options
+	return TextureCache::LoadTexture(path, TextureLoadOptions(false, gammaCorrection, 0, true, false,
+		TEXTURE_COMPRESSION_COLOR));
 }
\ No newline at end of file
@@ -16,7 +16,7 @@ struct Light {
 
 uniform Light lights[4];
 uniform sampler2D diffuseTexture;
-uniform vec3 viewPos;
+#include "FrameUniforms.glsl"
 
 void main()
 {           
@@ -28,7 +28,7 @@ void main()
 
     // lighting
     vec3 lighting = vec3(0.0);
-    vec3 viewDir = normalize(viewPos - shader_fs.fragPosition);
+    vec3 viewDir = normalize(frame.cameraPosition.xyz - shader_fs.fragPosition);
 
     for(int i = 0; i < 4; i++)
     {
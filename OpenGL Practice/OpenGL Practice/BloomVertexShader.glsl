@@ -10,8 +10,7 @@ out SHADER_VARIABLES {
     vec2 texCoords;
 } shader_vs;
 
-uniform mat4 projection;
-uniform mat4 view;
+#include "FrameUniforms.glsl"
 uniform mat4 model;
 
 void main()
@@ -22,5 +21,5 @@ void main()
     mat3 normalMatrix = transpose(inverse(mat3(model)));
     shader_vs.normal = normalize(normalMatrix * normals);
     
-    gl_Position = projection * view * model * vec4(position, 1.0);
+    gl_Position = frame.viewProjection * model * vec4(position, 1.0);
 }
\ No newline at end of file
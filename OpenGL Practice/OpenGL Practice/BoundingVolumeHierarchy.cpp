@@ -0,0 +1,391 @@
+#include "BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <cfloat>
+
+// Planes tried per split are one less than this
+const unsigned int BVH_BIN_COUNT = 12;
+
+// Cost of walking into a node compared to testing one primitive, without it every leaf would end up with one primitive
+const float BVH_TRAVERSAL_COST = 1.0f;
+
+// Half the surface area of a box, only ever compared to other areas so the factor of 2 doesn't matter
+static float HalfArea(const vec3& boundsMin, const vec3& boundsMax)
+{
+	vec3 extent = boundsMax - boundsMin;
+
+	return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+void BoundingVolumeHierarchy::Build(const vector<vec3>& boundsMins_, const vector<vec3>& boundsMaxs_,
+	unsigned int maxLeafSize_)
+{
+	Clear();
+
+	unsigned int primitiveCount = static_cast<unsigned int>(boundsMins_.size());
+
+	if (primitiveCount == 0)
+		return;
+
+	maxLeafSize_ = std::max(maxLeafSize_, 1u);
+
+	primitiveIndices.resize(primitiveCount);
+	primitiveMins = boundsMins_;
+	primitiveMaxs = boundsMaxs_;
+
+	vector<vec3> centers(primitiveCount);
+
+	for (unsigned int i = 0; i < primitiveCount; i++)
+	{
+		primitiveIndices[i] = i;
+		centers[i] = (boundsMins_[i] + boundsMaxs_[i]) * 0.5f;
+	}
+
+	// A binary tree with a primitive in every leaf has 2 * count - 1 nodes, it never has more than that
+	nodes.reserve(primitiveCount * 2 - 1);
+
+	BVHNode root;
+	root.first = 0;
+	root.count = primitiveCount;
+
+	nodes.push_back(root);
+	UpdateNodeBounds(0);
+
+	// Explicit stack of (node, depth), so a very deep tree can't run out of call stack while it's built
+	vector<pair<unsigned int, unsigned int>> stack;
+	stack.push_back(make_pair(0u, 0u));
+
+	while (!stack.empty())
+	{
+		pair<unsigned int, unsigned int> entry = stack.back();
+		stack.pop_back();
+
+		if (entry.second + 1 >= MAX_DEPTH || !Subdivide(entry.first, centers, maxLeafSize_))
+			continue;
+
+		unsigned int leftChild = nodes[entry.first].first;
+
+		stack.push_back(make_pair(leftChild, entry.second + 1));
+		stack.push_back(make_pair(leftChild + 1, entry.second + 1));
+	}
+
+	// The boxes were indexed by primitive while building, the leaves read them by slot from now on
+	for (unsigned int i = 0; i < primitiveCount; i++)
+	{
+		primitiveMins[i] = boundsMins_[primitiveIndices[i]];
+		primitiveMaxs[i] = boundsMaxs_[primitiveIndices[i]];
+	}
+
+	nodes.shrink_to_fit();
+}
+
+void BoundingVolumeHierarchy::UpdateNodeBounds(unsigned int nodeIndex_)
+{
+	BVHNode& node = nodes[nodeIndex_];
+
+	node.boundsMin = vec3(FLT_MAX);
+	node.boundsMax = vec3(-FLT_MAX);
+
+	for (unsigned int i = node.first; i < node.first + node.count; i++)
+	{
+		node.boundsMin = min(node.boundsMin, primitiveMins[primitiveIndices[i]]);
+		node.boundsMax = max(node.boundsMax, primitiveMaxs[primitiveIndices[i]]);
+	}
+}
+
+bool BoundingVolumeHierarchy::Subdivide(unsigned int nodeIndex_, const vector<vec3>& centers_,
+	unsigned int maxLeafSize_)
+{
+	BVHNode node = nodes[nodeIndex_];
+
+	if (node.count <= 1)
+		return false;
+
+	// The bins split the range of the centers, not the node's box, the centers are what gets sorted into them
+	vec3 centerMin = vec3(FLT_MAX), centerMax = vec3(-FLT_MAX);
+
+	for (unsigned int i = node.first; i < node.first + node.count; i++)
+	{
+		centerMin = min(centerMin, centers_[primitiveIndices[i]]);
+		centerMax = max(centerMax, centers_[primitiveIndices[i]]);
+	}
+
+	vec3 extent = centerMax - centerMin;
+	int axis = 0;
+
+	if (extent.y > extent[axis])
+		axis = 1;
+
+	if (extent.z > extent[axis])
+		axis = 2;
+
+	// Every center is in the same spot, no plane can separate them
+	if (extent[axis] <= 0.0f)
+		return false;
+
+	unsigned int binCounts[BVH_BIN_COUNT] = {};
+	vec3 binMins[BVH_BIN_COUNT], binMaxs[BVH_BIN_COUNT];
+
+	for (unsigned int i = 0; i < BVH_BIN_COUNT; i++)
+	{
+		binMins[i] = vec3(FLT_MAX);
+		binMaxs[i] = vec3(-FLT_MAX);
+	}
+
+	float binScale = BVH_BIN_COUNT / extent[axis];
+
+	auto GetBin = [&](unsigned int primitive)
+	{
+		unsigned int bin = static_cast<unsigned int>((centers_[primitive][axis] - centerMin[axis]) * binScale);
+		return std::min(bin, BVH_BIN_COUNT - 1);
+	};
+
+	for (unsigned int i = node.first; i < node.first + node.count; i++)
+	{
+		unsigned int primitive = primitiveIndices[i];
+		unsigned int bin = GetBin(primitive);
+
+		binCounts[bin]++;
+		binMins[bin] = min(binMins[bin], primitiveMins[primitive]);
+		binMaxs[bin] = max(binMaxs[bin], primitiveMaxs[primitive]);
+	}
+
+	// Sweep from the left and from the right once, so the cost of every plane is known without going over the bins again
+	float leftAreas[BVH_BIN_COUNT - 1], rightAreas[BVH_BIN_COUNT - 1];
+	unsigned int leftCounts[BVH_BIN_COUNT - 1], rightCounts[BVH_BIN_COUNT - 1];
+
+	vec3 leftMin = vec3(FLT_MAX), leftMax = vec3(-FLT_MAX);
+	vec3 rightMin = vec3(FLT_MAX), rightMax = vec3(-FLT_MAX);
+
+	unsigned int leftCount = 0, rightCount = 0;
+
+	for (unsigned int i = 0; i < BVH_BIN_COUNT - 1; i++)
+	{
+		leftCount += binCounts[i];
+		leftMin = min(leftMin, binMins[i]);
+		leftMax = max(leftMax, binMaxs[i]);
+
+		leftCounts[i] = leftCount;
+		leftAreas[i] = leftCount > 0 ? HalfArea(leftMin, leftMax) : 0.0f;
+
+		unsigned int rightBin = BVH_BIN_COUNT - 1 - i;
+
+		rightCount += binCounts[rightBin];
+		rightMin = min(rightMin, binMins[rightBin]);
+		rightMax = max(rightMax, binMaxs[rightBin]);
+
+		rightCounts[rightBin - 1] = rightCount;
+		rightAreas[rightBin - 1] = rightCount > 0 ? HalfArea(rightMin, rightMax) : 0.0f;
+	}
+
+	float bestCost = FLT_MAX;
+	unsigned int bestPlane = 0;
+
+	for (unsigned int i = 0; i < BVH_BIN_COUNT - 1; i++)
+	{
+		if (leftCounts[i] == 0 || rightCounts[i] == 0)
+			continue;
+
+		float cost = leftCounts[i] * leftAreas[i] + rightCounts[i] * rightAreas[i];
+
+		if (cost < bestCost)
+		{
+			bestCost = cost;
+			bestPlane = i;
+		}
+	}
+
+	if (bestCost == FLT_MAX)
+		return false;
+
+	// Small nodes stay leaves if testing their primitives directly is cheaper than walking into two children
+	float nodeArea = HalfArea(node.boundsMin, node.boundsMax);
+
+	if (node.count <= maxLeafSize_ && bestCost + BVH_TRAVERSAL_COST * nodeArea >= node.count * nodeArea)
+		return false;
+
+	unsigned int* begin = primitiveIndices.data() + node.first;
+	unsigned int* middle = partition(begin, begin + node.count, [&](unsigned int primitive)
+	{
+		return GetBin(primitive) <= bestPlane;
+	});
+
+	unsigned int leftSize = static_cast<unsigned int>(middle - begin);
+
+	unsigned int leftChild = static_cast<unsigned int>(nodes.size());
+
+	BVHNode left;
+	left.first = node.first;
+	left.count = leftSize;
+
+	BVHNode right;
+	right.first = node.first + leftSize;
+	right.count = node.count - leftSize;
+
+	nodes.push_back(left);
+	nodes.push_back(right);
+
+	UpdateNodeBounds(leftChild);
+	UpdateNodeBounds(leftChild + 1);
+
+	nodes[nodeIndex_].first = leftChild;
+	nodes[nodeIndex_].count = 0;
+
+	return true;
+}
+
+void BoundingVolumeHierarchy::Clear()
+{
+	nodes.clear();
+	primitiveIndices.clear();
+	primitiveMins.clear();
+	primitiveMaxs.clear();
+}
+
+bool BoundingVolumeHierarchy::IsEmpty() const
+{
+	return nodes.empty();
+}
+
+void BoundingVolumeHierarchy::QueryFrustum(const Frustum& frustum_, vector<unsigned int>& primitives_) const
+{
+	if (nodes.empty())
+		return;
+
+	unsigned int stack[MAX_DEPTH + 1];
+	unsigned int stackSize = 0;
+
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const BVHNode& node = nodes[stack[--stackSize]];
+
+		if (!frustum_.IntersectsBox(node.boundsMin, node.boundsMax))
+			continue;
+
+		if (node.count == 0)
+		{
+			stack[stackSize++] = node.first;
+			stack[stackSize++] = node.first + 1;
+
+			continue;
+		}
+
+		for (unsigned int i = node.first; i < node.first + node.count; i++)
+		{
+			// A leaf with a single primitive has the same box as it, there's no need to test it twice
+			if (node.count == 1 || frustum_.IntersectsBox(primitiveMins[i], primitiveMaxs[i]))
+				primitives_.push_back(primitiveIndices[i]);
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::QuerySphere(const vec3& center_, float radius_, vector<unsigned int>& primitives_) const
+{
+	if (nodes.empty())
+		return;
+
+	unsigned int stack[MAX_DEPTH + 1];
+	unsigned int stackSize = 0;
+
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const BVHNode& node = nodes[stack[--stackSize]];
+
+		if (!BoundingVolumes::SphereIntersectsBox(center_, radius_, node.boundsMin, node.boundsMax))
+			continue;
+
+		if (node.count == 0)
+		{
+			stack[stackSize++] = node.first;
+			stack[stackSize++] = node.first + 1;
+
+			continue;
+		}
+
+		for (unsigned int i = node.first; i < node.first + node.count; i++)
+		{
+			if (node.count == 1 || BoundingVolumes::SphereIntersectsBox(center_, radius_, primitiveMins[i],
+				primitiveMaxs[i]))
+			{
+				primitives_.push_back(primitiveIndices[i]);
+			}
+		}
+	}
+}
+
+int BoundingVolumeHierarchy::CastRay(const Ray& ray_, float& maxDistance_,
+	const function<bool(unsigned int, float&)>& intersect_) const
+{
+	int closestPrimitive = -1;
+	float distance;
+
+	if (nodes.empty() || !BoundingVolumes::RayIntersectsBox(ray_, nodes[0].boundsMin, nodes[0].boundsMax, maxDistance_,
+		distance))
+	{
+		return -1;
+	}
+
+	// Every node on the stack was hit by the ray, with the distance where the ray enters it
+	unsigned int stack[MAX_DEPTH + 1];
+	float stackDistances[MAX_DEPTH + 1];
+	unsigned int stackSize = 0;
+
+	stack[stackSize] = 0;
+	stackDistances[stackSize++] = distance;
+
+	while (stackSize > 0)
+	{
+		stackSize--;
+
+		// Something closer was hit since the node was pushed
+		if (stackDistances[stackSize] > maxDistance_)
+			continue;
+
+		const BVHNode& node = nodes[stack[stackSize]];
+
+		if (node.count > 0)
+		{
+			for (unsigned int i = node.first; i < node.first + node.count; i++)
+			{
+				if (intersect_(primitiveIndices[i], maxDistance_))
+					closestPrimitive = static_cast<int>(primitiveIndices[i]);
+			}
+
+			continue;
+		}
+
+		float leftDistance, rightDistance;
+
+		const BVHNode& left = nodes[node.first];
+		const BVHNode& right = nodes[node.first + 1];
+
+		bool hitLeft = BoundingVolumes::RayIntersectsBox(ray_, left.boundsMin, left.boundsMax, maxDistance_,
+			leftDistance);
+		bool hitRight = BoundingVolumes::RayIntersectsBox(ray_, right.boundsMin, right.boundsMax, maxDistance_,
+			rightDistance);
+
+		// The nearer child is pushed last so it's visited first, a hit in it can skip the other child completely
+		if (hitLeft && hitRight)
+		{
+			bool leftFirst = leftDistance <= rightDistance;
+
+			stack[stackSize] = leftFirst ? node.first + 1 : node.first;
+			stackDistances[stackSize++] = leftFirst ? rightDistance : leftDistance;
+
+			stack[stackSize] = leftFirst ? node.first : node.first + 1;
+			stackDistances[stackSize++] = leftFirst ? leftDistance : rightDistance;
+		}
+
+		else if (hitLeft || hitRight)
+		{
+			stack[stackSize] = hitLeft ? node.first : node.first + 1;
+			stackDistances[stackSize++] = hitLeft ? leftDistance : rightDistance;
+		}
+	}
+
+	return closestPrimitive;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#ifndef BOUNDING_VOLUME_HIERARCHY_H
+#define BOUNDING_VOLUME_HIERARCHY_H
+
+#include "BoundingVolumes.h"
+
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+/* A bounding volume hierarchy is a binary tree of boxes: the root's box encloses every primitive (a mesh or a triangle),
+every node splits its primitives between its two children, and the leaves hold a few primitives each. A query only walks
+into the nodes whose boxes it touches, so instead of testing every primitive it tests about log2(count) boxes on the way
+down to the ones that matter.
+
+Where a node is split is chosen with the surface area heuristic: the chance of a random ray (or query) hitting a box is
+about proportional to its surface area, so the split that minimizes (area of the left box * primitives on the left) +
+(area of the right box * primitives on the right) makes the cheapest tree to walk. Instead of trying every possible
+split, the primitives' centers are sorted into a handful of bins along the node's longest axis and only the planes between
+the bins are tried, which builds about as good a tree in linear time per level */
+
+// 32 bytes, two nodes fit in one cache line
+struct BVHNode
+{
+	vec3 boundsMin;
+
+	// First child for inner nodes (the second child always follows it), first primitive slot for leaves
+	unsigned int first;
+
+	vec3 boundsMax;
+
+	// Primitives in the leaf, 0 for inner nodes
+	unsigned int count;
+};
+
+static_assert(sizeof(BVHNode) == 32, "BVHNode has to stay tightly packed");
+
+class BoundingVolumeHierarchy
+{
+public:
+	BoundingVolumeHierarchy() { }
+
+	// Builds the tree over primitives given by their boxes, leaves hold at most maxLeafSize_ primitives where possible
+	void Build(const vector<vec3>& boundsMins_, const vector<vec3>& boundsMaxs_, unsigned int maxLeafSize_ = 4);
+
+	void Clear();
+
+	bool IsEmpty() const;
+
+	// Appends every primitive whose box is at least partly inside the frustum
+	void QueryFrustum(const Frustum& frustum_, vector<unsigned int>& primitives_) const;
+
+	// Appends every primitive whose box the sphere touches
+	void QuerySphere(const vec3& center_, float radius_, vector<unsigned int>& primitives_) const;
+
+	/* Walks the boxes the ray hits nearest first and calls intersect_ for the primitives in them. intersect_ gets the
+	closest distance found so far and returns true (with the shorter distance) if its primitive is hit even closer.
+	Returns the closest primitive that was hit with maxDistance_ set to its distance, or -1 if there wasn't any */
+	int CastRay(const Ray& ray_, float& maxDistance_, const function<bool(unsigned int, float&)>& intersect_) const;
+
+	vector<BVHNode> nodes;
+
+	// Primitive of every leaf slot, leaves point into this
+	vector<unsigned int> primitiveIndices;
+
+	// Box of every leaf slot's primitive, stored in slot order so the leaves read them one after the other
+	vector<vec3> primitiveMins, primitiveMaxs;
+
+	// Deeper nodes are always leaves, which keeps the query stacks at a fixed size
+	static const unsigned int MAX_DEPTH = 64;
+
+private:
+	// Turns a leaf into an inner node with two children if splitting it makes the tree cheaper, returns false if not
+	bool Subdivide(unsigned int nodeIndex_, const vector<vec3>& centers_, unsigned int maxLeafSize_);
+
+	// Sets the node's box to enclose its primitives
+	void UpdateNodeBounds(unsigned int nodeIndex_);
+};
+
+#endif
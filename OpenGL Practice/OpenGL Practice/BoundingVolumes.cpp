@@ -0,0 +1,252 @@
+#include "BoundingVolumes.h"
+#include "Mesh.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// Every x64 compiler has SSE2, 32 bit MSVC has it unless the project builds for /arch:IA32
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BOUNDING_VOLUMES_SSE
+#include <emmintrin.h>
+#endif
+
+Ray::Ray(const vec3& origin_, const vec3& direction_) : origin(origin_), direction(direction_)
+{
+	// A zero component gives infinity, which the slab test handles on its own
+	inverseDirection = vec3(1.0f) / direction;
+}
+
+Frustum::Frustum(const mat4& viewProjectionMatrix)
+{
+	// glm matrices are column major, so row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+	vec4 row0 = vec4(viewProjectionMatrix[0][0], viewProjectionMatrix[1][0], viewProjectionMatrix[2][0],
+		viewProjectionMatrix[3][0]);
+	vec4 row1 = vec4(viewProjectionMatrix[0][1], viewProjectionMatrix[1][1], viewProjectionMatrix[2][1],
+		viewProjectionMatrix[3][1]);
+	vec4 row2 = vec4(viewProjectionMatrix[0][2], viewProjectionMatrix[1][2], viewProjectionMatrix[2][2],
+		viewProjectionMatrix[3][2]);
+	vec4 row3 = vec4(viewProjectionMatrix[0][3], viewProjectionMatrix[1][3], viewProjectionMatrix[2][3],
+		viewProjectionMatrix[3][3]);
+
+	// A point is inside when -w <= x <= w, -w <= y <= w and -w <= z <= w in clip space
+	planes[0] = row3 + row0;
+	planes[1] = row3 - row0;
+	planes[2] = row3 + row1;
+	planes[3] = row3 - row1;
+	planes[4] = row3 + row2;
+	planes[5] = row3 - row2;
+
+	// Normalized planes give real distances, which the sphere test needs
+	for (unsigned int i = 0; i < 6; i++)
+	{
+		float normalLength = length(vec3(planes[i]));
+
+		if (normalLength > 0.0f)
+			planes[i] /= normalLength;
+	}
+}
+
+bool Frustum::IntersectsBox(const vec3& boundsMin, const vec3& boundsMax) const
+{
+	for (unsigned int i = 0; i < 6; i++)
+	{
+		const vec4& plane = planes[i];
+
+		// The corner furthest along the plane's normal, if even that one is behind the plane the whole box is
+		vec3 corner = vec3(plane.x >= 0.0f ? boundsMax.x : boundsMin.x, plane.y >= 0.0f ? boundsMax.y : boundsMin.y,
+			plane.z >= 0.0f ? boundsMax.z : boundsMin.z);
+
+		if (dot(vec3(plane), corner) + plane.w < 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+bool Frustum::IntersectsSphere(const vec3& center, float radius) const
+{
+	for (unsigned int i = 0; i < 6; i++)
+	{
+		if (dot(vec3(planes[i]), center) + planes[i].w < -radius)
+			return false;
+	}
+
+	return true;
+}
+
+void BoundingVolumes::ComputeBounds(const Vertex* vertices, unsigned int vertexCount, vec3& boundsMin, vec3& boundsMax)
+{
+	if (vertexCount == 0)
+	{
+		boundsMin = vec3(0.0f);
+		boundsMax = vec3(0.0f);
+
+		return;
+	}
+
+#ifdef BOUNDING_VOLUMES_SSE
+	/* The position is followed by the normal inside Vertex, so reading four floats from it never leaves the vertex. The
+	fourth lane just collects the normal's x and is thrown away. Two sets of registers let the processor work on two
+	vertices at once, the second one doesn't have to wait for the first one's result */
+	__m128 minimum0 = _mm_set1_ps(FLT_MAX), minimum1 = minimum0;
+	__m128 maximum0 = _mm_set1_ps(-FLT_MAX), maximum1 = maximum0;
+
+	unsigned int i = 0;
+
+	for (; i + 1 < vertexCount; i += 2)
+	{
+		__m128 position0 = _mm_loadu_ps(&vertices[i].meshPosition.x);
+		__m128 position1 = _mm_loadu_ps(&vertices[i + 1].meshPosition.x);
+
+		minimum0 = _mm_min_ps(minimum0, position0);
+		maximum0 = _mm_max_ps(maximum0, position0);
+		minimum1 = _mm_min_ps(minimum1, position1);
+		maximum1 = _mm_max_ps(maximum1, position1);
+	}
+
+	if (i < vertexCount)
+	{
+		__m128 position = _mm_loadu_ps(&vertices[i].meshPosition.x);
+
+		minimum0 = _mm_min_ps(minimum0, position);
+		maximum0 = _mm_max_ps(maximum0, position);
+	}
+
+	float minimum[4], maximum[4];
+	_mm_storeu_ps(minimum, _mm_min_ps(minimum0, minimum1));
+	_mm_storeu_ps(maximum, _mm_max_ps(maximum0, maximum1));
+
+	boundsMin = vec3(minimum[0], minimum[1], minimum[2]);
+	boundsMax = vec3(maximum[0], maximum[1], maximum[2]);
+#else
+	boundsMin = vertices[0].meshPosition;
+	boundsMax = vertices[0].meshPosition;
+
+	for (unsigned int i = 1; i < vertexCount; i++)
+	{
+		boundsMin = min(boundsMin, vertices[i].meshPosition);
+		boundsMax = max(boundsMax, vertices[i].meshPosition);
+	}
+#endif
+}
+
+BoundingSphere BoundingVolumes::ComputeBoundingSphere(const Vertex* vertices, unsigned int vertexCount,
+	const vec3& boundsMin, const vec3& boundsMax)
+{
+	BoundingSphere sphere;
+	sphere.center = (boundsMin + boundsMax) * 0.5f;
+
+	float squaredRadius = 0.0f;
+
+#ifdef BOUNDING_VOLUMES_SSE
+	__m128 center = _mm_setr_ps(sphere.center.x, sphere.center.y, sphere.center.z, 0.0f);
+
+	// Clears the fourth lane, which holds the normal's x instead of a coordinate
+	__m128 xyzMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+	__m128 maximum = _mm_setzero_ps();
+
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		__m128 offset = _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(&vertices[i].meshPosition.x), center), xyzMask);
+		__m128 squared = _mm_mul_ps(offset, offset);
+
+		// x + y + z ends up in every lane after adding the vector to two rotations of itself
+		__m128 sum = _mm_add_ps(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(0, 3, 2, 1)));
+		sum = _mm_add_ps(sum, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(1, 0, 3, 2)));
+
+		maximum = _mm_max_ps(maximum, sum);
+	}
+
+	squaredRadius = _mm_cvtss_f32(maximum);
+#else
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		vec3 offset = vertices[i].meshPosition - sphere.center;
+		squaredRadius = std::max(squaredRadius, dot(offset, offset));
+	}
+#endif
+
+	sphere.radius = sqrtf(squaredRadius);
+
+	return sphere;
+}
+
+void BoundingVolumes::TransformBounds(const mat4& matrix, const vec3& boundsMin, const vec3& boundsMax,
+	vec3& transformedMin, vec3& transformedMax)
+{
+	// Start at the translation, then add the smaller and larger end of every matrix element times the box's extent
+	transformedMin = vec3(matrix[3]);
+	transformedMax = vec3(matrix[3]);
+
+	for (int column = 0; column < 3; column++)
+	{
+		for (int row = 0; row < 3; row++)
+		{
+			float a = matrix[column][row] * boundsMin[column];
+			float b = matrix[column][row] * boundsMax[column];
+
+			transformedMin[row] += std::min(a, b);
+			transformedMax[row] += std::max(a, b);
+		}
+	}
+}
+
+bool BoundingVolumes::RayIntersectsBox(const Ray& ray, const vec3& boundsMin, const vec3& boundsMax,
+	float maxDistance, float& distance)
+{
+	// Where the ray crosses the two planes of every axis, the ray is inside the box where all three ranges overlap
+	vec3 distances0 = (boundsMin - ray.origin) * ray.inverseDirection;
+	vec3 distances1 = (boundsMax - ray.origin) * ray.inverseDirection;
+
+	vec3 nearDistances = min(distances0, distances1);
+	vec3 farDistances = max(distances0, distances1);
+
+	float entry = std::max(std::max(nearDistances.x, nearDistances.y), std::max(nearDistances.z, 0.0f));
+	float exit = std::min(std::min(farDistances.x, farDistances.y), std::min(farDistances.z, maxDistance));
+
+	distance = entry;
+
+	return entry <= exit;
+}
+
+bool BoundingVolumes::RayIntersectsTriangle(const Ray& ray, const vec3& a, const vec3& b, const vec3& c,
+	float& distance)
+{
+	vec3 edge1 = b - a;
+	vec3 edge2 = c - a;
+
+	vec3 p = cross(ray.direction, edge2);
+	float determinant = dot(edge1, p);
+
+	// The ray runs parallel to the triangle
+	if (fabsf(determinant) < 1e-12f)
+		return false;
+
+	float inverseDeterminant = 1.0f / determinant;
+
+	vec3 t = ray.origin - a;
+	float u = dot(t, p) * inverseDeterminant;
+
+	if (u < 0.0f || u > 1.0f)
+		return false;
+
+	vec3 q = cross(t, edge1);
+	float v = dot(ray.direction, q) * inverseDeterminant;
+
+	if (v < 0.0f || u + v > 1.0f)
+		return false;
+
+	distance = dot(edge2, q) * inverseDeterminant;
+
+	return distance >= 0.0f;
+}
+
+bool BoundingVolumes::SphereIntersectsBox(const vec3& center, float radius, const vec3& boundsMin,
+	const vec3& boundsMax)
+{
+	// The point of the box closest to the sphere's center
+	vec3 offset = glm::clamp(center, boundsMin, boundsMax) - center;
+
+	return dot(offset, offset) <= radius * radius;
+}
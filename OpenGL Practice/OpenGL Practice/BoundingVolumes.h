@@ -0,0 +1,84 @@
+#pragma once
+
+#ifndef BOUNDING_VOLUMES_H
+#define BOUNDING_VOLUMES_H
+
+#include <glm.hpp>
+
+using namespace std;
+using namespace glm;
+
+struct Vertex;
+
+/* Simple shapes that enclose a mesh (or a triangle, or a whole model), so the question "can the camera see it" or "does
+this ray hit it" can be answered with a handful of arithmetic instead of looking at every triangle. Boxes are axis
+aligned and given as their smallest and largest corner, the same way Mesh stores boundsMin and boundsMax.
+
+Every test here is in whichever space the shapes are in. To test a model that's drawn with a model matrix, either build
+the frustum from projection * view * model (its planes end up in model space) or move the ray into model space with the
+inverse of the model matrix */
+
+struct BoundingSphere
+{
+	vec3 center;
+	float radius;
+};
+
+struct Ray
+{
+	// The direction doesn't have to be normalized, distances along the ray are then in units of its length
+	Ray(const vec3& origin_, const vec3& direction_);
+
+	vec3 origin, direction;
+
+	// 1 / direction, the slab test divides by every component of the direction for every box
+	vec3 inverseDirection;
+};
+
+// The six planes of a view volume, every plane is (normal, distance) with the normal pointing into the volume
+struct Frustum
+{
+	Frustum() { }
+
+	/* Pulls the planes out of a projection * view matrix (Gribb and Hartmann, "Fast Extraction of Viewing Frustum Planes
+	from the World-View-Projection Matrix"). With a model matrix multiplied in as well, the planes are in model space */
+	explicit Frustum(const mat4& viewProjectionMatrix);
+
+	// False only if the box is completely outside one of the planes, boxes near the corners can pass without being inside
+	bool IntersectsBox(const vec3& boundsMin, const vec3& boundsMax) const;
+	bool IntersectsSphere(const vec3& center, float radius) const;
+
+	// Left, right, bottom, top, near and far
+	vec4 planes[6];
+};
+
+class BoundingVolumes
+{
+public:
+	// Smallest and largest vertex position of the vertices, four components at a time with SSE where the compiler has it
+	static void ComputeBounds(const Vertex* vertices, unsigned int vertexCount, vec3& boundsMin, vec3& boundsMax);
+
+	/* A sphere around the box's center that reaches the farthest vertex, which is smaller than the sphere around the box
+	itself for round meshes and never larger */
+	static BoundingSphere ComputeBoundingSphere(const Vertex* vertices, unsigned int vertexCount, const vec3& boundsMin,
+		const vec3& boundsMax);
+
+	// Box around the box after it's transformed by the matrix (Arvo's method, in "Graphics Gems")
+	static void TransformBounds(const mat4& matrix, const vec3& boundsMin, const vec3& boundsMax, vec3& transformedMin,
+		vec3& transformedMax);
+
+	/* Slab test, distance receives where the ray enters the box (0 if it starts inside). Misses count boxes that are only
+	hit further away than maxDistance */
+	static bool RayIntersectsBox(const Ray& ray, const vec3& boundsMin, const vec3& boundsMax, float maxDistance,
+		float& distance);
+
+	// Moller and Trumbore's test, both sides of the triangle count
+	static bool RayIntersectsTriangle(const Ray& ray, const vec3& a, const vec3& b, const vec3& c, float& distance);
+
+	static bool SphereIntersectsBox(const vec3& center, float radius, const vec3& boundsMin, const vec3& boundsMax);
+
+private:
+	BoundingVolumes() { }
+};
+
+#endif
@@ -0,0 +1,35 @@
+// Finds the lights of the cluster a fragment is in, the clusters are filled in by LightClusters on the CPU every frame
+// Works for the lighting pass of deferred shading as well as for forward shaders, all it needs is where the fragment is
+
+// Offset into clusterLightIndices and light count of every cluster
+uniform usamplerBuffer clusterGrid;
+
+// Every cluster's light indices, one list after the other
+uniform usamplerBuffer clusterLightIndices;
+
+// Tiles across and up the screen, and depth slices
+uniform vec3 clusterCounts;
+
+// The slice of a view space depth is log(depth) * scale + bias
+uniform vec2 clusterDepthScaleBias;
+
+// screenPosition goes from 0 to 1 across the screen (gl_FragCoord.xy / frame.screenSize in a forward shader), viewDepth
+// is the fragment's distance in front of the camera. Returns the cluster's offset and light count
+uvec2 FindCluster(vec2 screenPosition, float viewDepth)
+{
+    vec2 tile = clamp(floor(screenPosition * clusterCounts.xy), vec2(0.0), clusterCounts.xy - 1.0);
+
+    // Fragments closer than the near plane (or without any geometry) fall into the first slice
+    float slice = floor(log(max(viewDepth, 0.0001)) * clusterDepthScaleBias.x + clusterDepthScaleBias.y);
+    slice = clamp(slice, 0.0, clusterCounts.z - 1.0);
+
+    int cluster = int((slice * clusterCounts.y + tile.y) * clusterCounts.x + tile.x);
+
+    return texelFetch(clusterGrid, cluster).xy;
+}
+
+// Index of the cluster's i-th light in the light buffer
+int GetClusterLight(uvec2 cluster, uint i)
+{
+    return int(texelFetch(clusterLightIndices, int(cluster.x + i)).r);
+}
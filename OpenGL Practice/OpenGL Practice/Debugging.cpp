@@ -29,15 +29,15 @@ Debugging::~Debugging()
 {
 	delete debuggingShader;
 
-	glDeleteVertexArrays(1, &cubeVAO);
-	glDeleteBuffers(1, &cubeVBO);
+	GLStateCache::DeleteVertexArrays(1, &cubeVAO);
+	GLStateCache::DeleteBuffers(1, &cubeVBO);
 
 	for (unsigned int i = 0; i < cubeVertices.size(); i++)
 	{
 		cubeVertices[i] = NULL;
 	}
 
-	glDeleteTextures(1, &texture);
+	GLStateCache::DeleteTextures(1, &texture);
 
 	projection = mat4(NULL);
 }
@@ -84,8 +84,8 @@ void Debugging::InitializeDebugging()
 		callback function the moment an error occurred */
 
 		// initialize debug output
-		glEnable(GL_DEBUG_OUTPUT);
-		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+		GLStateCache::Enable(GL_DEBUG_OUTPUT);
+		GLStateCache::Enable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
 		glDebugMessageCallback(glDebugOutput, nullptr);
 
 		/* Filter the type(s) of errors youd like to receive a message from. Don't filter on any of the sources, types, or
@@ -93,8 +93,8 @@ void Debugging::InitializeDebugging()
 		glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
 	}
 
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE);
+	GLStateCache::Enable(GL_DEPTH_TEST);
+	GLStateCache::Enable(GL_CULL_FACE);
 
 	debuggingShader->InitializeShaderProgram(new VertexShaderLoader("DebuggingVertexShader.glsl"), 
 		new FragmentShaderLoader("DebuggingFragmentShader.glsl"));
@@ -148,20 +148,20 @@ void Debugging::InitializeDebugging()
 	glGenVertexArrays(1, &cubeVAO);
 	glGenBuffers(1, &cubeVBO);
 
-	glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, cubeVBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), &cubeVertices, GL_STATIC_DRAW);
 
-	glBindVertexArray(cubeVAO);
+	GLStateCache::BindVertexArray(cubeVAO);
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
 	glEnableVertexAttribArray(1);
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+	GLStateCache::BindVertexArray(0);
 
 	// Load cube texture
 	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, texture);
 
 	int width, height, nrComponents;
 	unsigned char* data = stbi_load("Textures/Wood.png", &width, &height, &nrComponents, 0);
@@ -194,7 +194,7 @@ void Debugging::RenderDebugging()
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	glUseProgram(debuggingShader->shaderProgram);
+	GLStateCache::UseProgram(debuggingShader->shaderProgram);
 
 	float rotationSpeed = 10.0f;
 	float angle = (float)glfwGetTime() * rotationSpeed;
@@ -210,11 +210,11 @@ void Debugging::RenderDebugging()
 
 	glUniformMatrix4fv(glGetUniformLocation(debuggingShader->shaderProgram, "model"), 1, GL_FALSE, value_ptr(model));
 
-	glBindTexture(GL_TEXTURE_2D, texture);
-	glBindVertexArray(cubeVAO);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, texture);
+	GLStateCache::BindVertexArray(cubeVAO);
 
 	glDrawArrays(GL_TRIANGLES, 0, 36);
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(0);
 }
 
 GLenum Debugging::CheckOpenGLerror(const char* file, int line)
@@ -4,11 +4,10 @@ layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 normals;
 layout (location = 2) in vec2 textureCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+#include "FrameUniforms.glsl"
 uniform mat4 model;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(position, 1.0);
+    gl_Position = frame.viewProjection * model * vec4(position, 1.0);
 }
\ No newline at end of file
@@ -1,8 +1,19 @@
 #include "DeferredShading.h"
 #include "Camera.h"
+#include "FrameUniforms.h"
 
 DeferredShading* DeferredShading::deferredShadingInstance = NULL;
 
+bool DeferredShading::cullOccludedObjects = false;
+bool DeferredShading::printOcclusionStatistics = false;
+
+unsigned int DeferredShading::lightCount = 32;
+bool DeferredShading::printLightClusterStatistics = false;
+
+// Uniform names hashed at compile time
+constexpr unsigned int MODEL_UNIFORM = UniformHash("model");
+constexpr unsigned int LIGHT_COLOR_UNIFORM = UniformHash("lightColor");
+
 /* Deferred shading is based on the idea that we defer or postpone most of the heavy rendering (like lighting) to a later 
 stage. Deferred shading consists of two passes: in the first pass, called the geometry pass, we render the scene once and 
 retrieve all kinds of geometrical information from the objects that we store in a collection of textures called the G-buffer. 
@@ -36,29 +47,28 @@ DeferredShading::~DeferredShading()
 
 	for (unsigned int i = 0; i < VAOs.size(); i++)
 	{
-		glDeleteVertexArrays(1, &VAOs[i]);
+		GLStateCache::DeleteVertexArrays(1, &VAOs[i]);
 	}
 
 	for (unsigned int i = 0; i < VBOs.size(); i++)
 	{
-		glDeleteBuffers(1, &VBOs[i]);
+		GLStateCache::DeleteBuffers(1, &VBOs[i]);
 	}
 
 	for (unsigned int i = 0; i < frameBuffers.size(); i++)
 	{
-		glDeleteFramebuffers(1, &frameBuffers[i]);
+		GLStateCache::DeleteFramebuffers(1, &frameBuffers[i]);
 	}
 
 	for (unsigned int i = 0; i < attachments.size(); i++)
 	{
-		glDeleteFramebuffers(1, &attachments[i]);
+		GLStateCache::DeleteFramebuffers(1, &attachments[i]);
 	}
 
 	glDeleteRenderbuffers(1, &rboDepth);
 
 	objectPositions.clear();
-	lightPositions.clear();
-	lightColors.clear();
+	objectMatrices.clear();
 
 	deferredShadingInstance = NULL;
 
@@ -78,7 +88,7 @@ DeferredShading* DeferredShading::Instance()
 
 void DeferredShading::InitializeDeferredShading()
 {
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::Enable(GL_DEPTH_TEST);
 
 	// Geometry pass for deferred shading
 	deferredShadings[0]->InitializeShaderProgram(new VertexShaderLoader("gBufferVertexShader.glsl"),
@@ -92,7 +102,12 @@ void DeferredShading::InitializeDeferredShading()
 	deferredShadings[2]->InitializeShaderProgram(new VertexShaderLoader("DeferredLightboxVertexShader.glsl"),
 		new FragmentShaderLoader("DeferredLightboxFragmentShader.glsl"));
 
-	backpack = new Model("Models/Backpack/backpack.obj");
+	/* Drawn once the loader thread has created its buffers, with placeholder textures until it has uploaded the real ones
+	too. Its coarsest level of detail stays on the CPU as well, so the backpacks in the front row can hide the ones behind them
+	when cullOccludedObjects is turned on */
+	Model::buildOccluders = true;
+	backpack = new Model("Models/Backpack/backpack.obj", false, true);
+	Model::buildOccluders = false;
 
 	objectPositions.push_back(vec3(-3.0, -0.5, -3.0));
 	objectPositions.push_back(vec3(0.0, -0.5, -3.0));
@@ -104,13 +119,22 @@ void DeferredShading::InitializeDeferredShading()
 	objectPositions.push_back(vec3(0.0, -0.5, 3.0));
 	objectPositions.push_back(vec3(3.0, -0.5, 3.0));
 
+	for (unsigned int i = 0; i < objectPositions.size(); i++)
+	{
+		mat4 model = mat4(1.0f);
+		model = translate(model, objectPositions[i]);
+		model = scale(model, vec3(0.5f));
+
+		objectMatrices.push_back(model);
+	}
+
 	// Configure g-buffer framebuffer
 	glGenFramebuffers(1, &gBuffer);
-	glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, gBuffer);
 
 	// position color buffer
 	glGenTextures(1, &gPosition);
-	glBindTexture(GL_TEXTURE_2D, gPosition);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, gPosition);
 
 	// 1280 for screen width & 960 for screen height
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, 1280, 960, 0, GL_RGBA, GL_FLOAT, NULL);
@@ -120,7 +144,7 @@ void DeferredShading::InitializeDeferredShading()
 
 	// normal color buffer
 	glGenTextures(1, &gNormal);
-	glBindTexture(GL_TEXTURE_2D, gNormal);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, gNormal);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, 1280, 960, 0, GL_RGBA, GL_FLOAT, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -128,7 +152,7 @@ void DeferredShading::InitializeDeferredShading()
 
 	// color + specular color buffer
 	glGenTextures(1, &gAlbedoSpec);
-	glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, gAlbedoSpec);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1280, 960, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -151,29 +175,48 @@ void DeferredShading::InitializeDeferredShading()
 
 	// finally check if framebuffer is complete
 	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) cout << "Framebuffer not complete!" << endl;
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	lights.Initialize(lightCount);
+	lightClusters.Initialize(CLUSTER_TILES_X, CLUSTER_TILES_Y, CLUSTER_DEPTH_SLICES);
+
+	/* More lights are spread over a larger volume, so there are about as many lights in one place (and in one cluster) as
+	with the 32 lights of the chapter */
+	double spread = 6.0 * cbrt(std::max(lightCount, 32u) / 32.0);
 
 	srand(13);
-	for (unsigned int i = 0; i < NR_LIGHTS; i++)
+	for (unsigned int i = 0; i < lightCount; i++)
 	{
+		PointLight light;
+
 		// Calculate slightly random offsets
-		float xPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 3.0);
-		float yPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 4.0);
-		float zPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 3.0);
-		lightPositions.push_back(vec3(xPos, yPos, zPos));
+		float xPos = static_cast<float>(((rand() % 100) / 100.0) * spread - spread * 0.5);
+		float yPos = static_cast<float>(((rand() % 100) / 100.0) * spread - spread * 0.5 - 1.0);
+		float zPos = static_cast<float>(((rand() % 100) / 100.0) * spread - spread * 0.5);
+		light.position = vec3(xPos, yPos, zPos);
 
 		// Calculate random color
 		float rColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.0
 		float gColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.0
 		float bColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.0
-		lightColors.push_back(vec3(rColor, gColor, bColor));
+		light.color = vec3(rColor, gColor, bColor);
+
+		// Attenuation parameters and the radius of the light volume/sphere (Deferred Shading Part 2)
+		light.linear = linear;
+		light.quadratic = quadratic;
+		light.radius = LightBuffer::CalculateRadius(light.color, constant, linear, quadratic);
+
+		lights.AddLight(light);
 	}
 
 	// Use the lighting pass deferred shading shaders
-	glUseProgram(deferredShadings[1]->shaderProgram);
+	GLStateCache::UseProgram(deferredShadings[1]->shaderProgram);
 	glUniform1i(glGetUniformLocation(deferredShadings[1]->shaderProgram, "gPosition"), 0);
 	glUniform1i(glGetUniformLocation(deferredShadings[1]->shaderProgram, "gNormal"), 1);
 	glUniform1i(glGetUniformLocation(deferredShadings[1]->shaderProgram, "gAlbedoSpec"), 2);
+	glUniform1i(glGetUniformLocation(deferredShadings[1]->shaderProgram, "lightData"), 3);
+	glUniform1i(glGetUniformLocation(deferredShadings[1]->shaderProgram, "clusterGrid"), 4);
+	glUniform1i(glGetUniformLocation(deferredShadings[1]->shaderProgram, "clusterLightIndices"), 5);
 }
 
 void DeferredShading::RenderDeferredShading()
@@ -182,110 +225,102 @@ void DeferredShading::RenderDeferredShading()
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// Geometry pass: render scene's geometry/color data into gbuffer
-	glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, gBuffer);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	mat4 projection = perspective(radians(Camera::fieldOfView), float(1280 / 960), 0.1f, 100.0f);
-	mat4 view = lookAt(Camera::cameraPosition, Camera::cameraPosition + Camera::cameraFront, Camera::cameraUp);
 	mat4 model = mat4(1.0f);
 
-	glUseProgram(deferredShadings[0]->shaderProgram);
-
-	glUniformMatrix4fv(glGetUniformLocation(deferredShadings[0]->shaderProgram, "projection"), 1, GL_FALSE, 
-		value_ptr(projection));
+	if (cullOccludedObjects)
+		RasterizeOccluders();
 
-	glUniformMatrix4fv(glGetUniformLocation(deferredShadings[0]->shaderProgram, "view"), 1, GL_FALSE, value_ptr(view));
+	GLStateCache::UseProgram(deferredShadings[0]->shaderProgram);
 
-	for (unsigned int i = 0; i < objectPositions.size(); i++)
+	for (unsigned int i = 0; i < objectMatrices.size(); i++)
 	{
-		model = mat4(1.0f);
-		model = translate(model, objectPositions[i]);
-		model = scale(model, vec3(0.5f));
-
-		glUniformMatrix4fv(glGetUniformLocation(deferredShadings[0]->shaderProgram, "model"), 1, GL_FALSE, 
-			value_ptr(model));
+		// A backpack's box is in front of its own triangles, so it never hides itself
+		if (cullOccludedObjects && !occlusionCuller.IsModelVisible(*backpack, objectMatrices[i]))
+			continue;
 
-		backpack->DrawModel(deferredShadings[0]);
+		backpack->DrawModel(deferredShadings[0], objectMatrices[i], 0, MODEL_UNIFORM);
 	}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (cullOccludedObjects && printOcclusionStatistics)
+		occlusionCuller.PrintStatistics();
+
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Lighting pass: calculate lighting by iterating over a screen filled quad pixel-by-pixel using the gbuffer's content
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	glUseProgram(deferredShadings[1]->shaderProgram);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, gPosition);
+	GLStateCache::UseProgram(deferredShadings[1]->shaderProgram);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, gPosition);
 
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, gNormal);
+	GLStateCache::ActiveTexture(GL_TEXTURE1);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, gNormal);
 
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
-
-	// Send light relevant uniforms
-	for (unsigned int i = 0; i < lightPositions.size(); i++)
-	{
-		glUniform3fv(glGetUniformLocation(deferredShadings[1]->shaderProgram, 
-		("lights[" + to_string(i) + "].Position").c_str()), 1, value_ptr(lightPositions[i]));
+	GLStateCache::ActiveTexture(GL_TEXTURE2);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, gAlbedoSpec);
 
-		glUniform3fv(glGetUniformLocation(deferredShadings[1]->shaderProgram, 
-			("lights[" + to_string(i) + "].Color").c_str()), 1, value_ptr(lightColors[i]));
+	/* Send the lights that changed since the last frame (none, unless a light was moved) and point the shader to the 
+	light buffer, the cost here doesn't depend on the number of lights */
+	lights.Upload();
+	lights.Bind(GL_TEXTURE3);
 
-		// Update attenuation parameters and calculate radius
-		glUniform1f(glGetUniformLocation(deferredShadings[1]->shaderProgram,
-			("lights[" + to_string(i) + "].Linear").c_str()), linear);
+	// The camera moves every frame, so the lights are sorted into the clusters again
+	lightClusters.Update(lights, FrameUniforms::frameData.view, FrameUniforms::frameData.projection,
+		FrameUniforms::NEAR_PLANE, FrameUniforms::FAR_PLANE);
+	lightClusters.Upload();
 
-		glUniform1f(glGetUniformLocation(deferredShadings[1]->shaderProgram,
-			("lights[" + to_string(i) + "].Quadratic").c_str()), quadratic);
+	if (printLightClusterStatistics)
+		lightClusters.PrintStatistics();
 
-		// Then calculate radius of light volume/sphere (Deferred Shading Part 2)
-		const float maxBrightness = fmaxf(fmaxf(lightColors[i].r, lightColors[i].g), lightColors[i].b);
+	lightClusters.Bind(GL_TEXTURE4, GL_TEXTURE5);
+	lightClusters.SetUniforms(deferredShadings[1]);
 
-		float radius = (-linear + sqrt(linear * linear - 4 * quadratic * (constant - (256.0f / 5.0f) * maxBrightness))) / 
-			(2.0f * quadratic);
-		
-		glUniform1f(glGetUniformLocation(deferredShadings[1]->shaderProgram, 
-			("lights[" + to_string(i) + "].Radius").c_str()), radius);
-	}
-
-	glUniform3fv(glGetUniformLocation(deferredShadings[1]->shaderProgram, "viewPos"), 1, value_ptr(Camera::cameraPosition));
-	
 	// Render quad after all the deferred shading shader uniforms are found and set
 	RenderQuad();
 
 	// Copy content of geometry's depth buffer to default framebuffer's depth buffer
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer);
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); // write to default framebuffer
+	GLStateCache::BindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer);
+	GLStateCache::BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); // write to default framebuffer
 
 	/* Blit to default framebuffer. This may or may not work as the internal formats of both the FBO and default framebuffer 
 	have to match since the internal formats are implementation defined. This works on all of my systems, but if it doesn't 
 	on yours you'll likely have to write to the depth buffer in another shader stage (or somehow see to match the default 
 	framebuffer's internal format with the FBO's internal format) */
 	glBlitFramebuffer(0, 0, 1280, 960, 0, 0, 1280, 960, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Render lights on top of scene
-	glUseProgram(deferredShadings[2]->shaderProgram);
-	glUniformMatrix4fv(glGetUniformLocation(deferredShadings[2]->shaderProgram, "projection"), 1, GL_FALSE, 
-		value_ptr(projection));
-
-	glUniformMatrix4fv(glGetUniformLocation(deferredShadings[2]->shaderProgram, "view"), 1, GL_FALSE, value_ptr(view));
+	GLStateCache::UseProgram(deferredShadings[2]->shaderProgram);
 
-	for (unsigned int i = 0; i < lightPositions.size(); i++)
+	for (unsigned int i = 0; i < lights.GetLightCount(); i++)
 	{
+		const PointLight& light = lights.GetLight(i);
+
 		model = glm::mat4(1.0f);
-		model = glm::translate(model, lightPositions[i]);
+		model = glm::translate(model, light.position);
 		model = glm::scale(model, vec3(0.125f));
 
-		glUniformMatrix4fv(glGetUniformLocation(deferredShadings[2]->shaderProgram, "model"), 1, GL_FALSE, 
-			value_ptr(model));
-
-		glUniform3fv(glGetUniformLocation(deferredShadings[2]->shaderProgram, "lightColor"), 1, value_ptr(lightColors[i]));
+		deferredShadings[2]->SetMat4(MODEL_UNIFORM, model);
+		deferredShadings[2]->SetVec3(LIGHT_COLOR_UNIFORM, light.color);
 		
 		RenderCube();
 	}
 }
 
+void DeferredShading::RasterizeOccluders()
+{
+	occlusionCuller.BeginFrame(FrameUniforms::frameData.viewProjection);
+
+	for (unsigned int i = 0; i < objectMatrices.size(); i++)
+	{
+		occlusionCuller.RasterizeModel(*backpack, objectMatrices[i]);
+	}
+
+	occlusionCuller.BuildHierarchy();
+}
+
 void DeferredShading::RenderQuad()
 {
 	if (quadVAO == 0)
@@ -303,8 +338,8 @@ void DeferredShading::RenderQuad()
 		glGenVertexArrays(1, &quadVAO);
 		glGenBuffers(1, &quadVBO);
 
-		glBindVertexArray(quadVAO);
-		glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+		GLStateCache::BindVertexArray(quadVAO);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, quadVBO);
 
 		glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
 		glEnableVertexAttribArray(0);
@@ -312,9 +347,9 @@ void DeferredShading::RenderQuad()
 		glEnableVertexAttribArray(1);
 		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
 	}
-	glBindVertexArray(quadVAO);
+	GLStateCache::BindVertexArray(quadVAO);
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(0);
 }
 
 void DeferredShading::RenderCube()
@@ -370,22 +405,22 @@ void DeferredShading::RenderCube()
 		glGenVertexArrays(1, &cubeVAO);
 		glGenBuffers(1, &cubeVBO);
 
-		glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, cubeVBO);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
 
-		glBindVertexArray(cubeVAO);
+		GLStateCache::BindVertexArray(cubeVAO);
 		glEnableVertexAttribArray(0);
 		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
 		glEnableVertexAttribArray(1);
 		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
 		glEnableVertexAttribArray(2);
 		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+		GLStateCache::BindVertexArray(0);
 	}
 
-	glBindVertexArray(cubeVAO);
+	GLStateCache::BindVertexArray(cubeVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 36);
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(0);
 
 }
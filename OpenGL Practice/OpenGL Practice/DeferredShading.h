@@ -11,6 +11,9 @@
 
 #include "ShaderProgram.h"
 #include "Model.h"
+#include "LightBuffer.h"
+#include "LightClusters.h"
+#include "OcclusionCuller.h"
 
 using namespace std;
 using namespace glm;
@@ -25,12 +28,30 @@ public:
 	void InitializeDeferredShading();
 	void RenderDeferredShading();
 
+	/* Skips the backpacks hidden behind other backpacks. Off by default: the occluders are the backpack's coarsest level
+	of detail, which can cover gaps the real backpack leaves open, so a backpack seen through one could pop */
+	static bool cullOccludedObjects;
+
+	// Prints the occlusion culler's statistics every frame
+	static bool printOcclusionStatistics;
+
+	/* Number of lights, set it before InitializeDeferredShading. The lighting pass only evaluates the lights of a
+	fragment's cluster, and once 2 * LightClusters::MIN_LIGHTS_PER_THREAD lights are in view the clusters are assigned on
+	several threads, so a few thousand lights are a test of the threaded assignment */
+	static unsigned int lightCount;
+
+	// Prints the light clusters' statistics every frame
+	static bool printLightClusterStatistics;
+
 private:
 	DeferredShading();
 
 	void RenderQuad();
 	void RenderCube();
 
+	// Rasterizes every backpack into the occlusion culler's depth buffer from this frame's camera
+	void RasterizeOccluders();
+
 	static DeferredShading* deferredShadingInstance;
 
 	array<ShaderProgram*, 3> deferredShadings;
@@ -40,13 +61,22 @@ private:
 	Model* backpack;
 
 	vector<vec3> objectPositions;
+	vector<mat4> objectMatrices;
+
+	// The backpacks are both the occluders and the objects that are tested
+	OcclusionCuller occlusionCuller;
 
 	unsigned int gBuffer, gPosition, gNormal, gAlbedoSpec, rboDepth;
 
-	const unsigned int NR_LIGHTS = 32;
+	LightBuffer lights;
+
+	// Which lights reach which part of the view frustum, sorted again every frame
+	LightClusters lightClusters;
 
-	vector<vec3> lightPositions;
-	vector<vec3> lightColors;
+	// Tiles across and up the screen (about 80 pixels each), and slices along the view direction
+	const unsigned int CLUSTER_TILES_X = 16;
+	const unsigned int CLUSTER_TILES_Y = 12;
+	const unsigned int CLUSTER_DEPTH_SLICES = 24;
 
 	array<unsigned int, 3> attachments;
 
@@ -18,9 +18,21 @@ struct Light
     float Radius;
 };
 
-const int NR_LIGHTS = 32;
-uniform Light lights[NR_LIGHTS];
-uniform vec3 viewPos;
+/* The lights live in a texture buffer instead of a uniform array, so there can be any number of them. Every light takes
+3 texels: (position, radius), (color, linear), (quadratic, unused) - see LightBuffer.h */
+uniform samplerBuffer lightData;
+
+Light FetchLight(int index)
+{
+    vec4 positionRadius = texelFetch(lightData, index * 3);
+    vec4 colorLinear = texelFetch(lightData, index * 3 + 1);
+    vec4 attenuation = texelFetch(lightData, index * 3 + 2);
+
+    return Light(positionRadius.xyz, colorLinear.rgb, colorLinear.a, attenuation.x, positionRadius.w);
+}
+
+#include "FrameUniforms.glsl"
+#include "ClusteredLights.glsl"
 
 void main()
 {             
@@ -32,27 +44,37 @@ void main()
     
     // Then calculate lighting here
     vec3 lighting  = Diffuse * 0.1; // hard-coded ambient component
-    vec3 viewDir  = normalize(viewPos - FragPos);
+    vec3 viewDir  = normalize(frame.cameraPosition.xyz - FragPos);
 
-    for(int i = 0; i < NR_LIGHTS; ++i)
+    // Only the lights whose spheres touch this fragment's cluster, instead of every light in the scene
+    float viewDepth = -(frame.view * vec4(FragPos, 1.0)).z;
+    uvec2 cluster = FindCluster(texCoords, viewDepth);
+
+    for(uint j = 0u; j < cluster.y; ++j)
     {
+        int i = GetClusterLight(cluster, j);
+
+        // The cluster is bigger than the fragment, so the light might still not reach it
+        vec4 positionRadius = texelFetch(lightData, i * 3);
+
         // Calculate distance between light source and current fragment (Deferred Shading Part 2)
-        float distance = length(lights[i].Position - FragPos);
+        float distance = length(positionRadius.xyz - FragPos);
 
-        if(distance < lights[i].Radius)
+        if(distance < positionRadius.w)
         {
+            Light light = FetchLight(i);
+
             // diffuse (Deferred Shading Part 1)
-            vec3 lightDir = normalize(lights[i].Position - FragPos);
-            vec3 diffuse = max(dot(Normal, lightDir), 0.0) * Diffuse * lights[i].Color;
+            vec3 lightDir = normalize(light.Position - FragPos);
+            vec3 diffuse = max(dot(Normal, lightDir), 0.0) * Diffuse * light.Color;
             
             // specular
             vec3 halfwayDir = normalize(lightDir + viewDir);  
             float spec = pow(max(dot(Normal, halfwayDir), 0.0), 16.0);
-            vec3 specular = lights[i].Color * spec * Specular;
+            vec3 specular = light.Color * spec * Specular;
 
             // attenuation
-            float distance = length(lights[i].Position - FragPos);
-            float attenuation = 1.0 / (1.0 + lights[i].Linear * distance + lights[i].Quadratic * distance * distance);
+            float attenuation = 1.0 / (1.0 + light.Linear * distance + light.Quadratic * distance * distance);
 
             diffuse *= attenuation;
             specular *= attenuation;
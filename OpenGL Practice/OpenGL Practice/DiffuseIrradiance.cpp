@@ -10,8 +10,8 @@ equations: treating each cubemap texel as a light emitter. This way we can effec
 lighting and general feel, giving objects a better sense of belonging in their environment */
 
 DiffuseIrradiance::DiffuseIrradiance() : irradianceShaders{ new ShaderProgram(), new ShaderProgram(), new ShaderProgram(),
-new ShaderProgram() }, sphereVAO(0), cubeVAO(0), nrColumns(0), nrRows(0), spacing(0), projection(mat4(0.0f)), 
-view(mat4(0.0f)), model(mat4(0.0f)), indexCount(0)
+new ShaderProgram() }, sphereVAO(0), cubeVAO(0), nrColumns(0), nrRows(0), spacing(0), model(mat4(0.0f)), 
+indexCount(0)
 {
 }
 
@@ -33,11 +33,11 @@ DiffuseIrradiance* DiffuseIrradiance::Instance()
 
 void DiffuseIrradiance::InitializeDiffuseIrradiance()
 {
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::Enable(GL_DEPTH_TEST);
 
 	/* The xyww trick here that ensures the depth value of the rendered cube fragments always end up at 1.0, the maximum 
 	depth value. We would need to change the depth comparison function to GL_LEQUAL */
-	glDepthFunc(GL_LEQUAL);
+	GLStateCache::DepthFunc(GL_LEQUAL);
 
 	// PBR shader
 	irradianceShaders[0]->InitializeShaderProgram(new VertexShaderLoader("PBRLightingVertexShader.glsl"),
@@ -55,13 +55,13 @@ void DiffuseIrradiance::InitializeDiffuseIrradiance()
 	irradianceShaders[3]->InitializeShaderProgram(new VertexShaderLoader("DiffuseIrradianceCubemapVertexShader.glsl"),
 		new FragmentShaderLoader("DiffuseIrradianceConvolutionFragmentShader.glsl"));
 
-	glUseProgram(irradianceShaders[0]->shaderProgram);
+	GLStateCache::UseProgram(irradianceShaders[0]->shaderProgram);
 
 	glUniform1i(glGetUniformLocation(irradianceShaders[0]->shaderProgram, "irradianceMap"), 0);
 	glUniform3f(glGetUniformLocation(irradianceShaders[0]->shaderProgram, "albedo"), 0.5f, 0.0f, 0.0f);
 	glUniform1f(glGetUniformLocation(irradianceShaders[0]->shaderProgram, "ambientOcclusion"), 1.0f);
 
-	glUseProgram(irradianceShaders[2]->shaderProgram);
+	GLStateCache::UseProgram(irradianceShaders[2]->shaderProgram);
 
 	glUniform1i(glGetUniformLocation(irradianceShaders[2]->shaderProgram, "environmentMap"), 0);
 
@@ -89,19 +89,21 @@ void DiffuseIrradiance::InitializeDiffuseIrradiance()
 	glGenFramebuffers(1, &captureFBO);
 	glGenRenderbuffers(1, &captureRBO);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, captureFBO);
 	glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
 	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 512, 512);
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, captureRBO);
 
-	stbi_set_flip_vertically_on_load(true);
+	/* The texture cache sets the flip per thread, and a per thread setting always wins over the global one, so this has
+	to be set per thread as well */
+	stbi_set_flip_vertically_on_load_thread(true);
 
 	data = stbi_loadf("Textures/HDR/newport_loft.hdr", &width, &height, &nrComponents, 0);
 
 	if (data)
 	{
 		glGenTextures(1, &hdrTexture);
-		glBindTexture(GL_TEXTURE_2D, hdrTexture);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, hdrTexture);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, data); // note how we specify the texture's data value to be float
 
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -119,7 +121,7 @@ void DiffuseIrradiance::InitializeDiffuseIrradiance()
 
 	// PBR: setup cubemap to render to and attach to framebuffer
 	glGenTextures(1, &envCubemap);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
 	for (unsigned int i = 0; i < 6; ++i)
 	{
@@ -145,18 +147,18 @@ void DiffuseIrradiance::InitializeDiffuseIrradiance()
 	};
 
 	// PBR: convert HDR equirectangular environment map to cubemap equivalent
-	glUseProgram(irradianceShaders[1]->shaderProgram);
+	GLStateCache::UseProgram(irradianceShaders[1]->shaderProgram);
 
 	glUniform1i(glGetUniformLocation(irradianceShaders[1]->shaderProgram, "equirectangularMap"), 0);
 
 	glUniformMatrix4fv(glGetUniformLocation(irradianceShaders[1]->shaderProgram, "projection"), 1, GL_FALSE,
 		value_ptr(captureProjection));
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, hdrTexture);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, hdrTexture);
 
 	glViewport(0, 0, 512, 512); // Configure the viewport to the capture dimensions.
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, captureFBO);
 
 	for (unsigned int i = 0; i < 6; ++i)
 	{
@@ -169,14 +171,14 @@ void DiffuseIrradiance::InitializeDiffuseIrradiance()
 		RenderCube();
 	}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// PBR: create an irradiance cubemap, and re-scale capture FBO to irradiance scale (Diffuse Irradiance Part 2)
 
 	/* As the irradiance map averages all surrounding radiance uniformly it doesnt have a lot of high frequency details, so 
 	we can store the map at a low resolution (32x32) and let OpenGLs linear filtering do most of the work */
 	glGenTextures(1, &irradianceMap);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
 
 	for (unsigned int i = 0; i < 6; ++i)
 	{
@@ -189,23 +191,23 @@ void DiffuseIrradiance::InitializeDiffuseIrradiance()
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, captureFBO);
 	glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
 	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 32, 32);
 
 	// PBR: solve diffuse integral by convolution to create an irradiance cube map
-	glUseProgram(irradianceShaders[3]->shaderProgram);
+	GLStateCache::UseProgram(irradianceShaders[3]->shaderProgram);
 
 	glUniform1i(glGetUniformLocation(irradianceShaders[3]->shaderProgram, "environmentMap"), 0);
 
 	glUniformMatrix4fv(glGetUniformLocation(irradianceShaders[3]->shaderProgram, "projection"), 1, GL_FALSE, 
 		value_ptr(captureProjection));
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
 	glViewport(0, 0, 32, 32); // Configure the viewport to the capture dimensions.
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, captureFBO);
 
 	for (unsigned int i = 0; i < 6; ++i)
 	{
@@ -218,20 +220,7 @@ void DiffuseIrradiance::InitializeDiffuseIrradiance()
 		RenderCube();
 	}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-	// Initialize static shader uniforms before rendering
-	projection = perspective(glm::radians(Camera::fieldOfView), float(1280 / 960), 0.1f, 100.0f);
-	
-	glUseProgram(irradianceShaders[0]->shaderProgram);
-
-	glUniformMatrix4fv(glGetUniformLocation(irradianceShaders[0]->shaderProgram, "projection"), 1, GL_FALSE, 
-		value_ptr(projection));
-	
-	glUseProgram(irradianceShaders[2]->shaderProgram);
-
-	glUniformMatrix4fv(glGetUniformLocation(irradianceShaders[2]->shaderProgram, "projection"), 1, GL_FALSE,
-		value_ptr(projection));
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void DiffuseIrradiance::RenderDiffuseIrradiance()
@@ -240,19 +229,11 @@ void DiffuseIrradiance::RenderDiffuseIrradiance()
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// Render scene, supplying the convoluted irradiance map to the final shader
-	glUseProgram(irradianceShaders[0]->shaderProgram);
-
-	view = lookAt(Camera::cameraPosition, Camera::cameraPosition + Camera::cameraFront, Camera::cameraUp);
-
-	glUniformMatrix4fv(glGetUniformLocation(irradianceShaders[0]->shaderProgram, "view"), 1, GL_FALSE,
-		value_ptr(view));
-
-	glUniform3fv(glGetUniformLocation(irradianceShaders[0]->shaderProgram, "cameraPosition"), 1,
-		value_ptr(Camera::cameraPosition));
+	GLStateCache::UseProgram(irradianceShaders[0]->shaderProgram);
 
 	// Bind pre-computed IBL data
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
 
 	// render rows*column number of spheres with varying metallic/roughness values scaled by rows and columns respectively
 	model = glm::mat4(1.0f);
@@ -310,12 +291,10 @@ void DiffuseIrradiance::RenderDiffuseIrradiance()
 	}
 
 	// Render skybox (render as last to prevent overdraw)
-	glUseProgram(irradianceShaders[2]->shaderProgram);
-
-	glUniformMatrix4fv(glGetUniformLocation(irradianceShaders[2]->shaderProgram, "view"), 1, GL_FALSE, value_ptr(view));
+	GLStateCache::UseProgram(irradianceShaders[2]->shaderProgram);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 	//glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap); // display irradiance map
 
 	RenderCube();
@@ -405,11 +384,11 @@ void DiffuseIrradiance::RenderSphere()
 			}
 		}
 
-		glBindVertexArray(sphereVAO);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		GLStateCache::BindVertexArray(sphereVAO);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, vbo);
 		glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), &data[0], GL_STATIC_DRAW);
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+		GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
 
 		unsigned int stride = sizeof(vec3) + sizeof(vec2) + sizeof(vec3);
@@ -422,7 +401,7 @@ void DiffuseIrradiance::RenderSphere()
 		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
 	}
 
-	glBindVertexArray(sphereVAO);
+	GLStateCache::BindVertexArray(sphereVAO);
 	glDrawElements(GL_TRIANGLE_STRIP, indexCount, GL_UNSIGNED_INT, 0);
 }
 
@@ -478,21 +457,21 @@ void DiffuseIrradiance::RenderCube()
 		glGenVertexArrays(1, &cubeVAO);
 		glGenBuffers(1, &cubeVBO);
 
-		glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, cubeVBO);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
 
-		glBindVertexArray(cubeVAO);
+		GLStateCache::BindVertexArray(cubeVAO);
 		glEnableVertexAttribArray(0);
 		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
 		glEnableVertexAttribArray(1);
 		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
 		glEnableVertexAttribArray(2);
 		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+		GLStateCache::BindVertexArray(0);
 	}
 
-	glBindVertexArray(cubeVAO);
+	GLStateCache::BindVertexArray(cubeVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 36);
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(0);
 }
\ No newline at end of file
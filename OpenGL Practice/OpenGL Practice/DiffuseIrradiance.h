@@ -43,7 +43,7 @@ private:
 	int width, height, nrComponents;
 	float* data;
 
-	mat4 captureProjection, projection, view, model;
+	mat4 captureProjection, model;
 	array<mat4, 6> captureViews;
 
 	unsigned int sphereVAO;
@@ -2,8 +2,7 @@
 
 layout (location = 0) in vec3 position;
 
-uniform mat4 projection;
-uniform mat4 view;
+#include "FrameUniforms.glsl"
 
 out vec3 worldPosition;
 
@@ -13,8 +12,8 @@ void main()
 {
     worldPosition = position;
 
-	mat4 rotView = mat4(mat3(view));
-	vec4 clipPos = projection * rotView * vec4(worldPosition, 1.0);
+	mat4 rotView = mat4(mat3(frame.view));
+	vec4 clipPos = frame.projection * rotView * vec4(worldPosition, 1.0);
 
 	gl_Position = clipPos.xyww;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "FaceCulling.h"
+#include "GLStateCache.h"
 
 FaceCulling::FaceCulling()
 {
@@ -16,8 +17,8 @@ FaceCulling::FaceCulling()
 
 FaceCulling::~FaceCulling()
 {
-	glDeleteVertexArrays(1, &faceCullingVAO);
-	glDeleteBuffers(1, &faceCullingVBO);
+	GLStateCache::DeleteVertexArrays(1, &faceCullingVAO);
+	GLStateCache::DeleteBuffers(1, &faceCullingVBO);
 
 	faceCullingTexture = NULL;
 
@@ -31,7 +32,7 @@ FaceCulling::~FaceCulling()
 void FaceCulling::SetFaceCullingVertices()
 {
 	// Enable face culling
-	glEnable(GL_CULL_FACE);
+	GLStateCache::Enable(GL_CULL_FACE);
 
 	/* glCullFace function only has 3 options:
 		
@@ -108,13 +109,13 @@ void FaceCulling::SetFaceCullingVertices()
 	glGenBuffers(1, &faceCullingVBO); // The & is a reference to the unsigned int of VBO and converts it to a GLuint pointer type
 
 	// This binds the buffers more than once at the same time as long as they're different buffer types
-	glBindBuffer(GL_ARRAY_BUFFER, faceCullingVBO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, faceCullingVBO);
 
 	// Copies the previously defined vertex data into the buffer's memory
 	glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), &cubeVertices, GL_STATIC_DRAW);
 
 	// Bind the vertex array object using its ID
-	glBindVertexArray(faceCullingVAO);
+	GLStateCache::BindVertexArray(faceCullingVAO);
 
 	// Set the position attribute's location to 0 like our vertex shader GLSL file
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
@@ -129,7 +130,7 @@ void FaceCulling::SetFaceCullingVertices()
 	// Generate the specular texture in OpenGL first before binding it
 	glGenTextures(1, &faceCullingTexture);
 
-	glBindTexture(GL_TEXTURE_2D, faceCullingTexture);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, faceCullingTexture);
 
 	// Use GL_CLAMP_TO_EDGE if we use alpha textures that shouldn't repeated
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
@@ -159,6 +160,6 @@ void FaceCulling::SetFaceCullingVertices()
 
 	// Bind the specular map texture here
 
-	glActiveTexture(GL_TEXTURE0); // Active the first texture unit
-	glBindTexture(GL_TEXTURE_2D, faceCullingTexture);
+	GLStateCache::ActiveTexture(GL_TEXTURE0); // Active the first texture unit
+	GLStateCache::BindTexture(GL_TEXTURE_2D, faceCullingTexture);
 }
\ No newline at end of file
@@ -1,50 +1,30 @@
 #include "FragmentShaderLoader.h"
 
-FragmentShaderLoader::FragmentShaderLoader(const char* fragmentShaderPath_)
+FragmentShaderLoader::FragmentShaderLoader(const char* fragmentShaderPath_, const std::string& defines_) :
+	fragmentShaderPath(fragmentShaderPath_), defines(defines_)
 {
-	// Make sure the fragment shader file ifstream will throw an exception error
-	fragmentShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+	/* The shader stage cache only reads each file once, so creating the same fragment shader loader in several places
+	doesn't read the file from disk again */
+	fShaderCode = ShaderStageCache::GetSource(fragmentShaderPath).data();
 
-	try
+	// Keep our own copy of the source only if it differs from the file because of the injected defines
+	if (!defines.empty())
 	{
-		// Open the fragment shader file
-		fragmentShaderFile.open(fragmentShaderPath_);
-
-		// Read the fragment shader's file buffer contents into a stream of the fragment shader file
-		fragmentShaderStream << fragmentShaderFile.rdbuf();
-
-		// Close the fragment shader's file handlers
-		fragmentShaderFile.close();
-
-		// Convert the fragment shader stream into a fragment shader string
-		fragmentShaderCode = fragmentShaderStream.str();
-	}
-
-	catch (std::ifstream::failure error)
-	{
-		std::cout << "ERROR::SHADER::FRAGMENT::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
+		fragmentShaderCode = ShaderPreprocessor::InjectDefines(string(ShaderStageCache::GetSource(fragmentShaderPath)), defines);
+		fShaderCode = fragmentShaderCode.c_str();
 	}
 
-	fShaderCode = fragmentShaderCode.c_str();
+	fragmentShader = NULL;
 }
 
 void FragmentShaderLoader::InitializeFragmentShaderLoader()
 {
-	// Compile the fragment shader using the shader object and the shader source code (GLSL)
-	fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fShaderCode, NULL);
-	glCompileShader(fragmentShader);
-
-	int successfullyCompiled; // An integer that checks if the vertex shader compilation was successful
-	char compilationInformationLog[512]; // Gives information about its compilation in a log file (maybe?)
-
-	// Returns a successful compilation of the fragment shader if it can compile successfully
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &successfullyCompiled);
+	/* Get the compiled fragment shader from the shader stage cache, it's only compiled the first time any program asks for
+	this file (with these defines), every other program reuses the same shader object */
+	fragmentShader = ShaderStageCache::AcquireShader(GL_FRAGMENT_SHADER, fragmentShaderPath, defines);
+}
 
-	// If the compilation failed, then return a log compilation error and explain the error
-	if (!successfullyCompiled)
-	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, compilationInformationLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << compilationInformationLog << std::endl;
-	}
+const char* FragmentShaderLoader::GetFragmentShaderCode() const
+{
+	return fShaderCode;
 }
\ No newline at end of file
@@ -6,19 +6,24 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include "ShaderStageCache.h"
 
 class FragmentShaderLoader
 {
 public:
-	FragmentShaderLoader(const char* fragmentShaderPath_);
+	// defines_ holds extra #define lines that are injected right after the shader's #version line
+	FragmentShaderLoader(const char* fragmentShaderPath_, const std::string& defines_ = "");
 	void InitializeFragmentShaderLoader();
 
+	// Returns the GLSL source code that was read from the fragment shader file
+	const char* GetFragmentShaderCode() const;
+
 	unsigned int fragmentShader;
 
 private:
+	std::string fragmentShaderPath;
+	std::string defines;
 	std::string fragmentShaderCode;
-	std::ifstream fragmentShaderFile;
-	std::stringstream fragmentShaderStream;
 	const char* fShaderCode;
 };
 
@@ -27,14 +27,14 @@ FrameBuffer::FrameBuffer()
 
 FrameBuffer::~FrameBuffer()
 {
-	glDeleteVertexArrays(1, &cubeVAO);
-	glDeleteBuffers(1, &cubeVBO);
-	glDeleteVertexArrays(1, &planeVAO);
-	glDeleteBuffers(1, &planeVBO);
-	glDeleteVertexArrays(1, &quadVAO);
-	glDeleteBuffers(1, &quadVBO);
-
-	glDeleteFramebuffers(1, &frameBufferFBO);
+	GLStateCache::DeleteVertexArrays(1, &cubeVAO);
+	GLStateCache::DeleteBuffers(1, &cubeVBO);
+	GLStateCache::DeleteVertexArrays(1, &planeVAO);
+	GLStateCache::DeleteBuffers(1, &planeVBO);
+	GLStateCache::DeleteVertexArrays(1, &quadVAO);
+	GLStateCache::DeleteBuffers(1, &quadVBO);
+
+	GLStateCache::DeleteFramebuffers(1, &frameBufferFBO);
 	glDeleteRenderbuffers(1, &frameBufferRBO);
 
 	frameBufferTexture = NULL;
@@ -106,10 +106,10 @@ void FrameBuffer::InitializeCubeVertices()
 	glGenBuffers(1, &cubeVBO);
 
 	// Bind the vertex array object using its ID
-	glBindVertexArray(cubeVAO);
+	GLStateCache::BindVertexArray(cubeVAO);
 
 	// This binds the buffers more than once at the same time as long as they're different buffer types
-	glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, cubeVBO);
 
 	// Copies the previously defined vertex data into the buffer's memory
 	glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), &cubeVertices, GL_STATIC_DRAW);
@@ -146,10 +146,10 @@ void FrameBuffer::InitializePlaneVertices()
 	glGenBuffers(1, &planeVBO);
 
 	// Bind the vertex array object using its ID
-	glBindVertexArray(planeVAO);
+	GLStateCache::BindVertexArray(planeVAO);
 
 	// This binds the buffers more than once at the same time as long as they're different buffer types
-	glBindBuffer(GL_ARRAY_BUFFER, planeVBO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, planeVBO);
 
 	// Copies the previously defined vertex data into the buffer's memory
 	glBufferData(GL_ARRAY_BUFFER, sizeof(planeVertices), &planeVertices, GL_STATIC_DRAW);
@@ -186,10 +186,10 @@ void FrameBuffer::InitializeQuadVertices()
 	glGenBuffers(1, &quadVBO);
 
 	// Bind the vertex array object using its ID
-	glBindVertexArray(quadVAO);
+	GLStateCache::BindVertexArray(quadVAO);
 
 	// This binds the buffers more than once at the same time as long as they're different buffer types
-	glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, quadVBO);
 
 	// Copies the previously defined vertex data into the buffer's memory
 	glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
@@ -219,12 +219,12 @@ void FrameBuffer::AddFrameBuffer()
 
 	/* The GL_READ_FRAMEBUFFER is used for all read operations like glReadPixels and GL_DRAW_FRAMEBUFFER is used as
 	the destination for rendering, clearing and other write operations */
-	glBindFramebuffer(GL_FRAMEBUFFER, frameBufferFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, frameBufferFBO);
 
 	// Generate the specular texture in OpenGL first before binding it
 	glGenTextures(1, &frameBufferTexture);
 
-	glBindTexture(GL_TEXTURE_2D, frameBufferTexture);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, frameBufferTexture);
 
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 800, 600, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
 
@@ -292,16 +292,16 @@ void FrameBuffer::AddFrameBuffer()
 		cout << "ERROR::FRAMEBUFFER:: Framebuffer is not complete!" << endl;
 	}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void FrameBuffer::RenderScene()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, frameBufferFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, frameBufferFBO);
 	glClearColor(0.05f, 0.05f, 0.05f, 0.05f);
 
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::Enable(GL_DEPTH_TEST);
 }
 
 void FrameBuffer::InitializeCubeTextures()
@@ -310,7 +310,7 @@ void FrameBuffer::InitializeCubeTextures()
 	glGenTextures(1, &cubeTexture);
 
 	// Then, we need to bind the textures to configure the currently bound texture on subsequent texture commands
-	glBindTexture(GL_TEXTURE_2D, cubeTexture);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, cubeTexture);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -337,11 +337,11 @@ void FrameBuffer::InitializeCubeTextures()
 	stbi_image_free(frameBufferData);
 
 	// Bind the vertex array object using its ID
-	glBindVertexArray(cubeVAO);
+	GLStateCache::BindVertexArray(cubeVAO);
 
 	// Bind the diffuse map texture here
-	glActiveTexture(GL_TEXTURE0); // Active the first texture unit first before binding it
-	glBindTexture(GL_TEXTURE_2D, cubeTexture);
+	GLStateCache::ActiveTexture(GL_TEXTURE0); // Active the first texture unit first before binding it
+	GLStateCache::BindTexture(GL_TEXTURE_2D, cubeTexture);
 }
 
 void FrameBuffer::InitializePlaneTextures()
@@ -350,7 +350,7 @@ void FrameBuffer::InitializePlaneTextures()
 	glGenTextures(1, &planeTexture);
 
 	// Then, we need to bind the textures to configure the currently bound texture on subsequent texture commands
-	glBindTexture(GL_TEXTURE_2D, planeTexture);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, planeTexture);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -375,28 +375,28 @@ void FrameBuffer::InitializePlaneTextures()
 	stbi_image_free(frameBufferData);
 
 	// Bind the vertex array object using its ID
-	glBindVertexArray(planeVAO);
+	GLStateCache::BindVertexArray(planeVAO);
 
 	/* Bind the texture before calling the glDrawElements function and it will automatically assign the texture to
 	the fragment shader's sampler */
 	// Bind the specular map texture here
-	glBindTexture(GL_TEXTURE_2D, planeTexture);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, planeTexture);
 }
 
 void FrameBuffer::InitializeQuadTextures()
 {
-	glBindVertexArray(quadVAO);
-	glBindTexture(GL_TEXTURE_2D, frameBufferTexture); // use the color attachment texture as the texture of the quad plane
+	GLStateCache::BindVertexArray(quadVAO);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, frameBufferTexture); // use the color attachment texture as the texture of the quad plane
 	glDrawArrays(GL_TRIANGLES, 0, 6);
 }
 
 void FrameBuffer::BindToDefaultFrameBuffer()
 {
 	// Bind back to default framebuffer and draw a quad plane with the attached framebuffer color texture
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Disable depth test so screen-space quad isn't discarded due to depth test
-	glDisable(GL_DEPTH_TEST);
+	GLStateCache::Disable(GL_DEPTH_TEST);
 
 	// Clear only the color buffer
 	glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
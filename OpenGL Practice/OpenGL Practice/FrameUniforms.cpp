@@ -0,0 +1,79 @@
+#include "FrameUniforms.h"
+#include "GLStateCache.h"
+#include "Camera.h"
+
+#include <gtc/matrix_transform.hpp>
+
+// Instantiate static variables
+FrameUniformData FrameUniforms::frameData = FrameUniformData();
+
+const float FrameUniforms::NEAR_PLANE = 0.1f;
+const float FrameUniforms::FAR_PLANE = 100.0f;
+
+unsigned int FrameUniforms::uniformBuffer = 0;
+
+void FrameUniforms::Initialize(int screenWidth, int screenHeight)
+{
+	SetScreenSize(screenWidth, screenHeight);
+
+	glGenBuffers(1, &uniformBuffer);
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, uniformBuffer);
+
+	// The whole block is rewritten every frame, so let the driver know it's dynamic
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniformData), NULL, GL_DYNAMIC_DRAW);
+
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	// The buffer never leaves its binding point, programs only have to point their block to it
+	glBindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, uniformBuffer);
+}
+
+void FrameUniforms::Update(float currentTime, float deltaTime)
+{
+	float aspectRatio = frameData.screenSize.y > 0.0f ? frameData.screenSize.x / frameData.screenSize.y : 1.0f;
+
+	frameData.view = Camera::CameraLookAt();
+	frameData.projection = glm::perspective(glm::radians(Camera::fieldOfView), aspectRatio, NEAR_PLANE, FAR_PLANE);
+	frameData.viewProjection = frameData.projection * frameData.view;
+
+	frameData.inverseView = glm::inverse(frameData.view);
+	frameData.inverseProjection = glm::inverse(frameData.projection);
+
+	frameData.cameraPosition = glm::vec4(Camera::cameraPosition, 1.0f);
+
+	frameData.time = currentTime;
+	frameData.deltaTime = deltaTime;
+
+	if (uniformBuffer == 0)
+		return;
+
+	// Orphan the old storage and upload the block in one call, so we never wait on a frame that still reads it
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, uniformBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniformData), &frameData, GL_DYNAMIC_DRAW);
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void FrameUniforms::SetScreenSize(int screenWidth, int screenHeight)
+{
+	frameData.screenSize = glm::vec2(static_cast<float>(screenWidth), static_cast<float>(screenHeight));
+}
+
+void FrameUniforms::BindProgram(unsigned int program)
+{
+	unsigned int blockIndex = glGetUniformBlockIndex(program, "FrameUniforms");
+
+	// Most programs (sprites, text, post-processing) don't use the camera at all
+	if (blockIndex == GL_INVALID_INDEX)
+		return;
+
+	glUniformBlockBinding(program, blockIndex, BINDING_POINT);
+}
+
+void FrameUniforms::Clear()
+{
+	if (uniformBuffer == 0)
+		return;
+
+	GLStateCache::DeleteBuffers(1, &uniformBuffer);
+	uniformBuffer = 0;
+}
@@ -0,0 +1,16 @@
+// Per-frame camera data shared by every program, filled once per frame by FrameUniforms::Update
+// The layout has to match the FrameUniformData struct in FrameUniforms.h
+layout (std140) uniform FrameUniforms
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    mat4 inverseView;
+    mat4 inverseProjection;
+
+    vec4 cameraPosition; // w is unused
+
+    vec2 screenSize;
+    float time;
+    float deltaTime;
+} frame;
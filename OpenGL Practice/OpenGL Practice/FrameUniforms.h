@@ -0,0 +1,72 @@
+#pragma once
+
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <glad/glad.h>
+
+// Include the GLM header files (OpenGL Mathematics Library)
+#include <glm.hpp>
+
+using namespace std;
+
+/* Every technique used to build its own projection and view matrices each frame and upload them (together with the camera
+position) to every one of its programs. The frame uniforms are computed once per frame instead and stored in a single
+uniform buffer that stays bound to a fixed binding point, so every program that includes FrameUniforms.glsl reads the
+same data without a single glUniform call (just like the "Matrices" block of the advanced data chapter, but for all
+programs) */
+
+/* The exact std140 layout of the FrameUniforms block in FrameUniforms.glsl. Matrices and vec4s are always aligned to 16
+bytes in std140, the vec3 camera position is padded to a vec4 so the C++ and GLSL layouts can't drift apart */
+struct FrameUniformData
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::mat4 viewProjection;
+	glm::mat4 inverseView;
+	glm::mat4 inverseProjection;
+
+	glm::vec4 cameraPosition; // w is unused
+
+	glm::vec2 screenSize;
+	float time;
+	float deltaTime;
+};
+
+static_assert(sizeof(FrameUniformData) == 352, "FrameUniformData has to match the std140 layout of FrameUniforms.glsl");
+
+class FrameUniforms
+{
+public:
+	// Creates the uniform buffer and binds it to its binding point, has to be called once the OpenGL context exists
+	static void Initialize(int screenWidth, int screenHeight);
+
+	// Recomputes the camera matrices and uploads the whole block, call once per frame before rendering anything
+	static void Update(float currentTime, float deltaTime);
+
+	// Called whenever the framebuffer is resized, the projection's aspect ratio follows the screen size
+	static void SetScreenSize(int screenWidth, int screenHeight);
+
+	/* Points the program's FrameUniforms block (if it has one) to the frame uniform binding point. GLSL 3.30 has no
+	layout (binding = N) for uniform blocks, so this is done for every program right after it's linked */
+	static void BindProgram(unsigned int program);
+
+	// Deletes the uniform buffer
+	static void Clear();
+
+	// The data uploaded by the last Update, for CPU code that needs the same matrices (culling etc.)
+	static FrameUniformData frameData;
+
+	// Binding point 0 is used by the "Matrices" block of the advanced data chapter
+	static const unsigned int BINDING_POINT = 1;
+
+	static const float NEAR_PLANE;
+	static const float FAR_PLANE;
+
+private:
+	FrameUniforms() { }
+
+	static unsigned int uniformBuffer;
+};
+
+#endif
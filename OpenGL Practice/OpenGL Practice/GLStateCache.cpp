@@ -0,0 +1,376 @@
+#include "GLStateCache.h"
+
+#include <iostream>
+
+// Instantiate static variables
+unsigned int GLStateCache::lastFrameIssuedCalls = 0;
+unsigned int GLStateCache::lastFrameSkippedCalls = 0;
+
+GLuint GLStateCache::currentProgram = GLStateCache::UNKNOWN;
+GLuint GLStateCache::currentVertexArray = GLStateCache::UNKNOWN;
+GLuint GLStateCache::currentArrayBuffer = GLStateCache::UNKNOWN;
+GLuint GLStateCache::currentReadFramebuffer = GLStateCache::UNKNOWN;
+GLuint GLStateCache::currentDrawFramebuffer = GLStateCache::UNKNOWN;
+
+GLuint GLStateCache::activeTextureUnit = GLStateCache::UNKNOWN;
+
+array<array<GLuint, GLStateCache::TEXTURE_TARGET_COUNT>, GLStateCache::MAX_TEXTURE_UNITS> GLStateCache::boundTextures;
+array<GLuint, GLStateCache::CAPABILITY_COUNT> GLStateCache::capabilities;
+
+GLuint GLStateCache::blendSourceFactor = GLStateCache::UNKNOWN;
+GLuint GLStateCache::blendDestinationFactor = GLStateCache::UNKNOWN;
+GLuint GLStateCache::depthFunction = GLStateCache::UNKNOWN;
+GLuint GLStateCache::depthMask = GLStateCache::UNKNOWN;
+GLuint GLStateCache::stencilFunction = GLStateCache::UNKNOWN;
+GLuint GLStateCache::stencilReference = GLStateCache::UNKNOWN;
+GLuint GLStateCache::stencilFunctionMask = GLStateCache::UNKNOWN;
+GLuint GLStateCache::stencilFail = GLStateCache::UNKNOWN;
+GLuint GLStateCache::stencilDepthFail = GLStateCache::UNKNOWN;
+GLuint GLStateCache::stencilDepthPass = GLStateCache::UNKNOWN;
+GLuint GLStateCache::stencilMask = GLStateCache::UNKNOWN;
+
+unsigned int GLStateCache::issuedCalls = 0;
+unsigned int GLStateCache::skippedCalls = 0;
+
+unsigned long long GLStateCache::totalIssuedCalls = 0;
+unsigned long long GLStateCache::totalSkippedCalls = 0;
+unsigned int GLStateCache::frameCount = 0;
+
+void GLStateCache::UseProgram(GLuint program)
+{
+	if (Changed(currentProgram, program))
+		glUseProgram(program);
+}
+
+void GLStateCache::BindVertexArray(GLuint vertexArray)
+{
+	if (Changed(currentVertexArray, vertexArray))
+		glBindVertexArray(vertexArray);
+}
+
+void GLStateCache::BindBuffer(GLenum target, GLuint buffer)
+{
+	if (target != GL_ARRAY_BUFFER)
+	{
+		issuedCalls++;
+		glBindBuffer(target, buffer);
+		return;
+	}
+
+	if (Changed(currentArrayBuffer, buffer))
+		glBindBuffer(target, buffer);
+}
+
+void GLStateCache::BindFramebuffer(GLenum target, GLuint framebuffer)
+{
+	if (target == GL_READ_FRAMEBUFFER)
+	{
+		if (Changed(currentReadFramebuffer, framebuffer))
+			glBindFramebuffer(target, framebuffer);
+
+		return;
+	}
+
+	if (target == GL_DRAW_FRAMEBUFFER)
+	{
+		if (Changed(currentDrawFramebuffer, framebuffer))
+			glBindFramebuffer(target, framebuffer);
+
+		return;
+	}
+
+	// GL_FRAMEBUFFER binds both the read and the draw framebuffer
+	if (currentReadFramebuffer == framebuffer && currentDrawFramebuffer == framebuffer)
+	{
+		skippedCalls++;
+		return;
+	}
+
+	currentReadFramebuffer = framebuffer;
+	currentDrawFramebuffer = framebuffer;
+
+	issuedCalls++;
+	glBindFramebuffer(target, framebuffer);
+}
+
+void GLStateCache::ActiveTexture(GLenum textureUnit)
+{
+	if (Changed(activeTextureUnit, textureUnit - GL_TEXTURE0))
+		glActiveTexture(textureUnit);
+}
+
+void GLStateCache::BindTexture(GLenum target, GLuint texture)
+{
+	int targetIndex = GetTextureTargetIndex(target);
+
+	// Untracked targets, units beyond what we track, or an unknown active unit can't be cached
+	if (targetIndex < 0 || activeTextureUnit >= MAX_TEXTURE_UNITS)
+	{
+		issuedCalls++;
+		glBindTexture(target, texture);
+		return;
+	}
+
+	if (Changed(boundTextures[activeTextureUnit][targetIndex], texture))
+		glBindTexture(target, texture);
+}
+
+void GLStateCache::Enable(GLenum capability)
+{
+	SetCapability(capability, true);
+}
+
+void GLStateCache::Disable(GLenum capability)
+{
+	SetCapability(capability, false);
+}
+
+void GLStateCache::BlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+	if (blendSourceFactor == sourceFactor && blendDestinationFactor == destinationFactor)
+	{
+		skippedCalls++;
+		return;
+	}
+
+	blendSourceFactor = sourceFactor;
+	blendDestinationFactor = destinationFactor;
+
+	issuedCalls++;
+	glBlendFunc(sourceFactor, destinationFactor);
+}
+
+void GLStateCache::DepthFunc(GLenum function)
+{
+	if (Changed(depthFunction, function))
+		glDepthFunc(function);
+}
+
+void GLStateCache::DepthMask(GLboolean flag)
+{
+	if (Changed(depthMask, flag))
+		glDepthMask(flag);
+}
+
+void GLStateCache::StencilFunc(GLenum function, GLint reference, GLuint mask)
+{
+	if (stencilFunction == function && stencilReference == static_cast<GLuint>(reference) && stencilFunctionMask == mask)
+	{
+		skippedCalls++;
+		return;
+	}
+
+	stencilFunction = function;
+	stencilReference = static_cast<GLuint>(reference);
+	stencilFunctionMask = mask;
+
+	issuedCalls++;
+	glStencilFunc(function, reference, mask);
+}
+
+void GLStateCache::StencilOp(GLenum stencilFail_, GLenum depthFail, GLenum depthPass)
+{
+	if (stencilFail == stencilFail_ && stencilDepthFail == depthFail && stencilDepthPass == depthPass)
+	{
+		skippedCalls++;
+		return;
+	}
+
+	stencilFail = stencilFail_;
+	stencilDepthFail = depthFail;
+	stencilDepthPass = depthPass;
+
+	issuedCalls++;
+	glStencilOp(stencilFail_, depthFail, depthPass);
+}
+
+void GLStateCache::StencilMask(GLuint mask)
+{
+	if (Changed(stencilMask, mask))
+		glStencilMask(mask);
+}
+
+void GLStateCache::DeleteTextures(GLsizei count, const GLuint* textures)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		for (array<GLuint, TEXTURE_TARGET_COUNT>& unit : boundTextures)
+		{
+			for (GLuint& boundTexture : unit)
+			{
+				if (boundTexture == textures[i])
+					boundTexture = 0;
+			}
+		}
+	}
+
+	glDeleteTextures(count, textures);
+}
+
+void GLStateCache::DeleteVertexArrays(GLsizei count, const GLuint* vertexArrays)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		if (currentVertexArray == vertexArrays[i])
+			currentVertexArray = 0;
+	}
+
+	glDeleteVertexArrays(count, vertexArrays);
+}
+
+void GLStateCache::DeleteBuffers(GLsizei count, const GLuint* buffers)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		if (currentArrayBuffer == buffers[i])
+			currentArrayBuffer = 0;
+	}
+
+	glDeleteBuffers(count, buffers);
+}
+
+void GLStateCache::DeleteFramebuffers(GLsizei count, const GLuint* framebuffers)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		if (currentReadFramebuffer == framebuffers[i])
+			currentReadFramebuffer = 0;
+
+		if (currentDrawFramebuffer == framebuffers[i])
+			currentDrawFramebuffer = 0;
+	}
+
+	glDeleteFramebuffers(count, framebuffers);
+}
+
+void GLStateCache::Invalidate()
+{
+	currentProgram = UNKNOWN;
+	currentVertexArray = UNKNOWN;
+	currentArrayBuffer = UNKNOWN;
+	currentReadFramebuffer = UNKNOWN;
+	currentDrawFramebuffer = UNKNOWN;
+
+	activeTextureUnit = UNKNOWN;
+
+	for (array<GLuint, TEXTURE_TARGET_COUNT>& unit : boundTextures)
+	{
+		unit.fill(UNKNOWN);
+	}
+
+	capabilities.fill(UNKNOWN);
+
+	blendSourceFactor = UNKNOWN;
+	blendDestinationFactor = UNKNOWN;
+	depthFunction = UNKNOWN;
+	depthMask = UNKNOWN;
+	stencilFunction = UNKNOWN;
+	stencilReference = UNKNOWN;
+	stencilFunctionMask = UNKNOWN;
+	stencilFail = UNKNOWN;
+	stencilDepthFail = UNKNOWN;
+	stencilDepthPass = UNKNOWN;
+	stencilMask = UNKNOWN;
+}
+
+void GLStateCache::EndFrame()
+{
+	lastFrameIssuedCalls = issuedCalls;
+	lastFrameSkippedCalls = skippedCalls;
+
+	totalIssuedCalls += issuedCalls;
+	totalSkippedCalls += skippedCalls;
+	frameCount++;
+
+	issuedCalls = 0;
+	skippedCalls = 0;
+}
+
+void GLStateCache::PrintStatistics()
+{
+	cout << "GL state cache: last frame issued " << lastFrameIssuedCalls << " state changes and skipped "
+		<< lastFrameSkippedCalls << " redundant ones" << endl;
+
+	if (frameCount == 0)
+		return;
+
+	cout << "GL state cache: " << frameCount << " frames, on average " << totalIssuedCalls / frameCount
+		<< " issued and " << totalSkippedCalls / frameCount << " skipped per frame" << endl;
+}
+
+int GLStateCache::GetTextureTargetIndex(GLenum target)
+{
+	switch (target)
+	{
+	case GL_TEXTURE_2D:
+		return TEXTURE_2D_TARGET;
+
+	case GL_TEXTURE_CUBE_MAP:
+		return TEXTURE_CUBE_MAP_TARGET;
+
+	case GL_TEXTURE_2D_MULTISAMPLE:
+		return TEXTURE_2D_MULTISAMPLE_TARGET;
+
+	default:
+		return -1;
+	}
+}
+
+int GLStateCache::GetCapabilityIndex(GLenum capability)
+{
+	switch (capability)
+	{
+	case GL_BLEND:
+		return BLEND_CAPABILITY;
+
+	case GL_DEPTH_TEST:
+		return DEPTH_TEST_CAPABILITY;
+
+	case GL_STENCIL_TEST:
+		return STENCIL_TEST_CAPABILITY;
+
+	case GL_CULL_FACE:
+		return CULL_FACE_CAPABILITY;
+
+	case GL_MULTISAMPLE:
+		return MULTISAMPLE_CAPABILITY;
+
+	case GL_FRAMEBUFFER_SRGB:
+		return FRAMEBUFFER_SRGB_CAPABILITY;
+
+	default:
+		return -1;
+	}
+}
+
+void GLStateCache::SetCapability(GLenum capability, bool enabled)
+{
+	int capabilityIndex = GetCapabilityIndex(capability);
+
+	if (capabilityIndex >= 0 && !Changed(capabilities[capabilityIndex], enabled ? 1 : 0))
+		return;
+
+	// Untracked capabilities (debug output, seamless cube maps etc.) are always passed through
+	if (capabilityIndex < 0)
+		issuedCalls++;
+
+	if (enabled)
+		glEnable(capability);
+
+	else
+		glDisable(capability);
+}
+
+bool GLStateCache::Changed(GLuint& cachedValue, GLuint newValue)
+{
+	if (cachedValue == newValue)
+	{
+		skippedCalls++;
+		return false;
+	}
+
+	cachedValue = newValue;
+	issuedCalls++;
+
+	return true;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+#include <glad/glad.h>
+#include <array>
+
+using namespace std;
+
+/* OpenGL doesn't check whether a state change actually changes anything, so binding the same program, VAO or texture for
+every sprite, glyph and particle still costs a driver call each time. The state cache remembers what's currently bound and
+set, and only calls OpenGL when the new value is different. Every function takes the exact same parameters as the OpenGL
+function it wraps, states that aren't tracked are simply passed through. For this to be correct every change of a tracked
+state has to go through the cache (objects deleted through the cache are forgotten as well), and Invalidate has to be
+called if some code changes the state behind its back */
+
+class GLStateCache
+{
+public:
+	static void UseProgram(GLuint program);
+	static void BindVertexArray(GLuint vertexArray);
+
+	// Tracks GL_ARRAY_BUFFER, the element array buffer belongs to the VAO and the indexed targets are changed by glBindBufferBase
+	static void BindBuffer(GLenum target, GLuint buffer);
+
+	// Tracks GL_FRAMEBUFFER, GL_READ_FRAMEBUFFER and GL_DRAW_FRAMEBUFFER
+	static void BindFramebuffer(GLenum target, GLuint framebuffer);
+
+	// The active unit is tracked as well, so the texture bindings can be tracked per unit
+	static void ActiveTexture(GLenum textureUnit);
+
+	// Tracks the 2D, cube map and 2D multisample bindings of every texture unit
+	static void BindTexture(GLenum target, GLuint texture);
+
+	// Tracks blending, depth testing, stencil testing, face culling, multisampling and sRGB framebuffers
+	static void Enable(GLenum capability);
+	static void Disable(GLenum capability);
+
+	static void BlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+	static void DepthFunc(GLenum function);
+	static void DepthMask(GLboolean flag);
+	static void StencilFunc(GLenum function, GLint reference, GLuint mask);
+	static void StencilOp(GLenum stencilFail, GLenum depthFail, GLenum depthPass);
+	static void StencilMask(GLuint mask);
+
+	// Delete the objects and forget any binding of them, OpenGL unbinds deleted objects and may reuse their names
+	static void DeleteTextures(GLsizei count, const GLuint* textures);
+	static void DeleteVertexArrays(GLsizei count, const GLuint* vertexArrays);
+	static void DeleteBuffers(GLsizei count, const GLuint* buffers);
+	static void DeleteFramebuffers(GLsizei count, const GLuint* framebuffers);
+
+	// Forgets everything, so the next change of every state is issued again (also has to be called once the context exists)
+	static void Invalidate();
+
+	// Stores the counts of the frame that just finished and starts counting the next one
+	static void EndFrame();
+
+	// Prints how many calls the last frame issued and skipped, and the averages over every frame so far
+	static void PrintStatistics();
+
+	// Calls issued to OpenGL and calls skipped because nothing changed, during the last finished frame
+	static unsigned int lastFrameIssuedCalls, lastFrameSkippedCalls;
+
+private:
+	GLStateCache() { }
+
+	// Texture targets tracked per texture unit
+	enum TextureTarget { TEXTURE_2D_TARGET, TEXTURE_CUBE_MAP_TARGET, TEXTURE_2D_MULTISAMPLE_TARGET, TEXTURE_TARGET_COUNT };
+
+	// Capabilities tracked by Enable and Disable
+	enum Capability { BLEND_CAPABILITY, DEPTH_TEST_CAPABILITY, STENCIL_TEST_CAPABILITY, CULL_FACE_CAPABILITY,
+		MULTISAMPLE_CAPABILITY, FRAMEBUFFER_SRGB_CAPABILITY, CAPABILITY_COUNT };
+
+	static const unsigned int MAX_TEXTURE_UNITS = 32;
+
+	// A value that is never a valid object name or enum, so the first change of a state is always issued
+	static const GLuint UNKNOWN = 0xFFFFFFFF;
+
+	static int GetTextureTargetIndex(GLenum target);
+	static int GetCapabilityIndex(GLenum capability);
+
+	static void SetCapability(GLenum capability, bool enabled);
+
+	// Returns true if the call is needed, and counts it as issued or skipped
+	static bool Changed(GLuint& cachedValue, GLuint newValue);
+
+	static GLuint currentProgram, currentVertexArray, currentArrayBuffer;
+	static GLuint currentReadFramebuffer, currentDrawFramebuffer;
+
+	// Index of the active texture unit (0 for GL_TEXTURE0)
+	static GLuint activeTextureUnit;
+
+	static array<array<GLuint, TEXTURE_TARGET_COUNT>, MAX_TEXTURE_UNITS> boundTextures;
+
+	static array<GLuint, CAPABILITY_COUNT> capabilities;
+
+	static GLuint blendSourceFactor, blendDestinationFactor;
+	static GLuint depthFunction, depthMask;
+	static GLuint stencilFunction, stencilReference, stencilFunctionMask;
+	static GLuint stencilFail, stencilDepthFail, stencilDepthPass, stencilMask;
+
+	static unsigned int issuedCalls, skippedCalls;
+
+	// Totals over every finished frame, for the averages
+	static unsigned long long totalIssuedCalls, totalSkippedCalls;
+	static unsigned int frameCount;
+};
+
+#endif
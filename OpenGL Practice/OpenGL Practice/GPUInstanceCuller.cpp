@@ -0,0 +1,313 @@
+#include "GPUInstanceCuller.h"
+#include "GLStateCache.h"
+
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+constexpr unsigned int FRUSTUM_PLANES_UNIFORM = UniformHash("frustumPlanes");
+constexpr unsigned int BOUNDING_SPHERE_UNIFORM = UniformHash("boundingSphere");
+constexpr unsigned int CAMERA_POSITION_UNIFORM = UniformHash("cameraPosition");
+constexpr unsigned int LOD_ERRORS_UNIFORM = UniformHash("lodErrors");
+constexpr unsigned int LOD_COUNT_UNIFORM = UniformHash("lodCount");
+constexpr unsigned int PIXELS_PER_UNIT_UNIFORM = UniformHash("pixelsPerUnit");
+constexpr unsigned int MAX_PIXEL_ERROR_UNIFORM = UniformHash("maxPixelError");
+constexpr unsigned int LOD_UNIFORM = UniformHash("lod");
+
+// Has to match MAX_LOD_COUNT in InstanceCullingVertexShader.glsl
+const unsigned int GPU_CULLING_MAX_LOD_COUNT = 8;
+
+// Instantiate static variables
+bool GPUInstanceCuller::supportQueried = false;
+bool GPUInstanceCuller::supported = false;
+
+GPUInstanceCuller::GPUInstanceCuller()
+{
+	model = nullptr;
+	instanceCount = 0;
+	lodCount = 0;
+
+	cullShaderProgram = nullptr;
+
+	instanceVAO = NULL;
+	instanceBuffer = NULL;
+	visibleBuffer = NULL;
+	indirectBuffer = NULL;
+}
+
+GPUInstanceCuller::~GPUInstanceCuller()
+{
+	DeleteBuffers();
+
+	delete cullShaderProgram;
+	cullShaderProgram = nullptr;
+}
+
+bool GPUInstanceCuller::IsSupported()
+{
+	if (supportQueried)
+		return supported;
+
+	supportQueried = true;
+
+	int majorVersion = 0, minorVersion = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+	glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+	// Query buffers are core since OpenGL 4.4
+	bool queryBuffers = majorVersion > 4 || (majorVersion == 4 && minorVersion >= 4);
+
+	/* Every level of detail reads its instances from its own part of the visible buffer through the draw command's
+	baseInstance, which has to be 0 without OpenGL 4.2 (or ARB_base_instance). Otherwise every level would draw the
+	first level's instances */
+	bool baseInstance = majorVersion > 4 || (majorVersion == 4 && minorVersion >= 2);
+
+	if (!queryBuffers || !baseInstance)
+	{
+		int extensionCount = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+
+		for (int i = 0; i < extensionCount; i++)
+		{
+			const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+
+			queryBuffers = queryBuffers || strcmp(extension, "GL_ARB_query_buffer_object") == 0;
+			baseInstance = baseInstance || strcmp(extension, "GL_ARB_base_instance") == 0;
+		}
+	}
+
+	supported = queryBuffers && baseInstance && MeshBuffer::SupportsMultiDrawIndirect();
+
+	return supported;
+}
+
+void GPUInstanceCuller::Initialize(Model* model_, const mat4* matrices_, unsigned int count_)
+{
+	DeleteBuffers();
+
+	model = model_;
+	instanceCount = count_;
+	lodCount = std::min(std::max(model->GetLODCount(), 1u), GPU_CULLING_MAX_LOD_COUNT);
+
+	if (cullShaderProgram == nullptr)
+	{
+		cullShaderProgram = new ShaderProgram();
+
+		// Transform feedback only captures what the geometry shader emits, which is the matrix of a visible instance
+		cullShaderProgram->transformFeedbackVaryings.push_back("culledInstanceMatrix");
+
+		cullShaderProgram->InitializeShaderProgram(new VertexShaderLoader("InstanceCullingVertexShader.glsl"),
+			new FragmentShaderLoader("InstanceCullingFragmentShader.glsl"),
+			new GeometryShader("InstanceCullingGeometryShader.glsl"));
+	}
+
+	glGenVertexArrays(1, &instanceVAO);
+	glGenBuffers(1, &instanceBuffer);
+
+	GLStateCache::BindVertexArray(instanceVAO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+	glBufferData(GL_ARRAY_BUFFER, instanceCount * sizeof(mat4), matrices_, GL_STATIC_DRAW);
+
+	// One matrix per point this time, the culling pass runs the vertex shader once for every instance
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		glEnableVertexAttribArray(i);
+		glVertexAttribPointer(i, 4, GL_FLOAT, GL_FALSE, sizeof(mat4), (void*)(i * sizeof(vec4)));
+	}
+
+	GLStateCache::BindVertexArray(0);
+
+	// Room for every instance at every level, a pass never knows how many instances the passes before it wrote
+	glGenBuffers(1, &visibleBuffer);
+	GLStateCache::BindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, visibleBuffer);
+	glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, static_cast<size_t>(lodCount) * instanceCount * sizeof(mat4), NULL,
+		GL_DYNAMIC_COPY);
+	GLStateCache::BindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0);
+
+	queries.resize(lodCount);
+	glGenQueries(lodCount, queries.data());
+
+	// The instance counts are filled in by the GPU every frame, everything else stays the same
+	vector<DrawElementsIndirectCommand> commands;
+
+	for (unsigned int lod = 0; lod < lodCount; lod++)
+	{
+		for (unsigned int i = 0; i < model->meshes.size(); i++)
+		{
+			const Mesh& mesh = model->meshes[i];
+			unsigned int meshLOD = std::min(lod, static_cast<unsigned int>(mesh.lods.size()) - 1);
+
+			DrawElementsIndirectCommand command;
+			command.count = mesh.lods[meshLOD].indexCount;
+			command.instanceCount = 0;
+			command.firstIndex = mesh.firstIndex + mesh.lods[meshLOD].indexOffset;
+			command.baseVertex = mesh.baseVertex;
+
+			// Instanced attributes start reading at baseInstance, which is where the level's part of the buffer starts
+			command.baseInstance = lod * instanceCount;
+
+			commands.push_back(command);
+		}
+	}
+
+	glGenBuffers(1, &indirectBuffer);
+	GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(),
+		GL_DYNAMIC_DRAW);
+	GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	for (unsigned int i = 0; i < model->meshes.size(); i++)
+	{
+		SetInstanceAttributes(model->meshes[i].VAO);
+	}
+
+	GLStateCache::BindVertexArray(0);
+}
+
+void GPUInstanceCuller::Cull(const mat4& projectionMatrix_, const mat4& viewMatrix_, const vec3& cameraPosition_,
+	float screenHeight_, float maxPixelError_)
+{
+	if (model == nullptr || instanceCount == 0)
+		return;
+
+	Frustum frustum(projectionMatrix_ * viewMatrix_);
+
+	float lodErrors[GPU_CULLING_MAX_LOD_COUNT] = { };
+
+	for (unsigned int i = 0; i < std::min(model->GetLODCount(), lodCount); i++)
+	{
+		lodErrors[i] = model->lodErrors[i];
+	}
+
+	GLStateCache::UseProgram(cullShaderProgram->shaderProgram);
+
+	glUniform4fv(cullShaderProgram->GetUniformLocation(UniformArrayHash(FRUSTUM_PLANES_UNIFORM, 0)), 6,
+		&frustum.planes[0].x);
+	glUniform1fv(cullShaderProgram->GetUniformLocation(UniformArrayHash(LOD_ERRORS_UNIFORM, 0)),
+		GPU_CULLING_MAX_LOD_COUNT, lodErrors);
+
+	cullShaderProgram->SetVec4(BOUNDING_SPHERE_UNIFORM, vec4(model->boundingSphere.center,
+		model->boundingSphere.radius));
+	cullShaderProgram->SetVec3(CAMERA_POSITION_UNIFORM, cameraPosition_);
+	cullShaderProgram->SetInt(LOD_COUNT_UNIFORM, static_cast<int>(lodCount));
+
+	// The same pixels per unit Model::SelectLOD works out, only without the distance which the shader divides by
+	cullShaderProgram->SetFloat(PIXELS_PER_UNIT_UNIFORM, projectionMatrix_[1][1] * 0.5f * screenHeight_);
+	cullShaderProgram->SetFloat(MAX_PIXEL_ERROR_UNIFORM, maxPixelError_);
+
+	GLStateCache::BindVertexArray(instanceVAO);
+
+	// Nothing is drawn, the pass stops right after the geometry shader
+	GLStateCache::Enable(GL_RASTERIZER_DISCARD);
+
+	for (unsigned int lod = 0; lod < lodCount; lod++)
+	{
+		cullShaderProgram->SetInt(LOD_UNIFORM, static_cast<int>(lod));
+
+		glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, visibleBuffer,
+			static_cast<GLintptr>(lod) * instanceCount * sizeof(mat4), instanceCount * sizeof(mat4));
+
+		glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, queries[lod]);
+		glBeginTransformFeedback(GL_POINTS);
+
+		glDrawArrays(GL_POINTS, 0, instanceCount);
+
+		glEndTransformFeedback();
+		glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+	}
+
+	GLStateCache::Disable(GL_RASTERIZER_DISCARD);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+
+	GLStateCache::BindVertexArray(0);
+
+	/* With a buffer bound to GL_QUERY_BUFFER the pointer is an offset into it, and the GPU writes the result there once
+	the pass is done. The CPU moves on right away instead of waiting for it */
+	GLStateCache::BindBuffer(GL_QUERY_BUFFER, indirectBuffer);
+
+	unsigned int meshCount = static_cast<unsigned int>(model->meshes.size());
+
+	for (unsigned int lod = 0; lod < lodCount; lod++)
+	{
+		for (unsigned int i = 0; i < meshCount; i++)
+		{
+			size_t offset = (lod * meshCount + i) * sizeof(DrawElementsIndirectCommand) +
+				offsetof(DrawElementsIndirectCommand, instanceCount);
+
+			glGetQueryObjectuiv(queries[lod], GL_QUERY_RESULT, reinterpret_cast<GLuint*>(offset));
+		}
+	}
+
+	GLStateCache::BindBuffer(GL_QUERY_BUFFER, 0);
+}
+
+void GPUInstanceCuller::DrawInstances(ShaderProgram* shaderProgram_)
+{
+	if (model == nullptr || instanceCount == 0)
+		return;
+
+	unsigned int meshCount = static_cast<unsigned int>(model->meshes.size());
+
+	GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+
+	for (unsigned int i = 0; i < meshCount; i++)
+	{
+		Mesh& mesh = model->meshes[i];
+
+		mesh.SetVertexFormat(shaderProgram_);
+
+		// The instancing draw moves the instance attributes around, so they're pointed back at the visible buffer
+		SetInstanceAttributes(mesh.VAO);
+
+		for (unsigned int lod = 0; lod < lodCount; lod++)
+		{
+			MeshBuffer::MultiDrawElementsIndirect(GL_TRIANGLES, mesh.indexType,
+				(void*)((lod * meshCount + i) * sizeof(DrawElementsIndirectCommand)), 1);
+		}
+
+		GLStateCache::BindVertexArray(0);
+		mesh.ResetVertexFormat(shaderProgram_);
+	}
+
+	GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+}
+
+void GPUInstanceCuller::SetInstanceAttributes(unsigned int VAO_)
+{
+	GLStateCache::BindVertexArray(VAO_);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, visibleBuffer);
+
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		glEnableVertexAttribArray(3 + i);
+		glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(mat4), (void*)(i * sizeof(vec4)));
+		glVertexAttribDivisor(3 + i, 1);
+	}
+}
+
+void GPUInstanceCuller::DeleteBuffers()
+{
+	if (!queries.empty())
+		glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+
+	queries.clear();
+
+	if (instanceBuffer != NULL)
+		GLStateCache::DeleteBuffers(1, &instanceBuffer);
+
+	if (visibleBuffer != NULL)
+		GLStateCache::DeleteBuffers(1, &visibleBuffer);
+
+	if (indirectBuffer != NULL)
+		GLStateCache::DeleteBuffers(1, &indirectBuffer);
+
+	if (instanceVAO != NULL)
+		GLStateCache::DeleteVertexArrays(1, &instanceVAO);
+
+	instanceBuffer = NULL;
+	visibleBuffer = NULL;
+	indirectBuffer = NULL;
+	instanceVAO = NULL;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#ifndef GPU_INSTANCE_CULLER_H
+#define GPU_INSTANCE_CULLER_H
+
+#include "Model.h"
+
+#include <vector>
+
+// Not part of OpenGL 3.3, so GLAD might not define it
+#ifndef GL_QUERY_BUFFER
+#define GL_QUERY_BUFFER 0x9192
+#endif
+
+using namespace std;
+
+/* Culls the instances of an instanced model on the GPU instead of the CPU. The instance matrices stay in a buffer on the
+GPU, and a culling pass draws them as points with rasterization turned off: the vertex shader tests every instance's
+sphere against the frustum planes and picks its level of detail, the geometry shader drops the instances that aren't
+visible at the pass's level, and transform feedback writes the others one after the other into the visible buffer. Every
+level of detail has its own pass and its own part of the visible buffer, which is where its draw reads the instances from
+(with the indirect command's baseInstance).
+
+A GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN query counts the instances every pass wrote. Reading it with
+glGetQueryObjectuiv would make the CPU wait for the GPU to finish the pass, so instead the result is written straight
+into the instanceCount of the indirect draw commands (with a buffer bound to GL_QUERY_BUFFER) and the CPU never sees
+it. That needs OpenGL 4.4 (or ARB_query_buffer_object), glMultiDrawElementsIndirect and a baseInstance that isn't
+ignored (OpenGL 4.2 or ARB_base_instance), without them Instancing culls on the CPU */
+
+class GPUInstanceCuller
+{
+public:
+	GPUInstanceCuller();
+	~GPUInstanceCuller();
+
+	/* Checks for query buffers, indirect draws and base instances the first time it's called, has to be called on the
+	main thread */
+	static bool IsSupported();
+
+	/* Uploads the instance matrices (they never change afterwards) and makes room for every instance at every one of the
+	model's levels of detail. The model has to stay alive as long as the culler */
+	void Initialize(Model* model_, const mat4* matrices_, unsigned int count_);
+
+	/* Runs one culling pass for every level of detail, the visible instances are ready for DrawInstances once the GPU gets
+	there. screenHeight_ is in pixels, the same as for Model::SelectLOD */
+	void Cull(const mat4& projectionMatrix_, const mat4& viewMatrix_, const vec3& cameraPosition_, float screenHeight_,
+		float maxPixelError_ = 1.0f);
+
+	/* Draws every mesh of the model for the visible instances of every level of detail, with the shader's instance matrix
+	attributes at locations 3 to 6 like the instancing shader has them. The shader has to be in use already */
+	void DrawInstances(ShaderProgram* shaderProgram_);
+
+private:
+	// Points attributes 3 to 6 of the vertex array at the visible buffer, one matrix per instance
+	void SetInstanceAttributes(unsigned int VAO_);
+
+	void DeleteBuffers();
+
+	Model* model;
+	unsigned int instanceCount;
+	unsigned int lodCount;
+
+	ShaderProgram* cullShaderProgram;
+
+	/* The culling pass reads the matrices from instanceBuffer through instanceVAO, and writes the visible ones to
+	visibleBuffer */
+	unsigned int instanceVAO, instanceBuffer;
+	unsigned int visibleBuffer;
+
+	// One GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN query for every level of detail
+	vector<unsigned int> queries;
+
+	// One draw command for every level of detail of every mesh, level after level
+	unsigned int indirectBuffer;
+
+	static bool supportQueried, supported;
+};
+
+#endif
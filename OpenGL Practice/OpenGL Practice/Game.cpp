@@ -35,23 +35,19 @@ void Game::InitializeGame()
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);*/
 
-	// Load shaders
-	ResourceManager::LoadShader("SpriteRendererVertexShader.glsl", "SpriteRendererFragmentShader.glsl", nullptr, "sprite");
-	ResourceManager::LoadShader("ParticleVertexShader.glsl", "ParticleFragmentShader.glsl", nullptr, "particle");
-	ResourceManager::LoadShader("PostprocessingVertexShader.glsl", "PostprocessingFragmentShader.glsl", nullptr, "postprocessing");
+	/* Load shaders asynchronously, the files are read on worker threads and all the programs are handed to the driver at once
+	so they can compile in parallel while we load the textures and levels below */
+	ResourceManager::LoadShaderAsync("SpriteRendererVertexShader.glsl", "SpriteRendererFragmentShader.glsl", nullptr, "sprite");
+	ResourceManager::LoadShaderAsync("ParticleVertexShader.glsl", "ParticleFragmentShader.glsl", nullptr, "particle");
 
-	// Configure shaders
-	mat4 proj = ortho(0.0f, static_cast<float>(gameWidth), static_cast<float>(gameHeight), 0.0f, -1.0f, 1.0f);
-
-	glUseProgram(ResourceManager::GetShader("sprite").shaderProgram);
-
-	glUniform1i(glGetUniformLocation(ResourceManager::GetShader("sprite").shaderProgram, "image"), 0);
-	glUniformMatrix4fv(glGetUniformLocation(ResourceManager::GetShader("sprite").shaderProgram, "projectionMatrix"), 1, GL_FALSE, value_ptr(proj));
+	// Every combination of the postprocessing effects is compiled as its own variant, the feature order matches PostprocessingEffect
+	ShaderVariantSet postprocessingShaders("PostprocessingVertexShader.glsl", "PostprocessingFragmentShader.glsl",
+		{ "CHAOS", "CONFUSE", "SHAKE" }, "postprocessing");
+	postprocessingShaders.LoadAllVariants();
 
-	glUseProgram(ResourceManager::GetShader("particle").shaderProgram);
+	ResourceManager::LoadShaderAsync("Text2DVertexShader.glsl", "Text2DFragmentShader.glsl", nullptr, "text");
 
-	glUniform1i(glGetUniformLocation(ResourceManager::GetShader("particle").shaderProgram, "sprite"), 0);
-	glUniformMatrix4fv(glGetUniformLocation(ResourceManager::GetShader("particle").shaderProgram, "projection"), 1, GL_FALSE, value_ptr(proj));
+	ResourceManager::CompileShaders();
 
 	// Load textures
 	ResourceManager::LoadTexture("Textures/background.jpg", false, "background");
@@ -72,7 +68,7 @@ void Game::InitializeGame()
 
 	Particles = new ParticleGenerator(ResourceManager::GetShader("particle"), ResourceManager::GetTexture("particle"), 500);
 
-	Effects = new Postprocessing(ResourceManager::GetShader("postprocessing"), this->gameWidth, this->gameHeight);
+	Effects = new Postprocessing(postprocessingShaders, this->gameWidth, this->gameHeight);
 
 	text = new TextRenderer(gameWidth, gameHeight);
 	text->Load("fonts/ocraext.TTF", 24);
@@ -90,6 +86,25 @@ void Game::InitializeGame()
 
 	level = 0;
 
+	// Configure shaders (this is the first point where the sprite and particle programs have to be linked)
+	mat4 proj = ortho(0.0f, static_cast<float>(gameWidth), static_cast<float>(gameHeight), 0.0f, -1.0f, 1.0f);
+
+	ShaderProgram spriteShader = ResourceManager::GetShader("sprite");
+	spriteShader.WaitUntilReady();
+
+	GLStateCache::UseProgram(spriteShader.shaderProgram);
+
+	glUniform1i(glGetUniformLocation(spriteShader.shaderProgram, "image"), 0);
+	glUniformMatrix4fv(glGetUniformLocation(spriteShader.shaderProgram, "projectionMatrix"), 1, GL_FALSE, value_ptr(proj));
+
+	ShaderProgram particleShader = ResourceManager::GetShader("particle");
+	particleShader.WaitUntilReady();
+
+	GLStateCache::UseProgram(particleShader.shaderProgram);
+
+	glUniform1i(glGetUniformLocation(particleShader.shaderProgram, "sprite"), 0);
+	glUniformMatrix4fv(glGetUniformLocation(particleShader.shaderProgram, "projection"), 1, GL_FALSE, value_ptr(proj));
+
 	vec2 playerPos = vec2(gameWidth / 2.0f - PLAYER_SIZE.x / 2.0f, gameHeight - PLAYER_SIZE.y);
 	player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
 
@@ -1,5 +1,6 @@
 #include "GammaCorrection.h"
 #include "Camera.h"
+#include "TextureCache.h"
 
 /* Doubling the input voltage resulted in a brightness equal to an exponential relationship of roughly 2.2 known as the 
 gamma of a monitor */
@@ -28,8 +29,8 @@ GammaCorrection::GammaCorrection() : gammaCorrectionShaderProgram(new ShaderProg
 
 GammaCorrection::~GammaCorrection()
 {
-    glDeleteVertexArrays(1, &planeVAO);
-    glDeleteBuffers(1, &planeVBO);
+    GLStateCache::DeleteVertexArrays(1, &planeVAO);
+    GLStateCache::DeleteBuffers(1, &planeVBO);
 }
 
 GammaCorrection* GammaCorrection::Instance()
@@ -56,9 +57,9 @@ void GammaCorrection::InitializeGamma()
 	We can specify a texture as an sRGB texture like so: (LEARNING PURPOSES ONLY)
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image); */
 
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLStateCache::Enable(GL_DEPTH_TEST);
+    GLStateCache::Enable(GL_BLEND);
+    GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	gammaCorrectionShaderProgram->InitializeShaderProgram(new VertexShaderLoader("GammaCorrectionVertexShader.glsl"),
 		new FragmentShaderLoader("GammaCorrectionFragmentShader.glsl"));
@@ -79,8 +80,8 @@ void GammaCorrection::InitializeGamma()
     glGenVertexArrays(1, &planeVAO);
     glGenBuffers(1, &planeVBO);
 
-    glBindVertexArray(planeVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, planeVBO);
+    GLStateCache::BindVertexArray(planeVAO);
+    GLStateCache::BindBuffer(GL_ARRAY_BUFFER, planeVBO);
 
     glBufferData(GL_ARRAY_BUFFER, sizeof(planeVertices), &planeVertices, GL_STATIC_DRAW);
 
@@ -94,103 +95,25 @@ void GammaCorrection::InitializeGamma()
     glVertexAttribPointer(TEXTURE_COORDINATE_ATTRIBUTE, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), 
         (void*)(6 * sizeof(float)));
 
-    glBindVertexArray(0);
+    GLStateCache::BindVertexArray(0);
 
 }
 
 void GammaCorrection::InitializeTextures(char const* path_, bool gammaCorrection_)
 {
-    glGenTextures(1, &floorTexture);
-
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(path_, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum internalFormat;
-        GLenum dataFormat;
-
-        if (nrComponents == 1)
-        {
-            internalFormat = dataFormat = GL_RED;
-        }
-
-        else if (nrComponents == 3)
-        {
-            internalFormat = gammaCorrection_ ? GL_SRGB : GL_RGB;
-            dataFormat = GL_RGB;
-        }
-
-        else if (nrComponents == 4)
-        {
-            internalFormat = gammaCorrection_ ? GL_SRGB_ALPHA : GL_RGBA;
-            dataFormat = GL_RGBA;
-        }
-
-        glBindTexture(GL_TEXTURE_2D, floorTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, dataFormat, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path_ << std::endl;
-        stbi_image_free(data);
-    }
+    /* The same file is loaded twice, once as linear and once as sRGB, and those are two different textures in the
+    texture cache */
+    floorTexture = TextureCache::LoadTexture(path_, TextureLoadOptions(false, gammaCorrection_, 0, true, false,
+        TEXTURE_COMPRESSION_COLOR));
 }
 
 void GammaCorrection::InitializeGammaCorrectedTextures(char const* path_, bool gammaCorrection_)
 {
-    glGenTextures(1, &floorTextureGammaCorrected);
-
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(path_, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum internalFormat;
-        GLenum dataFormat;
-
-        if (nrComponents == 1)
-        {
-            internalFormat = dataFormat = GL_RED;
-        }
-
-        else if (nrComponents == 3)
-        {
-            internalFormat = gammaCorrection_ ? GL_SRGB : GL_RGB;
-            dataFormat = GL_RGB;
-        }
-
-        else if (nrComponents == 4)
-        {
-            internalFormat = gammaCorrection_ ? GL_SRGB_ALPHA : GL_RGBA;
-            dataFormat = GL_RGBA;
-        }
-
-        glBindTexture(GL_TEXTURE_2D, floorTextureGammaCorrected);
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, dataFormat, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path_ << std::endl;
-        stbi_image_free(data);
-    }
+    floorTextureGammaCorrected = TextureCache::LoadTexture(path_, TextureLoadOptions(false, gammaCorrection_, 0, true, false,
+        TEXTURE_COMPRESSION_COLOR));
 
     // Use the shader program after initializing the 2 textures and set the sampler2D uniform
-    glUseProgram(gammaCorrectionShaderProgram->shaderProgram);
+    GLStateCache::UseProgram(gammaCorrectionShaderProgram->shaderProgram);
     glUniform1i(glGetUniformLocation(gammaCorrectionShaderProgram->shaderProgram, "floorTexture"), 0);
 }
 
@@ -218,16 +141,7 @@ void GammaCorrection::UseGammaShaderProgram()
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glUseProgram(gammaCorrectionShaderProgram->shaderProgram);
-
-    mat4 projectionMatrix = perspective(radians(Camera::fieldOfView), float(1280/960), 0.1f, 100.0f);
-    mat4 viewMatrix = lookAt(Camera::cameraPosition, Camera::cameraPosition + Camera::cameraFront, Camera::cameraUp);
-
-    glUniformMatrix4fv(glGetUniformLocation(gammaCorrectionShaderProgram->shaderProgram, "projectionMatrix"), 1,
-        GL_FALSE, value_ptr(projectionMatrix));
-
-    glUniformMatrix4fv(glGetUniformLocation(gammaCorrectionShaderProgram->shaderProgram, "viewMatrix"), 1, GL_FALSE,
-        value_ptr(viewMatrix));
+    GLStateCache::UseProgram(gammaCorrectionShaderProgram->shaderProgram);
 
     // Set light uniforms
     glUniform3fv(glGetUniformLocation(gammaCorrectionShaderProgram->shaderProgram, "lightPositions"), 4, 
@@ -235,16 +149,13 @@ void GammaCorrection::UseGammaShaderProgram()
 
     glUniform3fv(glGetUniformLocation(gammaCorrectionShaderProgram->shaderProgram, "lightColors"), 4, &lightColors[0][0]);
 
-    glUniform3f(glGetUniformLocation(gammaCorrectionShaderProgram->shaderProgram, "viewPosition"), 
-        Camera::cameraPosition.x, Camera::cameraPosition.y, Camera::cameraPosition.z);
-
     glUniform1i(glGetUniformLocation(gammaCorrectionShaderProgram->shaderProgram, "isGammaOn"), gammaEnabled);
 
     // Use the floor texture now
-    glBindVertexArray(planeVAO);
+    GLStateCache::BindVertexArray(planeVAO);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, gammaEnabled ? floorTextureGammaCorrected : floorTexture);
+    GLStateCache::ActiveTexture(GL_TEXTURE0);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, gammaEnabled ? floorTextureGammaCorrected : floorTexture);
     glDrawArrays(GL_TRIANGLES, 0, 6);
 
     cout << (gammaEnabled ? "Gamma enabled\n" : "Gamma disabled\n");
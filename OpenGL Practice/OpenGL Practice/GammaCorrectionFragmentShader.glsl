@@ -12,7 +12,7 @@ uniform sampler2D floorTexture;
 
 uniform vec3 lightPositions[4];
 uniform vec3 lightColors[4];
-uniform vec3 viewPosition;
+#include "FrameUniforms.glsl"
 
 uniform bool isGammaOn;
 
@@ -24,7 +24,7 @@ vec3 BlinnPhong(vec3 normal, vec3 fragPos, vec3 lightPos, vec3 lightColor)
     vec3 diffuse = diffValue * lightColor;
 
     // Specular lighting
-    vec3 viewDirection = normalize(viewPosition - fragPos);
+    vec3 viewDirection = normalize(frame.cameraPosition.xyz - fragPos);
     vec3 reflectDirection = reflect(-lightDirection, normal);
 
     float spec = 0.0;
@@ -10,8 +10,7 @@ out VS_OUT {
     vec2 TexCoords;
 } vs_out;
 
-uniform mat4 projectionMatrix;
-uniform mat4 viewMatrix;
+#include "FrameUniforms.glsl"
 
 void main()
 {
@@ -19,5 +18,5 @@ void main()
     vs_out.Normal = normals;
     vs_out.TexCoords = texCoordinates;
 
-    gl_Position = projectionMatrix * viewMatrix * vec4(position, 1.0);
+    gl_Position = frame.viewProjection * vec4(position, 1.0);
 }
\ No newline at end of file
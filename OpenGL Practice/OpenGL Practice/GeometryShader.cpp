@@ -11,39 +11,26 @@ Model* model = nullptr;
 shader takes as input a set of vertices that form a single primitive (e.g. a point or a triangle). The geometry shader can 
 then transform these vertices as it sees fit before sending them to the next shader stage */
 
-GeometryShader::GeometryShader(const char* geometryShaderPath_)
+GeometryShader::GeometryShader(const char* geometryShaderPath_, const string& defines_) : defines(defines_)
 {
-    // Make sure the geometry shader file ifstream will throw an exception error
-    geometryShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    gShaderCode = nullptr;
+    geometryShader = NULL;
 
-    try
+    if (geometryShaderPath_ != nullptr)
     {
-        if (geometryShaderPath_ != nullptr)
-        {
-            // Open the geometry shader file
-            geometryShaderFile.open(geometryShaderPath_);
-
-            // Read the geometry shader's file buffer contents into a stream of the geometry shader file
-            geometryShaderStream << geometryShaderFile.rdbuf();
+        geometryShaderPath = geometryShaderPath_;
 
-            // Close the geometry shader's file handlers
-            geometryShaderFile.close();
+        // The shader stage cache only reads each file once, even if several geometry shader loaders use the same file
+        gShaderCode = ShaderStageCache::GetSource(geometryShaderPath).data();
 
-            // Convert the geometry shader stream into a geometry shader string
-            geometryShaderCode = geometryShaderStream.str();
+        // Keep our own copy of the source only if it differs from the file because of the injected defines
+        if (!defines.empty())
+        {
+            geometryShaderCode = ShaderPreprocessor::InjectDefines(string(ShaderStageCache::GetSource(geometryShaderPath)), defines);
+            gShaderCode = geometryShaderCode.c_str();
         }
     }
 
-    catch (std::ifstream::failure error)
-    {
-        std::cout << "ERROR::SHADER::GEOMETRY::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
-    }
-
-    if (geometryShaderPath_ != nullptr)
-    {
-        gShaderCode = geometryShaderCode.c_str();
-    }
-
     pointsVAO = NULL;
     pointsVBO = NULL;
 
@@ -52,33 +39,22 @@ GeometryShader::GeometryShader(const char* geometryShaderPath_)
 
 GeometryShader::~GeometryShader()
 {
-    glDeleteVertexArrays(1, &pointsVAO);
-    glDeleteBuffers(1, &pointsVBO);
+    GLStateCache::DeleteVertexArrays(1, &pointsVAO);
+    GLStateCache::DeleteBuffers(1, &pointsVBO);
 
     model = nullptr;
 }
 
 void GeometryShader::InitializeGeometryShaderLoader()
 {
-    // Create a shader object ID to use it when we create the shader
-    geometryShader = glCreateShader(GL_GEOMETRY_SHADER); // Create a geometry shader using OpenGL's version of it
-
-    // Attach the shader source code (the GLSL one) to the shader object and compile it
-    glShaderSource(geometryShader, 1, &gShaderCode, NULL);
-    glCompileShader(geometryShader);
-
-    int successfullyCompiled; // An integer that checks if the geometry shader compilation was successful
-    char compilationInformationLog[512]; // Gives information about its compilation in a log file (maybe?)
-
-    // Returns a successful compilation of the geometry shader if it can compile successfully
-    glGetShaderiv(geometryShader, GL_COMPILE_STATUS, &successfullyCompiled);
+    /* Get the compiled geometry shader from the shader stage cache, it's only compiled the first time any program asks
+    for this file (with these defines), every other program reuses the same shader object */
+    geometryShader = ShaderStageCache::AcquireShader(GL_GEOMETRY_SHADER, geometryShaderPath, defines);
+}
 
-    // If the compilation failed, then return a log compilation error and explain the error
-    if (!successfullyCompiled)
-    {
-        glGetShaderInfoLog(geometryShader, 512, NULL, compilationInformationLog);
-        std::cout << "ERROR::SHADER::GEOMETRY::COMPILATION_FAILED\n" << compilationInformationLog << std::endl;
-    }
+const char* GeometryShader::GetGeometryShaderCode() const
+{
+    return gShaderCode;
 }
 
 void GeometryShader::InitializeGeometryModel()
@@ -109,8 +85,8 @@ void GeometryShader::InitializeGeometryVertices()
     glGenBuffers(1, &pointsVBO);
     glGenVertexArrays(1, &pointsVAO);
 
-    glBindVertexArray(pointsVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, pointsVBO);
+    GLStateCache::BindVertexArray(pointsVAO);
+    GLStateCache::BindBuffer(GL_ARRAY_BUFFER, pointsVBO);
 
     glBufferData(GL_ARRAY_BUFFER, sizeof(points), &points, GL_STATIC_DRAW);
 
@@ -120,13 +96,13 @@ void GeometryShader::InitializeGeometryVertices()
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(2 * sizeof(float)));
 
-    glBindVertexArray(0);
+    GLStateCache::BindVertexArray(0);
 
 }
 
 void GeometryShader::DrawGeometryPoints()
 {
-    glBindVertexArray(pointsVAO);
+    GLStateCache::BindVertexArray(pointsVAO);
     glDrawArrays(GL_POINTS, 0, 4);
 }
 
@@ -137,7 +113,7 @@ void GeometryShader::DrawExplodingModel()
     glm::mat4 viewMatrix = Camera::CameraLookAt();
     glm::mat4 modelMatrix = glm::mat4(1.0f);
 
-    glUseProgram(geometryShaderProgram->shaderProgram);
+    GLStateCache::UseProgram(geometryShaderProgram->shaderProgram);
 
     glUniformMatrix4fv(glGetUniformLocation(geometryShaderProgram->shaderProgram, "projectionMatrix"), 1,
         GL_FALSE, glm::value_ptr(projectionMatrix));
@@ -145,12 +121,9 @@ void GeometryShader::DrawExplodingModel()
     glUniformMatrix4fv(glGetUniformLocation(geometryShaderProgram->shaderProgram, "viewMatrix"), 1,
         GL_FALSE, glm::value_ptr(viewMatrix));
 
-    glUniformMatrix4fv(glGetUniformLocation(geometryShaderProgram->shaderProgram, "modelMatrix"), 1,
-        GL_FALSE, glm::value_ptr(modelMatrix));
-
     glUniform1f(glGetUniformLocation(geometryShaderProgram->shaderProgram, "time"), glfwGetTime());
 
-    model->DrawModel(geometryShaderProgram);
+    model->DrawModel(geometryShaderProgram, modelMatrix);
 }
 
 void GeometryShader::DrawVisualizingNormalVectors()
@@ -164,7 +137,7 @@ void GeometryShader::DrawVisualizingNormalVectors()
     glm::mat4 viewMatrix = Camera::CameraLookAt();
     glm::mat4 modelMatrix = glm::mat4(1.0f);
 
-    glUseProgram(textureShaderProgram->shaderProgram);
+    GLStateCache::UseProgram(textureShaderProgram->shaderProgram);
 
     glUniformMatrix4fv(glGetUniformLocation(textureShaderProgram->shaderProgram, "projectionMatrix"), 1,
         GL_FALSE, glm::value_ptr(projectionMatrix));
@@ -172,12 +145,9 @@ void GeometryShader::DrawVisualizingNormalVectors()
     glUniformMatrix4fv(glGetUniformLocation(textureShaderProgram->shaderProgram, "viewMatrix"), 1,
         GL_FALSE, glm::value_ptr(viewMatrix));
 
-    glUniformMatrix4fv(glGetUniformLocation(textureShaderProgram->shaderProgram, "modelMatrix"), 1,
-        GL_FALSE, glm::value_ptr(modelMatrix));
+    model->DrawModel(textureShaderProgram, modelMatrix);
 
-    model->DrawModel(textureShaderProgram);
-
-    glUseProgram(geometryShaderProgram->shaderProgram);
+    GLStateCache::UseProgram(geometryShaderProgram->shaderProgram);
 
     glUniformMatrix4fv(glGetUniformLocation(geometryShaderProgram->shaderProgram, "projectionMatrix"), 1,
         GL_FALSE, glm::value_ptr(projectionMatrix));
@@ -185,8 +155,5 @@ void GeometryShader::DrawVisualizingNormalVectors()
     glUniformMatrix4fv(glGetUniformLocation(geometryShaderProgram->shaderProgram, "viewMatrix"), 1,
         GL_FALSE, glm::value_ptr(viewMatrix));
 
-    glUniformMatrix4fv(glGetUniformLocation(geometryShaderProgram->shaderProgram, "modelMatrix"), 1,
-        GL_FALSE, glm::value_ptr(modelMatrix));
-
-    model->DrawModel(geometryShaderProgram);
+    model->DrawModel(geometryShaderProgram, modelMatrix);
 }
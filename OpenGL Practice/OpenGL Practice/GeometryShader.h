@@ -7,6 +7,7 @@
 #include <sstream>
 #include <iostream>
 #include "stb_image.h"
+#include "ShaderStageCache.h"
 
 // Include the GLM header files (OpenGL Mathematics Library)
 #include <glm.hpp>
@@ -19,11 +20,15 @@ using namespace std;
 class GeometryShader
 {
 public:
-	GeometryShader(const char* geometryShaderPath_);
+	// defines_ holds extra #define lines that are injected right after the shader's #version line
+	GeometryShader(const char* geometryShaderPath_, const string& defines_ = "");
 	~GeometryShader();
 
 	void InitializeGeometryShaderLoader();
 
+	// Returns the GLSL source code that was read from the geometry shader file (nullptr if there was no file)
+	const char* GetGeometryShaderCode() const;
+
 	void InitializeGeometryModel();
 
 	void InitializeGeometryVertices();
@@ -39,8 +44,8 @@ private:
 
 	unsigned int pointsVBO, pointsVAO;
 
+	string geometryShaderPath;
+	string defines;
 	string geometryShaderCode;
-	ifstream geometryShaderFile;
-	stringstream geometryShaderStream;
 	const char* gShaderCode;
 };
\ No newline at end of file
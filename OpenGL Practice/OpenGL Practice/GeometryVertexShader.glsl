@@ -15,6 +15,8 @@ out VS_OUT {
 uniform mat4 viewMatrix;
 uniform mat4 modelMatrix;
 
+#include "MeshVertex.glsl"
+
 void main()
 {
 	// Geometry Shader Part 1
@@ -31,8 +33,8 @@ void main()
 	matrix. The geometry shader receives its position vectors as view-space coordinates so we should also transform the 
 	normal vectors to the same space */
 
-	gl_Position = viewMatrix * modelMatrix * vec4(position, 1.0);
+	gl_Position = viewMatrix * modelMatrix * vec4(MeshPosition(position), 1.0);
 	mat3 normalMatrix = mat3(transpose(inverse(viewMatrix * modelMatrix)));
-	vs_out.normal = normalize(vec3(vec4(normalMatrix * normals, 0.0)));
+	vs_out.normal = normalize(vec3(vec4(normalMatrix * MeshNormal(normals), 0.0)));
 
 }
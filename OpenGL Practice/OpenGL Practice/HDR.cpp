@@ -1,5 +1,6 @@
 #include "HDR.h"
 #include "Camera.h"
+#include "TextureCache.h"
 
 /* Monitors (non-HDR) are limited to display colors in the range of 0.0 and 1.0, but there is no such limitation in lighting 
 equations. By allowing fragment colors to exceed 1.0 we have a much higher range of color values available to work in known 
@@ -37,7 +38,7 @@ HDR* HDR::Instance()
 
 void HDR::InitializeHDR()
 {
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::Enable(GL_DEPTH_TEST);
 
 	// Load the HDR lighting shaders here
 	shaders[0]->InitializeShaderProgram(new VertexShaderLoader("HDRLightingVertexShader.glsl"),
@@ -53,7 +54,7 @@ void HDR::InitializeHDR()
 
     // Create floating point color buffer
     glGenTextures(1, &colorBuffer);
-    glBindTexture(GL_TEXTURE_2D, colorBuffer);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, colorBuffer);
 
     /* With a floating point framebuffer with 32 bits per color component (when using GL_RGB32F or GL_RGBA32F) were using 4 
     times more memory for storing color values */
@@ -71,14 +72,14 @@ void HDR::InitializeHDR()
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, 1280, 960);
 
     // Attach buffers
-    glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorBuffer, 0);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
 
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) 
         cout << "Framebuffer not complete!" << endl;
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // positions
     lightPositions.push_back(glm::vec3(0.0f, 0.0f, 49.5f)); // back light
@@ -92,10 +93,10 @@ void HDR::InitializeHDR()
     lightColors.push_back(glm::vec3(0.0f, 0.0f, 0.2f));
     lightColors.push_back(glm::vec3(0.0f, 0.1f, 0.0f));
 
-    glUseProgram(shaders[0]->shaderProgram);
+    GLStateCache::UseProgram(shaders[0]->shaderProgram);
     glUniform1i(glGetUniformLocation(shaders[0]->shaderProgram, "diffuseTexture"), 0);
 
-    glUseProgram(shaders[1]->shaderProgram);
+    GLStateCache::UseProgram(shaders[1]->shaderProgram);
     glUniform1i(glGetUniformLocation(shaders[1]->shaderProgram, "hdrBuffer"), 0);
 }
 
@@ -105,17 +106,13 @@ void HDR::RenderHDR()
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     // Render scene into floating point framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glm::mat4 projection = glm::perspective(glm::radians(Camera::fieldOfView), GLfloat(1280 / 960), 0.1f, 100.0f);
-    glm::mat4 view = lookAt(Camera::cameraPosition, Camera::cameraPosition + Camera::cameraFront, Camera::cameraUp);
 
-    glUseProgram(shaders[0]->shaderProgram);
-    glUniformMatrix4fv(glGetUniformLocation(shaders[0]->shaderProgram, "projection"), 1, GL_FALSE, value_ptr(projection));
-    glUniformMatrix4fv(glGetUniformLocation(shaders[0]->shaderProgram, "view"), 1, GL_FALSE, value_ptr(view));
+    GLStateCache::UseProgram(shaders[0]->shaderProgram);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, woodTexture);
+    GLStateCache::ActiveTexture(GL_TEXTURE0);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, woodTexture);
 
     // set lighting uniforms
     for (unsigned int i = 0; i < lightPositions.size(); i++)
@@ -127,8 +124,6 @@ void HDR::RenderHDR()
             ("lights[" + to_string(i) + "].Color").c_str()), 1, value_ptr(lightColors[i]));
     }
 
-    glUniform3fv(glGetUniformLocation(shaders[0]->shaderProgram, "viewPos"), 1, value_ptr(Camera::cameraPosition));
-
     // render tunnel
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(0.0f, 0.0f, 25.0));
@@ -138,14 +133,14 @@ void HDR::RenderHDR()
     glUniform1i(glGetUniformLocation(shaders[0]->shaderProgram, "inverse_normals"), true);
 
     RenderCube();
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Render floating point color buffer to 2D quad and tonemap HDR colors to default framebuffer's (clamped) color range
     
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glUseProgram(shaders[1]->shaderProgram);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, colorBuffer);
+    GLStateCache::UseProgram(shaders[1]->shaderProgram);
+    GLStateCache::ActiveTexture(GL_TEXTURE0);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, colorBuffer);
     glUniform1i(glGetUniformLocation(shaders[1]->shaderProgram, "hdr"), hdr);
     glUniform1f(glGetUniformLocation(shaders[1]->shaderProgram, "exposure"), exposure);
     RenderQuad();
@@ -155,49 +150,8 @@ void HDR::RenderHDR()
 
 unsigned int HDR::LoadTexture(const char* path_, bool gammaCorrection)
 {
-	unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(path_, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum internalFormat;
-        GLenum dataFormat;
-
-        if (nrComponents == 1)
-        {
-            internalFormat = dataFormat = GL_RED;
-        }
-        else if (nrComponents == 3)
-        {
-            internalFormat = gammaCorrection ? GL_SRGB : GL_RGB;
-            dataFormat = GL_RGB;
-        }
-        else if (nrComponents == 4)
-        {
-            internalFormat = gammaCorrection ? GL_SRGB_ALPHA : GL_RGBA;
-            dataFormat = GL_RGBA;
-        }
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, dataFormat, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path_ << std::endl;
-        stbi_image_free(data);
-    }
-
-	return textureID;
+	return TextureCache::LoadTexture(path_, TextureLoadOptions(false, gammaCorrection, 0, true, false,
+		TEXTURE_COMPRESSION_COLOR));
 }
 
 void HDR::RenderCube()
@@ -252,24 +206,24 @@ void HDR::RenderCube()
         glGenVertexArrays(1, &cubeVAO);
         glGenBuffers(1, &cubeVBO);
         // fill buffer
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+        GLStateCache::BindBuffer(GL_ARRAY_BUFFER, cubeVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
         // link vertex attributes
-        glBindVertexArray(cubeVAO);
+        GLStateCache::BindVertexArray(cubeVAO);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
         glEnableVertexAttribArray(2);
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+        GLStateCache::BindVertexArray(0);
     }
 
     // render Cube
-    glBindVertexArray(cubeVAO);
+    GLStateCache::BindVertexArray(cubeVAO);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
+    GLStateCache::BindVertexArray(0);
 }
 
 void HDR::RenderQuad()
@@ -286,15 +240,15 @@ void HDR::RenderQuad()
         // setup plane VAO
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
-        glBindVertexArray(quadVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        GLStateCache::BindVertexArray(quadVAO);
+        GLStateCache::BindBuffer(GL_ARRAY_BUFFER, quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
     }
-    glBindVertexArray(quadVAO);
+    GLStateCache::BindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    glBindVertexArray(0);
+    GLStateCache::BindVertexArray(0);
 }
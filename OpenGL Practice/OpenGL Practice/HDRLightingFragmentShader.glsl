@@ -15,7 +15,6 @@ struct Light {
 
 uniform Light lights[16];
 uniform sampler2D diffuseTexture;
-uniform vec3 viewPos;
 
 void main()
 {           
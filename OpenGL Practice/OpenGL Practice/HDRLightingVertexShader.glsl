@@ -10,8 +10,7 @@ out VS_OUT {
     vec2 TexCoords;
 } vs_out;
 
-uniform mat4 projection;
-uniform mat4 view;
+#include "FrameUniforms.glsl"
 uniform mat4 model;
 
 uniform bool inverse_normals;
@@ -26,5 +25,5 @@ void main()
     mat3 normalMatrix = transpose(inverse(mat3(model)));
     vs_out.Normal = normalize(normalMatrix * n);
     
-    gl_Position = projection * view * model * vec4(position, 1.0);
+    gl_Position = frame.viewProjection * model * vec4(position, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "InstanceCuller.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <thread>
+
+// Same check as the bounding volumes, AVX is only there if the project builds with /arch:AVX (or -mavx)
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INSTANCE_CULLER_SSE
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#define INSTANCE_CULLER_AVX
+#include <immintrin.h>
+#endif
+
+// Instantiate static variables
+unsigned int InstanceCuller::cullThreadCount = 0;
+
+void InstanceCuller::SetInstances(const mat4* matrices_, unsigned int count_, const BoundingSphere& sphere_)
+{
+	Clear();
+	Reserve(count_);
+
+	for (unsigned int i = 0; i < count_; i++)
+	{
+		const mat4& matrix = matrices_[i];
+
+		// Scaled by the largest axis, so the sphere still holds the mesh if the instance is stretched along one of them
+		float scale = std::max(std::max(length(vec3(matrix[0])), length(vec3(matrix[1]))), length(vec3(matrix[2])));
+
+		AddInstance(vec3(matrix * vec4(sphere_.center, 1.0f)), sphere_.radius * scale);
+	}
+}
+
+void InstanceCuller::AddInstance(const vec3& center_, float radius_)
+{
+	centerXs.push_back(center_.x);
+	centerYs.push_back(center_.y);
+	centerZs.push_back(center_.z);
+	radii.push_back(radius_);
+}
+
+void InstanceCuller::Reserve(unsigned int count_)
+{
+	centerXs.reserve(count_);
+	centerYs.reserve(count_);
+	centerZs.reserve(count_);
+	radii.reserve(count_);
+}
+
+void InstanceCuller::Clear()
+{
+	centerXs.clear();
+	centerYs.clear();
+	centerZs.clear();
+	radii.clear();
+}
+
+unsigned int InstanceCuller::GetInstanceCount() const
+{
+	return static_cast<unsigned int>(radii.size());
+}
+
+void InstanceCuller::Cull(const Frustum& frustum_, vector<unsigned int>& visibleInstances_, unsigned int threadCount_,
+	bool useSIMD_) const
+{
+	unsigned int instanceCount = GetInstanceCount();
+
+	// Room for every instance, so every range can write to where it starts without running into the next one
+	visibleInstances_.resize(instanceCount);
+
+	unsigned int threadCount = threadCount_ != 0 ? threadCount_ : cullThreadCount;
+
+	if (threadCount == 0)
+		threadCount = std::max(thread::hardware_concurrency(), 1u);
+
+	threadCount = std::max(std::min(threadCount, instanceCount / MIN_INSTANCES_PER_THREAD), 1u);
+
+	// A multiple of 8, so only the last range has a tail that doesn't fill a whole SIMD register
+	unsigned int rangeSize = ((instanceCount + threadCount - 1) / threadCount + 7) & ~7u;
+
+	vector<unsigned int> visibleCounts(threadCount, 0);
+	vector<future<void>> workers;
+
+	auto cullRange = [&](unsigned int range)
+	{
+		unsigned int first = std::min(range * rangeSize, instanceCount);
+		unsigned int last = std::min(first + rangeSize, instanceCount);
+
+		visibleCounts[range] = CullRange(frustum_, first, last, visibleInstances_.data() + first, useSIMD_);
+	};
+
+	for (unsigned int i = 1; i < threadCount; i++)
+	{
+		workers.push_back(async(launch::async, cullRange, i));
+	}
+
+	// The calling thread takes the first range instead of just waiting
+	cullRange(0);
+
+	for (unsigned int i = 0; i < workers.size(); i++)
+	{
+		workers[i].wait();
+	}
+
+	// Move every range's visible instances right behind the ones of the range before
+	unsigned int visibleCount = visibleCounts[0];
+
+	for (unsigned int i = 1; i < threadCount; i++)
+	{
+		memmove(visibleInstances_.data() + visibleCount, visibleInstances_.data() + i * rangeSize,
+			visibleCounts[i] * sizeof(unsigned int));
+
+		visibleCount += visibleCounts[i];
+	}
+
+	visibleInstances_.resize(visibleCount);
+}
+
+unsigned int InstanceCuller::CullRange(const Frustum& frustum_, unsigned int first_, unsigned int last_,
+	unsigned int* visibleInstances_, bool useSIMD_) const
+{
+	unsigned int visibleCount = 0;
+	unsigned int i = first_;
+
+	/* The index is always written and the count only moves on if the instance is visible, which avoids a hard to predict
+	branch for every instance. The write never goes past the range since there are never more visible instances than
+	tested ones */
+	if (useSIMD_)
+	{
+#ifdef INSTANCE_CULLER_AVX
+		__m256 planes8[6][4];
+
+		for (unsigned int j = 0; j < 6; j++)
+		{
+			for (unsigned int k = 0; k < 4; k++)
+			{
+				planes8[j][k] = _mm256_set1_ps(frustum_.planes[j][k]);
+			}
+		}
+
+		for (; i + 8 <= last_; i += 8)
+		{
+			__m256 x = _mm256_loadu_ps(&centerXs[i]);
+			__m256 y = _mm256_loadu_ps(&centerYs[i]);
+			__m256 z = _mm256_loadu_ps(&centerZs[i]);
+			__m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&radii[i]));
+
+			int visible = 0xFF;
+
+			for (unsigned int j = 0; j < 6 && visible != 0; j++)
+			{
+				__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planes8[j][0], x),
+					_mm256_mul_ps(planes8[j][1], y)), _mm256_add_ps(_mm256_mul_ps(planes8[j][2], z), planes8[j][3]));
+
+				visible &= _mm256_movemask_ps(_mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+			}
+
+			for (unsigned int k = 0; k < 8; k++)
+			{
+				visibleInstances_[visibleCount] = i + k;
+				visibleCount += (visible >> k) & 1;
+			}
+		}
+#endif
+
+#ifdef INSTANCE_CULLER_SSE
+		__m128 planes4[6][4];
+
+		for (unsigned int j = 0; j < 6; j++)
+		{
+			for (unsigned int k = 0; k < 4; k++)
+			{
+				planes4[j][k] = _mm_set1_ps(frustum_.planes[j][k]);
+			}
+		}
+
+		for (; i + 4 <= last_; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(&centerXs[i]);
+			__m128 y = _mm_loadu_ps(&centerYs[i]);
+			__m128 z = _mm_loadu_ps(&centerZs[i]);
+			__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radii[i]));
+
+			int visible = 0xF;
+
+			// Once all four are outside one plane the others can't bring them back
+			for (unsigned int j = 0; j < 6 && visible != 0; j++)
+			{
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes4[j][0], x), _mm_mul_ps(planes4[j][1], y)),
+					_mm_add_ps(_mm_mul_ps(planes4[j][2], z), planes4[j][3]));
+
+				visible &= _mm_movemask_ps(_mm_cmpge_ps(distance, negativeRadius));
+			}
+
+			for (unsigned int k = 0; k < 4; k++)
+			{
+				visibleInstances_[visibleCount] = i + k;
+				visibleCount += (visible >> k) & 1;
+			}
+		}
+#endif
+	}
+
+	// The instances that don't fill a whole register, or all of them without SIMD
+	for (; i < last_; i++)
+	{
+		visibleInstances_[visibleCount] = i;
+		visibleCount += frustum_.IntersectsSphere(vec3(centerXs[i], centerYs[i], centerZs[i]), radii[i]) ? 1 : 0;
+	}
+
+	return visibleCount;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#ifndef INSTANCE_CULLER_H
+#define INSTANCE_CULLER_H
+
+#include "BoundingVolumes.h"
+
+#include <vector>
+
+using namespace std;
+
+/* Finds the instances of an instanced draw that the camera can see, so only those have to be sent to the GPU. Every
+instance is a sphere, and the spheres are stored as four separate arrays (every center x, then every center y...) instead
+of one array of spheres. That way four (or eight with AVX) spheres are tested against a plane with a handful of
+instructions: one load per array gives the same component of four spheres, and no shuffling is needed to line them up.
+
+The instances are split into one range per thread, and each range's visible instances are written to where the range
+starts in the output and then moved together, so the output keeps the order of the input without any locking */
+
+class InstanceCuller
+{
+public:
+	InstanceCuller() { }
+
+	/* Replaces the instances with one sphere per instance matrix, sphere_ is the instanced mesh's sphere in its own space.
+	Only has to run again when the instances move */
+	void SetInstances(const mat4* matrices_, unsigned int count_, const BoundingSphere& sphere_);
+
+	void AddInstance(const vec3& center_, float radius_);
+
+	void Reserve(unsigned int count_);
+
+	void Clear();
+
+	unsigned int GetInstanceCount() const;
+
+	/* Fills visibleInstances_ with the index of every instance whose sphere is at least partly inside the frustum, in
+	increasing order. threadCount_ 0 uses cullThreadCount, useSIMD_ false tests one sphere at a time (to compare against) */
+	void Cull(const Frustum& frustum_, vector<unsigned int>& visibleInstances_, unsigned int threadCount_ = 0,
+		bool useSIMD_ = true) const;
+
+	vector<float> centerXs, centerYs, centerZs, radii;
+
+	/* Number of threads Cull splits the instances across (the calling thread counts as one of them), 0 uses one thread per
+	core. Threads only pay off for tens of thousands of instances, fewer than that stay on the calling thread */
+	static unsigned int cullThreadCount;
+
+	// Ranges smaller than this aren't split any further, starting a thread costs more than testing them
+	static const unsigned int MIN_INSTANCES_PER_THREAD = 16384;
+
+private:
+	// Writes the visible instances of [first_, last_) to visibleInstances_ and returns how many there were
+	unsigned int CullRange(const Frustum& frustum_, unsigned int first_, unsigned int last_,
+		unsigned int* visibleInstances_, bool useSIMD_) const;
+};
+
+#endif
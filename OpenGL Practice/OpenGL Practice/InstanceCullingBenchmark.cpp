@@ -0,0 +1,80 @@
+#include "InstanceCullingBenchmark.h"
+
+#include <glfw3.h>
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <thread>
+#include <algorithm>
+
+#include <gtc/matrix_transform.hpp>
+
+void InstanceCullingBenchmark::Run(unsigned int repetitions)
+{
+	const unsigned int instanceCounts[] = { 10000, 100000, 1000000, 10000000 };
+
+	unsigned int coreCount = std::max(thread::hardware_concurrency(), 1u);
+
+	// Looking across the ring from just outside it, so some of the rocks are in view and most aren't
+	mat4 projectionMatrix = perspective(radians(45.0f), 800.0f / 600.0f, 0.1f, 1000.0f);
+	mat4 viewMatrix = lookAt(vec3(0.0f, 20.0f, 200.0f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+
+	Frustum frustum(projectionMatrix * viewMatrix);
+
+	// The same seed every time, so the numbers can be compared between runs
+	mt19937 random(1234);
+	uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	cout << "INSTANCE_CULLING_BENCHMARK: " << coreCount << " cores, best of " << repetitions << " runs (times in ms)" <<
+		endl;
+	cout << "   instances    visible     scalar       simd    threads   ns/instance" << endl;
+
+	for (unsigned int i = 0; i < sizeof(instanceCounts) / sizeof(instanceCounts[0]); i++)
+	{
+		unsigned int instanceCount = instanceCounts[i];
+
+		InstanceCuller culler;
+		culler.Reserve(instanceCount);
+
+		for (unsigned int j = 0; j < instanceCount; j++)
+		{
+			float angle = unit(random) * 6.2831853f;
+			float radius = 150.0f + (unit(random) * 2.0f - 1.0f) * 25.0f;
+			float height = (unit(random) * 2.0f - 1.0f) * 10.0f;
+
+			culler.AddInstance(vec3(sin(angle) * radius, height, cos(angle) * radius), 0.05f + unit(random) * 0.2f);
+		}
+
+		vector<unsigned int> visibleInstances;
+		visibleInstances.reserve(instanceCount);
+
+		double scalarTime = MeasureCull(culler, frustum, 1, false, repetitions, visibleInstances);
+		double simdTime = MeasureCull(culler, frustum, 1, true, repetitions, visibleInstances);
+		double threadedTime = MeasureCull(culler, frustum, coreCount, true, repetitions, visibleInstances);
+
+		cout << fixed << setprecision(3) << setw(12) << instanceCount << setw(11) << visibleInstances.size() <<
+			setw(11) << scalarTime * 1000.0 << setw(11) << simdTime * 1000.0 << setw(11) << threadedTime * 1000.0 <<
+			setw(14) << threadedTime * 1e9 / instanceCount << endl;
+	}
+}
+
+double InstanceCullingBenchmark::MeasureCull(const InstanceCuller& culler, const Frustum& frustum,
+	unsigned int threadCount, bool useSIMD, unsigned int repetitions, vector<unsigned int>& visibleInstances)
+{
+	double bestTime = 0.0;
+
+	for (unsigned int i = 0; i < repetitions; i++)
+	{
+		double startTime = glfwGetTime();
+
+		culler.Cull(frustum, visibleInstances, threadCount, useSIMD);
+
+		double time = glfwGetTime() - startTime;
+
+		if (i == 0 || time < bestTime)
+			bestTime = time;
+	}
+
+	return bestTime;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#ifndef INSTANCE_CULLING_BENCHMARK_H
+#define INSTANCE_CULLING_BENCHMARK_H
+
+#include "InstanceCuller.h"
+
+using namespace std;
+
+/* Culls asteroid fields of 10 thousand up to 10 million rocks against the same camera, one sphere at a time, with SIMD on
+one thread and with SIMD on every core, and prints how long each took. The field is laid out like the one in Instancing
+(a flat ring around the origin), only denser as it grows */
+
+class InstanceCullingBenchmark
+{
+public:
+	// Keeps the fastest of repetitions runs for every count, only needs the CPU
+	static void Run(unsigned int repetitions = 5);
+
+private:
+	InstanceCullingBenchmark() { }
+
+	// Fastest time of culling every instance repetitions times (in seconds)
+	static double MeasureCull(const InstanceCuller& culler, const Frustum& frustum, unsigned int threadCount,
+		bool useSIMD, unsigned int repetitions, vector<unsigned int>& visibleInstances);
+};
+
+#endif
@@ -0,0 +1,9 @@
+#version 330 core
+
+// Never runs since rasterization is turned off during the culling pass, but every program needs a fragment shader here
+out vec4 fragmentColor;
+
+void main()
+{
+	fragmentColor = vec4(0.0);
+}
@@ -0,0 +1,26 @@
+#version 330 core
+layout (points) in;
+layout (points, max_vertices = 1) out;
+
+/* A vertex shader has to output exactly one vertex for every vertex it gets, but a geometry shader can output none. So
+this is where the culled instances are dropped: transform feedback only captures the points that are emitted, packed one
+after the other, and the GL_PRIMITIVES_WRITTEN query counts them */
+
+in mat4 vertexInstanceMatrix[];
+flat in int instanceLOD[];
+
+// The level of detail this pass collects, every level is culled in its own pass into its own part of the buffer
+uniform int lod;
+
+out mat4 culledInstanceMatrix;
+
+void main()
+{
+	if (instanceLOD[0] != lod)
+		return;
+
+	culledInstanceMatrix = vertexInstanceMatrix[0];
+
+	EmitVertex();
+	EndPrimitive();
+}
@@ -0,0 +1,59 @@
+#version 330 core
+layout (location = 0) in mat4 instanceMatrix;
+
+/* Runs once for every instance (drawn as points with rasterization turned off), nothing is drawn. It only decides
+whether the instance is visible and which level of detail it needs, the geometry shader then passes on the visible
+instances of the level this pass is for */
+
+const int MAX_LOD_COUNT = 8;
+
+// Every plane is (normal, distance) in world space with the normal pointing into the view volume
+uniform vec4 frustumPlanes[6];
+
+// The instanced mesh's sphere in its own space, center in xyz and radius in w
+uniform vec4 boundingSphere;
+
+uniform vec3 cameraPosition;
+
+// Largest error of the model at every level of detail, and how many pixels one unit covers one unit away from the camera
+uniform float lodErrors[MAX_LOD_COUNT];
+uniform int lodCount;
+uniform float pixelsPerUnit;
+uniform float maxPixelError;
+
+out mat4 vertexInstanceMatrix;
+flat out int instanceLOD; // -1 if the instance is outside the frustum
+
+void main()
+{
+	vertexInstanceMatrix = instanceMatrix;
+
+	// Scaled by the largest axis, so the sphere still holds the mesh if the instance is stretched along one of them
+	float scale = max(max(length(instanceMatrix[0].xyz), length(instanceMatrix[1].xyz)), length(instanceMatrix[2].xyz));
+
+	vec3 center = (instanceMatrix * vec4(boundingSphere.xyz, 1.0)).xyz;
+	float radius = boundingSphere.w * scale;
+
+	instanceLOD = -1;
+
+	for (int i = 0; i < 6; i++)
+	{
+		if (dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius)
+			return;
+	}
+
+	// Same choice as Model::SelectLOD, the coarsest level whose error stays below maxPixelError pixels on screen
+	float distance = max(length(cameraPosition - instanceMatrix[3].xyz), 0.0001);
+	float screenScale = length(instanceMatrix[0].xyz) * pixelsPerUnit / distance;
+
+	instanceLOD = 0;
+
+	for (int i = lodCount - 1; i > 0; i--)
+	{
+		if (lodErrors[i] * screenScale <= maxPixelError)
+		{
+			instanceLOD = i;
+			break;
+		}
+	}
+}
@@ -1,5 +1,6 @@
 #include "Instancing.h"
 #include "Camera.h"
+#include "FrameUniforms.h"
 
 /* Instancing is a technique where we draw many (equal mesh data) objects at once with a single render call, saving us all 
 the CPU -> GPU communications each time we need to render an object. To render using instancing all we need to do is change 
@@ -10,15 +11,23 @@ the number of instances we want to render. We sent all the required data to the
 draw all these instances with a single call. The GPU then renders all these instances without having to continually 
 communicate with the CPU */
 
+// Instantiate static variables
+bool Instancing::cullInstances = true;
+bool Instancing::cullOnGPU = false;
+
 Instancing::Instancing() : instancingShaderProgram(new ShaderProgram()), modelShaderProgram(new ShaderProgram())
 {
+	gpuInstanceCuller = nullptr;
 }
 
 Instancing::~Instancing()
 {
-	glDeleteBuffers(1, &instanceVBO);
-	glDeleteBuffers(1, &quadVBO);
-	glDeleteVertexArrays(1, &quadVAO);
+	delete gpuInstanceCuller;
+	gpuInstanceCuller = nullptr;
+
+	GLStateCache::DeleteBuffers(1, &instanceVBO);
+	GLStateCache::DeleteBuffers(1, &quadVBO);
+	GLStateCache::DeleteVertexArrays(1, &quadVAO);
 }
 
 void Instancing::SetInstancingOffsetPositions()
@@ -44,10 +53,10 @@ void Instancing::SetInstancingOffsetPositions()
 	/* Because an instanced array is a vertex attribute, just like the position and color variables, we need to store its
 	content in a vertex buffer object and configure its attribute pointer */
 	glGenBuffers(1, &instanceVBO);
-	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, instanceVBO);
 
 	glBufferData(GL_ARRAY_BUFFER, sizeof(vec2) * 100, &translations[0], GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void Instancing::InitializeInstancingVertices()
@@ -68,8 +77,8 @@ void Instancing::InitializeInstancingVertices()
 	glGenBuffers(1, &quadVBO);
 	glGenVertexArrays(1, &quadVAO);
 
-	glBindVertexArray(quadVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+	GLStateCache::BindVertexArray(quadVAO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, quadVBO);
 
 	glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
 
@@ -81,11 +90,11 @@ void Instancing::InitializeInstancingVertices()
 
 	// Then we also need to set its vertex attribute pointer and enable the vertex attribute
 	glEnableVertexAttribArray(2);
-	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO); // this attribute comes from a different vertex buffer
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, instanceVBO); // this attribute comes from a different vertex buffer
 
 	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
 
 	/* This function tells OpenGL when to update the content of a vertex attribute to the next element. Its first parameter 
 	is the vertex attribute in question and the second parameter the attribute divisor. */
@@ -156,43 +165,120 @@ void Instancing::SetTransformationMatrix()
 		modelMatrices[i] = model;
 	}
 
+	// The rocks never move, so their spheres are only worked out once
+	instanceCuller.SetInstances(modelMatrices, amount, rock->boundingSphere);
 }
 
 void Instancing::SetInstancedArrays()
 {
 	// Instancing Part 3 (vertex buffer object)
 	glGenBuffers(1, &buffer);
-	glBindBuffer(GL_ARRAY_BUFFER, buffer);
-	glBufferData(GL_ARRAY_BUFFER, amount * sizeof(glm::mat4), &modelMatrices[0], GL_STATIC_DRAW);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, buffer);
+
+	// The visible matrices are sorted by level of detail and uploaded again every frame
+	glBufferData(GL_ARRAY_BUFFER, amount * sizeof(glm::mat4), &modelMatrices[0], GL_DYNAMIC_DRAW);
+
+	lodMatrices.resize(amount);
 
 	for (unsigned int i = 0; i < rock->meshes.size(); i++)
 	{
 		unsigned int VAO = rock->meshes[i].VAO;
-		glBindVertexArray(VAO);
+		GLStateCache::BindVertexArray(VAO);
 
 		// Vertex attributes
 		glEnableVertexAttribArray(3);
-		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)0);
-
 		glEnableVertexAttribArray(4);
-		glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)(1 * sizeof(glm::vec4)));
-
 		glEnableVertexAttribArray(5);
-		glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)(2 * sizeof(glm::vec4)));
-
 		glEnableVertexAttribArray(6);
-		glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)(3 * sizeof(glm::vec4)));
+
+		SetInstanceMatrixOffset(VAO, 0);
 
 		glVertexAttribDivisor(3, 1);
 		glVertexAttribDivisor(4, 1);
 		glVertexAttribDivisor(5, 1);
 		glVertexAttribDivisor(6, 1);
 
-		glBindVertexArray(0);
+		GLStateCache::BindVertexArray(0);
 	}
 
 }
 
+void Instancing::CullInstances(const mat4& projectionMatrix, const mat4& viewMatrix)
+{
+	if (cullInstances)
+	{
+		// The rocks' spheres are in world space, so the planes have to be as well
+		instanceCuller.Cull(Frustum(projectionMatrix * viewMatrix), visibleInstances);
+		return;
+	}
+
+	visibleInstances.resize(amount);
+
+	for (unsigned int i = 0; i < amount; i++)
+	{
+		visibleInstances[i] = i;
+	}
+}
+
+void Instancing::SortInstancesByLOD(const mat4& projectionMatrix)
+{
+	unsigned int lodCount = std::max(rock->GetLODCount(), 1u);
+	unsigned int visibleCount = static_cast<unsigned int>(visibleInstances.size());
+
+	lodInstanceCounts.assign(lodCount, 0);
+
+	// Pick every rock's level of detail from how big it is on the screen, and count how many rocks use each level
+	vector<unsigned int> instanceLODs(visibleCount);
+
+	for (unsigned int i = 0; i < visibleCount; i++)
+	{
+		const mat4& modelMatrix = modelMatrices[visibleInstances[i]];
+
+		float distance = length(Camera::cameraPosition - vec3(modelMatrix[3]));
+		float scale = length(vec3(modelMatrix[0]));
+
+		instanceLODs[i] = rock->SelectLOD(distance, scale, projectionMatrix, FrameUniforms::frameData.screenSize.y);
+		lodInstanceCounts[instanceLODs[i]]++;
+	}
+
+	// Then place the rocks of each level right after the ones of the level before (a counting sort)
+	vector<unsigned int> lodOffsets(lodCount, 0);
+
+	for (unsigned int i = 1; i < lodCount; i++)
+	{
+		lodOffsets[i] = lodOffsets[i - 1] + lodInstanceCounts[i - 1];
+	}
+
+	for (unsigned int i = 0; i < visibleCount; i++)
+	{
+		lodMatrices[lodOffsets[instanceLODs[i]]++] = modelMatrices[visibleInstances[i]];
+	}
+
+	/* Orphan the old storage before filling it, the GPU might still be drawing last frame's rocks from it and this way
+	the driver can hand us new memory instead of waiting. The size stays the same so the driver can keep reusing the same
+	blocks, but only the visible rocks are copied into it */
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, amount * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
+
+	if (visibleCount > 0)
+		glBufferSubData(GL_ARRAY_BUFFER, 0, visibleCount * sizeof(glm::mat4), lodMatrices.data());
+}
+
+void Instancing::SetInstanceMatrixOffset(unsigned int VAO, unsigned int firstInstance)
+{
+	/* OpenGL 3.3 can't start an instanced draw at a later instance (glDrawElementsInstancedBaseInstance needs 4.2), so
+	instead the attribute pointers are moved to where the instances of the level of detail start */
+	size_t offset = static_cast<size_t>(firstInstance) * sizeof(glm::mat4);
+
+	GLStateCache::BindVertexArray(VAO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, buffer);
+
+	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)(offset));
+	glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)(offset + 1 * sizeof(glm::vec4)));
+	glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)(offset + 2 * sizeof(glm::vec4)));
+	glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)(offset + 3 * sizeof(glm::vec4)));
+}
+
 void Instancing::UseInstancingShaderProgram()
 {
 	/* In addition to generating the translations array, wed also need to transfer the data to the vertex shaders
@@ -220,7 +306,7 @@ void Instancing::UseInstancingShaderProgram()
 	glm::mat4 projectionMatrix = perspective(glm::radians(45.0f), float(800 / 600), 0.1f, 1000.0f);
 	glm::mat4 viewMatrix = Camera::CameraLookAt();
 
-	glUseProgram(instancingShaderProgram->shaderProgram);
+	GLStateCache::UseProgram(instancingShaderProgram->shaderProgram);
 
 	glUniformMatrix4fv(glGetUniformLocation(instancingShaderProgram->shaderProgram, "projectionMatrix"), 1,
 		GL_FALSE, glm::value_ptr(projectionMatrix));
@@ -228,7 +314,7 @@ void Instancing::UseInstancingShaderProgram()
 	glUniformMatrix4fv(glGetUniformLocation(instancingShaderProgram->shaderProgram, "viewMatrix"), 1,
 		GL_FALSE, glm::value_ptr(viewMatrix));
 
-	glUseProgram(modelShaderProgram->shaderProgram);
+	GLStateCache::UseProgram(modelShaderProgram->shaderProgram);
 
 	glUniformMatrix4fv(glGetUniformLocation(modelShaderProgram->shaderProgram, "projectionMatrix"), 1,
 		GL_FALSE, glm::value_ptr(projectionMatrix));
@@ -255,23 +341,62 @@ void Instancing::UseInstancingShaderProgram()
 		rock->DrawModel(instancingShaderProgram);
 	}*/
 
-	glUseProgram(instancingShaderProgram->shaderProgram);
+	GLStateCache::UseProgram(instancingShaderProgram->shaderProgram);
 
 	glUniform1i(glGetUniformLocation(instancingShaderProgram->shaderProgram, "textureImage"), 0);
 
 	//glActiveTexture(GL_TEXTURE0);
 	//glBindTexture(GL_TEXTURE_2D, rock->texturesLoaded[0].textureID);
 
-	// Draw meteorites
+	if (cullInstances && cullOnGPU && GPUInstanceCuller::IsSupported())
+	{
+		if (gpuInstanceCuller == nullptr)
+		{
+			gpuInstanceCuller = new GPUInstanceCuller();
+			gpuInstanceCuller->Initialize(rock, modelMatrices, amount);
+		}
+
+		// The culling pass uses its own program, the visible rocks are drawn with the instancing one afterwards
+		gpuInstanceCuller->Cull(projectionMatrix, viewMatrix, Camera::cameraPosition,
+			FrameUniforms::frameData.screenSize.y);
+
+		GLStateCache::UseProgram(instancingShaderProgram->shaderProgram);
+		gpuInstanceCuller->DrawInstances(instancingShaderProgram);
+
+		return;
+	}
+
+	CullInstances(projectionMatrix, viewMatrix);
+	SortInstancesByLOD(projectionMatrix);
+
+	// Draw meteorites, one instanced draw per mesh and level of detail
 	for (unsigned int i = 0; i < rock->meshes.size(); i++)
 	{
 		// Instance Part 3
-		glBindVertexArray(rock->meshes[i].VAO);
+		rock->meshes[i].SetVertexFormat(instancingShaderProgram);
 
-		glDrawElementsInstanced(GL_TRIANGLES, rock->meshes[i].indices.size(), 
-			GL_UNSIGNED_INT, 0, amount);
+		unsigned int firstInstance = 0;
 
-		glBindVertexArray(0);
+		for (unsigned int lod = 0; lod < lodInstanceCounts.size(); lod++)
+		{
+			if (lodInstanceCounts[lod] > 0)
+			{
+				// Meshes with fewer levels than the model draw their last level instead
+				unsigned int meshLOD = std::min(lod, static_cast<unsigned int>(rock->meshes[i].lods.size()) - 1);
+
+				SetInstanceMatrixOffset(rock->meshes[i].VAO, firstInstance);
+
+				// The rock's meshes share one buffer, each of them starts at its own base vertex
+				glDrawElementsInstancedBaseVertex(GL_TRIANGLES, rock->meshes[i].lods[meshLOD].indexCount,
+					rock->meshes[i].indexType, (void*)rock->meshes[i].GetIndexByteOffset(meshLOD), lodInstanceCounts[lod],
+					rock->meshes[i].baseVertex);
+			}
+
+			firstInstance += lodInstanceCounts[lod];
+		}
+
+		GLStateCache::BindVertexArray(0);
+		rock->meshes[i].ResetVertexFormat(instancingShaderProgram);
 	}
 
-}
+}
\ No newline at end of file
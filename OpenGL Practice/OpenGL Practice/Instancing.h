@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <vector>
 
 #include <glm.hpp>
 #include <gtc/matrix_transform.hpp>
@@ -10,6 +11,8 @@ using namespace std;
 using namespace glm;
 
 #include "Model.h"
+#include "InstanceCuller.h"
+#include "GPUInstanceCuller.h"
 
 class Instancing
 {
@@ -26,7 +29,24 @@ public:
 
 	void UseInstancingShaderProgram();
 
+	// Draws every rock when turned off, to compare against drawing only the ones the camera can see
+	static bool cullInstances;
+
+	/* Culls and sorts the rocks by level of detail on the GPU instead, where the driver supports it (see
+	GPUInstanceCuller). Ignored if cullInstances is turned off */
+	static bool cullOnGPU;
+
 private:
+	// Finds the rocks inside the view frustum, every rock if cullInstances is turned off
+	void CullInstances(const mat4& projectionMatrix, const mat4& viewMatrix);
+
+	/* Sorts the visible rocks by their level of detail and uploads them, so every level is one contiguous range of the
+	buffer */
+	void SortInstancesByLOD(const mat4& projectionMatrix);
+
+	// Points the instance matrix attributes of a rock mesh at the first instance of one level of detail
+	void SetInstanceMatrixOffset(unsigned int VAO, unsigned int firstInstance);
+
 	array<float, 30> quadVertices;
 
 	unsigned int quadVAO, quadVBO;
@@ -44,4 +64,15 @@ private:
 
 	unsigned int amount;
 	glm::mat4* modelMatrices;
+
+	// The visible rocks' model matrices sorted by level of detail, and how many rocks use each level
+	vector<mat4> lodMatrices;
+	vector<unsigned int> lodInstanceCounts;
+
+	// A sphere around every rock, and the index of every rock that passed this frame's culling
+	InstanceCuller instanceCuller;
+	vector<unsigned int> visibleInstances;
+
+	// Only created once cullOnGPU is used for the first time
+	GPUInstanceCuller* gpuInstanceCuller;
 };
\ No newline at end of file
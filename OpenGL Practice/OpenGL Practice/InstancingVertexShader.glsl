@@ -16,6 +16,8 @@ uniform mat4 projectionMatrix;
 uniform mat4 viewMatrix;
 //uniform mat4 modelMatrix;
 
+#include "MeshVertex.glsl"
+
 /* Instanced arrays are defined as a vertex attribute (allowing us to store much more data) that are updated per instance 
 instead of per vertex */
 
@@ -48,6 +50,6 @@ void main()
 	//gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(position, 1.0);
 
 	// Instance Part 3 (store an instanced array of transformation matrices instead of using model matrix)
-	gl_Position = projectionMatrix * viewMatrix * instanceMatrix * vec4(position, 1.0);
+	gl_Position = projectionMatrix * viewMatrix * instanceMatrix * vec4(MeshPosition(position), 1.0);
 	texCoords = texCoordinates;
 }
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "LightBuffer.h"
+#include "GLStateCache.h"
+
+#include <iostream>
+#include <algorithm>
+
+LightBuffer::LightBuffer() : buffer(0), texture(0), capacity(0), dirtyBegin(0), dirtyEnd(0)
+{
+}
+
+LightBuffer::~LightBuffer()
+{
+	if (texture != 0)
+		GLStateCache::DeleteTextures(1, &texture);
+
+	if (buffer != 0)
+		GLStateCache::DeleteBuffers(1, &buffer);
+
+	lights.clear();
+	packedLights.clear();
+}
+
+void LightBuffer::Initialize(unsigned int lightCapacity)
+{
+	glGenBuffers(1, &buffer);
+	glGenTextures(1, &texture);
+
+	Reserve(std::max(lightCapacity, 1u));
+}
+
+unsigned int LightBuffer::AddLight(const PointLight& light)
+{
+	unsigned int index = static_cast<unsigned int>(lights.size());
+
+	lights.push_back(light);
+	packedLights.resize(lights.size() * LIGHT_TEXELS);
+
+	PackLight(index);
+
+	return index;
+}
+
+void LightBuffer::SetLight(unsigned int index, const PointLight& light)
+{
+	if (index >= lights.size())
+	{
+		cout << "ERROR::LIGHT_BUFFER: Light " << index << " doesn't exist, there are only " << lights.size() << " lights"
+			<< endl;
+		return;
+	}
+
+	lights[index] = light;
+	PackLight(index);
+}
+
+const PointLight& LightBuffer::GetLight(unsigned int index) const
+{
+	return lights[index];
+}
+
+unsigned int LightBuffer::GetLightCount() const
+{
+	return static_cast<unsigned int>(lights.size());
+}
+
+void LightBuffer::Upload()
+{
+	if (dirtyBegin >= dirtyEnd || buffer == 0)
+		return;
+
+	// Double the capacity when the lights don't fit anymore, that uploads the whole list anyway
+	if (lights.size() > capacity)
+	{
+		Reserve(std::max(static_cast<unsigned int>(lights.size()), capacity * 2));
+		return;
+	}
+
+	GLStateCache::BindBuffer(GL_TEXTURE_BUFFER, buffer);
+
+	glBufferSubData(GL_TEXTURE_BUFFER, dirtyBegin * LIGHT_TEXELS * sizeof(vec4),
+		(dirtyEnd - dirtyBegin) * LIGHT_TEXELS * sizeof(vec4), &packedLights[dirtyBegin * LIGHT_TEXELS]);
+
+	GLStateCache::BindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	dirtyBegin = 0;
+	dirtyEnd = 0;
+}
+
+void LightBuffer::Bind(GLenum textureUnit)
+{
+	GLStateCache::ActiveTexture(textureUnit);
+	GLStateCache::BindTexture(GL_TEXTURE_BUFFER, texture);
+}
+
+float LightBuffer::CalculateRadius(const vec3& color, float constant, float linear, float quadratic)
+{
+	const float maxBrightness = fmaxf(fmaxf(color.r, color.g), color.b);
+
+	return (-linear + sqrtf(linear * linear - 4.0f * quadratic * (constant - (256.0f / 5.0f) * maxBrightness))) /
+		(2.0f * quadratic);
+}
+
+void LightBuffer::PackLight(unsigned int index)
+{
+	const PointLight& light = lights[index];
+	vec4* texels = &packedLights[index * LIGHT_TEXELS];
+
+	texels[0] = vec4(light.position, light.radius);
+	texels[1] = vec4(light.color, light.linear);
+	texels[2] = vec4(light.quadratic, 0.0f, 0.0f, 0.0f);
+
+	if (dirtyBegin >= dirtyEnd)
+	{
+		dirtyBegin = index;
+		dirtyEnd = index + 1;
+		return;
+	}
+
+	dirtyBegin = std::min(dirtyBegin, index);
+	dirtyEnd = std::max(dirtyEnd, index + 1);
+}
+
+void LightBuffer::Reserve(unsigned int lightCapacity)
+{
+	capacity = lightCapacity;
+
+	GLStateCache::BindBuffer(GL_TEXTURE_BUFFER, buffer);
+
+	// Allocate the new storage and fill in every light we already have
+	glBufferData(GL_TEXTURE_BUFFER, capacity * LIGHT_TEXELS * sizeof(vec4), NULL, GL_DYNAMIC_DRAW);
+
+	if (!packedLights.empty())
+		glBufferSubData(GL_TEXTURE_BUFFER, 0, packedLights.size() * sizeof(vec4), packedLights.data());
+
+	GLStateCache::BindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	// The texture doesn't store anything itself, it lets the shader read the buffer's storage as RGBA32F texels
+	GLStateCache::BindTexture(GL_TEXTURE_BUFFER, texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+	GLStateCache::BindTexture(GL_TEXTURE_BUFFER, 0);
+
+	dirtyBegin = 0;
+	dirtyEnd = 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#ifndef LIGHT_BUFFER_H
+#define LIGHT_BUFFER_H
+
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <glm.hpp>
+
+using namespace std;
+using namespace glm;
+
+// A point light with its attenuation and the radius of its light volume
+struct PointLight
+{
+	vec3 position;
+	vec3 color;
+
+	float linear;
+	float quadratic;
+
+	// Beyond this distance the light's contribution is too dark to see, so the shader can skip it
+	float radius;
+};
+
+/* Stores a list of point lights in a texture buffer so a shader can loop over any number of lights with texelFetch,
+instead of having a uniform per light member (uniform arrays run out of space after a few hundred lights, and setting
+five uniforms per light per frame gets expensive long before that). Every light takes LIGHT_TEXELS RGBA32F texels:
+
+	texel 0: position.xyz, radius
+	texel 1: color.rgb, linear
+	texel 2: quadratic, unused
+
+Only the lights that changed since the last Upload are sent to the GPU, in a single glBufferSubData call covering the
+range between the first and the last changed light */
+
+class LightBuffer
+{
+public:
+	LightBuffer();
+	~LightBuffer();
+
+	// Creates the buffer and its texture with room for the given number of lights (the buffer grows when needed)
+	void Initialize(unsigned int capacity);
+
+	// Adds a light and returns its index
+	unsigned int AddLight(const PointLight& light);
+
+	// Replaces a light, it's uploaded with the next Upload
+	void SetLight(unsigned int index, const PointLight& light);
+
+	const PointLight& GetLight(unsigned int index) const;
+	unsigned int GetLightCount() const;
+
+	// Sends all lights that changed since the last call to the GPU, does nothing if none changed
+	void Upload();
+
+	// Binds the light texture to the given texture unit (e.g. GL_TEXTURE3) for a samplerBuffer uniform
+	void Bind(GLenum textureUnit);
+
+	/* Solves the attenuation equation for the distance where the brightest color channel drops to 5/256, anything
+	farther away would be too dark to see */
+	static float CalculateRadius(const vec3& color, float constant, float linear, float quadratic);
+
+	static const unsigned int LIGHT_TEXELS = 3;
+
+private:
+	// Writes a light's texels into the CPU copy of the buffer and extends the dirty range
+	void PackLight(unsigned int index);
+
+	// Reallocates the GPU buffer so it fits at least the given number of lights, everything is uploaded again
+	void Reserve(unsigned int lightCapacity);
+
+	vector<PointLight> lights;
+
+	// CPU copy of the buffer contents, LIGHT_TEXELS vec4s per light
+	vector<vec4> packedLights;
+
+	unsigned int buffer, texture;
+	unsigned int capacity;
+
+	// Range of lights [dirtyBegin, dirtyEnd) that changed since the last Upload
+	unsigned int dirtyBegin, dirtyEnd;
+};
+
+#endif
@@ -0,0 +1,426 @@
+#include "LightClusters.h"
+#include "ShaderProgram.h"
+#include "GLStateCache.h"
+
+#include <iostream>
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <future>
+#include <thread>
+
+// Uniform names hashed at compile time
+constexpr unsigned int CLUSTER_COUNTS_UNIFORM = UniformHash("clusterCounts");
+constexpr unsigned int CLUSTER_DEPTH_SCALE_BIAS_UNIFORM = UniformHash("clusterDepthScaleBias");
+
+// Instantiate static variables
+unsigned int LightClusters::assignThreadCount = 0;
+
+LightClusters::LightClusters() : tilesX(0), tilesY(0), depthSlices(0), nearPlane(0.0f), farPlane(0.0f),
+clusterProjection(0.0f), gridBuffer(0), gridTexture(0), indexBuffer(0), indexTexture(0), indexCapacity(0)
+{
+	statistics = { 0, 0, 0, 0.0 };
+}
+
+LightClusters::~LightClusters()
+{
+	array<unsigned int, 2> textures = { gridTexture, indexTexture };
+	array<unsigned int, 2> buffers = { gridBuffer, indexBuffer };
+
+	for (unsigned int i = 0; i < textures.size(); i++)
+	{
+		if (textures[i] != 0)
+			GLStateCache::DeleteTextures(1, &textures[i]);
+
+		if (buffers[i] != 0)
+			GLStateCache::DeleteBuffers(1, &buffers[i]);
+	}
+}
+
+void LightClusters::Initialize(unsigned int tilesX_, unsigned int tilesY_, unsigned int depthSlices_)
+{
+	tilesX = std::max(tilesX_, 1u);
+	tilesY = std::max(tilesY_, 1u);
+	depthSlices = std::max(depthSlices_, 1u);
+
+	// Every cluster starts out empty, with two unsigned ints (offset and count) each
+	clusterGrid.assign(GetClusterCount() * 2, 0);
+
+	glGenBuffers(1, &gridBuffer);
+	glGenTextures(1, &gridTexture);
+
+	GLStateCache::BindBuffer(GL_TEXTURE_BUFFER, gridBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, clusterGrid.size() * sizeof(unsigned int), clusterGrid.data(), GL_DYNAMIC_DRAW);
+	GLStateCache::BindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	GLStateCache::BindTexture(GL_TEXTURE_BUFFER, gridTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, gridBuffer);
+	GLStateCache::BindTexture(GL_TEXTURE_BUFFER, 0);
+
+	glGenBuffers(1, &indexBuffer);
+	glGenTextures(1, &indexTexture);
+
+	ReserveIndices(1024);
+}
+
+void LightClusters::Update(const LightBuffer& lights_, const mat4& viewMatrix_, const mat4& projectionMatrix_,
+	float nearPlane_, float farPlane_)
+{
+	double startTime = glfwGetTime();
+
+	if (projectionMatrix_ != clusterProjection || nearPlane_ != nearPlane || farPlane_ != farPlane)
+		BuildClusterBounds(projectionMatrix_, nearPlane_, farPlane_);
+
+	// Every light is moved into view space and narrowed down to a range of clusters once, instead of once per thread
+	lightBounds.clear();
+
+	for (unsigned int i = 0; i < lights_.GetLightCount(); i++)
+	{
+		LightBounds bounds;
+
+		if (FindLightBounds(lights_.GetLight(i), viewMatrix_, projectionMatrix_, bounds))
+		{
+			bounds.light = i;
+			lightBounds.push_back(bounds);
+		}
+	}
+
+	unsigned int lightCount = static_cast<unsigned int>(lightBounds.size());
+	unsigned int threadCount = assignThreadCount;
+
+	if (threadCount == 0)
+		threadCount = std::max(thread::hardware_concurrency(), 1u);
+
+	threadCount = std::max(std::min(std::min(threadCount, lightCount / MIN_LIGHTS_PER_THREAD), depthSlices), 1u);
+
+	if (threadIndices.size() < threadCount)
+		threadIndices.resize(threadCount);
+
+	auto assignRange = [&](unsigned int range)
+	{
+		AssignSlices(range * depthSlices / threadCount, (range + 1) * depthSlices / threadCount, threadIndices[range]);
+	};
+
+	vector<future<void>> workers;
+
+	for (unsigned int i = 1; i < threadCount; i++)
+	{
+		workers.push_back(async(launch::async, assignRange, i));
+	}
+
+	// The calling thread takes the first slices instead of just waiting
+	assignRange(0);
+
+	for (unsigned int i = 0; i < workers.size(); i++)
+	{
+		workers[i].wait();
+	}
+
+	// Every thread's offsets start at 0, they move up by the size of the lists of the slices in front of them
+	lightIndices.clear();
+
+	unsigned int sliceClusterCount = tilesX * tilesY;
+
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		unsigned int offset = static_cast<unsigned int>(lightIndices.size());
+
+		unsigned int firstCluster = i * depthSlices / threadCount * sliceClusterCount;
+		unsigned int lastCluster = (i + 1) * depthSlices / threadCount * sliceClusterCount;
+
+		for (unsigned int j = firstCluster; j < lastCluster; j++)
+		{
+			clusterGrid[j * 2] += offset;
+		}
+
+		lightIndices.insert(lightIndices.end(), threadIndices[i].begin(), threadIndices[i].end());
+	}
+
+	statistics.visibleLights = lightCount;
+	statistics.lightIndices = static_cast<unsigned int>(lightIndices.size());
+	statistics.maxClusterLights = 0;
+
+	for (unsigned int i = 0; i < GetClusterCount(); i++)
+	{
+		statistics.maxClusterLights = std::max(statistics.maxClusterLights, clusterGrid[i * 2 + 1]);
+	}
+
+	statistics.assignTime = glfwGetTime() - startTime;
+}
+
+void LightClusters::AssignSlices(unsigned int firstSlice_, unsigned int lastSlice_, vector<unsigned int>& indices_)
+{
+	indices_.clear();
+
+	unsigned int sliceTileCount = tilesX * tilesY;
+
+	/* Every light only visits the tiles of its own rectangle, which gives (tile, light) pairs in light order. A counting
+	sort then puts them into one list per tile, and the lights of every list stay in the same order */
+	vector<unsigned int> pairTiles, pairLights;
+	vector<unsigned int> tileCursors(sliceTileCount);
+
+	for (unsigned int slice = firstSlice_; slice < lastSlice_; slice++)
+	{
+		pairTiles.clear();
+		pairLights.clear();
+
+		fill(tileCursors.begin(), tileCursors.end(), 0);
+
+		unsigned int firstCluster = slice * sliceTileCount;
+
+		for (unsigned int i = 0; i < lightBounds.size(); i++)
+		{
+			const LightBounds& bounds = lightBounds[i];
+
+			if (slice < bounds.minSlice || slice > bounds.maxSlice)
+				continue;
+
+			float radiusSquared = bounds.radius * bounds.radius;
+
+			for (unsigned int y = bounds.minY; y <= bounds.maxY; y++)
+			{
+				for (unsigned int x = bounds.minX; x <= bounds.maxX; x++)
+				{
+					unsigned int tile = y * tilesX + x;
+
+					// The sphere touches the cluster's box if the closest point of the box is inside of it
+					vec3 closestPoint = glm::clamp(bounds.center, clusterMins[firstCluster + tile],
+						clusterMaxs[firstCluster + tile]);
+					vec3 offsetToCenter = bounds.center - closestPoint;
+
+					if (dot(offsetToCenter, offsetToCenter) > radiusSquared)
+						continue;
+
+					pairTiles.push_back(tile);
+					pairLights.push_back(bounds.light);
+					tileCursors[tile]++;
+				}
+			}
+		}
+
+		// The counts become where every tile's list starts
+		unsigned int offset = static_cast<unsigned int>(indices_.size());
+
+		for (unsigned int tile = 0; tile < sliceTileCount; tile++)
+		{
+			unsigned int count = tileCursors[tile];
+
+			clusterGrid[(firstCluster + tile) * 2] = offset;
+			clusterGrid[(firstCluster + tile) * 2 + 1] = count;
+
+			tileCursors[tile] = offset;
+			offset += count;
+		}
+
+		indices_.resize(offset);
+
+		for (unsigned int i = 0; i < pairTiles.size(); i++)
+		{
+			indices_[tileCursors[pairTiles[i]]++] = pairLights[i];
+		}
+	}
+}
+
+bool LightClusters::FindLightBounds(const PointLight& light_, const mat4& viewMatrix_, const mat4& projectionMatrix_,
+	LightBounds& bounds_) const
+{
+	bounds_.center = vec3(viewMatrix_ * vec4(light_.position, 1.0f));
+	bounds_.radius = light_.radius;
+
+	// The camera looks down -z, the depth grows the other way
+	float nearestDepth = -bounds_.center.z - light_.radius;
+	float farthestDepth = -bounds_.center.z + light_.radius;
+
+	if (farthestDepth < nearPlane || nearestDepth > farPlane)
+		return false;
+
+	bounds_.minSlice = FindSlice(std::max(nearestDepth, nearPlane));
+	bounds_.maxSlice = FindSlice(std::min(farthestDepth, farPlane));
+
+	bounds_.minX = 0;
+	bounds_.minY = 0;
+	bounds_.maxX = tilesX - 1;
+	bounds_.maxY = tilesY - 1;
+
+	// A sphere that reaches past the near plane can cover any tile
+	if (nearestDepth <= nearPlane)
+		return true;
+
+	// The box around the sphere is entirely in front of the camera, so its corners on the screen surround the sphere's
+	vec2 screenMin = vec2(FLT_MAX);
+	vec2 screenMax = vec2(-FLT_MAX);
+
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		vec3 corner = bounds_.center + vec3(i & 1 ? light_.radius : -light_.radius,
+			i & 2 ? light_.radius : -light_.radius, i & 4 ? light_.radius : -light_.radius);
+
+		vec4 clipPosition = projectionMatrix_ * vec4(corner, 1.0f);
+		vec2 ndcPosition = vec2(clipPosition.x, clipPosition.y) / clipPosition.w;
+
+		screenMin = min(screenMin, ndcPosition);
+		screenMax = max(screenMax, ndcPosition);
+	}
+
+	if (screenMax.x < -1.0f || screenMax.y < -1.0f || screenMin.x > 1.0f || screenMin.y > 1.0f)
+		return false;
+
+	// From -1 to 1 into tiles, clamped to the screen since part of the sphere can be off of it
+	vec2 firstTile = (screenMin * 0.5f + 0.5f) * vec2(static_cast<float>(tilesX), static_cast<float>(tilesY));
+	vec2 lastTile = (screenMax * 0.5f + 0.5f) * vec2(static_cast<float>(tilesX), static_cast<float>(tilesY));
+
+	bounds_.minX = static_cast<unsigned int>(std::max(firstTile.x, 0.0f));
+	bounds_.minY = static_cast<unsigned int>(std::max(firstTile.y, 0.0f));
+	bounds_.maxX = std::min(static_cast<unsigned int>(std::max(lastTile.x, 0.0f)), tilesX - 1);
+	bounds_.maxY = std::min(static_cast<unsigned int>(std::max(lastTile.y, 0.0f)), tilesY - 1);
+
+	return true;
+}
+
+void LightClusters::BuildClusterBounds(const mat4& projectionMatrix_, float nearPlane_, float farPlane_)
+{
+	clusterProjection = projectionMatrix_;
+	nearPlane = nearPlane_;
+	farPlane = farPlane_;
+
+	clusterMins.resize(GetClusterCount());
+	clusterMaxs.resize(GetClusterCount());
+
+	mat4 inverseProjection = inverse(projectionMatrix_);
+
+	// Direction through every tile corner, scaled so its depth is 1
+	vector<vec3> cornerDirections((tilesX + 1) * (tilesY + 1));
+
+	for (unsigned int y = 0; y <= tilesY; y++)
+	{
+		for (unsigned int x = 0; x <= tilesX; x++)
+		{
+			vec4 corner = inverseProjection * vec4(x * 2.0f / tilesX - 1.0f, y * 2.0f / tilesY - 1.0f, -1.0f, 1.0f);
+			vec3 direction = vec3(corner) / corner.w;
+
+			cornerDirections[y * (tilesX + 1) + x] = direction / -direction.z;
+		}
+	}
+
+	for (unsigned int slice = 0; slice < depthSlices; slice++)
+	{
+		// The same depths FindSlice splits at
+		float sliceNear = nearPlane * pow(farPlane / nearPlane, static_cast<float>(slice) / depthSlices);
+		float sliceFar = nearPlane * pow(farPlane / nearPlane, static_cast<float>(slice + 1) / depthSlices);
+
+		for (unsigned int y = 0; y < tilesY; y++)
+		{
+			for (unsigned int x = 0; x < tilesX; x++)
+			{
+				unsigned int cluster = (slice * tilesY + y) * tilesX + x;
+
+				// The box around the tile's four corner directions at the slice's near and far depth
+				for (unsigned int i = 0; i < 8; i++)
+				{
+					unsigned int cornerX = x + (i & 1);
+					unsigned int cornerY = y + ((i >> 1) & 1);
+
+					vec3 point = cornerDirections[cornerY * (tilesX + 1) + cornerX] * (i & 4 ? sliceFar : sliceNear);
+
+					clusterMins[cluster] = i == 0 ? point : min(clusterMins[cluster], point);
+					clusterMaxs[cluster] = i == 0 ? point : max(clusterMaxs[cluster], point);
+				}
+			}
+		}
+	}
+}
+
+unsigned int LightClusters::FindSlice(float depth_) const
+{
+	// Same as ClusteredLights.glsl, the slices are evenly spaced in log(depth)
+	float slice = floor(log(depth_ / nearPlane) / log(farPlane / nearPlane) * depthSlices);
+
+	return static_cast<unsigned int>(std::clamp(slice, 0.0f, static_cast<float>(depthSlices - 1)));
+}
+
+void LightClusters::Upload()
+{
+	if (gridBuffer == 0)
+		return;
+
+	GLStateCache::BindBuffer(GL_TEXTURE_BUFFER, gridBuffer);
+	glBufferSubData(GL_TEXTURE_BUFFER, 0, clusterGrid.size() * sizeof(unsigned int), clusterGrid.data());
+
+	if (lightIndices.size() > indexCapacity)
+	{
+		ReserveIndices(std::max(static_cast<unsigned int>(lightIndices.size()), indexCapacity * 2));
+		GLStateCache::BindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+	}
+	else
+	{
+		GLStateCache::BindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+
+		// Orphans the old lists, the GPU might still be reading them for the last frame
+		glBufferData(GL_TEXTURE_BUFFER, indexCapacity * sizeof(unsigned int), NULL, GL_DYNAMIC_DRAW);
+	}
+
+	if (!lightIndices.empty())
+		glBufferSubData(GL_TEXTURE_BUFFER, 0, lightIndices.size() * sizeof(unsigned int), lightIndices.data());
+
+	GLStateCache::BindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void LightClusters::Bind(GLenum gridTextureUnit_, GLenum indexTextureUnit_)
+{
+	GLStateCache::ActiveTexture(gridTextureUnit_);
+	GLStateCache::BindTexture(GL_TEXTURE_BUFFER, gridTexture);
+
+	GLStateCache::ActiveTexture(indexTextureUnit_);
+	GLStateCache::BindTexture(GL_TEXTURE_BUFFER, indexTexture);
+}
+
+void LightClusters::SetUniforms(ShaderProgram* shaderProgram_)
+{
+	// slice = log(depth) * scale + bias, which is FindSlice's log(depth / near) / log(far / near) * slices
+	float scale = depthSlices / log(farPlane / nearPlane);
+
+	shaderProgram_->SetVec3(CLUSTER_COUNTS_UNIFORM, vec3(static_cast<float>(tilesX), static_cast<float>(tilesY),
+		static_cast<float>(depthSlices)));
+	shaderProgram_->SetVec2(CLUSTER_DEPTH_SCALE_BIAS_UNIFORM, vec2(scale, -log(nearPlane) * scale));
+}
+
+const unsigned int* LightClusters::GetClusterLights(unsigned int tileX_, unsigned int tileY_, unsigned int slice_,
+	unsigned int& lightCount_) const
+{
+	unsigned int cluster = (slice_ * tilesY + tileY_) * tilesX + tileX_;
+
+	lightCount_ = clusterGrid[cluster * 2 + 1];
+
+	return lightIndices.data() + clusterGrid[cluster * 2];
+}
+
+unsigned int LightClusters::GetClusterCount() const
+{
+	return tilesX * tilesY * depthSlices;
+}
+
+const LightClusterStatistics& LightClusters::GetStatistics() const
+{
+	return statistics;
+}
+
+void LightClusters::PrintStatistics() const
+{
+	cout << "Light clusters: " << statistics.visibleLights << " visible lights assigned to " << GetClusterCount() <<
+		" clusters in " << statistics.assignTime * 1000.0 << " ms, " << statistics.lightIndices << " light indices, " <<
+		"at most " << statistics.maxClusterLights << " lights in one cluster" << endl;
+}
+
+void LightClusters::ReserveIndices(unsigned int indexCapacity_)
+{
+	indexCapacity = indexCapacity_;
+
+	GLStateCache::BindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, indexCapacity * sizeof(unsigned int), NULL, GL_DYNAMIC_DRAW);
+	GLStateCache::BindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	GLStateCache::BindTexture(GL_TEXTURE_BUFFER, indexTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, indexBuffer);
+	GLStateCache::BindTexture(GL_TEXTURE_BUFFER, 0);
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#ifndef LIGHT_CLUSTERS_H
+#define LIGHT_CLUSTERS_H
+
+#include "LightBuffer.h"
+
+#include <vector>
+
+using namespace std;
+
+class ShaderProgram;
+
+// What the last Update did
+struct LightClusterStatistics
+{
+	unsigned int visibleLights; // lights that touch at least one cluster
+	unsigned int lightIndices; // entries in all the clusters' light lists together
+	unsigned int maxClusterLights; // the longest list of a single cluster
+
+	double assignTime; // assigning the lights to the clusters (in seconds)
+};
+
+/* Splits the view frustum into a grid of clusters so a fragment only has to loop over the lights that can reach it,
+instead of every light in the scene. The screen is cut into tiles and the depth into slices that get thicker further
+away (each slice is the same number of times deeper than the one before, so the clusters stay about as deep as they are
+wide). Every frame the CPU works out which clusters each light's sphere touches, and writes one compact list of light
+indices for all the clusters together, with an offset and a count per cluster.
+
+Both are uploaded to texture buffers (the same way LightBuffer stores the lights), and ClusteredLights.glsl finds a
+fragment's cluster from its position on the screen and its depth. The lighting cost then depends on how many lights
+overlap in one place rather than on how many there are in total.
+
+The depth slices are split between threads. Every thread writes the lists of its own slices, which are one contiguous
+range of clusters, and the lists are joined together in slice order afterwards */
+
+class LightClusters
+{
+public:
+	LightClusters();
+	~LightClusters();
+
+	// Creates the buffers for tilesX_ x tilesY_ tiles on the screen, each split into depthSlices_ clusters
+	void Initialize(unsigned int tilesX_, unsigned int tilesY_, unsigned int depthSlices_);
+
+	/* Assigns every light to the clusters its sphere touches. nearPlane_ and farPlane_ have to be the projection's, the
+	slices go from one to the other */
+	void Update(const LightBuffer& lights_, const mat4& viewMatrix_, const mat4& projectionMatrix_, float nearPlane_,
+		float farPlane_);
+
+	// Sends the clusters and their light lists to the GPU
+	void Upload();
+
+	// Binds the cluster and light index textures for the clusterGrid and clusterLightIndices usamplerBuffer uniforms
+	void Bind(GLenum gridTextureUnit_, GLenum indexTextureUnit_);
+
+	// Sets the grid size and depth slicing of ClusteredLights.glsl, the shader has to be in use already
+	void SetUniforms(ShaderProgram* shaderProgram_);
+
+	// Index of every light in the cluster, and how many there are
+	const unsigned int* GetClusterLights(unsigned int tileX_, unsigned int tileY_, unsigned int slice_,
+		unsigned int& lightCount_) const;
+
+	unsigned int GetClusterCount() const;
+
+	const LightClusterStatistics& GetStatistics() const;
+
+	void PrintStatistics() const;
+
+	/* Number of threads Update splits the slices across (the calling thread counts as one of them), 0 uses one thread
+	per core */
+	static unsigned int assignThreadCount;
+
+	// Every thread gets at least this many lights worth of work, a few dozen lights are assigned faster on one thread
+	static const unsigned int MIN_LIGHTS_PER_THREAD = 128;
+
+private:
+	// A light's sphere in view space, and the range of tiles and slices it could touch
+	struct LightBounds
+	{
+		unsigned int light;
+
+		vec3 center;
+		float radius;
+
+		unsigned int minX, maxX, minY, maxY, minSlice, maxSlice;
+	};
+
+	// Works out the view space box around every cluster, only runs again when the projection changes
+	void BuildClusterBounds(const mat4& projectionMatrix_, float nearPlane_, float farPlane_);
+
+	// Returns false if the light is outside the frustum, otherwise fills in its bounds
+	bool FindLightBounds(const PointLight& light_, const mat4& viewMatrix_, const mat4& projectionMatrix_,
+		LightBounds& bounds_) const;
+
+	// Writes the light lists of the slices [firstSlice_, lastSlice_) to indices_, with offsets starting at 0
+	void AssignSlices(unsigned int firstSlice_, unsigned int lastSlice_, vector<unsigned int>& indices_);
+
+	// Returns the slice a view space depth falls in
+	unsigned int FindSlice(float depth_) const;
+
+	// Reallocates the index buffer so it fits at least the given number of light indices
+	void ReserveIndices(unsigned int indexCapacity_);
+
+	unsigned int tilesX, tilesY, depthSlices;
+
+	float nearPlane, farPlane;
+
+	// The projection the cluster boxes were built for
+	mat4 clusterProjection;
+
+	// View space box of every cluster, tile after tile and slice after slice
+	vector<vec3> clusterMins, clusterMaxs;
+
+	// Offset into lightIndices and light count of every cluster, and every cluster's lights one list after the other
+	vector<unsigned int> clusterGrid;
+	vector<unsigned int> lightIndices;
+
+	// Only the lights inside the frustum
+	vector<LightBounds> lightBounds;
+
+	// The lists every thread wrote for its slices, kept between frames so they don't have to grow again
+	vector<vector<unsigned int>> threadIndices;
+
+	unsigned int gridBuffer, gridTexture;
+	unsigned int indexBuffer, indexTexture;
+	unsigned int indexCapacity;
+
+	LightClusterStatistics statistics;
+};
+
+#endif
@@ -0,0 +1,125 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : data(nullptr), size(0), fileHandle(nullptr), mappingHandle(nullptr)
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const string& filePath)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+
+	// Empty files can't be mapped
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if (mapping == NULL)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (view == NULL)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	mappingHandle = mapping;
+	data = static_cast<const unsigned char*>(view);
+	size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	int file = open(filePath.c_str(), O_RDONLY);
+
+	if (file < 0)
+		return false;
+
+	struct stat fileStatus;
+
+	if (fstat(file, &fileStatus) != 0 || fileStatus.st_size == 0)
+	{
+		close(file);
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+	// The mapping keeps the file alive on its own, so the descriptor isn't needed anymore
+	close(file);
+
+	if (view == MAP_FAILED)
+		return false;
+
+	data = static_cast<const unsigned char*>(view);
+	size = static_cast<size_t>(fileStatus.st_size);
+#endif
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data == nullptr)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+	CloseHandle(static_cast<HANDLE>(mappingHandle));
+	CloseHandle(static_cast<HANDLE>(fileHandle));
+#else
+	munmap(const_cast<unsigned char*>(data), size);
+#endif
+
+	data = nullptr;
+	size = 0;
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+}
+
+bool MappedFile::IsOpen() const
+{
+	return data != nullptr;
+}
+
+const unsigned char* MappedFile::GetData() const
+{
+	return data;
+}
+
+size_t MappedFile::GetSize() const
+{
+	return size;
+}
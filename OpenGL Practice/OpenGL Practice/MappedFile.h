@@ -0,0 +1,43 @@
+#pragma once
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+/* Maps a whole file into memory as read-only bytes. Nothing is copied when the file is opened, the operating system only
+pages in the parts we actually touch, which makes it ideal for large binary caches that are read once and thrown away.
+The bytes stay valid until Close is called or the MappedFile is destroyed */
+
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	// A mapping can't be shared between two objects, so copying is not allowed
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Maps the file, returns false if it doesn't exist, is empty or can't be mapped
+	bool Open(const string& filePath);
+	void Close();
+
+	bool IsOpen() const;
+
+	const unsigned char* GetData() const;
+	size_t GetSize() const;
+
+private:
+	const unsigned char* data;
+	size_t size;
+
+	// Operating system handles of the file and its mapping (unused on platforms that only need the pointer)
+	void* fileHandle;
+	void* mappingHandle;
+};
+
+#endif
@@ -1,7 +1,82 @@
 #include "Mesh.h"
 
-Mesh::Mesh(vector<Vertex> vertices_, vector<unsigned int> indices_, vector<Texture> textures_) : 
-	vertices(vertices_), indices(indices_), textures(textures_)
+#include <cstring>
+
+constexpr unsigned int MESH_QUANTIZED_UNIFORM = UniformHash("meshQuantized");
+constexpr unsigned int MESH_POSITION_SCALE_UNIFORM = UniformHash("meshPositionScale");
+constexpr unsigned int MESH_POSITION_OFFSET_UNIFORM = UniformHash("meshPositionOffset");
+
+// Maps -1 to 1 onto a signed normalized 16-bit integer
+static short PackSnorm16(float value)
+{
+	return static_cast<short>(roundf(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+static float SignNotZero(float value)
+{
+	return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+/* Octahedral encoding projects the unit sphere onto an octahedron and unfolds it into a square, so a direction only needs
+two numbers and the error is spread evenly over the whole sphere (DecodeOctahedral in MeshVertex.glsl undoes it) */
+static void PackOctahedral(const vec3& direction, short packed[2])
+{
+	float length = fabsf(direction.x) + fabsf(direction.y) + fabsf(direction.z);
+
+	// Meshes without normals or tangents leave them at zero, any direction is as good as another then
+	if (length == 0.0f)
+	{
+		packed[0] = packed[1] = 0;
+		return;
+	}
+
+	vec2 encoded = vec2(direction.x, direction.y) / length;
+
+	// Fold the lower half of the octahedron over the upper half
+	if (direction.z < 0.0f)
+	{
+		encoded = vec2((1.0f - fabsf(encoded.y)) * SignNotZero(encoded.x), (1.0f - fabsf(encoded.x)) *
+			SignNotZero(encoded.y));
+	}
+
+	packed[0] = PackSnorm16(encoded.x);
+	packed[1] = PackSnorm16(encoded.y);
+}
+
+// IEEE 754 half float conversion with rounding to the nearest value, too large values become infinity
+static unsigned short PackHalf(float value)
+{
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(float));
+
+	unsigned int sign = (bits >> 16) & 0x8000;
+	int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127 + 15;
+	unsigned int mantissa = bits & 0x7FFFFF;
+
+	// Too small for a normal half float, keep it as a denormal (or zero if it's tiny)
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+			return static_cast<unsigned short>(sign);
+
+		mantissa |= 0x800000;
+
+		unsigned int shift = static_cast<unsigned int>(14 - exponent);
+		return static_cast<unsigned short>(sign | ((mantissa + (1u << (shift - 1))) >> shift));
+	}
+
+	// The rounding may carry into the exponent, which is exactly what should happen
+	unsigned int half = (static_cast<unsigned int>(exponent) << 10) + ((mantissa + 0x1000) >> 13);
+
+	if (exponent >= 31 || half >= 0x7C00)
+		half = 0x7C00;
+
+	return static_cast<unsigned short>(sign | half);
+}
+
+Mesh::Mesh(vector<Vertex> vertices_, vector<unsigned int> indices_, vector<Texture> textures_, bool compactVertices_,
+	const vector<MeshLOD>& lods_, MeshBuffer* meshBuffer_) : vertices(move(vertices_)), indices(move(indices_)),
+	textures(textures_), compactVertices(compactVertices_)
 {
 	// I typically like to initialize the variables of the constructors to NULL, 0, nullptr or false
 	VAO = NULL;
@@ -11,23 +86,93 @@ Mesh::Mesh(vector<Vertex> vertices_, vector<unsigned int> indices_, vector<Textu
 	diffuseNumber = NULL;
 	specularNumber = NULL;
 
-	SetupMesh();
+	vertexCount = static_cast<unsigned int>(vertices.size());
+	indexCount = static_cast<unsigned int>(indices.size());
+
+	BoundingVolumes::ComputeBounds(vertices.data(), vertexCount, boundsMin, boundsMax);
+	boundingSphere = BoundingVolumes::ComputeBoundingSphere(vertices.data(), vertexCount, boundsMin, boundsMax);
+
+	SetupLODs(lods_);
+	SetupMesh(vertices.data(), indices.data(), meshBuffer_);
+	HashSamplerNames();
+}
+
+Mesh::Mesh(const Vertex* vertices_, unsigned int vertexCount_, const unsigned int* indices_, unsigned int indexCount_,
+	vector<Texture> textures_, const vec3& boundsMin_, const vec3& boundsMax_, bool compactVertices_,
+	const vector<MeshLOD>& lods_, MeshBuffer* meshBuffer_) : textures(textures_),
+	vertexCount(vertexCount_), indexCount(indexCount_), boundsMin(boundsMin_), boundsMax(boundsMax_),
+	compactVertices(compactVertices_)
+{
+	VAO = NULL;
+	VBO = NULL;
+	EBO = NULL;
+
+	diffuseNumber = NULL;
+	specularNumber = NULL;
+
+	// The box comes from the cache file, the sphere is quick enough to work out again from the mapped vertices
+	boundingSphere = BoundingVolumes::ComputeBoundingSphere(vertices_, vertexCount, boundsMin, boundsMax);
+
+	SetupLODs(lods_);
+	SetupMesh(vertices_, indices_, meshBuffer_);
+	HashSamplerNames();
+}
+
+void Mesh::SetupLODs(const vector<MeshLOD>& lods_)
+{
+	lods = lods_;
+
+	if (lods.empty())
+	{
+		MeshLOD lod;
+		lod.indexOffset = 0;
+		lod.indexCount = indexCount;
+		lod.error = 0.0f;
+
+		lods.push_back(lod);
+	}
 }
 
-void Mesh::SetupMesh()
+void Mesh::SetupMesh(const Vertex* vertices_, const unsigned int* indices_, MeshBuffer* meshBuffer_)
 {
+	indexType = GL_UNSIGNED_INT;
+
+	positionScale = vec3(1.0f);
+	positionOffset = vec3(0.0f);
+
+	baseVertex = 0;
+	firstIndex = 0;
+
+	sharedBuffer = meshBuffer_ != nullptr && !compactVertices;
+
+	if (sharedBuffer)
+	{
+		meshBuffer_->Allocate(vertices_, vertexCount, indices_, indexCount, baseVertex, firstIndex);
+		VAO = meshBuffer_->VAO;
+
+		return;
+	}
+
 	glGenVertexArrays(1, &VAO);
 
 	glGenBuffers(1, &VBO);
 	glGenBuffers(1, &EBO);
 
-	glBindVertexArray(VAO);
+	GLStateCache::BindVertexArray(VAO);
+
+	if (compactVertices)
+	{
+		SetupCompactMesh(vertices_, indices_);
+		GLStateCache::BindVertexArray(0);
+
+		return;
+	}
 
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(Vertex), vertices_, GL_STATIC_DRAW);
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+	GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indices_, GL_STATIC_DRAW);
 
 	/* The offsetof macro passes in a struct name as the first argument, and the variable name inside the struct for 
 	the second argument. */
@@ -40,42 +185,174 @@ void Mesh::SetupMesh()
 	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, meshTextureCoordinates));
 	glEnableVertexAttribArray(2); // Position attribute location occurs at 2
 
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(0);
+}
+
+void Mesh::SetupCompactMesh(const Vertex* vertices_, const unsigned int* indices_)
+{
+	// The compact positions cover the bounding box, a flat box still needs some scale to avoid dividing by zero
+	positionOffset = (boundsMin + boundsMax) * 0.5f;
+	positionScale = max((boundsMax - boundsMin) * 0.5f, vec3(1e-6f));
+
+	vector<CompactVertex> packedVertices(vertexCount);
+
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		const Vertex& vertex = vertices_[i];
+		CompactVertex& compactVertex = packedVertices[i];
+
+		vec3 position = (vertex.meshPosition - positionOffset) / positionScale;
+
+		compactVertex.meshPosition[0] = PackSnorm16(position.x);
+		compactVertex.meshPosition[1] = PackSnorm16(position.y);
+		compactVertex.meshPosition[2] = PackSnorm16(position.z);
+
+		PackOctahedral(vertex.meshNormal, compactVertex.meshNormal);
+		PackOctahedral(vertex.tangent, compactVertex.tangent);
+
+		// Only the handedness of the tangent frame is kept, the bitangent itself is rebuilt from the normal and tangent
+		compactVertex.bitangentSign = dot(cross(vertex.meshNormal, vertex.tangent), vertex.biTangent) < 0.0f ? -32767 :
+			32767;
+
+		compactVertex.meshTextureCoordinates[0] = PackHalf(vertex.meshTextureCoordinates.x);
+		compactVertex.meshTextureCoordinates[1] = PackHalf(vertex.meshTextureCoordinates.y);
+	}
+
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(CompactVertex), packedVertices.data(), GL_STATIC_DRAW);
+
+	GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+	// Every index fits in 16 bits, which halves the index buffer
+	if (vertexCount <= 65536)
+	{
+		vector<unsigned short> shortIndices(indices_, indices_ + indexCount);
+
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned short), shortIndices.data(), GL_STATIC_DRAW);
+		indexType = GL_UNSIGNED_SHORT;
+	}
+
+	else
+	{
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indices_, GL_STATIC_DRAW);
+	}
+
+	// GL_TRUE makes OpenGL turn the integers into -1 to 1 floats before they reach the shader
+	glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(CompactVertex), (void*)offsetof(CompactVertex, meshPosition));
+	glEnableVertexAttribArray(0);
+
+	// The shader's vec3 normal gets (x, y, 0), MeshNormal only looks at x and y for compact meshes
+	glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(CompactVertex), (void*)offsetof(CompactVertex, meshNormal));
+	glEnableVertexAttribArray(1);
+
+	glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(CompactVertex),
+		(void*)offsetof(CompactVertex, meshTextureCoordinates));
+	glEnableVertexAttribArray(2);
+}
+
+void Mesh::SetVertexFormat(ShaderProgram* shaderProgram_)
+{
+	if (!compactVertices)
+		return;
+
+	shaderProgram_->SetInt(MESH_QUANTIZED_UNIFORM, 1);
+	shaderProgram_->SetVec3(MESH_POSITION_SCALE_UNIFORM, positionScale);
+	shaderProgram_->SetVec3(MESH_POSITION_OFFSET_UNIFORM, positionOffset);
+}
+
+void Mesh::ResetVertexFormat(ShaderProgram* shaderProgram_)
+{
+	if (compactVertices)
+		shaderProgram_->SetInt(MESH_QUANTIZED_UNIFORM, 0);
+}
+
+size_t Mesh::GetIndexByteOffset(unsigned int lod) const
+{
+	size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+
+	return (firstIndex + lods[lod].indexOffset) * indexSize;
+}
+
+size_t Mesh::GetBufferSize() const
+{
+	size_t vertexSize = compactVertices ? sizeof(CompactVertex) : sizeof(Vertex);
+	size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+
+	return vertexCount * vertexSize + indexCount * indexSize;
 }
 
-void Mesh::DrawMesh(ShaderProgram *shaderProgram_)
+void Mesh::HashSamplerNames()
 {
 	diffuseNumber = 1;
 	specularNumber = 1;
 
+	samplerHashes.clear();
+
 	for (unsigned int i = 0; i < textures.size(); i++)
 	{
-		// Active as many textures as we need as this loop iterates through the textures list
-		glActiveTexture(GL_TEXTURE0 + i);
-
-		string number;
-		string name = textures[i].textureType;
+		const string& name = textures[i].textureType;
+		unsigned int nameHash = UniformHash(name.c_str());
 
 		/* Basically, if the name of the string can find TextureDiffuse in my fragment shader, increment the number to
 		loop through all the diffuse textures we set in the fragment shader. */
 		if (name == "TextureDiffuse")
 		{
-			number = to_string(diffuseNumber++);
+			nameHash = UniformHashNumber(nameHash, diffuseNumber++);
 		}
 
 		else if (name == "TextureSpecular")
 		{
-			number = to_string(specularNumber++);
+			nameHash = UniformHashNumber(nameHash, specularNumber++);
 		}
 
-		glUniform1f(glGetUniformLocation(shaderProgram_->shaderProgram, (name + number).c_str()), i);
-		glBindTexture(GL_TEXTURE_2D, textures[i].textureID);
+		samplerHashes.push_back(nameHash);
 	}
+}
+
+void Mesh::DrawMesh(ShaderProgram *shaderProgram_, unsigned int lod)
+{
+	// Meshes with fewer levels than asked for draw their coarsest one
+	lod = std::min(lod, static_cast<unsigned int>(lods.size() - 1));
+
+	BindTextures(shaderProgram_);
+	SetVertexFormat(shaderProgram_);
 
 	// Draw a mesh
-	glBindVertexArray(VAO);
-	glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(VAO);
+	glDrawElementsBaseVertex(GL_TRIANGLES, lods[lod].indexCount, indexType, (void*)GetIndexByteOffset(lod), baseVertex);
+	GLStateCache::BindVertexArray(0);
+
+	ResetVertexFormat(shaderProgram_);
+
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+}
 
-	glActiveTexture(GL_TEXTURE0);
+void Mesh::BindTextures(ShaderProgram* shaderProgram_)
+{
+	for (unsigned int i = 0; i < textures.size(); i++)
+	{
+		// Active as many textures as we need as this loop iterates through the textures list
+		GLStateCache::ActiveTexture(GL_TEXTURE0 + i);
+
+		// Samplers have to be set as integers, the texture unit is the same as the texture's index
+		shaderProgram_->SetInt(samplerHashes[i], i);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, textures[i].textureID);
+	}
+}
+
+void Mesh::DeleteMesh()
+{
+	if (sharedBuffer)
+	{
+		VAO = NULL;
+		return;
+	}
+
+	GLStateCache::DeleteVertexArrays(1, &VAO);
+	GLStateCache::DeleteBuffers(1, &VBO);
+	GLStateCache::DeleteBuffers(1, &EBO);
+
+	VAO = NULL;
+	VBO = NULL;
+	EBO = NULL;
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 #include "ShaderProgram.h"
+#include "MeshBuffer.h"
+#include "BoundingVolumes.h"
 #include <vector>
 
 using namespace std;
@@ -12,6 +14,32 @@ struct Vertex
 	vec3 tangent, biTangent;
 };
 
+/* Compact version of Vertex (20 bytes instead of 56), used by meshes created with compactVertices. Positions are signed
+normalized 16-bit integers inside the mesh's bounding box (the vertex shader scales them back with meshPositionScale and
+meshPositionOffset), normals and tangents are octahedral encoded into two 16-bit integers each, the bitangent is rebuilt
+from cross(normal, tangent) * bitangentSign, and the texture coordinates are half floats. Like Vertex, only the position,
+normal and texture coordinates are wired to vertex attributes */
+struct CompactVertex
+{
+	short meshPosition[3];
+	short bitangentSign;
+	short meshNormal[2];
+	short tangent[2];
+	unsigned short meshTextureCoordinates[2];
+};
+
+static_assert(sizeof(CompactVertex) == 20, "CompactVertex has to stay tightly packed");
+
+// A range of the mesh's indices that draws the mesh at one level of detail (see MeshSimplifier)
+struct MeshLOD
+{
+	unsigned int indexOffset;
+	unsigned int indexCount;
+
+	// How far (in model space) the simplified surface may be from the full mesh
+	float error;
+};
+
 struct Texture
 {
 	unsigned int textureID;
@@ -22,21 +50,93 @@ struct Texture
 class Mesh
 {
 public:
-	Mesh(vector<Vertex> vertices_, vector<unsigned int> indices_, vector<Texture> textures_);
-	void SetupMesh();
-	void DrawMesh(ShaderProgram *shaderProgram_);
+	/* Without any lods the whole index buffer is the only level of detail. With a mesh buffer the vertices and indices are
+	added to it instead of getting buffers of their own (compact meshes always get their own) */
+	Mesh(vector<Vertex> vertices_, vector<unsigned int> indices_, vector<Texture> textures_,
+		bool compactVertices_ = false, const vector<MeshLOD>& lods_ = vector<MeshLOD>(), MeshBuffer* meshBuffer_ = nullptr);
+
+	/* Uploads vertices and indices that live somewhere else (a memory mapped mesh cache file) straight to the GPU, the
+	vertices and indices vectors stay empty since the mesh never needs them on the CPU again */
+	Mesh(const Vertex* vertices_, unsigned int vertexCount_, const unsigned int* indices_, unsigned int indexCount_,
+		vector<Texture> textures_, const vec3& boundsMin_, const vec3& boundsMax_, bool compactVertices_ = false,
+		const vector<MeshLOD>& lods_ = vector<MeshLOD>(), MeshBuffer* meshBuffer_ = nullptr);
+
+	void SetupMesh(const Vertex* vertices_, const unsigned int* indices_, MeshBuffer* meshBuffer_ = nullptr);
+	void DrawMesh(ShaderProgram *shaderProgram_, unsigned int lod = 0);
+
+	/* Binds every texture to the texture unit of its index and sets its sampler to that unit. Models bind the textures of
+	a whole batch of meshes with it */
+	void BindTextures(ShaderProgram* shaderProgram_);
+
+	/* Tells the vertex shader how to decode a compact mesh (meshQuantized, meshPositionScale and meshPositionOffset, see
+	MeshVertex.glsl). Nothing is set for full float meshes, which is why ResetVertexFormat has to be called after drawing a
+	compact mesh, the next thing drawn with the same program might not be a mesh at all */
+	void SetVertexFormat(ShaderProgram* shaderProgram_);
+	void ResetVertexFormat(ShaderProgram* shaderProgram_);
+
+	// Size of the vertex and index buffers on the GPU (in bytes)
+	size_t GetBufferSize() const;
+
+	// Where a level of detail's indices start in the element buffer (in bytes), as glDrawElements expects it
+	size_t GetIndexByteOffset(unsigned int lod) const;
+
+	/* Deletes the vertex array and buffers, meshes are copied around by value so this isn't done in a destructor. A mesh
+	in a mesh buffer leaves them alone, the buffer's owner deletes them */
+	void DeleteMesh();
+
+	// Works out the sampler uniform name of every texture (TextureDiffuse1, TextureSpecular1 etc.) and stores its hash
+	void HashSamplerNames();
 
 	unsigned int VAO;
 
+	/* Where the mesh's vertices and indices start in its buffers, both are 0 unless the mesh is in a shared mesh buffer.
+	The indices count from the mesh's own first vertex, so they're drawn with baseVertex */
+	int baseVertex;
+	unsigned int firstIndex;
+
+	// Whether the vertex array and buffers belong to a mesh buffer
+	bool sharedBuffer;
+
 	// Create a vector of mesh data information here
 	vector<Vertex> vertices;
 	vector<unsigned int> indices;
 	vector<Texture> textures;
 
+	/* Stored separately because a mesh loaded from the mesh cache doesn't keep its vertices and indices around. indexCount
+	covers every level of detail, the indices of each level follow the ones of the level before */
+	unsigned int vertexCount, indexCount;
+
+	// Level 0 is the full mesh, every following level has fewer triangles
+	vector<MeshLOD> lods;
+
+	// Axis aligned bounding box of the mesh's vertex positions (in model space)
+	vec3 boundsMin, boundsMax;
+
+	// Sphere around the center of the box that encloses every vertex, cheaper to test than the box
+	BoundingSphere boundingSphere;
+
+	// Uses CompactVertex on the GPU instead of Vertex, chosen when the mesh is created
+	bool compactVertices;
+
+	// GL_UNSIGNED_SHORT for compact meshes with less than 65536 vertices, GL_UNSIGNED_INT otherwise
+	GLenum indexType;
+
 private:
 	// Create render data information here
 	unsigned int VBO, EBO;
 
+	// Makes sure there's at least one level of detail covering the whole index buffer
+	void SetupLODs(const vector<MeshLOD>& lods_);
+
+	// Converts the vertices to CompactVertex (and the indices to 16 bits if they fit) and uploads them
+	void SetupCompactMesh(const Vertex* vertices_, const unsigned int* indices_);
+
+	// Maps the compact positions (-1 to 1) back into the mesh's bounding box
+	vec3 positionScale, positionOffset;
+
 	// Create diffuse and specular textures number here to use the texture diffuse and specular uniforms in the shader
 	unsigned int diffuseNumber, specularNumber;
+
+	// Hashed sampler uniform name of every texture, the names never change so they're only worked out once
+	vector<unsigned int> samplerHashes;
 };
\ No newline at end of file
@@ -0,0 +1,274 @@
+#include "MeshBuffer.h"
+#include "Mesh.h"
+#include "GLStateCache.h"
+
+#include <glfw3.h>
+#include <cstring>
+#include <algorithm>
+
+typedef void (APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void* indirect,
+	GLsizei drawCount, GLsizei stride);
+
+static MultiDrawElementsIndirectProc multiDrawElementsIndirect = nullptr;
+
+// Instantiate static variables
+bool MeshBuffer::multiDrawIndirectEnabled = true;
+
+bool MeshBuffer::multiDrawIndirectQueried = false;
+bool MeshBuffer::multiDrawIndirectSupported = false;
+
+MeshBuffer::MeshBuffer()
+{
+	VAO = NULL;
+	VBO = NULL;
+	EBO = NULL;
+
+	vertexCount = 0;
+	indexCount = 0;
+
+	vertexCapacity = 0;
+	indexCapacity = 0;
+
+	staging = false;
+}
+
+void MeshBuffer::Reserve(unsigned int vertexCount_, unsigned int indexCount_)
+{
+	if (staging)
+	{
+		stagedVertices.reserve((vertexCount + vertexCount_) * sizeof(Vertex));
+		stagedIndices.reserve((indexCount + indexCount_) * sizeof(unsigned int));
+
+		return;
+	}
+
+	if (vertexCount + vertexCount_ <= vertexCapacity && indexCount + indexCount_ <= indexCapacity)
+		return;
+
+	Grow(std::max(vertexCapacity, vertexCount + vertexCount_), std::max(indexCapacity, indexCount + indexCount_));
+}
+
+void MeshBuffer::Allocate(const Vertex* vertices_, unsigned int vertexCount_, const unsigned int* indices_,
+	unsigned int indexCount_, int& baseVertex_, unsigned int& firstIndex_)
+{
+	if (staging)
+	{
+		baseVertex_ = static_cast<int>(vertexCount);
+		firstIndex_ = indexCount;
+
+		const unsigned char* vertexBytes = reinterpret_cast<const unsigned char*>(vertices_);
+		const unsigned char* indexBytes = reinterpret_cast<const unsigned char*>(indices_);
+
+		stagedVertices.insert(stagedVertices.end(), vertexBytes, vertexBytes + vertexCount_ * sizeof(Vertex));
+		stagedIndices.insert(stagedIndices.end(), indexBytes, indexBytes + indexCount_ * sizeof(unsigned int));
+
+		vertexCount += vertexCount_;
+		indexCount += indexCount_;
+
+		return;
+	}
+
+	// Growing by half of the size each time keeps the copies rare when meshes are added one at a time without Reserve
+	if (VAO == NULL || vertexCount + vertexCount_ > vertexCapacity || indexCount + indexCount_ > indexCapacity)
+	{
+		Grow(std::max(vertexCount + vertexCount_, vertexCapacity + vertexCapacity / 2),
+			std::max(indexCount + indexCount_, indexCapacity + indexCapacity / 2));
+	}
+
+	baseVertex_ = static_cast<int>(vertexCount);
+	firstIndex_ = indexCount;
+
+	/* The copy targets aren't part of the vertex array's state, unlike GL_ELEMENT_ARRAY_BUFFER which would change the
+	element buffer of whichever vertex array happens to be bound */
+	GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, vertexCount * sizeof(Vertex), vertexCount_ * sizeof(Vertex), vertices_);
+
+	GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, indexCount * sizeof(unsigned int), indexCount_ * sizeof(unsigned int),
+		indices_);
+
+	GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	vertexCount += vertexCount_;
+	indexCount += indexCount_;
+}
+
+void MeshBuffer::Grow(unsigned int vertexCapacity_, unsigned int indexCapacity_)
+{
+	unsigned int buffers[2];
+	glGenBuffers(2, buffers);
+
+	GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, buffers[0]);
+	glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity_ * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+
+	// The old contents are copied on the GPU, the vertices never have to come back to the CPU
+	if (vertexCount > 0)
+	{
+		GLStateCache::BindBuffer(GL_COPY_READ_BUFFER, VBO);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, vertexCount * sizeof(Vertex));
+	}
+
+	GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, buffers[1]);
+	glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity_ * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+
+	if (indexCount > 0)
+	{
+		GLStateCache::BindBuffer(GL_COPY_READ_BUFFER, EBO);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, indexCount * sizeof(unsigned int));
+	}
+
+	GLStateCache::BindBuffer(GL_COPY_READ_BUFFER, 0);
+	GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	GLStateCache::DeleteBuffers(1, &VBO);
+	GLStateCache::DeleteBuffers(1, &EBO);
+
+	VBO = buffers[0];
+	EBO = buffers[1];
+
+	vertexCapacity = vertexCapacity_;
+	indexCapacity = indexCapacity_;
+
+	/* The vertex array stays the same, so anything else that was set on it (like the instance attributes of the instancing
+	technique) keeps working, only the attributes read from the vertex buffer are pointed at the new one */
+	if (VAO == NULL)
+		glGenVertexArrays(1, &VAO);
+
+	GLStateCache::BindVertexArray(VAO);
+
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, VBO);
+	SetVertexAttributes();
+
+	GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+	GLStateCache::BindVertexArray(0);
+}
+
+void MeshBuffer::SetVertexAttributes()
+{
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, meshNormal));
+	glEnableVertexAttribArray(1);
+
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, meshTextureCoordinates));
+	glEnableVertexAttribArray(2);
+}
+
+void MeshBuffer::BeginStaging()
+{
+	if (VAO == NULL && vertexCount == 0)
+		staging = true;
+}
+
+void MeshBuffer::TakeStagedData(vector<unsigned char>& vertexData_, vector<unsigned char>& indexData_)
+{
+	vertexData_.swap(stagedVertices);
+	indexData_.swap(stagedIndices);
+
+	stagedVertices.clear();
+	stagedIndices.clear();
+}
+
+void MeshBuffer::AdoptBuffers(unsigned int VBO_, unsigned int EBO_)
+{
+	staging = false;
+
+	VBO = VBO_;
+	EBO = EBO_;
+
+	// The buffers were created exactly as large as the staged meshes
+	vertexCapacity = vertexCount;
+	indexCapacity = indexCount;
+
+	glGenVertexArrays(1, &VAO);
+
+	GLStateCache::BindVertexArray(VAO);
+
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, VBO);
+	SetVertexAttributes();
+
+	GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+	GLStateCache::BindVertexArray(0);
+}
+
+bool MeshBuffer::IsStaging() const
+{
+	return staging;
+}
+
+void MeshBuffer::DeleteBuffer()
+{
+	GLStateCache::DeleteVertexArrays(1, &VAO);
+	GLStateCache::DeleteBuffers(1, &VBO);
+	GLStateCache::DeleteBuffers(1, &EBO);
+
+	VAO = NULL;
+	VBO = NULL;
+	EBO = NULL;
+
+	vertexCount = 0;
+	indexCount = 0;
+
+	vertexCapacity = 0;
+	indexCapacity = 0;
+
+	staging = false;
+	vector<unsigned char>().swap(stagedVertices);
+	vector<unsigned char>().swap(stagedIndices);
+}
+
+size_t MeshBuffer::GetBufferSize() const
+{
+	return vertexCapacity * sizeof(Vertex) + indexCapacity * sizeof(unsigned int);
+}
+
+bool MeshBuffer::SupportsMultiDrawIndirect()
+{
+	if (multiDrawIndirectQueried)
+		return multiDrawIndirectSupported && multiDrawIndirectEnabled;
+
+	multiDrawIndirectQueried = true;
+
+	int majorVersion = 0, minorVersion = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+	glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+	// Core since OpenGL 4.3, before that only with the extension (which needs ARB_draw_indirect for the buffer target)
+	bool supported = majorVersion > 4 || (majorVersion == 4 && minorVersion >= 3);
+
+	if (!supported)
+	{
+		int extensionCount = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+
+		for (int i = 0; i < extensionCount; i++)
+		{
+			const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+
+			if (strcmp(extension, "GL_ARB_multi_draw_indirect") == 0)
+			{
+				supported = true;
+				break;
+			}
+		}
+	}
+
+	if (supported)
+	{
+		multiDrawElementsIndirect =
+			reinterpret_cast<MultiDrawElementsIndirectProc>(glfwGetProcAddress("glMultiDrawElementsIndirect"));
+
+		multiDrawIndirectSupported = multiDrawElementsIndirect != nullptr;
+	}
+
+	return multiDrawIndirectSupported && multiDrawIndirectEnabled;
+}
+
+void MeshBuffer::MultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount,
+	GLsizei stride)
+{
+	multiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+}
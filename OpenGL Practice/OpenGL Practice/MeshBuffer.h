@@ -0,0 +1,108 @@
+#pragma once
+
+#ifndef MESH_BUFFER_H
+#define MESH_BUFFER_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+struct Vertex;
+
+// Not part of OpenGL 3.3, so GLAD might not define it
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+using namespace std;
+
+/* Every mesh used to have its own vertex array, vertex buffer and element buffer, so drawing a model bound a different
+vertex array for every mesh and issued one glDrawElements each. A mesh buffer holds the vertices and indices of many
+meshes one after the other in one vertex buffer and one element buffer, described by a single vertex array. Every mesh
+keeps its indices relative to its own first vertex and is drawn with a base vertex (glDrawElementsBaseVertex), so the
+indices never have to be rewritten when a mesh is added.
+
+Since all the meshes share the vertex array, every mesh that uses the same textures can be drawn with one
+glMultiDrawElementsBaseVertex call, or with glMultiDrawElementsIndirect where the driver supports it (OpenGL 4.3 or
+ARB_multi_draw_indirect). A buffer can be shared by several models as well, as long as they are all full float meshes.
+Compact meshes (see CompactVertex) keep their own buffers, each of them needs its own decoding uniforms anyway */
+
+// The layout glMultiDrawElementsIndirect reads every draw from
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+class MeshBuffer
+{
+public:
+	MeshBuffer();
+
+	// Makes room for this many more vertices and indices, so adding the meshes afterwards doesn't grow the buffers again
+	void Reserve(unsigned int vertexCount_, unsigned int indexCount_);
+
+	/* Copies a mesh's vertices and indices to the end of the buffers and returns where they start (in vertices and in
+	indices). Grows the buffers if they're full, which copies what's already in them on the GPU */
+	void Allocate(const Vertex* vertices_, unsigned int vertexCount_, const unsigned int* indices_,
+		unsigned int indexCount_, int& baseVertex_, unsigned int& firstIndex_);
+
+	/* Makes Allocate copy the meshes into memory instead of the buffers, so the buffers can be created somewhere else
+	(on the asset loader's thread). Only for a buffer that's still empty */
+	void BeginStaging();
+
+	// Hands over everything allocated since BeginStaging, nothing can be added after this until AdoptBuffers
+	void TakeStagedData(vector<unsigned char>& vertexData_, vector<unsigned char>& indexData_);
+
+	/* Takes over a vertex and an element buffer that hold the staged meshes and creates the vertex array for them. Vertex
+	arrays aren't shared between contexts, so this has to run on the main thread */
+	void AdoptBuffers(unsigned int VBO_, unsigned int EBO_);
+
+	bool IsStaging() const;
+
+	// Deletes the vertex array and buffers, every mesh in the buffer can't be drawn anymore afterwards
+	void DeleteBuffer();
+
+	// Size of the vertex and element buffers on the GPU (in bytes), including the space that isn't used yet
+	size_t GetBufferSize() const;
+
+	// Checks for glMultiDrawElementsIndirect the first time it's called, has to be called on the main thread
+	static bool SupportsMultiDrawIndirect();
+
+	// Draws commands from the bound GL_DRAW_INDIRECT_BUFFER, only call it if SupportsMultiDrawIndirect returned true
+	static void MultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount,
+		GLsizei stride = 0);
+
+	// Allows turning indirect drawing off, models draw with glMultiDrawElementsBaseVertex then
+	static bool multiDrawIndirectEnabled;
+
+	unsigned int VAO;
+
+	// Used vertices and indices
+	unsigned int vertexCount, indexCount;
+
+private:
+	// Moves the contents into larger buffers and points the vertex array at them
+	void Grow(unsigned int vertexCapacity_, unsigned int indexCapacity_);
+
+	// Describes the Vertex layout in the vertex array, for the vertex buffer that's bound to GL_ARRAY_BUFFER
+	void SetVertexAttributes();
+
+	unsigned int VBO, EBO;
+
+	// Vertices and indices the buffers have room for
+	unsigned int vertexCapacity, indexCapacity;
+
+	// Between BeginStaging and AdoptBuffers the meshes are only copied into these
+	bool staging;
+	vector<unsigned char> stagedVertices, stagedIndices;
+
+	static bool multiDrawIndirectQueried;
+	static bool multiDrawIndirectSupported;
+};
+
+#endif
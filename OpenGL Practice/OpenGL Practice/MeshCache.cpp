@@ -0,0 +1,476 @@
+#include "MeshCache.h"
+
+#include <glfw3.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <cstring>
+#include <cctype>
+
+// Instantiate static variables
+string MeshCache::cacheDirectory = "MeshCache";
+bool MeshCache::enabled = true;
+
+unsigned int MeshCache::modelsLoaded = 0;
+unsigned int MeshCache::modelsImported = 0;
+
+double MeshCache::loadTime = 0.0;
+double MeshCache::importTime = 0.0;
+double MeshCache::savedImportTime = 0.0;
+
+/* Every cache file starts with this header, followed by dependencyCount dependencies (each a MeshCacheDependency and
+the file's path) and then meshCount meshes. Each mesh is a MeshCacheEntry, then its vertices, then its indices, then its
+textures (type and path, each stored as a length followed by the characters and padded to 4 bytes), and finally its
+levels of detail. The nodeCount nodes follow the meshes, each a MeshCacheNode and its
+name. Everything stays 4 byte aligned so the vertices and indices can be used in place */
+struct MeshCacheHeader
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int importFlags;
+	unsigned int vertexSize;
+	unsigned long long sourceSize;
+	long long sourceWriteTime;
+	double importTime;
+	unsigned int dependencyCount;
+	unsigned int meshCount;
+	unsigned int nodeCount;
+};
+
+// The stamp of a file the import read besides the source model (like an .obj's .mtl files)
+struct MeshCacheDependency
+{
+	unsigned long long size;
+	long long writeTime;
+};
+
+struct MeshCacheEntry
+{
+	unsigned int vertexCount;
+	unsigned int indexCount;
+	unsigned int textureCount;
+	unsigned int lodCount;
+	unsigned int node;
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+struct MeshCacheNode
+{
+	int parent;
+	float localTransform[16];
+};
+
+// "MSHC" in little endian, bump the version whenever the file layout changes so old files are rebuilt
+const unsigned int MESH_CACHE_MAGIC = 0x4348534D;
+const unsigned int MESH_CACHE_VERSION = 6;
+
+// Walks through the mapped bytes and refuses to read past the end, so a truncated file is rejected instead of crashing
+class MeshCacheReader
+{
+public:
+	MeshCacheReader(const unsigned char* data_, size_t size_) : data(data_), size(size_), offset(0) { }
+
+	const unsigned char* Read(size_t byteCount)
+	{
+		if (byteCount > size - offset)
+			return nullptr;
+
+		const unsigned char* bytes = data + offset;
+
+		// Keep every following read 4 byte aligned
+		offset += (byteCount + 3) & ~static_cast<size_t>(3);
+
+		if (offset > size)
+			offset = size;
+
+		return bytes;
+	}
+
+	bool ReadString(string& text)
+	{
+		const unsigned char* length = Read(sizeof(unsigned int));
+
+		if (length == nullptr)
+			return false;
+
+		unsigned int textLength;
+		memcpy(&textLength, length, sizeof(unsigned int));
+
+		const unsigned char* characters = Read(textLength);
+
+		if (characters == nullptr)
+			return false;
+
+		text.assign(reinterpret_cast<const char*>(characters), textLength);
+		return true;
+	}
+
+private:
+	const unsigned char* data;
+	size_t size, offset;
+};
+
+static void WritePadding(ofstream& file, size_t byteCount)
+{
+	static const char zeros[4] = { 0, 0, 0, 0 };
+	file.write(zeros, (4 - byteCount % 4) % 4);
+}
+
+static void WriteString(ofstream& file, const string& text)
+{
+	unsigned int textLength = static_cast<unsigned int>(text.size());
+
+	file.write(reinterpret_cast<const char*>(&textLength), sizeof(unsigned int));
+	file.write(text.data(), textLength);
+	WritePadding(file, textLength);
+}
+
+/* Finds the other files Assimp reads when it imports the source model. The material texture paths in the cache come
+from an .obj's material libraries, so the cache has to be rebuilt when one of those changes too */
+static void FindImportDependencies(const string& sourcePath, vector<string>& dependencies)
+{
+	dependencies.clear();
+
+	filesystem::path source(sourcePath);
+	string extension = source.extension().string();
+
+	for (unsigned int i = 0; i < extension.size(); i++)
+	{
+		extension[i] = static_cast<char>(tolower(static_cast<unsigned char>(extension[i])));
+	}
+
+	if (extension != ".obj")
+		return;
+
+	ifstream file(sourcePath);
+	string line;
+
+	while (getline(file, line))
+	{
+		size_t start = line.find_first_not_of(" \t");
+
+		if (start == string::npos || line.compare(start, 6, "mtllib") != 0)
+			continue;
+
+		// Like Assimp, the rest of the line is the library's file name, relative to the .obj
+		size_t nameStart = line.find_first_not_of(" \t", start + 6);
+		size_t nameEnd = line.find_last_not_of(" \t\r");
+
+		if (nameStart == string::npos || nameStart == start + 6)
+			continue;
+
+		dependencies.push_back((source.parent_path() / line.substr(nameStart, nameEnd - nameStart + 1)).string());
+	}
+}
+
+bool MeshCache::LoadModel(const string& sourcePath, unsigned int importFlags, MappedFile& file,
+	vector<MeshCacheView>& meshes, NodeTable& nodes)
+{
+	if (!enabled)
+		return false;
+
+	double startTime = glfwGetTime();
+
+	unsigned long long sourceSize;
+	long long sourceWriteTime;
+
+	if (!GetSourceStamp(sourcePath, sourceSize, sourceWriteTime))
+		return false;
+
+	if (!file.Open(GetCacheFilePath(sourcePath)))
+		return false;
+
+	MeshCacheReader reader(file.GetData(), file.GetSize());
+
+	const unsigned char* headerBytes = reader.Read(sizeof(MeshCacheHeader));
+
+	if (headerBytes == nullptr)
+	{
+		file.Close();
+		return false;
+	}
+
+	MeshCacheHeader header;
+	memcpy(&header, headerBytes, sizeof(MeshCacheHeader));
+
+	// An old cache version, a different vertex layout or import, or a source model that changed since the cache was built
+	if (header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION || header.importFlags != importFlags ||
+		header.vertexSize != sizeof(Vertex) || header.sourceSize != sourceSize || header.sourceWriteTime != sourceWriteTime)
+	{
+		file.Close();
+		return false;
+	}
+
+	// A material library (or another file the import read) changed since the cache was built
+	for (unsigned int i = 0; i < header.dependencyCount; i++)
+	{
+		const unsigned char* dependencyBytes = reader.Read(sizeof(MeshCacheDependency));
+		string dependencyPath;
+
+		if (dependencyBytes == nullptr || !reader.ReadString(dependencyPath))
+		{
+			file.Close();
+			return false;
+		}
+
+		MeshCacheDependency dependency;
+		memcpy(&dependency, dependencyBytes, sizeof(MeshCacheDependency));
+
+		unsigned long long dependencySize;
+		long long dependencyWriteTime;
+
+		// A dependency that's gone now changes the import just as much as one that was edited
+		if (!GetSourceStamp(dependencyPath, dependencySize, dependencyWriteTime) || dependency.size != dependencySize ||
+			dependency.writeTime != dependencyWriteTime)
+		{
+			file.Close();
+			return false;
+		}
+	}
+
+	meshes.clear();
+	meshes.reserve(header.meshCount);
+
+	for (unsigned int i = 0; i < header.meshCount; i++)
+	{
+		const unsigned char* entryBytes = reader.Read(sizeof(MeshCacheEntry));
+
+		if (entryBytes == nullptr)
+			break;
+
+		MeshCacheEntry entry;
+		memcpy(&entry, entryBytes, sizeof(MeshCacheEntry));
+
+		MeshCacheView mesh;
+		mesh.vertexCount = entry.vertexCount;
+		mesh.indexCount = entry.indexCount;
+		mesh.boundsMin = vec3(entry.boundsMin[0], entry.boundsMin[1], entry.boundsMin[2]);
+		mesh.boundsMax = vec3(entry.boundsMax[0], entry.boundsMax[1], entry.boundsMax[2]);
+		mesh.node = entry.node;
+
+		mesh.vertices = reinterpret_cast<const Vertex*>(reader.Read(static_cast<size_t>(entry.vertexCount) * sizeof(Vertex)));
+		mesh.indices = reinterpret_cast<const unsigned int*>(reader.Read(static_cast<size_t>(entry.indexCount) *
+			sizeof(unsigned int)));
+
+		if (mesh.vertices == nullptr || mesh.indices == nullptr)
+			break;
+
+		bool texturesRead = true;
+
+		for (unsigned int j = 0; j < entry.textureCount && texturesRead; j++)
+		{
+			MeshCacheTexture texture;
+			texturesRead = reader.ReadString(texture.textureType) && reader.ReadString(texture.texturePath);
+
+			mesh.textures.push_back(texture);
+		}
+
+		if (!texturesRead)
+			break;
+
+		const MeshLOD* lods = reinterpret_cast<const MeshLOD*>(reader.Read(static_cast<size_t>(entry.lodCount) *
+			sizeof(MeshLOD)));
+
+		if (lods == nullptr)
+			break;
+
+		mesh.lods.assign(lods, lods + entry.lodCount);
+
+		meshes.push_back(mesh);
+	}
+
+	nodes.Clear();
+
+	for (unsigned int i = 0; i < header.nodeCount && meshes.size() == header.meshCount; i++)
+	{
+		const unsigned char* nodeBytes = reader.Read(sizeof(MeshCacheNode));
+		string name;
+
+		if (nodeBytes == nullptr || !reader.ReadString(name))
+			break;
+
+		MeshCacheNode node;
+		memcpy(&node, nodeBytes, sizeof(MeshCacheNode));
+
+		mat4 localTransform;
+		memcpy(&localTransform[0][0], node.localTransform, sizeof(node.localTransform));
+
+		nodes.AddNode(name, node.parent, localTransform);
+	}
+
+	// A truncated file, treat it as if there was no cache at all
+	if (meshes.size() != header.meshCount || nodes.GetNodeCount() != header.nodeCount)
+	{
+		cout << "MESH_CACHE: " << GetCacheFilePath(sourcePath) << " is damaged, importing " << sourcePath << " again" << endl;
+
+		meshes.clear();
+		nodes.Clear();
+		file.Close();
+
+		return false;
+	}
+
+	modelsLoaded++;
+	loadTime += glfwGetTime() - startTime;
+	savedImportTime += header.importTime;
+
+	return true;
+}
+
+void MeshCache::SaveModel(const string& sourcePath, unsigned int importFlags, const vector<Mesh>& meshes,
+	const vector<unsigned int>& meshNodes, const NodeTable& nodes, double importTime_)
+{
+	modelsImported++;
+	importTime += importTime_;
+
+	if (!enabled)
+		return;
+
+	MeshCacheHeader header;
+	header.magic = MESH_CACHE_MAGIC;
+	header.version = MESH_CACHE_VERSION;
+	header.importFlags = importFlags;
+	header.vertexSize = sizeof(Vertex);
+	header.importTime = importTime_;
+	header.meshCount = static_cast<unsigned int>(meshes.size());
+	header.nodeCount = nodes.GetNodeCount();
+
+	if (!GetSourceStamp(sourcePath, header.sourceSize, header.sourceWriteTime))
+		return;
+
+	vector<string> dependencyPaths;
+	FindImportDependencies(sourcePath, dependencyPaths);
+
+	// A library the .obj names but that doesn't exist is skipped, Assimp imports the model without it as well
+	vector<MeshCacheDependency> dependencies;
+
+	for (unsigned int i = 0; i < dependencyPaths.size(); i++)
+	{
+		MeshCacheDependency dependency;
+
+		if (GetSourceStamp(dependencyPaths[i], dependency.size, dependency.writeTime))
+			dependencies.push_back(dependency);
+		else
+			dependencyPaths.erase(dependencyPaths.begin() + i--);
+	}
+
+	header.dependencyCount = static_cast<unsigned int>(dependencies.size());
+
+	error_code errorCode;
+	filesystem::create_directories(cacheDirectory, errorCode);
+
+	ofstream file(GetCacheFilePath(sourcePath), ios::binary | ios::trunc);
+
+	if (!file.is_open())
+	{
+		cout << "MESH_CACHE: Failed to write " << GetCacheFilePath(sourcePath) << endl;
+		return;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	for (unsigned int i = 0; i < dependencies.size(); i++)
+	{
+		file.write(reinterpret_cast<const char*>(&dependencies[i]), sizeof(MeshCacheDependency));
+		WriteString(file, dependencyPaths[i]);
+	}
+
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		const Mesh& mesh = meshes[i];
+
+		MeshCacheEntry entry;
+		entry.vertexCount = static_cast<unsigned int>(mesh.vertices.size());
+		entry.indexCount = static_cast<unsigned int>(mesh.indices.size());
+		entry.textureCount = static_cast<unsigned int>(mesh.textures.size());
+		entry.lodCount = static_cast<unsigned int>(mesh.lods.size());
+		entry.node = meshNodes[i];
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			entry.boundsMin[axis] = mesh.boundsMin[axis];
+			entry.boundsMax[axis] = mesh.boundsMax[axis];
+		}
+
+		file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+		file.write(reinterpret_cast<const char*>(mesh.vertices.data()), mesh.vertices.size() * sizeof(Vertex));
+		file.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size() * sizeof(unsigned int));
+
+		for (unsigned int j = 0; j < mesh.textures.size(); j++)
+		{
+			WriteString(file, mesh.textures[j].textureType);
+			WriteString(file, mesh.textures[j].texturePath);
+		}
+
+		file.write(reinterpret_cast<const char*>(mesh.lods.data()), mesh.lods.size() * sizeof(MeshLOD));
+	}
+
+	for (unsigned int i = 0; i < nodes.GetNodeCount(); i++)
+	{
+		MeshCacheNode node;
+		node.parent = nodes.parents[i];
+		memcpy(node.localTransform, &nodes.localTransforms[i][0][0], sizeof(node.localTransform));
+
+		file.write(reinterpret_cast<const char*>(&node), sizeof(node));
+		WriteString(file, nodes.names[i]);
+	}
+
+	if (!file)
+	{
+		cout << "MESH_CACHE: Failed to write " << GetCacheFilePath(sourcePath) << endl;
+
+		// Don't leave half a file behind, the size check would catch it but there's no reason to keep it
+		file.close();
+		filesystem::remove(GetCacheFilePath(sourcePath), errorCode);
+	}
+}
+
+void MeshCache::PrintStatistics()
+{
+	if (modelsLoaded + modelsImported == 0)
+		return;
+
+	cout << "MESH_CACHE: " << modelsLoaded << " models loaded from the cache in " << loadTime * 1000.0 << " ms (importing "
+		"them took " << savedImportTime * 1000.0 << " ms), " << modelsImported << " imported with Assimp in " <<
+		importTime * 1000.0 << " ms" << endl;
+}
+
+string MeshCache::GetCacheFilePath(const string& sourcePath)
+{
+	// FNV-1a of the source path, so every model gets its own file no matter how deep its directory is
+	unsigned long long hash = 14695981039346656037ULL;
+
+	for (unsigned int i = 0; i < sourcePath.size(); i++)
+	{
+		hash ^= static_cast<unsigned char>(sourcePath[i]);
+		hash *= 1099511628211ULL;
+	}
+
+	stringstream path;
+	path << cacheDirectory << "/" << filesystem::path(sourcePath).stem().string() << "_" << hex << setw(16) <<
+		setfill('0') << hash << ".mesh";
+
+	return path.str();
+}
+
+bool MeshCache::GetSourceStamp(const string& sourcePath, unsigned long long& sourceSize, long long& sourceWriteTime)
+{
+	error_code errorCode;
+
+	sourceSize = filesystem::file_size(sourcePath, errorCode);
+
+	if (errorCode)
+		return false;
+
+	filesystem::file_time_type writeTime = filesystem::last_write_time(sourcePath, errorCode);
+
+	if (errorCode)
+		return false;
+
+	sourceWriteTime = static_cast<long long>(writeTime.time_since_epoch().count());
+	return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <string>
+#include <vector>
+
+#include "Mesh.h"
+#include "MappedFile.h"
+#include "NodeTable.h"
+
+using namespace std;
+
+/* Importing a model with Assimp (parsing the .obj text, triangulating, calculating tangents...) takes far longer than
+actually uploading the result to the GPU, and we used to do it on every start for every model. After the first import
+the final vertex and index streams of every mesh are written to a binary cache file, together with the material texture
+paths, the bounds of each mesh and the model's node hierarchy. Later loads map that file into memory and hand the mapped
+bytes straight to glBufferData, without touching Assimp at all.
+
+A cache file belongs to one source model. It's thrown away and rebuilt whenever the size or last write time of the
+source file or of one of the files it pulls in (an .obj's .mtl material libraries) changes, the import flags change, the
+Vertex struct changes size, or the cache version is bumped */
+
+struct MeshCacheTexture
+{
+	string textureType;
+	string texturePath;
+};
+
+// A mesh read from a cache file, the vertices and indices point straight into the mapped file
+struct MeshCacheView
+{
+	const Vertex* vertices;
+	unsigned int vertexCount;
+
+	const unsigned int* indices;
+	unsigned int indexCount;
+
+	vector<MeshCacheTexture> textures;
+	vector<MeshLOD> lods;
+
+	vec3 boundsMin, boundsMax;
+
+	// Index of the node the mesh belongs to in the model's node table
+	unsigned int node;
+};
+
+class MeshCache
+{
+public:
+	/* Maps the cache file of a source model and fills in a view of every mesh and the node table, returns false if there's
+	no cache file or it's out of date (the model has to be imported with Assimp then). The views are only valid while the
+	file is open */
+	static bool LoadModel(const string& sourcePath, unsigned int importFlags, MappedFile& file,
+		vector<MeshCacheView>& meshes, NodeTable& nodes);
+
+	/* Writes the cache file of a source model that was just imported, meshNodes holds the node of every mesh and
+	importTime is how long the import took (in seconds) */
+	static void SaveModel(const string& sourcePath, unsigned int importFlags, const vector<Mesh>& meshes,
+		const vector<unsigned int>& meshNodes, const NodeTable& nodes, double importTime);
+
+	// Prints how long the models took to load this launch compared to importing them all with Assimp
+	static void PrintStatistics();
+
+	/* The size and last write time of a source file, returns false if the source doesn't exist. The texture compressor
+	uses the same stamp to tell whether its cache files are out of date */
+	static bool GetSourceStamp(const string& sourcePath, unsigned long long& sourceSize, long long& sourceWriteTime);
+
+	// Directory (relative to the working directory) where the cache files are stored
+	static string cacheDirectory;
+
+	// Allows turning the cache off completely, so every model is imported with Assimp like before
+	static bool enabled;
+
+private:
+	MeshCache() { }
+
+	static string GetCacheFilePath(const string& sourcePath);
+
+	static unsigned int modelsLoaded, modelsImported;
+
+	// Time spent this launch on models loaded from the cache and models imported with Assimp (in seconds)
+	static double loadTime, importTime;
+
+	// How long the models that were loaded from the cache took to import the last time
+	static double savedImportTime;
+};
+
+#endif
@@ -0,0 +1,433 @@
+#include "MeshOptimizer.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+// Instantiate static variables
+bool MeshOptimizer::reportStatistics = true;
+
+// Size of the LRU cache the Forsyth algorithm simulates, bigger than real caches so it also plans a little ahead
+const unsigned int FORSYTH_CACHE_SIZE = 32;
+
+// Size of the FIFO cache the statistics and the overdraw clusters are simulated with
+const unsigned int FIFO_CACHE_SIZE = 16;
+
+/* Forsyth's vertex score. Vertices that were used recently score higher (but the three vertices of the last triangle get
+a fixed lower score, drawing a triangle right next to the last one isn't always the best choice), and vertices with only
+a few triangles left get a boost so they're finished off and don't need to come back into the cache later */
+static float VertexScore(int cachePosition, unsigned int remainingTriangles)
+{
+	if (remainingTriangles == 0)
+		return -1.0f;
+
+	float score = 0.0f;
+
+	if (cachePosition >= 0)
+	{
+		if (cachePosition < 3)
+			score = 0.75f;
+
+		else
+			score = powf(1.0f - (cachePosition - 3) / static_cast<float>(FORSYTH_CACHE_SIZE - 3), 1.5f);
+	}
+
+	return score + 2.0f * powf(static_cast<float>(remainingTriangles), -0.5f);
+}
+
+MeshOptimizationStatistics MeshOptimizer::OptimizeMesh(vector<Vertex>& vertices, vector<unsigned int>& indices)
+{
+	MeshOptimizationStatistics statistics;
+	statistics.before = AnalyzeVertexCache(indices, static_cast<unsigned int>(vertices.size()));
+
+	OptimizeVertexCache(indices, static_cast<unsigned int>(vertices.size()));
+	OptimizeOverdraw(indices, vertices);
+	OptimizeVertexFetch(vertices, indices);
+
+	statistics.after = AnalyzeVertexCache(indices, static_cast<unsigned int>(vertices.size()));
+
+	return statistics;
+}
+
+void MeshOptimizer::OptimizeVertexCache(vector<unsigned int>& indices, unsigned int vertexCount)
+{
+	unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+
+	if (triangleCount == 0)
+		return;
+
+	// How many triangles that weren't added yet use each vertex
+	vector<unsigned int> remainingTriangles(vertexCount, 0);
+
+	for (unsigned int i = 0; i < triangleCount * 3; i++)
+	{
+		remainingTriangles[indices[i]]++;
+	}
+
+	/* The triangles of every vertex are stored back to back, vertex v's triangles start at adjacencyOffsets[v]. Added
+	triangles are swapped to the end of their vertex's range, so the first remainingTriangles[v] are always the ones left */
+	vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		adjacencyOffsets[i + 1] = adjacencyOffsets[i] + remainingTriangles[i];
+	}
+
+	vector<unsigned int> adjacency(triangleCount * 3);
+	vector<unsigned int> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+	for (unsigned int i = 0; i < triangleCount * 3; i++)
+	{
+		adjacency[adjacencyFill[indices[i]]++] = i / 3;
+	}
+
+	vector<int> cachePositions(vertexCount, -1);
+	vector<float> vertexScores(vertexCount);
+
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		vertexScores[i] = VertexScore(-1, remainingTriangles[i]);
+	}
+
+	vector<float> triangleScores(triangleCount);
+	vector<bool> triangleAdded(triangleCount, false);
+
+	int bestTriangle = 0;
+
+	for (unsigned int i = 0; i < triangleCount; i++)
+	{
+		triangleScores[i] = vertexScores[indices[i * 3]] + vertexScores[indices[i * 3 + 1]] +
+			vertexScores[indices[i * 3 + 2]];
+
+		if (triangleScores[i] > triangleScores[bestTriangle])
+			bestTriangle = i;
+	}
+
+	vector<unsigned int> cache, newCache;
+	cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+	vector<unsigned int> optimizedIndices;
+	optimizedIndices.reserve(triangleCount * 3);
+
+	unsigned int nextUnaddedTriangle = 0;
+
+	while (optimizedIndices.size() < triangleCount * 3)
+	{
+		// Nothing in the cache has triangles left, so continue with the next triangle that wasn't added yet
+		if (bestTriangle < 0)
+		{
+			while (triangleAdded[nextUnaddedTriangle])
+			{
+				nextUnaddedTriangle++;
+			}
+
+			bestTriangle = nextUnaddedTriangle;
+		}
+
+		const unsigned int* triangle = &indices[bestTriangle * 3];
+
+		optimizedIndices.insert(optimizedIndices.end(), triangle, triangle + 3);
+		triangleAdded[bestTriangle] = true;
+
+		newCache.clear();
+
+		for (unsigned int i = 0; i < 3; i++)
+		{
+			unsigned int vertex = triangle[i];
+
+			// Move the triangle to the end of the vertex's range of remaining triangles
+			unsigned int* vertexTriangles = &adjacency[adjacencyOffsets[vertex]];
+			unsigned int* lastTriangle = vertexTriangles + remainingTriangles[vertex] - 1;
+
+			swap(*find(vertexTriangles, lastTriangle + 1, static_cast<unsigned int>(bestTriangle)), *lastTriangle);
+			remainingTriangles[vertex]--;
+
+			// The triangle's vertices go to the front of the cache
+			if (find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+				newCache.push_back(vertex);
+		}
+
+		for (unsigned int i = 0; i < cache.size(); i++)
+		{
+			if (find(newCache.begin(), newCache.end(), cache[i]) == newCache.end())
+				newCache.push_back(cache[i]);
+		}
+
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+
+		// Update every vertex that moved in the cache (or fell out of it) and the triangles it still belongs to
+		for (unsigned int i = 0; i < newCache.size(); i++)
+		{
+			unsigned int vertex = newCache[i];
+			int cachePosition = i < FORSYTH_CACHE_SIZE ? static_cast<int>(i) : -1;
+
+			float score = VertexScore(cachePosition, remainingTriangles[vertex]);
+			float scoreChange = score - vertexScores[vertex];
+
+			cachePositions[vertex] = cachePosition;
+			vertexScores[vertex] = score;
+
+			for (unsigned int j = 0; j < remainingTriangles[vertex]; j++)
+			{
+				unsigned int vertexTriangle = adjacency[adjacencyOffsets[vertex] + j];
+				triangleScores[vertexTriangle] += scoreChange;
+
+				// Only triangles with a vertex in the cache are worth considering next
+				if (cachePosition >= 0 && triangleScores[vertexTriangle] > bestScore)
+				{
+					bestScore = triangleScores[vertexTriangle];
+					bestTriangle = vertexTriangle;
+				}
+			}
+		}
+
+		if (newCache.size() > FORSYTH_CACHE_SIZE)
+			newCache.resize(FORSYTH_CACHE_SIZE);
+
+		swap(cache, newCache);
+	}
+
+	indices.swap(optimizedIndices);
+}
+
+vector<unsigned int> MeshOptimizer::FindClusters(const vector<unsigned int>& indices, unsigned int vertexCount,
+	unsigned int cacheSize, float threshold)
+{
+	unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+
+	/* A FIFO cache can be simulated with one timestamp per vertex, a vertex is still in the cache if fewer than cacheSize
+	other vertices were added after it. Starting the clock at cacheSize + 1 makes every vertex miss the first time */
+	vector<unsigned int> cacheTimestamps(vertexCount, 0);
+	unsigned int timestamp = cacheSize + 1;
+
+	auto CountMisses = [&](unsigned int triangle)
+	{
+		unsigned int misses = 0;
+
+		for (unsigned int i = 0; i < 3; i++)
+		{
+			unsigned int vertex = indices[triangle * 3 + i];
+
+			if (timestamp - cacheTimestamps[vertex] > cacheSize)
+			{
+				cacheTimestamps[vertex] = timestamp++;
+				misses++;
+			}
+		}
+
+		return misses;
+	};
+
+	// Hard boundaries, a triangle where all three vertices miss is where the cache starts over anyway
+	vector<unsigned int> hardClusters;
+
+	for (unsigned int i = 0; i < triangleCount; i++)
+	{
+		if (CountMisses(i) == 3)
+			hardClusters.push_back(i);
+	}
+
+	hardClusters.push_back(triangleCount);
+
+	/* Soft boundaries, a hard cluster can be split again wherever the triangles so far already reach (close to) the ACMR of
+	the whole cluster, even if the cache is flushed right after them. Smaller clusters give the overdraw sort more to work
+	with */
+	vector<unsigned int> clusters;
+
+	for (unsigned int i = 0; i + 1 < hardClusters.size(); i++)
+	{
+		unsigned int start = hardClusters[i], end = hardClusters[i + 1];
+
+		// Flush the cache before measuring the cluster on its own
+		timestamp += cacheSize + 1;
+
+		unsigned int clusterMisses = 0;
+
+		for (unsigned int j = start; j < end; j++)
+		{
+			clusterMisses += CountMisses(j);
+		}
+
+		float targetACMR = threshold * clusterMisses / (end - start);
+
+		timestamp += cacheSize + 1;
+		clusters.push_back(start);
+
+		unsigned int runningMisses = 0, runningStart = start;
+
+		for (unsigned int j = start; j < end; j++)
+		{
+			runningMisses += CountMisses(j);
+
+			// Always keep a few triangles together, a single triangle trivially hits any target
+			if (j + 1 < end && j + 1 - runningStart >= 8 && runningMisses <= targetACMR * (j + 1 - runningStart))
+			{
+				clusters.push_back(j + 1);
+
+				runningMisses = 0;
+				runningStart = j + 1;
+				timestamp += cacheSize + 1;
+			}
+		}
+	}
+
+	return clusters;
+}
+
+void MeshOptimizer::OptimizeOverdraw(vector<unsigned int>& indices, const vector<Vertex>& vertices, float threshold)
+{
+	unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+
+	if (triangleCount == 0)
+		return;
+
+	unsigned int vertexCount = static_cast<unsigned int>(vertices.size());
+
+	vector<unsigned int> clusters = FindClusters(indices, vertexCount, FIFO_CACHE_SIZE, threshold);
+	clusters.push_back(triangleCount);
+
+	unsigned int clusterCount = static_cast<unsigned int>(clusters.size() - 1);
+
+	if (clusterCount < 2)
+		return;
+
+	// Area weighted center of the whole mesh, and the center and average normal of every cluster
+	vec3 meshCenter = vec3(0.0f);
+	float meshArea = 0.0f;
+
+	vector<vec3> clusterCenters(clusterCount, vec3(0.0f)), clusterNormals(clusterCount, vec3(0.0f));
+
+	for (unsigned int i = 0; i < clusterCount; i++)
+	{
+		float clusterArea = 0.0f;
+
+		for (unsigned int j = clusters[i]; j < clusters[i + 1]; j++)
+		{
+			const vec3& a = vertices[indices[j * 3]].meshPosition;
+			const vec3& b = vertices[indices[j * 3 + 1]].meshPosition;
+			const vec3& c = vertices[indices[j * 3 + 2]].meshPosition;
+
+			// The cross product's length is twice the triangle's area, so summing them weighs every normal by its area
+			vec3 normal = cross(b - a, c - a);
+			float area = length(normal);
+
+			clusterCenters[i] += (a + b + c) * (area / 3.0f);
+			clusterNormals[i] += normal;
+			clusterArea += area;
+		}
+
+		meshCenter += clusterCenters[i];
+		meshArea += clusterArea;
+
+		clusterCenters[i] = clusterArea > 0.0f ? clusterCenters[i] / clusterArea : vertices[indices[clusters[i] * 3]].meshPosition;
+	}
+
+	meshCenter = meshArea > 0.0f ? meshCenter / meshArea : vec3(0.0f);
+
+	// Clusters that are far out and face away from the center are the most likely to cover others, so they go first
+	vector<float> sortKeys(clusterCount);
+	vector<unsigned int> clusterOrder(clusterCount);
+
+	for (unsigned int i = 0; i < clusterCount; i++)
+	{
+		float normalLength = length(clusterNormals[i]);
+		vec3 normal = normalLength > 0.0f ? clusterNormals[i] / normalLength : vec3(0.0f);
+
+		sortKeys[i] = dot(clusterCenters[i] - meshCenter, normal);
+		clusterOrder[i] = i;
+	}
+
+	stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](unsigned int a, unsigned int b)
+	{
+		return sortKeys[a] > sortKeys[b];
+	});
+
+	vector<unsigned int> sortedIndices;
+	sortedIndices.reserve(indices.size());
+
+	for (unsigned int i = 0; i < clusterCount; i++)
+	{
+		unsigned int cluster = clusterOrder[i];
+		sortedIndices.insert(sortedIndices.end(), indices.begin() + clusters[cluster] * 3, indices.begin() +
+			clusters[cluster + 1] * 3);
+	}
+
+	// The soft boundaries only estimate the cost, so check the real ACMR before keeping the new order
+	float originalACMR = AnalyzeVertexCache(indices, vertexCount, FIFO_CACHE_SIZE).acmr;
+	float sortedACMR = AnalyzeVertexCache(sortedIndices, vertexCount, FIFO_CACHE_SIZE).acmr;
+
+	if (sortedACMR <= originalACMR * threshold)
+		indices.swap(sortedIndices);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(vector<Vertex>& vertices, vector<unsigned int>& indices)
+{
+	const unsigned int UNUSED = ~0u;
+
+	vector<unsigned int> remap(vertices.size(), UNUSED);
+
+	vector<Vertex> sortedVertices;
+	sortedVertices.reserve(vertices.size());
+
+	for (unsigned int i = 0; i < indices.size(); i++)
+	{
+		unsigned int& newIndex = remap[indices[i]];
+
+		if (newIndex == UNUSED)
+		{
+			newIndex = static_cast<unsigned int>(sortedVertices.size());
+			sortedVertices.push_back(vertices[indices[i]]);
+		}
+
+		indices[i] = newIndex;
+	}
+
+	vertices.swap(sortedVertices);
+}
+
+MeshCacheStatistics MeshOptimizer::AnalyzeVertexCache(const vector<unsigned int>& indices, unsigned int vertexCount,
+	unsigned int cacheSize)
+{
+	MeshCacheStatistics statistics = { 0.0f, 0.0f };
+
+	unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+
+	if (triangleCount == 0 || vertexCount == 0)
+		return statistics;
+
+	// Same timestamp trick as FindClusters
+	vector<unsigned int> cacheTimestamps(vertexCount, 0);
+	unsigned int timestamp = cacheSize + 1;
+
+	unsigned int misses = 0;
+
+	for (unsigned int i = 0; i < triangleCount * 3; i++)
+	{
+		unsigned int vertex = indices[i];
+
+		if (timestamp - cacheTimestamps[vertex] > cacheSize)
+		{
+			cacheTimestamps[vertex] = timestamp++;
+			misses++;
+		}
+	}
+
+	statistics.acmr = static_cast<float>(misses) / triangleCount;
+	statistics.atvr = static_cast<float>(misses) / vertexCount;
+
+	return statistics;
+}
+
+void MeshOptimizer::PrintStatistics(const string& modelPath, unsigned int meshIndex,
+	const MeshOptimizationStatistics& statistics)
+{
+	if (!reportStatistics)
+		return;
+
+	cout << "MESH_OPTIMIZER: " << modelPath << " mesh " << meshIndex << fixed << setprecision(3) << ": ACMR " <<
+		statistics.before.acmr << " -> " << statistics.after.acmr << ", ATVR " << statistics.before.atvr << " -> " <<
+		statistics.after.atvr << defaultfloat << endl;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <vector>
+#include <string>
+
+#include "Mesh.h"
+
+using namespace std;
+
+/* Assimp hands us the triangles in whatever order they were stored in the model file, which is rarely a good order for
+the GPU. After the vertex shader runs, its results are kept in a small post-transform cache, so a vertex shared by
+several triangles that are drawn close together only has to be shaded once. The optimizer runs three passes at import
+time, in this order:
+
+1. Vertex cache: Tom Forsyth's linear-speed algorithm greedily picks the next triangle whose vertices are either still in
+   a simulated cache or about to run out of triangles, so the cache gets as many hits as possible.
+2. Overdraw: the cache friendly order is cut into clusters wherever the cache would start from scratch anyway, and the
+   clusters are sorted so that the ones facing away from the center of the mesh (more likely to be in front) are drawn
+   first. The depth test then rejects more of the hidden pixels before their fragment shader runs. A cluster order is
+   only kept if it doesn't make the cache hit rate noticeably worse.
+3. Vertex fetch: the vertices are renumbered in the order the triangles first use them, so the vertex fetch reads the
+   vertex buffer front to back instead of jumping around in it.
+
+Two numbers describe how well the cache is used (both simulated with a FIFO cache like most GPUs have):
+ACMR (average cache miss ratio) = shaded vertices / triangles, 0.5 is the best possible for large grids, 3 is the worst
+ATVR (average transformed vertex ratio) = shaded vertices / vertices, 1 is the best possible */
+
+struct MeshCacheStatistics
+{
+	float acmr;
+	float atvr;
+};
+
+// Cache statistics of one mesh before and after it was optimized
+struct MeshOptimizationStatistics
+{
+	MeshCacheStatistics before;
+	MeshCacheStatistics after;
+};
+
+class MeshOptimizer
+{
+public:
+	// Runs all three passes on a mesh, safe to call on worker threads
+	static MeshOptimizationStatistics OptimizeMesh(vector<Vertex>& vertices, vector<unsigned int>& indices);
+
+	// Reorders the triangles for the post-transform vertex cache
+	static void OptimizeVertexCache(vector<unsigned int>& indices, unsigned int vertexCount);
+
+	/* Reorders clusters of triangles so the outer ones are drawn first, threshold is how much worse (1.05 = 5%) the ACMR
+	is allowed to get. Expects indices that are already optimized for the vertex cache */
+	static void OptimizeOverdraw(vector<unsigned int>& indices, const vector<Vertex>& vertices, float threshold = 1.05f);
+
+	// Renumbers the vertices in the order they're first used, unused vertices are dropped
+	static void OptimizeVertexFetch(vector<Vertex>& vertices, vector<unsigned int>& indices);
+
+	// Simulates a FIFO post-transform cache with cacheSize entries
+	static MeshCacheStatistics AnalyzeVertexCache(const vector<unsigned int>& indices, unsigned int vertexCount,
+		unsigned int cacheSize = 16);
+
+	// Prints the statistics of one imported mesh
+	static void PrintStatistics(const string& modelPath, unsigned int meshIndex, const MeshOptimizationStatistics& statistics);
+
+	// Allows turning off the per mesh report (the import benchmark imports the same models over and over)
+	static bool reportStatistics;
+
+private:
+	MeshOptimizer() { }
+
+	// Splits the triangles wherever every vertex of a triangle misses the cache, returns the first triangle of each cluster
+	static vector<unsigned int> FindClusters(const vector<unsigned int>& indices, unsigned int vertexCount,
+		unsigned int cacheSize, float threshold);
+};
+
+#endif
@@ -0,0 +1,505 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+
+// Levels of detail with fewer triangles than this aren't worth an extra draw range
+const unsigned int MIN_LOD_TRIANGLES = 16;
+
+// Symmetric 4x4 matrix of a quadric, only the upper half is stored
+struct Quadric
+{
+	double a00, a01, a02, a03;
+	double a11, a12, a13;
+	double a22, a23;
+	double a33;
+
+	// Total area of the planes, dividing by it turns the error into an average squared distance
+	double weight;
+};
+
+// One candidate edge collapse, moving vertex from onto vertex to
+struct EdgeCollapse
+{
+	unsigned int from, to;
+	float error;
+};
+
+static void AddQuadric(Quadric& quadric, const Quadric& other)
+{
+	quadric.a00 += other.a00; quadric.a01 += other.a01; quadric.a02 += other.a02; quadric.a03 += other.a03;
+	quadric.a11 += other.a11; quadric.a12 += other.a12; quadric.a13 += other.a13;
+	quadric.a22 += other.a22; quadric.a23 += other.a23;
+	quadric.a33 += other.a33;
+
+	quadric.weight += other.weight;
+}
+
+// Quadric of the plane through a triangle, weighted by the triangle's area
+static Quadric TriangleQuadric(const vec3& p0, const vec3& p1, const vec3& p2)
+{
+	Quadric quadric;
+	memset(&quadric, 0, sizeof(Quadric));
+
+	vec3 normal = cross(p1 - p0, p2 - p0);
+	double doubleArea = length(normal);
+
+	if (doubleArea == 0.0)
+		return quadric;
+
+	double a = normal.x / doubleArea, b = normal.y / doubleArea, c = normal.z / doubleArea;
+	double d = -(a * p0.x + b * p0.y + c * p0.z);
+	double weight = doubleArea * 0.5;
+
+	quadric.a00 = weight * a * a; quadric.a01 = weight * a * b; quadric.a02 = weight * a * c; quadric.a03 = weight * a * d;
+	quadric.a11 = weight * b * b; quadric.a12 = weight * b * c; quadric.a13 = weight * b * d;
+	quadric.a22 = weight * c * c; quadric.a23 = weight * c * d;
+	quadric.a33 = weight * d * d;
+
+	quadric.weight = weight;
+
+	return quadric;
+}
+
+// Area weighted sum of the squared distances from the point to every plane in the quadric
+static double EvaluateQuadric(const Quadric& quadric, const vec3& point)
+{
+	double x = point.x, y = point.y, z = point.z;
+
+	return quadric.a00 * x * x + 2.0 * quadric.a01 * x * y + 2.0 * quadric.a02 * x * z + 2.0 * quadric.a03 * x +
+		quadric.a11 * y * y + 2.0 * quadric.a12 * y * z + 2.0 * quadric.a13 * y +
+		quadric.a22 * z * z + 2.0 * quadric.a23 * z +
+		quadric.a33;
+}
+
+// Distance from a point to the closest point of a triangle (Ericson, "Real-Time Collision Detection" 5.1.5)
+static float PointTriangleDistance(const vec3& point, const vec3& a, const vec3& b, const vec3& c)
+{
+	vec3 ab = b - a, ac = c - a, ap = point - a;
+
+	float d1 = dot(ab, ap), d2 = dot(ac, ap);
+
+	if (d1 <= 0.0f && d2 <= 0.0f)
+		return length(point - a);
+
+	vec3 bp = point - b;
+	float d3 = dot(ab, bp), d4 = dot(ac, bp);
+
+	if (d3 >= 0.0f && d4 <= d3)
+		return length(point - b);
+
+	float vc = d1 * d4 - d3 * d2;
+
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+		return length(point - (a + ab * (d1 / (d1 - d3))));
+
+	vec3 cp = point - c;
+	float d5 = dot(ab, cp), d6 = dot(ac, cp);
+
+	if (d6 >= 0.0f && d5 <= d6)
+		return length(point - c);
+
+	float vb = d5 * d2 - d1 * d6;
+
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+		return length(point - (a + ac * (d2 / (d2 - d6))));
+
+	float va = d3 * d6 - d5 * d4;
+
+	if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+		return length(point - (b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)))));
+
+	// Inside the triangle, the closest point is straight down onto its plane
+	float denominator = 1.0f / (va + vb + vc);
+	return length(point - (a + ab * (vb * denominator) + ac * (vc * denominator)));
+}
+
+// Vertices with the same position but different normals or texture coordinates share one position entry
+struct PositionHash
+{
+	size_t operator()(const vec3& position) const
+	{
+		unsigned int bits[3];
+		memcpy(bits, &position.x, sizeof(float));
+		memcpy(bits + 1, &position.y, sizeof(float));
+		memcpy(bits + 2, &position.z, sizeof(float));
+
+		return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+	}
+};
+
+struct PositionEqual
+{
+	bool operator()(const vec3& a, const vec3& b) const
+	{
+		return a.x == b.x && a.y == b.y && a.z == b.z;
+	}
+};
+
+vector<unsigned int> MeshSimplifier::Simplify(const vector<Vertex>& vertices, const vector<unsigned int>& indices,
+	unsigned int targetIndexCount, float maxError, float* error)
+{
+	vector<unsigned int> result(indices.begin(), indices.end() - indices.size() % 3);
+
+	float resultError = 0.0f;
+
+	unsigned int vertexCount = static_cast<unsigned int>(vertices.size());
+
+	/* Weld the vertices by position, the simplifier works on positions so the two sides of a texture seam move together.
+	The vertices sharing a position are called its wedges */
+	vector<unsigned int> positionIDs(vertexCount);
+	vector<vec3> positions;
+
+	unordered_map<vec3, unsigned int, PositionHash, PositionEqual> positionLookup;
+	positionLookup.reserve(vertexCount);
+
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		auto inserted = positionLookup.emplace(vertices[i].meshPosition, static_cast<unsigned int>(positions.size()));
+
+		if (inserted.second)
+			positions.push_back(vertices[i].meshPosition);
+
+		positionIDs[i] = inserted.first->second;
+	}
+
+	unsigned int positionCount = static_cast<unsigned int>(positions.size());
+
+	// Wedges of every position, stored back to back like the triangle lists below
+	vector<unsigned int> wedgeOffsets(positionCount + 1, 0), wedges(vertexCount);
+
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		wedgeOffsets[positionIDs[i] + 1]++;
+	}
+
+	for (unsigned int i = 0; i < positionCount; i++)
+	{
+		wedgeOffsets[i + 1] += wedgeOffsets[i];
+	}
+
+	vector<unsigned int> wedgeFill(wedgeOffsets.begin(), wedgeOffsets.end() - 1);
+
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		wedges[wedgeFill[positionIDs[i]]++] = i;
+	}
+
+	// An edge is on an open border if no triangle uses it in the other direction, those positions never move
+	vector<bool> locked(positionCount, false);
+	unordered_set<unsigned long long> directedEdges;
+
+	for (unsigned int i = 0; i < result.size(); i++)
+	{
+		unsigned long long a = positionIDs[result[i]], b = positionIDs[result[i - i % 3 + (i + 1) % 3]];
+		directedEdges.insert((a << 32) | b);
+	}
+
+	for (unsigned int i = 0; i < result.size(); i++)
+	{
+		unsigned long long a = positionIDs[result[i]], b = positionIDs[result[i - i % 3 + (i + 1) % 3]];
+
+		if (directedEdges.count((b << 32) | a) == 0)
+		{
+			locked[a] = true;
+			locked[b] = true;
+		}
+	}
+
+	vector<Quadric> quadrics(positionCount);
+	memset(quadrics.data(), 0, quadrics.size() * sizeof(Quadric));
+
+	for (unsigned int i = 0; i < result.size(); i += 3)
+	{
+		unsigned int a = positionIDs[result[i]], b = positionIDs[result[i + 1]], c = positionIDs[result[i + 2]];
+		Quadric quadric = TriangleQuadric(positions[a], positions[b], positions[c]);
+
+		AddQuadric(quadrics[a], quadric);
+		AddQuadric(quadrics[b], quadric);
+		AddQuadric(quadrics[c], quadric);
+	}
+
+	/* How far the surface around every position may have moved away from the original mesh so far. The quadrics only
+	order the collapses, this is what error and maxError are measured against */
+	vector<float> deviations(positionCount, 0.0f);
+
+	vector<unsigned int> wedgeRemap(vertexCount);
+	vector<unsigned int> triangleOffsets(positionCount + 1), triangles, triangleFill;
+	vector<EdgeCollapse> collapses;
+	vector<bool> touched(positionCount);
+
+	/* Every pass finds the cheapest collapses of the current mesh and does as many of them as it can, as long as they don't
+	touch each other. Each collapse locks the triangles around it for the rest of the pass, so the checks of a collapse are
+	never invalidated by another one in the same pass */
+	while (result.size() > targetIndexCount)
+	{
+		unsigned int triangleCount = static_cast<unsigned int>(result.size() / 3);
+
+		// Triangles around every position
+		fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+
+		for (unsigned int i = 0; i < result.size(); i++)
+		{
+			triangleOffsets[positionIDs[result[i]] + 1]++;
+		}
+
+		for (unsigned int i = 0; i < positionCount; i++)
+		{
+			triangleOffsets[i + 1] += triangleOffsets[i];
+		}
+
+		triangles.resize(result.size());
+		triangleFill.assign(triangleOffsets.begin(), triangleOffsets.end() - 1);
+
+		for (unsigned int i = 0; i < result.size(); i++)
+		{
+			triangles[triangleFill[positionIDs[result[i]]]++] = i / 3;
+		}
+
+		// Both directions of every edge, as long as the vertex that moves isn't locked
+		collapses.clear();
+
+		for (unsigned int i = 0; i < result.size(); i++)
+		{
+			unsigned int a = positionIDs[result[i]], b = positionIDs[result[i - i % 3 + (i + 1) % 3]];
+
+			unsigned int ends[2][2] = { { a, b }, { b, a } };
+
+			for (unsigned int j = 0; j < 2; j++)
+			{
+				unsigned int from = ends[j][0], to = ends[j][1];
+
+				if (locked[from] || from == to)
+					continue;
+
+				double weight = quadrics[from].weight + quadrics[to].weight;
+				double squaredError = EvaluateQuadric(quadrics[from], positions[to]) +
+					EvaluateQuadric(quadrics[to], positions[to]);
+
+				EdgeCollapse collapse;
+				collapse.from = from;
+				collapse.to = to;
+				collapse.error = weight > 0.0 ? static_cast<float>(sqrt(std::max(squaredError, 0.0) / weight)) : 0.0f;
+
+				collapses.push_back(collapse);
+			}
+		}
+
+		sort(collapses.begin(), collapses.end(), [](const EdgeCollapse& a, const EdgeCollapse& b)
+		{
+			return a.error < b.error;
+		});
+
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			wedgeRemap[i] = i;
+		}
+
+		fill(touched.begin(), touched.end(), false);
+
+		unsigned int collapseCount = 0;
+
+		for (unsigned int i = 0; i < collapses.size() && triangleCount * 3 > targetIndexCount; i++)
+		{
+			const EdgeCollapse& collapse = collapses[i];
+
+			if (touched[collapse.from] || touched[collapse.to])
+				continue;
+
+			const unsigned int* fromTriangles = &triangles[triangleOffsets[collapse.from]];
+			unsigned int fromTriangleCount = triangleOffsets[collapse.from + 1] - triangleOffsets[collapse.from];
+
+			bool valid = true;
+
+			/* Every wedge of the moving vertex needs a wedge of the target on its side of any texture seam, which is the
+			target's wedge in one of its own triangles. If there's none, the collapse would tear the seam open */
+			for (unsigned int j = wedgeOffsets[collapse.from]; j < wedgeOffsets[collapse.from + 1] && valid; j++)
+			{
+				unsigned int wedge = wedges[j], partner = ~0u;
+
+				for (unsigned int k = 0; k < fromTriangleCount && partner == ~0u; k++)
+				{
+					const unsigned int* triangle = &result[fromTriangles[k] * 3];
+
+					if (triangle[0] != wedge && triangle[1] != wedge && triangle[2] != wedge)
+						continue;
+
+					for (unsigned int corner = 0; corner < 3; corner++)
+					{
+						if (positionIDs[triangle[corner]] == collapse.to)
+							partner = triangle[corner];
+					}
+				}
+
+				valid = partner != ~0u || wedgeOffsets[collapse.from + 1] - wedgeOffsets[collapse.from] == 1;
+				wedgeRemap[wedge] = partner;
+			}
+
+			/* Every triangle that survives the collapse keeps two of its corners, so the furthest its old points can be from
+			the new triangle is the distance of the moving vertex's old position from it */
+			float collapseDistance = 0.0f;
+			float previousDeviation = std::max(deviations[collapse.from], deviations[collapse.to]);
+
+			// The triangles that survive the collapse must not flip over
+			for (unsigned int j = 0; j < fromTriangleCount && valid; j++)
+			{
+				const unsigned int* triangle = &result[fromTriangles[j] * 3];
+
+				vec3 corners[3], movedCorners[3];
+				bool hasTarget = false;
+
+				for (unsigned int corner = 0; corner < 3; corner++)
+				{
+					unsigned int position = positionIDs[triangle[corner]];
+
+					corners[corner] = positions[position];
+					movedCorners[corner] = position == collapse.from ? positions[collapse.to] : positions[position];
+
+					hasTarget = hasTarget || position == collapse.to;
+				}
+
+				if (hasTarget)
+					continue;
+
+				vec3 normal = cross(corners[1] - corners[0], corners[2] - corners[0]);
+				vec3 movedNormal = cross(movedCorners[1] - movedCorners[0], movedCorners[2] - movedCorners[0]);
+
+				valid = dot(normal, movedNormal) > 0.0f;
+
+				collapseDistance = std::max(collapseDistance, PointTriangleDistance(positions[collapse.from],
+					movedCorners[0], movedCorners[1], movedCorners[2]));
+
+				for (unsigned int corner = 0; corner < 3; corner++)
+				{
+					previousDeviation = std::max(previousDeviation, deviations[positionIDs[triangle[corner]]]);
+				}
+			}
+
+			// The old surface was already this far from the original one, so the distances add up
+			float deviation = previousDeviation + collapseDistance;
+
+			valid = valid && deviation <= maxError;
+
+			if (!valid)
+			{
+				for (unsigned int j = wedgeOffsets[collapse.from]; j < wedgeOffsets[collapse.from + 1]; j++)
+				{
+					wedgeRemap[wedges[j]] = wedges[j];
+				}
+
+				continue;
+			}
+
+			// A single wedge that isn't in any triangle with the target can't be used anymore, so the choice doesn't matter
+			for (unsigned int j = wedgeOffsets[collapse.from]; j < wedgeOffsets[collapse.from + 1]; j++)
+			{
+				if (wedgeRemap[wedges[j]] == ~0u)
+					wedgeRemap[wedges[j]] = wedges[wedgeOffsets[collapse.to]];
+			}
+
+			AddQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+
+			for (unsigned int j = 0; j < fromTriangleCount; j++)
+			{
+				const unsigned int* triangle = &result[fromTriangles[j] * 3];
+				bool removed = false;
+
+				for (unsigned int corner = 0; corner < 3; corner++)
+				{
+					unsigned int position = positionIDs[triangle[corner]];
+
+					touched[position] = true;
+					deviations[position] = std::max(deviations[position], deviation);
+
+					removed = removed || position == collapse.to;
+				}
+
+				if (removed)
+					triangleCount--;
+			}
+
+			resultError = std::max(resultError, deviation);
+			collapseCount++;
+		}
+
+		if (collapseCount == 0)
+			break;
+
+		// Move the collapsed vertices and throw away the triangles that lost their area
+		unsigned int writeIndex = 0;
+
+		for (unsigned int i = 0; i < result.size(); i += 3)
+		{
+			unsigned int a = wedgeRemap[result[i]], b = wedgeRemap[result[i + 1]], c = wedgeRemap[result[i + 2]];
+
+			if (positionIDs[a] == positionIDs[b] || positionIDs[b] == positionIDs[c] || positionIDs[c] == positionIDs[a])
+				continue;
+
+			result[writeIndex++] = a;
+			result[writeIndex++] = b;
+			result[writeIndex++] = c;
+		}
+
+		result.resize(writeIndex);
+	}
+
+	if (error != nullptr)
+		*error = resultError;
+
+	return result;
+}
+
+vector<MeshLOD> MeshSimplifier::GenerateLODs(const vector<Vertex>& vertices, vector<unsigned int>& indices,
+	unsigned int maxLODCount, float reduction)
+{
+	vector<MeshLOD> lods;
+
+	MeshLOD fullLOD;
+	fullLOD.indexOffset = 0;
+	fullLOD.indexCount = static_cast<unsigned int>(indices.size());
+	fullLOD.error = 0.0f;
+
+	lods.push_back(fullLOD);
+
+	vector<unsigned int> previousIndices = indices;
+
+	/* Every level is simplified from the one before it, which is much faster than starting from the full mesh each time.
+	Each level's error is measured against the level before it though, so the errors are added up */
+	float totalError = 0.0f;
+
+	while (lods.size() < maxLODCount)
+	{
+		unsigned int targetIndexCount = static_cast<unsigned int>(previousIndices.size() / 3 * reduction) * 3;
+
+		if (targetIndexCount < MIN_LOD_TRIANGLES * 3)
+			break;
+
+		float error;
+		vector<unsigned int> lodIndices = Simplify(vertices, previousIndices, targetIndexCount, FLT_MAX, &error);
+
+		// Borders and seams can stop the simplifier long before the target, a level that barely changes isn't worth it
+		if (lodIndices.size() > previousIndices.size() * 0.9f)
+			break;
+
+		MeshOptimizer::OptimizeVertexCache(lodIndices, static_cast<unsigned int>(vertices.size()));
+
+		totalError += error;
+
+		MeshLOD lod;
+		lod.indexOffset = static_cast<unsigned int>(indices.size());
+		lod.indexCount = static_cast<unsigned int>(lodIndices.size());
+		lod.error = totalError;
+
+		lods.push_back(lod);
+		indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+
+		previousIndices.swap(lodIndices);
+	}
+
+	return lods;
+}
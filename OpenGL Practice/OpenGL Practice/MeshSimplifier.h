@@ -0,0 +1,42 @@
+#pragma once
+
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <vector>
+
+#include "Mesh.h"
+
+using namespace std;
+
+/* Builds cheaper versions of a mesh (levels of detail) for when it's too far away for the missing triangles to be seen.
+The simplifier collapses edges, moving one vertex onto a neighbouring vertex and throwing away the triangles that become
+degenerate. Every vertex keeps a quadric (the sum of the squared distance functions to the planes of its triangles, see
+Garland and Heckbert's "Surface Simplification Using Quadric Error Metrics"), so the cost of a collapse is how far the
+moved vertex ends up from the surface it used to describe. The cheapest collapses are done first.
+
+Vertices only ever move onto other existing vertices, so every level of detail is just a different index buffer into the
+same vertex buffer. Vertices on open borders never move (that would open holes), and vertices on texture seams only move
+along the seam, so the texture coordinates on both sides stay intact */
+
+class MeshSimplifier
+{
+public:
+	/* Returns the indices of a simplified mesh with at most targetIndexCount indices (if possible without moving the
+	surface further than maxError away from the original one). error receives a bound on how far the original surface
+	ended up from the simplified one, in the same units as the vertex positions. The quadrics only decide which collapses
+	are tried first, the bound is measured from the triangles themselves */
+	static vector<unsigned int> Simplify(const vector<Vertex>& vertices, const vector<unsigned int>& indices,
+		unsigned int targetIndexCount, float maxError, float* error = nullptr);
+
+	/* Appends up to maxLODCount - 1 simplified versions of the mesh to its indices, each with about reduction times the
+	triangles of the one before, and returns where every level's indices are. Level 0 is always the full mesh. Stops early
+	once a mesh can't be simplified any further */
+	static vector<MeshLOD> GenerateLODs(const vector<Vertex>& vertices, vector<unsigned int>& indices,
+		unsigned int maxLODCount = 4, float reduction = 0.5f);
+
+private:
+	MeshSimplifier() { }
+};
+
+#endif
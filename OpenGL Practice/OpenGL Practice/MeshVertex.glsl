@@ -0,0 +1,30 @@
+// Decodes the vertex attributes of meshes stored in the compact layout (CompactVertex in Mesh.h)
+// Mesh::SetVertexFormat turns meshQuantized on while a compact mesh is drawn, full float meshes go through unchanged
+uniform bool meshQuantized;
+
+// Maps the -1 to 1 positions back into the mesh's bounding box
+uniform vec3 meshPositionScale;
+uniform vec3 meshPositionOffset;
+
+// Undoes the octahedral encoding of normals and tangents
+vec3 DecodeOctahedral(vec2 encoded)
+{
+    vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+
+    // Unfold the lower half of the octahedron
+    float fold = max(-direction.z, 0.0);
+    direction.x += direction.x >= 0.0 ? -fold : fold;
+    direction.y += direction.y >= 0.0 ? -fold : fold;
+
+    return normalize(direction);
+}
+
+vec3 MeshPosition(vec3 position)
+{
+    return meshQuantized ? position * meshPositionScale + meshPositionOffset : position;
+}
+
+vec3 MeshNormal(vec3 normal)
+{
+    return meshQuantized ? DecodeOctahedral(normal.xy) : normal;
+}
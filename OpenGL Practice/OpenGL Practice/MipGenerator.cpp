@@ -0,0 +1,418 @@
+#include "MipGenerator.h"
+
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+
+// Every x64 compiler has SSE2, 32 bit MSVC has it unless the project builds for /arch:IA32
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIP_GENERATOR_SSE
+#include <emmintrin.h>
+#endif
+
+// Instantiate static variables
+MipFilter MipGenerator::filter = MIP_FILTER_KAISER;
+unsigned int MipGenerator::threadCount = 0;
+bool MipGenerator::enabled = true;
+
+// Set while the thread has a SingleThreadScope
+static thread_local bool singleThreaded = false;
+
+// Largest number of taps of any filter
+const unsigned int MAX_FILTER_TAPS = 8;
+
+// Levels with fewer texels than this are filtered on the calling thread, starting threads would take longer
+const size_t MIN_TEXELS_PER_THREAD = 65536;
+
+// Entries of the linear to sRGB table, enough that neighbouring entries are less than a step of 8 bits apart near black
+const unsigned int LINEAR_TO_SRGB_SIZE = 16384;
+
+// The sRGB transfer function both ways, built once the first time they're needed (thread safe since C++11)
+struct SRGBTables
+{
+	SRGBTables()
+	{
+		for (unsigned int i = 0; i < 256; i++)
+		{
+			float value = i / 255.0f;
+			toLinear[i] = value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+		}
+
+		for (unsigned int i = 0; i < LINEAR_TO_SRGB_SIZE; i++)
+		{
+			float value = i / static_cast<float>(LINEAR_TO_SRGB_SIZE - 1);
+			float encoded = value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+
+			toSRGB[i] = static_cast<unsigned char>(std::clamp(encoded * 255.0f + 0.5f, 0.0f, 255.0f));
+		}
+	}
+
+	float toLinear[256];
+	unsigned char toSRGB[LINEAR_TO_SRGB_SIZE];
+};
+
+static const SRGBTables& GetSRGBTables()
+{
+	static const SRGBTables tables;
+	return tables;
+}
+
+/* The weights of a filter that halves the image. Destination texel x covers source texels 2x and 2x + 1, so its center is
+between them and the taps are half a texel, one and a half texels... away from it on either side. The first tap is
+tapOffset texels before 2x */
+struct MipKernel
+{
+	unsigned int tapCount;
+	int tapOffset;
+	float weights[MAX_FILTER_TAPS];
+};
+
+// The zeroth order modified Bessel function of the first kind, which the Kaiser window is built from
+static float BesselI0(float x)
+{
+	float sum = 1.0f, term = 1.0f;
+
+	for (unsigned int k = 1; k < 16; k++)
+	{
+		term *= (x / (2.0f * k)) * (x / (2.0f * k));
+		sum += term;
+	}
+
+	return sum;
+}
+
+static MipKernel GetKernel(MipFilter mipFilter)
+{
+	MipKernel kernel;
+
+	switch (mipFilter)
+	{
+	case MIP_FILTER_TRIANGLE:
+		kernel.tapCount = 4;
+		break;
+
+	case MIP_FILTER_KAISER:
+		kernel.tapCount = 8;
+		break;
+
+	default:
+		kernel.tapCount = 2;
+		break;
+	}
+
+	kernel.tapOffset = 1 - static_cast<int>(kernel.tapCount / 2);
+
+	float weightSum = 0.0f;
+
+	for (unsigned int i = 0; i < kernel.tapCount; i++)
+	{
+		// Distance of the tap from the destination texel's center, in source texels
+		float distance = fabsf(kernel.tapOffset + static_cast<int>(i) - 0.5f);
+		float weight = 1.0f;
+
+		if (mipFilter == MIP_FILTER_TRIANGLE)
+		{
+			weight = 1.0f - distance / 2.0f;
+		}
+
+		else if (mipFilter == MIP_FILTER_KAISER)
+		{
+			// A sinc stretched to the destination's texel size, faded out towards the last tap by the Kaiser window
+			const float pi = 3.14159265f;
+			const float alpha = 4.0f;
+
+			float x = distance / 2.0f;
+			float sinc = sinf(pi * x) / (pi * x);
+
+			float t = distance / (kernel.tapCount / 2.0f);
+			weight = sinc * BesselI0(alpha * sqrtf(std::max(1.0f - t * t, 0.0f))) / BesselI0(alpha);
+		}
+
+		kernel.weights[i] = weight;
+		weightSum += weight;
+	}
+
+	for (unsigned int i = 0; i < kernel.tapCount; i++)
+	{
+		kernel.weights[i] /= weightSum;
+	}
+
+	return kernel;
+}
+
+/* Which source texels every destination texel along one axis reads. Worked out once per level and axis, so the filter
+loops never have to wrap or clamp a coordinate */
+static vector<int> GetTapIndices(const MipKernel& kernel, int sourceSize, int destinationSize, bool clampEdges)
+{
+	vector<int> indices(static_cast<size_t>(destinationSize) * kernel.tapCount);
+
+	for (int i = 0; i < destinationSize; i++)
+	{
+		for (unsigned int j = 0; j < kernel.tapCount; j++)
+		{
+			int index = i * 2 + kernel.tapOffset + static_cast<int>(j);
+
+			if (clampEdges)
+				index = std::clamp(index, 0, sourceSize - 1);
+
+			else
+				index = ((index % sourceSize) + sourceSize) % sourceSize;
+
+			indices[static_cast<size_t>(i) * kernel.tapCount + j] = index;
+		}
+	}
+
+	return indices;
+}
+
+// Sum of the weighted texels, every texel is 4 floats (RGBA)
+static inline void FilterTexels(const float* const* texels, const float* weights, unsigned int tapCount, float* output)
+{
+#ifdef MIP_GENERATOR_SSE
+	__m128 sum = _mm_setzero_ps();
+
+	for (unsigned int i = 0; i < tapCount; i++)
+	{
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(texels[i]), _mm_set1_ps(weights[i])));
+	}
+
+	_mm_storeu_ps(output, sum);
+#else
+	float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	for (unsigned int i = 0; i < tapCount; i++)
+	{
+		for (unsigned int c = 0; c < 4; c++)
+		{
+			sum[c] += texels[i][c] * weights[i];
+		}
+	}
+
+	for (unsigned int c = 0; c < 4; c++)
+	{
+		output[c] = sum[c];
+	}
+#endif
+}
+
+// Calls work for bands of rows from 0 to rowCount, on several threads if the level is large enough to be worth it
+static void ForEachRowBand(int rowCount, int rowWidth, const function<void(int, int)>& work)
+{
+	unsigned int threads = singleThreaded ? 1 : MipGenerator::threadCount;
+
+	if (threads == 0)
+		threads = std::max(thread::hardware_concurrency(), 1u);
+
+	size_t texelCount = static_cast<size_t>(rowCount) * rowWidth;
+	threads = static_cast<unsigned int>(std::min<size_t>(threads, texelCount / MIN_TEXELS_PER_THREAD));
+	threads = std::min(threads, static_cast<unsigned int>(rowCount));
+
+	if (threads <= 1)
+	{
+		work(0, rowCount);
+		return;
+	}
+
+	vector<thread> workers;
+	int rowsPerThread = (rowCount + static_cast<int>(threads) - 1) / static_cast<int>(threads);
+
+	// The calling thread takes the first band itself
+	for (unsigned int i = 1; i < threads; i++)
+	{
+		int firstRow = static_cast<int>(i) * rowsPerThread;
+		int lastRow = std::min(firstRow + rowsPerThread, rowCount);
+
+		if (firstRow < lastRow)
+			workers.emplace_back(work, firstRow, lastRow);
+	}
+
+	work(0, std::min(rowsPerThread, rowCount));
+
+	for (unsigned int i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+MipGenerator::SingleThreadScope::SingleThreadScope()
+{
+	// Scopes can be nested, only the outermost one turns the threads back on
+	wasSingleThreaded = singleThreaded;
+	singleThreaded = true;
+}
+
+MipGenerator::SingleThreadScope::~SingleThreadScope()
+{
+	singleThreaded = wasSingleThreaded;
+}
+
+// Halves a float RGBA image, first along X into a temporary image and then along Y
+static void ReduceLevel(const vector<float>& source, int width, int height, const MipKernel& kernel, bool clampEdges,
+	vector<float>& destination, int& destinationWidth, int& destinationHeight)
+{
+	destinationWidth = std::max(width / 2, 1);
+	destinationHeight = std::max(height / 2, 1);
+
+	vector<int> columns = GetTapIndices(kernel, width, destinationWidth, clampEdges);
+	vector<int> rows = GetTapIndices(kernel, height, destinationHeight, clampEdges);
+
+	vector<float> reducedRows(static_cast<size_t>(destinationWidth) * height * 4);
+	destination.resize(static_cast<size_t>(destinationWidth) * destinationHeight * 4);
+
+	ForEachRowBand(height, destinationWidth, [&](int firstRow, int lastRow)
+	{
+		const float* texels[MAX_FILTER_TAPS];
+
+		for (int y = firstRow; y < lastRow; y++)
+		{
+			const float* sourceRow = &source[static_cast<size_t>(y) * width * 4];
+			float* outputRow = &reducedRows[static_cast<size_t>(y) * destinationWidth * 4];
+
+			for (int x = 0; x < destinationWidth; x++)
+			{
+				for (unsigned int i = 0; i < kernel.tapCount; i++)
+				{
+					texels[i] = sourceRow + columns[static_cast<size_t>(x) * kernel.tapCount + i] * 4;
+				}
+
+				FilterTexels(texels, kernel.weights, kernel.tapCount, outputRow + x * 4);
+			}
+		}
+	});
+
+	ForEachRowBand(destinationHeight, destinationWidth, [&](int firstRow, int lastRow)
+	{
+		const float* sourceRows[MAX_FILTER_TAPS];
+		const float* texels[MAX_FILTER_TAPS];
+
+		for (int y = firstRow; y < lastRow; y++)
+		{
+			for (unsigned int i = 0; i < kernel.tapCount; i++)
+			{
+				sourceRows[i] = &reducedRows[static_cast<size_t>(rows[static_cast<size_t>(y) * kernel.tapCount + i]) *
+					destinationWidth * 4];
+			}
+
+			float* outputRow = &destination[static_cast<size_t>(y) * destinationWidth * 4];
+
+			for (int x = 0; x < destinationWidth; x++)
+			{
+				for (unsigned int i = 0; i < kernel.tapCount; i++)
+				{
+					texels[i] = sourceRows[i] + x * 4;
+				}
+
+				FilterTexels(texels, kernel.weights, kernel.tapCount, outputRow + x * 4);
+			}
+		}
+	});
+}
+
+/* The negative lobes of the sinc can push a value past 0 or 1 next to sharp edges, which would ring more with every level.
+Normals are also brought back to unit length here */
+static void CleanUpLevel(vector<float>& texels, bool normalMap)
+{
+	for (size_t i = 0; i < texels.size(); i += 4)
+	{
+		float* texel = &texels[i];
+
+		for (unsigned int c = 0; c < 4; c++)
+		{
+			texel[c] = std::clamp(texel[c], 0.0f, 1.0f);
+		}
+
+		if (!normalMap)
+			continue;
+
+		float x = texel[0] * 2.0f - 1.0f;
+		float y = texel[1] * 2.0f - 1.0f;
+		float z = texel[2] * 2.0f - 1.0f;
+
+		float length = sqrtf(x * x + y * y + z * z);
+
+		if (length < 1e-6f)
+			continue;
+
+		texel[0] = (x / length) * 0.5f + 0.5f;
+		texel[1] = (y / length) * 0.5f + 0.5f;
+		texel[2] = (z / length) * 0.5f + 0.5f;
+	}
+}
+
+void MipGenerator::GenerateMipChain(const unsigned char* data, int width, int height, int nrComponents,
+	const MipOptions& options, MipChain& chain)
+{
+	chain.nrComponents = nrComponents;
+	chain.levels.clear();
+	chain.data.clear();
+
+	if (width <= 1 && height <= 1)
+		return;
+
+	const SRGBTables& tables = GetSRGBTables();
+
+	// A single channel is grey, with two the second one is alpha, otherwise the first three are the color
+	int colorChannels = options.linearColor ? (nrComponents >= 3 ? 3 : 1) : 0;
+
+	/* Filtering happens on 4 float channels no matter how many the image has, the missing ones are filled in like OpenGL
+	would (0 for green and blue, 1 for alpha) and dropped again when the level is stored */
+	vector<float> texels(static_cast<size_t>(width) * height * 4);
+
+	for (size_t i = 0; i < static_cast<size_t>(width) * height; i++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			if (c >= nrComponents)
+				texels[i * 4 + c] = c == 3 ? 1.0f : 0.0f;
+
+			else if (c < colorChannels)
+				texels[i * 4 + c] = tables.toLinear[data[i * nrComponents + c]];
+
+			else
+				texels[i * 4 + c] = data[i * nrComponents + c] / 255.0f;
+		}
+	}
+
+	MipKernel kernel = GetKernel(filter);
+
+	vector<float> nextTexels;
+	int levelWidth = width, levelHeight = height;
+
+	while (levelWidth > 1 || levelHeight > 1)
+	{
+		int nextWidth, nextHeight;
+		ReduceLevel(texels, levelWidth, levelHeight, kernel, options.clampEdges, nextTexels, nextWidth, nextHeight);
+		CleanUpLevel(nextTexels, options.normalMap);
+
+		texels.swap(nextTexels);
+		levelWidth = nextWidth;
+		levelHeight = nextHeight;
+
+		MipLevel level;
+		level.width = levelWidth;
+		level.height = levelHeight;
+		level.offset = chain.data.size();
+		level.size = static_cast<size_t>(levelWidth) * levelHeight * nrComponents;
+
+		chain.levels.push_back(level);
+		chain.data.resize(level.offset + level.size);
+
+		unsigned char* output = &chain.data[level.offset];
+
+		for (size_t i = 0; i < static_cast<size_t>(levelWidth) * levelHeight; i++)
+		{
+			for (int c = 0; c < nrComponents; c++)
+			{
+				float value = texels[i * 4 + c];
+
+				if (c < colorChannels)
+					output[i * nrComponents + c] = tables.toSRGB[static_cast<unsigned int>(value *
+						(LINEAR_TO_SRGB_SIZE - 1) + 0.5f)];
+
+				else
+					output[i * nrComponents + c] = static_cast<unsigned char>(value * 255.0f + 0.5f);
+			}
+		}
+	}
+}
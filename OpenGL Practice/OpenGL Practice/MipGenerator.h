@@ -0,0 +1,96 @@
+#pragma once
+
+#ifndef MIP_GENERATOR_H
+#define MIP_GENERATOR_H
+
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+/* glGenerateMipmap builds every mip level on the render thread right after the upload, and drivers only average 2x2
+squares of the stored values. Color textures store gamma encoded (sRGB) values though, and averaging those darkens
+everything with contrast in the distance: a black and white checkerboard averages to 0.5, which is displayed as a
+brightness of about 0.21 instead of 0.5.
+
+The mip generator builds the mip chain on the CPU while the image is being decoded (on whichever worker thread decodes
+it). Color textures are converted to linear values first, filtered, and converted back, and normal maps are renormalized
+after filtering so they don't get shorter (and the lighting flatter) with every level. Every level is filtered from the
+previous one with a separable filter, one RGBA pixel per SSE register, and large levels of an image that's decoded on
+its own are split into bands of rows that are filtered on several threads. Images that are decoded several at a time on
+worker threads are filtered on their own worker only, the threads are already busy with the other images. The texture
+compressor encodes these levels into its cache files, and uncompressed textures upload them level by level instead of
+calling glGenerateMipmap */
+
+// The filter every level is reduced with, wider filters keep more detail without aliasing but take longer
+enum MipFilter
+{
+	MIP_FILTER_BOX, // average of 2x2 texels, what glGenerateMipmap does
+	MIP_FILTER_TRIANGLE, // tent filter over 4x4 texels, softer and with less aliasing than the box
+	MIP_FILTER_KAISER // Kaiser windowed sinc over 8x8 texels, the sharpest of the three
+};
+
+// How an image has to be filtered
+struct MipOptions
+{
+	MipOptions(bool linearColor_ = false, bool normalMap_ = false, bool clampEdges_ = false) : linearColor(linearColor_),
+		normalMap(normalMap_), clampEdges(clampEdges_) { }
+
+	bool linearColor; // the RGB values are sRGB encoded and get filtered as linear values
+	bool normalMap; // RGB is a normal mapped to 0 to 1 that's renormalized after filtering
+	bool clampEdges; // texels past the edge repeat the edge instead of wrapping around to the other side
+};
+
+// Where one mip level is in a chain's data
+struct MipLevel
+{
+	int width, height;
+	size_t offset, size;
+};
+
+// Every level below the source image, each with the source's channels and tightly packed rows
+struct MipChain
+{
+	MipChain() : nrComponents(0) { }
+
+	int nrComponents;
+
+	vector<MipLevel> levels;
+	vector<unsigned char> data;
+};
+
+class MipGenerator
+{
+public:
+	/* Builds every level below the image, from half its size down to 1x1. The image stays untouched, it's level 0 of the
+	texture. Thread safe */
+	static void GenerateMipChain(const unsigned char* data, int width, int height, int nrComponents,
+		const MipOptions& options, MipChain& chain);
+
+	// Filter used for every level, changing it also rebuilds the texture compressor's cache files
+	static MipFilter filter;
+
+	/* Threads that filter the larger levels (a thread that calls GenerateMipChain counts as one of them), 0 uses one per
+	core. Ignored on a thread that has a SingleThreadScope */
+	static unsigned int threadCount;
+
+	// Allows turning the generator off, uncompressed textures call glGenerateMipmap again
+	static bool enabled;
+
+	/* Keeps GenerateMipChain on the calling thread for as long as it exists. Every worker of Model::ParallelFor holds one,
+	otherwise each worker decoding a texture would start threadCount threads of its own for every level */
+	class SingleThreadScope
+	{
+	public:
+		SingleThreadScope();
+		~SingleThreadScope();
+
+	private:
+		bool wasSingleThreaded;
+	};
+
+private:
+	MipGenerator() { }
+};
+
+#endif
@@ -1,22 +1,582 @@
 #include "Model.h"
+#include "GLStateCache.h"
 
-Model::Model(const char* filePath_)
+#include <thread>
+#include <atomic>
+#include <future>
+#include <unordered_set>
+
+// Instantiate static variables
+unsigned int Model::importThreadCount = 0;
+
+bool Model::batchDraws = true;
+bool Model::buildTriangleBVHs = false;
+bool Model::buildOccluders = false;
+
+Model::Model(const char* filePath_, bool compactVertices_, bool asyncLoading_, MeshBuffer* meshBuffer_) :
+compactVertices(compactVertices_), asyncLoading(asyncLoading_)
 {
+	importTimings = { 0.0, 0.0, 0.0, 0.0 };
+	scene = nullptr;
+
+	// Compact meshes keep their own buffers, so they're drawn one at a time like before
+	meshBuffer = compactVertices ? nullptr : meshBuffer_;
+	ownsMeshBuffer = !compactVertices && meshBuffer == nullptr;
+
+	if (ownsMeshBuffer)
+		meshBuffer = new MeshBuffer();
+
+	indirectBuffer = NULL;
+
+	boundsMin = vec3(0.0f);
+	boundsMax = vec3(0.0f);
+	boundingSphere = { vec3(0.0f), 0.0f };
+
 	LoadModel(filePath_);
 }
 
 Model::~Model()
 {
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		meshes[i].DeleteMesh();
+	}
+
+	// Buffers that haven't arrived yet are deleted as soon as they do
+	if (streamingBuffers != nullptr)
+		AssetLoader::ReleaseBuffers(streamingBuffers);
+
+	if (ownsMeshBuffer)
+	{
+		meshBuffer->DeleteBuffer();
+		delete meshBuffer;
+	}
+
+	meshBuffer = nullptr;
+
+	if (indirectBuffer != NULL)
+		GLStateCache::DeleteBuffers(1, &indirectBuffer);
+
+	// Textures that haven't arrived yet give their reference back as soon as they do
+	for (unsigned int i = 0; i < streamingTextures.size(); i++)
+	{
+		AssetLoader::ReleaseTexture(streamingTextures[i].second);
+		texturesLoaded[streamingTextures[i].first].textureID = 0;
+	}
+
+	// Other models might still use the same textures, the cache deletes them once nobody does
+	for (unsigned int i = 0; i < texturesLoaded.size(); i++)
+	{
+		TextureCache::ReleaseTexture(texturesLoaded[i].textureID);
+	}
+
 	fileDirectory = "";
 	scene = nullptr;
 }
 
-void Model::DrawModel(ShaderProgram *shaderProgram_)
+void Model::DrawModel(ShaderProgram *shaderProgram_, unsigned int lod)
+{
+	DrawBatches(shaderProgram_, lod, nullptr, 0);
+}
+
+void Model::DrawModel(ShaderProgram *shaderProgram_, const mat4& modelMatrix_, unsigned int lod,
+	unsigned int modelMatrixUniform_)
+{
+	UpdateNodeTransforms();
+	DrawBatches(shaderProgram_, lod, &modelMatrix_, modelMatrixUniform_);
+}
+
+void Model::DrawBatches(ShaderProgram *shaderProgram_, unsigned int lod, const mat4* modelMatrix_,
+	unsigned int modelMatrixUniform_)
+{
+	// Nothing can be drawn before the asset loader has filled the buffers
+	if (streamingBuffers != nullptr && !UpdateStreamingBuffers())
+		return;
+
+	if (!streamingTextures.empty())
+		UpdateStreamingTextures();
+
+	// The world transform the shader has right now, a uniform upload is only needed when the next mesh's is different
+	const mat4* currentTransform = nullptr;
+
+	auto setTransform = [&](unsigned int meshIndex)
+	{
+		const mat4& transform = nodes.worldTransforms[meshNodes[meshIndex]];
+
+		if (currentTransform != nullptr && (currentTransform == &transform || *currentTransform == transform))
+			return;
+
+		currentTransform = &transform;
+		shaderProgram_->SetMat4(modelMatrixUniform_, *modelMatrix_ * transform);
+	};
+
+	if (drawBatches.empty() || !batchDraws)
+	{
+		for (unsigned int i = 0; i < meshes.size(); i++)
+		{
+			if (modelMatrix_ != nullptr)
+				setTransform(i);
+
+			meshes[i].DrawMesh(shaderProgram_, lod);
+		}
+
+		return;
+	}
+
+	// Every mesh is in the same vertex array, so it's bound once for the whole model
+	GLStateCache::BindVertexArray(meshBuffer->VAO);
+
+	bool drawIndirect = indirectBuffer != NULL && MeshBuffer::SupportsMultiDrawIndirect();
+
+	if (drawIndirect)
+		GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+
+	for (unsigned int i = 0; i < drawBatches.size(); i++)
+	{
+		ModelDrawBatch& batch = drawBatches[i];
+
+		GLsizei meshCount = static_cast<GLsizei>(batch.meshIndices.size());
+		unsigned int first = std::min(lod, batch.lodCount - 1) * meshCount;
+
+		// Draws drawCount of the batch's meshes starting at its start'th mesh
+		auto drawRange = [&](unsigned int start, GLsizei drawCount)
+		{
+			if (drawIndirect)
+			{
+				// The indirect pointer is a byte offset into the bound GL_DRAW_INDIRECT_BUFFER
+				MeshBuffer::MultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+					(void*)((batch.firstCommand + first + start) * sizeof(DrawElementsIndirectCommand)), drawCount);
+			}
+
+			else
+			{
+				glMultiDrawElementsBaseVertex(GL_TRIANGLES, &batch.indexCounts[first + start], GL_UNSIGNED_INT,
+					&batch.indexOffsets[first + start], drawCount, &batch.baseVertices[first + start]);
+			}
+		};
+
+		meshes[batch.meshIndices[0]].BindTextures(shaderProgram_);
+
+		if (modelMatrix_ == nullptr)
+		{
+			drawRange(0, meshCount);
+			continue;
+		}
+
+		/* Without gl_DrawID (OpenGL 4.6) the shader can't tell which draw of a multi-draw call it's in, so every draw of
+		one call has to use the same model matrix */
+		for (unsigned int j = 0; j + 1 < batch.transformRuns.size(); j++)
+		{
+			unsigned int runStart = batch.transformRuns[j];
+
+			setTransform(batch.meshIndices[runStart]);
+			drawRange(runStart, static_cast<GLsizei>(batch.transformRuns[j + 1] - runStart));
+		}
+	}
+
+	if (drawIndirect)
+		GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	GLStateCache::BindVertexArray(0);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+}
+
+void Model::SetNodeTransform(unsigned int node_, const mat4& localTransform_)
+{
+	nodes.SetLocalTransform(node_, localTransform_);
+}
+
+int Model::FindNode(const string& name_) const
+{
+	return nodes.FindNode(name_);
+}
+
+void Model::UpdateNodeTransforms()
+{
+	if (!nodes.HasDirtyNodes())
+		return;
+
+	nodes.UpdateWorldTransforms();
+
+	UpdateMeshBounds();
+	BuildTransformRuns();
+}
+
+unsigned int Model::GetLODCount() const
+{
+	return static_cast<unsigned int>(lodErrors.size());
+}
+
+unsigned int Model::SelectLOD(float distance, float scale, const mat4& projectionMatrix, float screenHeight,
+	float maxPixelError) const
+{
+	/* projectionMatrix[1][1] is 1 / tan(fov / 2), so this is how many pixels one unit covers at the given distance. The
+	camera can be inside the model's bounds, which always gets the full model */
+	float pixelsPerUnit = projectionMatrix[1][1] * 0.5f * screenHeight / std::max(distance, 0.0001f);
+
+	for (unsigned int i = GetLODCount(); i-- > 1;)
+	{
+		if (lodErrors[i] * scale * pixelsPerUnit <= maxPixelError)
+			return i;
+	}
+
+	return 0;
+}
+
+void Model::GatherLODErrors()
+{
+	lodErrors.clear();
+
+	if (meshes.empty())
+		return;
+
+	// Only the levels every mesh has, otherwise some meshes would stay at their coarsest level for longer than others
+	unsigned int lodCount = static_cast<unsigned int>(meshes[0].lods.size());
+
+	for (unsigned int i = 1; i < meshes.size(); i++)
+	{
+		lodCount = std::min(lodCount, static_cast<unsigned int>(meshes[i].lods.size()));
+	}
+
+	lodErrors.assign(lodCount, 0.0f);
+
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		for (unsigned int j = 0; j < lodCount; j++)
+		{
+			lodErrors[j] = std::max(lodErrors[j], meshes[i].lods[j].error);
+		}
+	}
+}
+
+void Model::BuildDrawBatches()
+{
+	drawBatches.clear();
+
+	if (meshBuffer == nullptr)
+		return;
+
+	// Meshes with the same texture types and paths in the same order can be drawn with the same bindings
+	unordered_map<string, unsigned int> batchLookup;
+
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		string key;
+
+		for (unsigned int j = 0; j < meshes[i].textures.size(); j++)
+		{
+			key += meshes[i].textures[j].textureType + '|' + meshes[i].textures[j].texturePath + '\n';
+		}
+
+		auto found = batchLookup.find(key);
+
+		if (found == batchLookup.end())
+		{
+			found = batchLookup.emplace(key, static_cast<unsigned int>(drawBatches.size())).first;
+			drawBatches.push_back(ModelDrawBatch());
+		}
+
+		drawBatches[found->second].meshIndices.push_back(i);
+	}
+
+	vector<DrawElementsIndirectCommand> commands;
+
+	for (unsigned int i = 0; i < drawBatches.size(); i++)
+	{
+		ModelDrawBatch& batch = drawBatches[i];
+
+		batch.lodCount = 0;
+		batch.firstCommand = static_cast<unsigned int>(commands.size());
+
+		for (unsigned int j = 0; j < batch.meshIndices.size(); j++)
+		{
+			batch.lodCount = std::max(batch.lodCount, static_cast<unsigned int>(meshes[batch.meshIndices[j]].lods.size()));
+		}
+
+		for (unsigned int lod = 0; lod < batch.lodCount; lod++)
+		{
+			for (unsigned int j = 0; j < batch.meshIndices.size(); j++)
+			{
+				const Mesh& mesh = meshes[batch.meshIndices[j]];
+				unsigned int meshLOD = std::min(lod, static_cast<unsigned int>(mesh.lods.size() - 1));
+
+				batch.indexCounts.push_back(static_cast<GLsizei>(mesh.lods[meshLOD].indexCount));
+				batch.indexOffsets.push_back((void*)mesh.GetIndexByteOffset(meshLOD));
+				batch.baseVertices.push_back(mesh.baseVertex);
+
+				// Indirect commands count in indices instead of bytes
+				DrawElementsIndirectCommand command;
+				command.count = mesh.lods[meshLOD].indexCount;
+				command.instanceCount = 1;
+				command.firstIndex = mesh.firstIndex + mesh.lods[meshLOD].indexOffset;
+				command.baseVertex = mesh.baseVertex;
+				command.baseInstance = 0;
+
+				commands.push_back(command);
+			}
+		}
+	}
+
+	BuildTransformRuns();
+
+	if (commands.empty() || !MeshBuffer::SupportsMultiDrawIndirect())
+		return;
+
+	glGenBuffers(1, &indirectBuffer);
+
+	GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(),
+		GL_STATIC_DRAW);
+	GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void Model::BuildBoundingVolumes(const vector<const Vertex*>& meshVertices_,
+	const vector<const unsigned int*>& meshIndices_)
+{
+	meshTriangles.clear();
+	occluderMeshes.clear();
+
+	UpdateMeshBounds();
+
+	if (meshes.empty())
+		return;
+
+	if (buildOccluders)
+		BuildOccluderMeshes(meshVertices_, meshIndices_);
+
+	if (!buildTriangleBVHs)
+		return;
+
+	meshTriangles.resize(meshes.size());
+
+	// Every mesh's hierarchy is independent of the others, so they're built on whichever worker thread is free
+	ParallelFor(static_cast<unsigned int>(meshes.size()), [&](unsigned int i)
+	{
+		const Mesh& mesh = meshes[i];
+		MeshTriangles& triangles = meshTriangles[i];
+
+		const Vertex* vertices = meshVertices_[i];
+		const unsigned int* indices = meshIndices_[i] + mesh.lods[0].indexOffset;
+
+		triangles.positions.resize(mesh.vertexCount);
+
+		for (unsigned int j = 0; j < mesh.vertexCount; j++)
+		{
+			triangles.positions[j] = vertices[j].meshPosition;
+		}
+
+		triangles.indices.assign(indices, indices + mesh.lods[0].indexCount);
+
+		unsigned int triangleCount = mesh.lods[0].indexCount / 3;
+		vector<vec3> triangleMins(triangleCount), triangleMaxs(triangleCount);
+
+		for (unsigned int j = 0; j < triangleCount; j++)
+		{
+			const vec3& a = triangles.positions[triangles.indices[j * 3]];
+			const vec3& b = triangles.positions[triangles.indices[j * 3 + 1]];
+			const vec3& c = triangles.positions[triangles.indices[j * 3 + 2]];
+
+			triangleMins[j] = min(min(a, b), c);
+			triangleMaxs[j] = max(max(a, b), c);
+		}
+
+		triangles.bvh.Build(triangleMins, triangleMaxs);
+	});
+}
+
+void Model::BuildOccluderMeshes(const vector<const Vertex*>& meshVertices_,
+	const vector<const unsigned int*>& meshIndices_)
+{
+	occluderMeshes.resize(meshes.size());
+
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		const Mesh& mesh = meshes[i];
+		const MeshLOD& lod = mesh.lods.back();
+
+		OccluderMesh& occluder = occluderMeshes[i];
+
+		const Vertex* vertices = meshVertices_[i];
+		const unsigned int* indices = meshIndices_[i] + lod.indexOffset;
+
+		/* The coarsest level only uses a small part of the mesh's vertices, the others would be transformed every frame
+		for nothing */
+		vector<unsigned int> remap(mesh.vertexCount, 0xFFFFFFFF);
+
+		occluder.indices.resize(lod.indexCount);
+
+		for (unsigned int j = 0; j < lod.indexCount; j++)
+		{
+			unsigned int& newIndex = remap[indices[j]];
+
+			if (newIndex == 0xFFFFFFFF)
+			{
+				newIndex = static_cast<unsigned int>(occluder.positions.size());
+				occluder.positions.push_back(vertices[indices[j]].meshPosition);
+			}
+
+			occluder.indices[j] = newIndex;
+		}
+	}
+}
+
+void Model::UpdateMeshBounds()
+{
+	meshBVH.Clear();
+
+	inverseNodeTransforms.resize(nodes.GetNodeCount());
+
+	for (unsigned int i = 0; i < nodes.GetNodeCount(); i++)
+	{
+		inverseNodeTransforms[i] = inverse(nodes.worldTransforms[i]);
+	}
+
+	if (meshes.empty())
+		return;
+
+	vector<vec3> meshMins(meshes.size()), meshMaxs(meshes.size());
+	vector<BoundingSphere> meshSpheres(meshes.size());
+
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		const mat4& worldTransform = nodes.worldTransforms[meshNodes[i]];
+
+		BoundingVolumes::TransformBounds(worldTransform, meshes[i].boundsMin, meshes[i].boundsMax, meshMins[i],
+			meshMaxs[i]);
+
+		// The sphere grows with the largest scale of the three axes, so it still holds the mesh if they're scaled unevenly
+		float scale = std::max(std::max(length(vec3(worldTransform[0])), length(vec3(worldTransform[1]))),
+			length(vec3(worldTransform[2])));
+
+		meshSpheres[i].center = vec3(worldTransform * vec4(meshes[i].boundingSphere.center, 1.0f));
+		meshSpheres[i].radius = meshes[i].boundingSphere.radius * scale;
+
+		boundsMin = i == 0 ? meshMins[i] : min(boundsMin, meshMins[i]);
+		boundsMax = i == 0 ? meshMaxs[i] : max(boundsMax, meshMaxs[i]);
+	}
+
+	// The sphere around the box's center that reaches around every mesh's sphere, unless the box's own sphere is smaller
+	boundingSphere.center = (boundsMin + boundsMax) * 0.5f;
+	boundingSphere.radius = length(boundsMax - boundsMin) * 0.5f;
+
+	float meshSphereRadius = 0.0f;
+
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		meshSphereRadius = std::max(meshSphereRadius, length(meshSpheres[i].center - boundingSphere.center) +
+			meshSpheres[i].radius);
+	}
+
+	boundingSphere.radius = std::min(boundingSphere.radius, meshSphereRadius);
+
+	// Models rarely have more than a few dozen meshes, two per leaf keeps the tree shallow
+	meshBVH.Build(meshMins, meshMaxs, 2);
+}
+
+void Model::BuildTransformRuns()
+{
+	for (unsigned int i = 0; i < drawBatches.size(); i++)
+	{
+		ModelDrawBatch& batch = drawBatches[i];
+		batch.transformRuns.clear();
+
+		for (unsigned int j = 0; j < batch.meshIndices.size(); j++)
+		{
+			if (j == 0 || nodes.worldTransforms[meshNodes[batch.meshIndices[j]]] !=
+				nodes.worldTransforms[meshNodes[batch.meshIndices[j - 1]]])
+			{
+				batch.transformRuns.push_back(j);
+			}
+		}
+
+		batch.transformRuns.push_back(static_cast<unsigned int>(batch.meshIndices.size()));
+	}
+}
+
+void Model::QueryFrustum(const Frustum& frustum_, vector<unsigned int>& meshIndices_) const
+{
+	meshBVH.QueryFrustum(frustum_, meshIndices_);
+}
+
+void Model::QuerySphere(const vec3& center_, float radius_, vector<unsigned int>& meshIndices_) const
 {
+	meshBVH.QuerySphere(center_, radius_, meshIndices_);
+}
+
+bool Model::CastRay(const Ray& ray_, ModelRayHit& hit_, float maxDistance_) const
+{
+	unsigned int hitTriangle = ModelRayHit::NO_TRIANGLE;
+
+	int hitMesh = meshBVH.CastRay(ray_, maxDistance_, [&](unsigned int meshIndex, float& distance)
+	{
+		const Mesh& mesh = meshes[meshIndex];
+
+		/* The mesh's box and triangles are in its node's space. The direction isn't normalized again, so a distance along
+		the moved ray is the same distance along the model space one */
+		const mat4& toMesh = inverseNodeTransforms[meshNodes[meshIndex]];
+		Ray meshRay(vec3(toMesh * vec4(ray_.origin, 1.0f)), vec3(toMesh * vec4(ray_.direction, 0.0f)));
+
+		if (meshTriangles.empty())
+		{
+			float boxDistance;
+
+			if (!BoundingVolumes::RayIntersectsBox(meshRay, mesh.boundsMin, mesh.boundsMax, distance, boxDistance))
+				return false;
+
+			distance = boxDistance;
+			hitTriangle = ModelRayHit::NO_TRIANGLE;
+
+			return true;
+		}
+
+		const MeshTriangles& triangles = meshTriangles[meshIndex];
+
+		// The mesh's own hierarchy only reports a hit if it's closer than anything hit in the meshes before
+		int triangle = triangles.bvh.CastRay(meshRay, distance, [&](unsigned int triangleIndex, float& triangleDistance)
+		{
+			const unsigned int* indices = &triangles.indices[triangleIndex * 3];
+			float hitDistance;
+
+			if (!BoundingVolumes::RayIntersectsTriangle(meshRay, triangles.positions[indices[0]],
+				triangles.positions[indices[1]], triangles.positions[indices[2]], hitDistance) ||
+				hitDistance >= triangleDistance)
+			{
+				return false;
+			}
+
+			triangleDistance = hitDistance;
+
+			return true;
+		});
+
+		if (triangle < 0)
+			return false;
+
+		hitTriangle = static_cast<unsigned int>(triangle);
+
+		return true;
+	});
+
+	if (hitMesh < 0)
+		return false;
+
+	hit_.meshIndex = static_cast<unsigned int>(hitMesh);
+	hit_.triangle = hitTriangle;
+	hit_.distance = maxDistance_;
+
+	return true;
+}
+
+size_t Model::GetBufferSize() const
+{
+	size_t bufferSize = 0;
+
 	for (unsigned int i = 0; i < meshes.size(); i++)
 	{
-		meshes[i].DrawMesh(shaderProgram_);
+		bufferSize += meshes[i].GetBufferSize();
 	}
+
+	return bufferSize;
 }
 
 void Model::LoadModel(string filePath_)
@@ -34,13 +594,23 @@ void Model::LoadModel(string filePath_)
 	/* aiProcess_OptimizeMeshes does the opposite of aiProcess_SplitLargeMeshes, meshes join together into one large
 	mesh, reducing drawing calls for optimization. */
 
+	// Retrieve the directory path of the given file path
+	fileDirectory = filePath_.substr(0, filePath_.find_last_of('/'));
+
+	// Skip Assimp entirely if the model was already imported before and hasn't changed since
+	if (LoadFromCache(filePath_))
+		return;
+
+	double importStartTime = glfwGetTime();
+	double stepStartTime = importStartTime;
+
 	// Abstract the details of loading models in all different formats
 	// The second argument of ReadFile() expects several post-processing options
 
 	/* When the aiProcess_CalcTangentSpace bit is supplied to Assimps ReadFile function, Assimp calculates smooth tangent 
 	and bitangent vectors for each of the loaded vertices, similarly to how we did it in this chapter */
-	scene = assimpImporter.ReadFile(filePath_, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
-	
+	scene = assimpImporter.ReadFile(filePath_, MODEL_IMPORT_FLAGS);
+
 	// Check if the scene and the root node of the scene is null, and if the flags returned is incomplete
 	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
 	{
@@ -49,27 +619,219 @@ void Model::LoadModel(string filePath_)
 		return;
 	}
 
-	// Retrieve the directory path of the given file path
-	fileDirectory = filePath_.substr(0, filePath_.find_last_of('/'));
-
 	/* A recursive function is a function that does some processing and recursively calls the same function with 
 	different parameters until a certain condition is met.  */
 
+	importTimings.readTime = glfwGetTime() - stepStartTime;
+	stepStartTime = glfwGetTime();
+
 	// If load model works, process all the scene's nodes (pass in the root node and the scene)
-	ProcessNode(scene->mRootNode, scene);
+	vector<aiMesh*> sceneMeshes;
+	ProcessNode(scene->mRootNode, scene, sceneMeshes);
+
+	/* Converting the meshes doesn't need OpenGL, so every mesh is converted on whichever worker thread is free. The meshes
+	keep their order since every worker writes into its own slot */
+	vector<MeshData> meshData(sceneMeshes.size());
+
+	ParallelFor(static_cast<unsigned int>(sceneMeshes.size()), [&](unsigned int i)
+	{
+		meshData[i] = ProcessMesh(sceneMeshes[i], scene);
+	});
+
+	importTimings.convertTime = glfwGetTime() - stepStartTime;
+
+	for (unsigned int i = 0; i < meshData.size(); i++)
+	{
+		MeshOptimizer::PrintStatistics(filePath_, i, meshData[i].optimizationStatistics);
+	}
+
+	vector<Texture> materialTextures;
+
+	for (unsigned int i = 0; i < meshData.size(); i++)
+	{
+		materialTextures.insert(materialTextures.end(), meshData[i].textures.begin(), meshData[i].textures.end());
+	}
+
+	LoadTextures(materialTextures);
+
+	// Everything is ready on the CPU, so all the GL uploads happen here in one go on the main thread
+	stepStartTime = glfwGetTime();
+
+	meshes.reserve(meshData.size());
+
+	// The meshes only record where they are in the buffers for now, the asset loader creates the buffers later
+	if (asyncLoading && ownsMeshBuffer)
+		meshBuffer->BeginStaging();
+
+	if (meshBuffer != nullptr)
+	{
+		unsigned int vertexCount = 0, indexCount = 0;
+
+		for (unsigned int i = 0; i < meshData.size(); i++)
+		{
+			vertexCount += static_cast<unsigned int>(meshData[i].vertices.size());
+			indexCount += static_cast<unsigned int>(meshData[i].indices.size());
+		}
+
+		// Sized for the whole model up front, so adding the meshes never has to grow the buffers
+		meshBuffer->Reserve(vertexCount, indexCount);
+	}
+
+	for (unsigned int i = 0; i < meshData.size(); i++)
+	{
+		vector<Texture>& textures = meshData[i].textures;
+
+		for (unsigned int j = 0; j < textures.size(); j++)
+		{
+			textures[j] = LoadTexture(textures[j].texturePath, textures[j].textureType);
+		}
+
+		meshes.push_back(Mesh(move(meshData[i].vertices), move(meshData[i].indices), textures, compactVertices,
+			meshData[i].lods, meshBuffer));
+	}
+
+	StreamMeshBuffer();
+
+	nodes.UpdateWorldTransforms();
+
+	GatherLODErrors();
+	BuildDrawBatches();
+
+	vector<const Vertex*> meshVertices(meshes.size());
+	vector<const unsigned int*> meshIndices(meshes.size());
+
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		meshVertices[i] = meshes[i].vertices.data();
+		meshIndices[i] = meshes[i].indices.data();
+	}
+
+	BuildBoundingVolumes(meshVertices, meshIndices);
+
+	importTimings.uploadTime += glfwGetTime() - stepStartTime;
+
+	// Save the imported meshes so the next launch can load them from the mesh cache
+	MeshCache::SaveModel(filePath_, MODEL_IMPORT_FLAGS, meshes, meshNodes, nodes, glfwGetTime() - importStartTime);
+}
+
+bool Model::LoadFromCache(const string& filePath_)
+{
+	double stepStartTime = glfwGetTime();
+
+	// The file only has to stay mapped until every mesh has been uploaded to the GPU
+	MappedFile cacheFile;
+	vector<MeshCacheView> cachedMeshes;
+
+	if (!MeshCache::LoadModel(filePath_, MODEL_IMPORT_FLAGS, cacheFile, cachedMeshes, nodes))
+		return false;
+
+	importTimings.readTime = glfwGetTime() - stepStartTime;
+
+	vector<Texture> materialTextures;
+
+	for (unsigned int i = 0; i < cachedMeshes.size(); i++)
+	{
+		for (unsigned int j = 0; j < cachedMeshes[i].textures.size(); j++)
+		{
+			Texture texture;
+			texture.textureID = 0;
+			texture.textureType = cachedMeshes[i].textures[j].textureType;
+			texture.texturePath = cachedMeshes[i].textures[j].texturePath;
+
+			materialTextures.push_back(texture);
+		}
+	}
+
+	LoadTextures(materialTextures);
+
+	stepStartTime = glfwGetTime();
+
+	meshes.reserve(cachedMeshes.size());
+
+	/* The mapped vertices are copied once more when they're staged, but the render thread no longer waits for the upload
+	itself */
+	if (asyncLoading && ownsMeshBuffer)
+		meshBuffer->BeginStaging();
+
+	if (meshBuffer != nullptr)
+	{
+		unsigned int vertexCount = 0, indexCount = 0;
+
+		for (unsigned int i = 0; i < cachedMeshes.size(); i++)
+		{
+			vertexCount += cachedMeshes[i].vertexCount;
+			indexCount += cachedMeshes[i].indexCount;
+		}
+
+		meshBuffer->Reserve(vertexCount, indexCount);
+	}
+
+	for (unsigned int i = 0; i < cachedMeshes.size(); i++)
+	{
+		const MeshCacheView& cachedMesh = cachedMeshes[i];
+		vector<Texture> textures;
+
+		for (unsigned int j = 0; j < cachedMesh.textures.size(); j++)
+		{
+			textures.push_back(LoadTexture(cachedMesh.textures[j].texturePath, cachedMesh.textures[j].textureType));
+		}
+
+		meshes.push_back(Mesh(cachedMesh.vertices, cachedMesh.vertexCount, cachedMesh.indices, cachedMesh.indexCount,
+			textures, cachedMesh.boundsMin, cachedMesh.boundsMax, compactVertices, cachedMesh.lods, meshBuffer));
+
+		meshNodes.push_back(cachedMesh.node);
+	}
+
+	StreamMeshBuffer();
+
+	nodes.UpdateWorldTransforms();
+
+	GatherLODErrors();
+	BuildDrawBatches();
+
+	// The cache file is still mapped, so the triangles can be read from it one last time
+	vector<const Vertex*> meshVertices(cachedMeshes.size());
+	vector<const unsigned int*> meshIndices(cachedMeshes.size());
+
+	for (unsigned int i = 0; i < cachedMeshes.size(); i++)
+	{
+		meshVertices[i] = cachedMeshes[i].vertices;
+		meshIndices[i] = cachedMeshes[i].indices;
+	}
+
+	BuildBoundingVolumes(meshVertices, meshIndices);
+
+	importTimings.uploadTime += glfwGetTime() - stepStartTime;
+
+	return true;
 }
 
-void Model::ProcessNode(aiNode* node_, const aiScene* scene_)
+void Model::ProcessNode(aiNode* node_, const aiScene* scene_, vector<aiMesh*>& sceneMeshes_, int parentNode_)
 {
+	// Assimp's matrices are row major and glm's are column major, so every element is swapped across the diagonal
+	const aiMatrix4x4& transformation = node_->mTransformation;
+	mat4 localTransform;
+
+	for (unsigned int row = 0; row < 4; row++)
+	{
+		for (unsigned int column = 0; column < 4; column++)
+		{
+			localTransform[column][row] = transformation[row][column];
+		}
+	}
+
+	unsigned int node = nodes.AddNode(node_->mName.C_Str(), parentNode_, localTransform);
+
 	// Process all the node's meshes
 	for (unsigned int i = 0; i < node_->mNumMeshes; i++)
 	{
 		// Check each node's mesh indices and retrieve the corresponding mesh by indexing the scene's mMeshes array
 		aiMesh* mesh = scene_->mMeshes[node_->mMeshes[i]];
 
-		/* The returned mesh is then passed to the ProcessMesh function that returns a Mesh object that will be stored 
-		in the meshes vector */
-		meshes.push_back(ProcessMesh(mesh, scene_));
+		/* The mesh is later passed to the ProcessMesh function that returns the mesh data of the Mesh object that will be
+		stored in the meshes vector */
+		sceneMeshes_.push_back(mesh);
+		meshNodes.push_back(node);
 	}
 
 	// Process all the node's children
@@ -77,20 +839,26 @@ void Model::ProcessNode(aiNode* node_, const aiScene* scene_)
 	{
 		/* Once all the meshes have been processed, iterate through the node's children and use the ProcessNode function
 		to iterate through each its children */
-		ProcessNode(node_->mChildren[i], scene_);
+		ProcessNode(node_->mChildren[i], scene_, sceneMeshes_, static_cast<int>(node));
 	}
 }
 
-Mesh Model::ProcessMesh(aiMesh* mesh_, const aiScene* scene_)
+MeshData Model::ProcessMesh(aiMesh* mesh_, const aiScene* scene_)
 {
-	vector<Vertex> vertices;
-	vector<unsigned int> indices;
-	vector<Texture> textures;
+	MeshData meshData;
+
+	vector<Vertex>& vertices = meshData.vertices;
+	vector<unsigned int>& indices = meshData.indices;
+	vector<Texture>& textures = meshData.textures;
+
+	// Both sizes are known up front (every face is a triangle after aiProcess_Triangulate), so allocate them only once
+	vertices.resize(mesh_->mNumVertices);
+	indices.reserve(mesh_->mNumFaces * 3);
 
 	// Process the mesh's vertex positions, normals and texture coordinates
 	for (unsigned int i = 0; i < mesh_->mNumVertices; i++)
 	{
-		Vertex vertex;
+		Vertex& vertex = vertices[i];
 		vec3 vector;
 
 		vector.x = mesh_->mVertices[i].x;
@@ -133,8 +901,6 @@ Mesh Model::ProcessMesh(aiMesh* mesh_, const aiScene* scene_)
 		{
 			vertex.meshTextureCoordinates = vec2(0.0f, 0.0f);
 		}
-
-		vertices.push_back(vertex);
 	}
 
 	// Process the mesh's indices
@@ -171,7 +937,13 @@ Mesh Model::ProcessMesh(aiMesh* mesh_, const aiScene* scene_)
 		textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
 	}
 
-	return Mesh(vertices, indices, textures);
+	// Reorder the triangles and vertices for the GPU's caches, this is saved in the mesh cache so it only runs once
+	meshData.optimizationStatistics = MeshOptimizer::OptimizeMesh(vertices, indices);
+
+	// Cheaper versions of the mesh for when it's far away, their indices are added after the full mesh's
+	meshData.lods = MeshSimplifier::GenerateLODs(vertices, indices);
+
+	return meshData;
 }
 
 vector<Texture> Model::LoadMaterialTexture(aiMaterial* material_, aiTextureType textureType, string typeName_)
@@ -183,81 +955,243 @@ vector<Texture> Model::LoadMaterialTexture(aiMaterial* material_, aiTextureType
 		aiString str;
 		material_->GetTexture(textureType, i, &str);
 
-		bool skip = false;
+		// Only the path and type for now, the main thread decides which textures still have to be loaded
+		Texture texture;
+		texture.textureID = 0;
+		texture.textureType = typeName_;
+		texture.texturePath = str.C_Str();
 
-		for (unsigned int j = 0; j < texturesLoaded.size(); j++)
+		textures.push_back(texture);
+	}
+
+	return textures;
+}
+
+void Model::LoadTextures(const vector<Texture>& textures_)
+{
+	double stepStartTime = glfwGetTime();
+
+	/* Every texture this model doesn't have yet and that isn't resident in the texture cache either, only once even if
+	several meshes use it */
+	vector<TextureImage> images;
+	unordered_set<string> queuedPaths;
+
+	for (unsigned int i = 0; i < textures_.size(); i++)
+	{
+		const string& texturePath = textures_[i].texturePath;
+
+		if (texturesLoadedLookup.count(texturePath) != 0 || queuedPaths.count(texturePath) != 0)
+			continue;
+
+		if (asyncLoading)
 		{
-			if (strcmp(texturesLoaded[j].texturePath.data(), str.C_Str()) == 0)
-			{
-				textures.push_back(texturesLoaded[j]);
-				skip = true;
+			// The meshes get the placeholder for now, UpdateStreamingTextures swaps in the real texture later
+			shared_ptr<AsyncTexture> texture = AssetLoader::LoadTextureAsync(fileDirectory + '/' + texturePath,
+				GetTextureOptions(textures_[i].textureType),
+				textures_[i].textureType == "TextureNormal" ? PLACEHOLDER_NORMAL : PLACEHOLDER_COLOR);
 
-				break;
-			}
+			if (!texture->ready)
+				streamingTextures.push_back(make_pair(static_cast<unsigned int>(texturesLoaded.size()), texture));
+
+			AddLoadedTexture(texture->textureID, textures_[i].textureType, texturePath);
+			continue;
 		}
 
-		if (!skip)
+		// Another model (or an earlier load of this one) already has it on the GPU
+		unsigned int textureID = TextureCache::AcquireTexture(fileDirectory + '/' + texturePath,
+			GetTextureOptions(textures_[i].textureType));
+
+		if (textureID != 0)
 		{
-			Texture texture;
-			texture.textureID = TextureFromFile(str.C_Str(), fileDirectory);
-			texture.textureType = typeName_;
-			texture.texturePath = str.C_Str();
-			textures.push_back(texture);
-			texturesLoaded.push_back(texture);
+			AddLoadedTexture(textureID, textures_[i].textureType, texturePath);
+			continue;
 		}
+
+		TextureImage image;
+		image.texturePath = texturePath;
+		image.textureType = textures_[i].textureType;
+
+		images.push_back(image);
+		queuedPaths.insert(texturePath);
 	}
 
-	return textures;
+	/* Decoding the image files is the slow part (encoding them on the first launch even more so), and neither stb_image
+	nor the texture compressor needs OpenGL so it can run on any thread */
+	ParallelFor(static_cast<unsigned int>(images.size()), [&](unsigned int i)
+	{
+		if (!TextureCache::DecodeImage(fileDirectory + '/' + images[i].texturePath,
+			GetTextureOptions(images[i].textureType), images[i].image))
+			images[i].image = DecodedImage();
+	});
+
+	importTimings.decodeTime += glfwGetTime() - stepStartTime;
+	stepStartTime = glfwGetTime();
+
+	for (unsigned int i = 0; i < images.size(); i++)
+	{
+		unsigned int textureID = 0;
+
+		if (images[i].image.data == nullptr && images[i].image.compressed.format == 0)
+			cout << "Texture has failed to load at path: " << images[i].texturePath << endl;
+
+		else
+			textureID = TextureCache::AddTexture(fileDirectory + '/' + images[i].texturePath,
+				GetTextureOptions(images[i].textureType), images[i].image);
+
+		AddLoadedTexture(textureID, images[i].textureType, images[i].texturePath);
+	}
+
+	importTimings.uploadTime += glfwGetTime() - stepStartTime;
 }
 
-unsigned int Model::TextureFromFile(const char* filePath_, const string &fileDirectory_)
+Texture Model::LoadTexture(const string& texturePath_, const string& typeName_)
 {
-	string fileName = string(filePath_);
-	fileName = fileDirectory_ + '/' + fileName;
+	auto loaded = texturesLoadedLookup.find(texturePath_);
 
-	stbi_set_flip_vertically_on_load(true);
+	// Already loaded by another mesh, reuse it
+	if (loaded != texturesLoadedLookup.end())
+		return texturesLoaded[loaded->second];
 
-	glGenTextures(1, &textureID);
+	AddLoadedTexture(TextureFromFile(texturePath_.c_str(), fileDirectory, typeName_), typeName_, texturePath_);
 
-	data = stbi_load(fileName.c_str(), &width, &height, &nrComponents, 0);
+	return texturesLoaded.back();
+}
 
-	if (data != nullptr)
+void Model::UpdateStreamingTextures()
+{
+	for (unsigned int i = 0; i < streamingTextures.size();)
 	{
-		GLenum formatChannel;
+		const AsyncTexture& texture = *streamingTextures[i].second;
 
-		if (nrComponents == 1)
+		if (!texture.ready)
 		{
-			formatChannel = GL_RED;
+			i++;
+			continue;
 		}
 
-		else if (nrComponents == 3)
+		Texture& loadedTexture = texturesLoaded[streamingTextures[i].first];
+
+		// Every mesh that uses the texture still has the placeholder
+		for (unsigned int j = 0; j < meshes.size(); j++)
 		{
-			formatChannel = GL_RGB;
+			for (unsigned int k = 0; k < meshes[j].textures.size(); k++)
+			{
+				if (meshes[j].textures[k].texturePath == loadedTexture.texturePath)
+					meshes[j].textures[k].textureID = texture.textureID;
+			}
 		}
 
-		else if (nrComponents == 4)
+		loadedTexture.textureID = texture.textureID;
+
+		streamingTextures.erase(streamingTextures.begin() + i);
+	}
+}
+
+void Model::StreamMeshBuffer()
+{
+	if (meshBuffer == nullptr || !meshBuffer->IsStaging())
+		return;
+
+	vector<unsigned char> vertexData, indexData;
+	meshBuffer->TakeStagedData(vertexData, indexData);
+
+	streamingBuffers = AssetLoader::LoadBuffersAsync(move(vertexData), move(indexData));
+
+	// Without a loader thread the buffers are ready right away
+	UpdateStreamingBuffers();
+}
+
+bool Model::UpdateStreamingBuffers()
+{
+	if (!streamingBuffers->ready)
+		return false;
+
+	meshBuffer->AdoptBuffers(streamingBuffers->vertexBuffer, streamingBuffers->indexBuffer);
+
+	// The meshes were created before there was a vertex array
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		meshes[i].VAO = meshBuffer->VAO;
+	}
+
+	streamingBuffers = nullptr;
+
+	return true;
+}
+
+void Model::AddLoadedTexture(unsigned int textureID_, const string& typeName_, const string& texturePath_)
+{
+	Texture texture;
+	texture.textureID = textureID_;
+	texture.textureType = typeName_;
+	texture.texturePath = texturePath_;
+
+	texturesLoadedLookup[texturePath_] = static_cast<unsigned int>(texturesLoaded.size());
+	texturesLoaded.push_back(texture);
+}
+
+unsigned int Model::TextureFromFile(const char* filePath_, const string &fileDirectory_, const string& typeName_)
+{
+	string fileName = string(filePath_);
+	fileName = fileDirectory_ + '/' + fileName;
+
+	return TextureCache::LoadTexture(fileName, GetTextureOptions(typeName_));
+}
+
+TextureLoadOptions Model::GetTextureOptions(const string& typeName_)
+{
+	TextureCompression compression = typeName_ == "TextureNormal" ? TEXTURE_COMPRESSION_NORMAL : TEXTURE_COMPRESSION_COLOR;
+
+	return TextureLoadOptions(true, false, 0, true, false, compression);
+}
+
+void Model::ParallelFor(unsigned int count_, const function<void(unsigned int)>& work_)
+{
+	unsigned int threadCount = importThreadCount;
+
+	if (threadCount == 0)
+		threadCount = std::max(thread::hardware_concurrency(), 1u);
+
+	threadCount = std::min(threadCount, count_);
+
+	// On a single thread the mip generator can still use threads of its own for a texture
+	if (threadCount <= 1)
+	{
+		for (unsigned int i = 0; i < count_; i++)
 		{
-			formatChannel = GL_RGBA;
+			work_(i);
 		}
 
-		glBindTexture(GL_TEXTURE_2D, textureID);
-		glTexImage2D(GL_TEXTURE_2D, 0, formatChannel, width, height, 0, formatChannel, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+		return;
+	}
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// Every thread keeps taking the next index until there's nothing left, so a few big meshes don't hold up one thread
+	atomic<unsigned int> nextIndex(0);
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	auto worker = [&]()
+	{
+		/* The work is already spread across every core, a texture decoded here filters its mip levels on this thread
+		instead of starting threads of its own */
+		MipGenerator::SingleThreadScope singleThread;
 
-		stbi_image_free(data);
-	}
+		for (unsigned int i = nextIndex++; i < count_; i = nextIndex++)
+		{
+			work_(i);
+		}
+	};
 
-	else
+	vector<future<void>> workers;
+
+	for (unsigned int i = 1; i < threadCount; i++)
 	{
-		cout << "Texture has failed to load at path: " << filePath_ << endl;
-		stbi_image_free(data);
+		workers.push_back(async(launch::async, worker));
 	}
 
-	return textureID;
-}
\ No newline at end of file
+	// The main thread helps out instead of just waiting
+	worker();
+
+	for (unsigned int i = 0; i < workers.size(); i++)
+	{
+		workers[i].wait();
+	}
+}
@@ -4,6 +4,17 @@
 #define MODEL_H
 
 #include "Mesh.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "TextureCache.h"
+#include "AssetLoader.h"
+#include "BoundingVolumeHierarchy.h"
+#include "NodeTable.h"
+
+#include <functional>
+#include <unordered_map>
+#include <cfloat>
 
 // Include assimp library
 #include <assimp/Importer.hpp>
@@ -15,34 +26,300 @@ using namespace std;
 // Makes it easier to access Assimp's library without having to declare it every time I use it
 using namespace Assimp;
 
+/* Post processing steps every model is imported with, they're also stored in the mesh cache files since a different set
+of steps produces different vertices */
+const unsigned int MODEL_IMPORT_FLAGS = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace;
+
+/* A mesh converted from Assimp on a worker thread, nothing in it touches OpenGL yet. The textures only have their type
+and path filled in, their IDs are set once the main thread uploads them */
+struct MeshData
+{
+	vector<Vertex> vertices;
+	vector<unsigned int> indices;
+	vector<Texture> textures;
+
+	// Where the indices of every level of detail are, the simplified levels are appended after the full mesh's indices
+	vector<MeshLOD> lods;
+
+	MeshOptimizationStatistics optimizationStatistics;
+};
+
+// A texture file decoded on a worker thread, waiting to be uploaded on the main thread
+struct TextureImage
+{
+	string texturePath;
+	string textureType;
+
+	DecodedImage image;
+};
+
+// How long each step of the last load took (in seconds)
+struct ModelImportTimings
+{
+	double readTime; // Assimp's ReadFile or mapping the mesh cache file
+	double convertTime; // converting the Assimp meshes into our vertices and indices
+	double decodeTime; // decoding the texture files
+	double uploadTime; // creating the textures, vertex arrays and buffers
+};
+
+/* Meshes of a model that use the same textures. They sit in the same mesh buffer, so once the textures are bound all of
+them are drawn with a single multi-draw call */
+struct ModelDrawBatch
+{
+	// Index of every mesh of the batch in the model's meshes, the first mesh's textures are bound for all of them
+	vector<unsigned int> meshIndices;
+
+	// The most levels of detail any of the batch's meshes has, the others repeat their coarsest level
+	unsigned int lodCount;
+
+	// Index count, byte offset into the element buffer and base vertex of every mesh, level after level
+	vector<GLsizei> indexCounts;
+	vector<const void*> indexOffsets;
+	vector<GLint> baseVertices;
+
+	// Where the batch's level 0 commands are in the model's indirect buffer, every level follows the one before
+	unsigned int firstCommand;
+
+	/* Where every run of meshes with the same world transform starts in meshIndices, followed by meshIndices.size(). The
+	meshes are in node order, so the meshes of a node (and of nodes that didn't move relative to each other) are next to
+	each other and each run is still drawn with one multi-draw call */
+	vector<unsigned int> transformRuns;
+};
+
+/* A mesh's full (level 0) triangles kept on the CPU with a bounding volume hierarchy over them, so rays can be cast
+against the actual surface instead of the mesh's box */
+struct MeshTriangles
+{
+	vector<vec3> positions;
+
+	// Three indices into positions for every triangle
+	vector<unsigned int> indices;
+
+	// Over the triangles, primitive i is the triangle at indices[i * 3]
+	BoundingVolumeHierarchy bvh;
+};
+
+/* A mesh's coarsest level of detail kept on the CPU for the occlusion culler, with only the vertices its triangles use.
+The positions are in the mesh's node space like the mesh's vertices */
+struct OccluderMesh
+{
+	vector<vec3> positions;
+
+	// Three indices into positions for every triangle
+	vector<unsigned int> indices;
+};
+
+struct ModelRayHit
+{
+	unsigned int meshIndex;
+
+	// Index of the triangle in the mesh's level 0 indices, NO_TRIANGLE if only the mesh's box was tested
+	unsigned int triangle;
+
+	// Along the ray (in units of its direction's length)
+	float distance;
+
+	static const unsigned int NO_TRIANGLE = 0xFFFFFFFF;
+};
+
 class Model
 {
 public:
-	Model(const char* filePath_);
+	/* compactVertices_ stores every mesh in the CompactVertex layout, the model's shaders have to include MeshVertex.glsl.
+	asyncLoading_ loads the textures and creates the vertex and element buffers on the asset loader's thread. The model
+	draws nothing until its buffers arrive and draws with placeholder textures until those do, and its meshes only get
+	their vertex array then, so it doesn't suit a model whose vertex arrays are changed after loading (like instancing).
+	meshBuffer_ puts the meshes into a buffer that other models share as well, which stays alive until its owner deletes
+	it. Without one the model creates its own, compact models don't use one at all */
+	Model(const char* filePath_, bool compactVertices_ = false, bool asyncLoading_ = false,
+		MeshBuffer* meshBuffer_ = nullptr);
 	~Model();
 
-	void DrawModel(ShaderProgram *shaderProgram_);
+	/* Meshes without as many levels of detail as asked for draw their coarsest one. Draws one batch at a time, or one mesh
+	at a time for compact models and when batchDraws is turned off. Ignores the node transforms, every mesh is drawn with
+	whatever model matrix the shader already has */
+	void DrawModel(ShaderProgram *shaderProgram_, unsigned int lod = 0);
+
+	/* Same as above, but every mesh is drawn with modelMatrix_ times its node's world transform, which is set to the
+	modelMatrixUniform_ uniform whenever it changes. Updates the world transforms of the nodes that moved first */
+	void DrawModel(ShaderProgram *shaderProgram_, const mat4& modelMatrix_, unsigned int lod = 0,
+		unsigned int modelMatrixUniform_ = UniformHash("modelMatrix"));
+
+	// Moves a node (and every node below it), the change shows up with the next draw or UpdateNodeTransforms
+	void SetNodeTransform(unsigned int node_, const mat4& localTransform_);
+
+	// Returns the index of the node with the given name (as it's called in the model file), or -1 if there isn't one
+	int FindNode(const string& name_) const;
+
+	/* Recomputes the world transforms of the nodes that moved and everything that depends on them (the model's bounds, the
+	hierarchy over the meshes and the draw runs). Does nothing if no node moved */
+	void UpdateNodeTransforms();
+
+	// Number of levels of detail every mesh of the model has
+	unsigned int GetLODCount() const;
+
+	/* Picks the coarsest level of detail whose simplification error stays below maxPixelError pixels on screen. distance
+	is from the camera to the model, scale is the model matrix's (largest) scale and screenHeight is in pixels */
+	unsigned int SelectLOD(float distance, float scale, const mat4& projectionMatrix, float screenHeight,
+		float maxPixelError = 1.0f) const;
+
+	// Size of all the meshes' vertex and index buffers on the GPU (in bytes), textures not included
+	size_t GetBufferSize() const;
+
+	/* Appends the index of every mesh whose box is at least partly inside the frustum. Everything is in model space, build
+	the frustum from projection * view * model to test a model that's drawn with a model matrix */
+	void QueryFrustum(const Frustum& frustum_, vector<unsigned int>& meshIndices_) const;
+
+	// Appends the index of every mesh whose box the sphere touches (in model space)
+	void QuerySphere(const vec3& center_, float radius_, vector<unsigned int>& meshIndices_) const;
+
+	/* Finds the closest mesh the ray (in model space) hits within maxDistance_. With buildTriangleBVHs the ray is tested
+	against the meshes' triangles, otherwise only against their boxes */
+	bool CastRay(const Ray& ray_, ModelRayHit& hit_, float maxDistance_ = FLT_MAX) const;
 
 	// Model data
 	vector<Mesh> meshes;
 	vector<Texture> texturesLoaded;
+
+	// Index of every texture path in texturesLoaded
+	unordered_map<string, unsigned int> texturesLoadedLookup;
+
+	// Textures still loading on the asset loader's thread, with their index in texturesLoaded
+	vector<pair<unsigned int, shared_ptr<AsyncTexture>>> streamingTextures;
+
+	ModelImportTimings importTimings;
+
+	bool compactVertices;
+	bool asyncLoading;
+
+	// Largest error of every mesh at each level of detail (in model space)
+	vector<float> lodErrors;
+
+	/* The model file's node hierarchy, with a local and world transform for every node. A mesh's vertices are in its node's
+	space, the node's world transform takes them into model space */
+	NodeTable nodes;
+
+	// Node of every mesh
+	vector<unsigned int> meshNodes;
+
+	// Box and sphere around every mesh of the model (in model space)
+	vec3 boundsMin, boundsMax;
+	BoundingSphere boundingSphere;
+
+	// Over the meshes' boxes (in model space), primitive i is meshes[i]
+	BoundingVolumeHierarchy meshBVH;
+
+	// One for every mesh, empty unless the model was loaded with buildTriangleBVHs
+	vector<MeshTriangles> meshTriangles;
+
+	// One for every mesh, empty unless the model was loaded with buildOccluders
+	vector<OccluderMesh> occluderMeshes;
+
+	/* Number of threads used to convert meshes and decode textures (the main thread counts as one of them), 0 uses one
+	thread per core */
+	static unsigned int importThreadCount;
+
+	// Allows drawing every mesh with its own glDrawElementsBaseVertex again, to compare against the batched draws
+	static bool batchDraws;
+
+	/* Keeps every mesh's triangles on the CPU with a hierarchy over them for CastRay. Off by default, the triangles take
+	about as much memory as the vertex buffers do on the GPU */
+	static bool buildTriangleBVHs;
+
+	/* Keeps every mesh's coarsest level of detail on the CPU, so the model can hide other objects from the occlusion
+	culler. Off by default, only a few large models in a scene are worth rasterizing on the CPU every frame. The
+	simplified meshes aren't guaranteed to stay inside the real ones, so they only suit models without holes or deep
+	concave parts that other objects could be seen through */
+	static bool buildOccluders;
+
 private:
 
 	void LoadModel(string filePath_);
-	void ProcessNode(aiNode* node_, const aiScene* scene_);
-	Mesh ProcessMesh(aiMesh* mesh_, const aiScene* scene_);
 
-	vector<Texture> LoadMaterialTexture(aiMaterial* material_, aiTextureType textureType, string typeName_);
+	// Creates the meshes from the model's mesh cache file, returns false if it has to be imported with Assimp instead
+	bool LoadFromCache(const string& filePath_);
+
+	// Draws the batches, either all at once or one transform run at a time if modelMatrix_ isn't nullptr
+	void DrawBatches(ShaderProgram *shaderProgram_, unsigned int lod, const mat4* modelMatrix_,
+		unsigned int modelMatrixUniform_);
 
-	unsigned int TextureFromFile(const char* filePath_, const string& fileDirectory_);
+	// Fills in lodErrors once all the meshes are created
+	void GatherLODErrors();
 
-	unsigned int textureID;
-	int width, height, nrComponents;
+	/* Groups the meshes by their textures once they're all created, and writes the indirect draw commands if the driver
+	supports glMultiDrawElementsIndirect */
+	void BuildDrawBatches();
 
-	unsigned char* data;
+	/* Works out the model's bounds and builds the hierarchy over its meshes once they're all created, and the occluder
+	meshes and triangle hierarchies (on worker threads) if they're wanted. Takes every mesh's vertices and indices since
+	meshes loaded from the mesh cache don't keep them */
+	void BuildBoundingVolumes(const vector<const Vertex*>& meshVertices_, const vector<const unsigned int*>& meshIndices_);
+
+	// Copies the coarsest level of detail of every mesh into occluderMeshes
+	void BuildOccluderMeshes(const vector<const Vertex*>& meshVertices_, const vector<const unsigned int*>& meshIndices_);
+
+	/* Moves every mesh's box into model space with its node's world transform, then works out the model's bounds and
+	builds the hierarchy over the meshes. Runs again whenever a node moves */
+	void UpdateMeshBounds();
+
+	// Splits every draw batch into runs of meshes with the same world transform
+	void BuildTransformRuns();
+
+	/* Collects every mesh in the node hierarchy, in the same order the meshes end up in, and adds every node to the node
+	table below its parent */
+	void ProcessNode(aiNode* node_, const aiScene* scene_, vector<aiMesh*>& sceneMeshes_, int parentNode_ = -1);
+
+	// Runs on worker threads, so it only reads from the scene and never touches OpenGL or the model's members
+	static MeshData ProcessMesh(aiMesh* mesh_, const aiScene* scene_);
+
+	static vector<Texture> LoadMaterialTexture(aiMaterial* material_, aiTextureType textureType, string typeName_);
+
+	/* Decodes every texture that neither the model nor the texture cache has yet on worker threads, then uploads them
+	all on the main thread */
+	void LoadTextures(const vector<Texture>& textures_);
+
+	// Returns the texture at the given path, it's only loaded from the file if no other mesh of this model uses it yet
+	Texture LoadTexture(const string& texturePath_, const string& typeName_);
+
+	// Swaps in the textures the asset loader has finished since the last draw
+	void UpdateStreamingTextures();
+
+	/* With asyncLoading, hands the meshes that were staged in the mesh buffer to the asset loader once they're all
+	created */
+	void StreamMeshBuffer();
+
+	// Creates the vertex array once the asset loader has filled the buffers, returns false until then
+	bool UpdateStreamingBuffers();
+
+	// Keeps the model's reference to a texture, so the destructor can release it
+	void AddLoadedTexture(unsigned int textureID_, const string& typeName_, const string& texturePath_);
+
+	unsigned int TextureFromFile(const char* filePath_, const string& fileDirectory_, const string& typeName_);
+
+	/* Model textures are flipped to match the flipped texture coordinates. Normal maps are compressed as normals (two
+	channels), diffuse and specular maps as colors */
+	static TextureLoadOptions GetTextureOptions(const string& typeName_);
+
+	// Calls work for every index from 0 to count - 1, spread across importThreadCount threads
+	static void ParallelFor(unsigned int count_, const function<void(unsigned int)>& work_);
 
 	string fileDirectory;
 
+	// Where the meshes' vertices and indices are, nullptr for compact models
+	MeshBuffer* meshBuffer;
+	bool ownsMeshBuffer;
+
+	// The mesh buffer's vertex and element buffer while the asset loader is still creating them
+	shared_ptr<AsyncBuffers> streamingBuffers;
+
+	vector<ModelDrawBatch> drawBatches;
+
+	// Every batch's draw commands at every level of detail, 0 without glMultiDrawElementsIndirect
+	unsigned int indirectBuffer;
+
+	// Takes a ray from model space into each node's space, kept up to date with the world transforms for CastRay
+	vector<mat4> inverseNodeTransforms;
+
 	// Let's use Assimp's library here
 	Importer assimpImporter;
 	const aiScene* scene;
@@ -0,0 +1,466 @@
+#include "ModelImportBenchmark.h"
+
+#include <thread>
+#include <iomanip>
+#include <random>
+
+const char* BENCHMARK_MODELS[] = { "Models/Backpack/backpack.obj", "Models/Nanosuit/nanosuit.obj",
+	"Models/Rock/rock.obj", "Models/Planet/planet.obj" };
+
+void ModelImportBenchmark::Run(unsigned int repetitions)
+{
+	// The rock and planet are tiny, they don't tell us anything about import scaling
+	const char* modelPaths[] = { BENCHMARK_MODELS[0], BENCHMARK_MODELS[1] };
+
+	unsigned int coreCount = std::max(thread::hardware_concurrency(), 1u);
+
+	bool cacheEnabled = MeshCache::enabled;
+	bool textureCacheEnabled = TextureCache::enabled;
+	bool compressorEnabled = TextureCompressor::enabled;
+	bool reportStatistics = MeshOptimizer::reportStatistics;
+	unsigned int threadCount = Model::importThreadCount;
+
+	/* Every load has to decode its textures again, otherwise only the first load would measure them. The compressor's KTX
+	files would be read instead of the image files after the first load as well */
+	MeshCache::enabled = false;
+	TextureCache::enabled = false;
+	TextureCompressor::enabled = false;
+	MeshOptimizer::reportStatistics = false;
+
+	cout << "MODEL_IMPORT_BENCHMARK: " << coreCount << " cores, best of " << repetitions << " loads (times in ms)" << endl;
+
+	for (unsigned int i = 0; i < sizeof(modelPaths) / sizeof(modelPaths[0]); i++)
+	{
+		cout << modelPaths[i] << endl;
+		cout << "  threads      total       read    convert     decode     upload" << endl;
+
+		// 1, 2, 4, 8... threads, always ending with one thread per core
+		for (unsigned int threads = 1; threads <= coreCount; threads = (threads == coreCount) ? coreCount + 1 :
+			std::min(threads * 2, coreCount))
+		{
+			Model::importThreadCount = threads;
+
+			double wallTime;
+			ModelImportTimings timings = MeasureModel(modelPaths[i], repetitions, wallTime);
+
+			cout << fixed << setprecision(2) << setw(9) << threads << setw(11) << wallTime * 1000.0 << setw(11) <<
+				timings.readTime * 1000.0 << setw(11) << timings.convertTime * 1000.0 << setw(11) <<
+				timings.decodeTime * 1000.0 << setw(11) << timings.uploadTime * 1000.0 << endl;
+		}
+	}
+
+	cout << defaultfloat;
+
+	MeshCache::enabled = cacheEnabled;
+	TextureCache::enabled = textureCacheEnabled;
+	TextureCompressor::enabled = compressorEnabled;
+	MeshOptimizer::reportStatistics = reportStatistics;
+	Model::importThreadCount = threadCount;
+}
+
+void ModelImportBenchmark::CompareVertexFormats(unsigned int drawCount)
+{
+	ShaderProgram* shaderProgram = new ShaderProgram();
+	shaderProgram->InitializeShaderProgram(new VertexShaderLoader("ModelVertexShader.glsl"), new
+		FragmentShaderLoader("ModelFragmentShader.glsl"));
+
+	cout << "MODEL_VERTEX_FORMATS: buffer sizes in KB, GPU time of " << drawCount << " draws in ms" << endl;
+	cout << "  model                              float    compact      float    compact" << endl;
+
+	for (unsigned int i = 0; i < sizeof(BENCHMARK_MODELS) / sizeof(BENCHMARK_MODELS[0]); i++)
+	{
+		Model* floatModel = new Model(BENCHMARK_MODELS[i]);
+		Model* compactModel = new Model(BENCHMARK_MODELS[i], true);
+
+		// Look at the model from far enough away that all of it is on screen
+		vec3 boundsMin = vec3(0.0f), boundsMax = vec3(0.0f);
+
+		for (unsigned int j = 0; j < floatModel->meshes.size(); j++)
+		{
+			boundsMin = j == 0 ? floatModel->meshes[j].boundsMin : min(boundsMin, floatModel->meshes[j].boundsMin);
+			boundsMax = j == 0 ? floatModel->meshes[j].boundsMax : max(boundsMax, floatModel->meshes[j].boundsMax);
+		}
+
+		vec3 center = (boundsMin + boundsMax) * 0.5f;
+		float radius = std::max(length(boundsMax - boundsMin) * 0.5f, 0.01f);
+
+		GLStateCache::UseProgram(shaderProgram->shaderProgram);
+
+		glUniformMatrix4fv(glGetUniformLocation(shaderProgram->shaderProgram, "modelMatrix"), 1, GL_FALSE,
+			value_ptr(mat4(1.0f)));
+
+		glUniformMatrix4fv(glGetUniformLocation(shaderProgram->shaderProgram, "viewMatrix"), 1, GL_FALSE,
+			value_ptr(lookAt(center + vec3(0.0f, 0.0f, radius * 3.0f), center, vec3(0.0f, 1.0f, 0.0f))));
+
+		glUniformMatrix4fv(glGetUniformLocation(shaderProgram->shaderProgram, "projectionMatrix"), 1, GL_FALSE,
+			value_ptr(perspective(radians(45.0f), 1280.0f / 960.0f, radius * 0.1f, radius * 10.0f)));
+
+		// Draw each once first so the driver has done all its lazy setup before we measure anything
+		MeasureDrawTime(floatModel, shaderProgram, 1);
+		MeasureDrawTime(compactModel, shaderProgram, 1);
+
+		double floatDrawTime = MeasureDrawTime(floatModel, shaderProgram, drawCount);
+		double compactDrawTime = MeasureDrawTime(compactModel, shaderProgram, drawCount);
+
+		cout << "  " << left << setw(30) << BENCHMARK_MODELS[i] << right << fixed << setprecision(1) << setw(11) <<
+			floatModel->GetBufferSize() / 1024.0 << setw(11) << compactModel->GetBufferSize() / 1024.0 << setprecision(2) <<
+			setw(11) << floatDrawTime * 1000.0 << setw(11) << compactDrawTime * 1000.0 << endl;
+
+		delete floatModel;
+		delete compactModel;
+	}
+
+	cout << defaultfloat;
+
+	GLStateCache::UseProgram(0);
+	glDeleteProgram(shaderProgram->shaderProgram);
+	delete shaderProgram;
+}
+
+void ModelImportBenchmark::MeasureBoundingVolumes(unsigned int queryCount)
+{
+	bool cacheEnabled = MeshCache::enabled;
+	bool reportStatistics = MeshOptimizer::reportStatistics;
+	bool triangleBVHs = Model::buildTriangleBVHs;
+
+	// Meshes loaded from the mesh cache don't keep their vertices, and the bounds are computed from them again here
+	MeshCache::enabled = false;
+	MeshOptimizer::reportStatistics = false;
+	Model::buildTriangleBVHs = true;
+
+	// The same seed every time, so the numbers can be compared between runs
+	mt19937 random(1234);
+	uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	// Keeps the compiler from throwing away bounds that are never used
+	volatile float sink = 0.0f;
+
+	cout << "BOUNDING_VOLUMES: " << queryCount << " queries of every kind per model, with the hierarchies and by testing "
+		"every triangle" << endl;
+
+	for (unsigned int i = 0; i < sizeof(BENCHMARK_MODELS) / sizeof(BENCHMARK_MODELS[0]); i++)
+	{
+		Model* model = new Model(BENCHMARK_MODELS[i]);
+
+		unsigned int vertexCount = 0, triangleCount = 0;
+
+		for (unsigned int j = 0; j < model->meshes.size(); j++)
+		{
+			vertexCount += model->meshes[j].vertexCount;
+			triangleCount += static_cast<unsigned int>(model->meshTriangles[j].indices.size() / 3);
+		}
+
+		if (vertexCount == 0)
+		{
+			delete model;
+			continue;
+		}
+
+		// Enough passes over the vertices that the time isn't just the timer's resolution
+		unsigned int passes = std::max(4000000u / vertexCount, 1u);
+
+		double startTime = glfwGetTime();
+
+		for (unsigned int pass = 0; pass < passes; pass++)
+		{
+			for (unsigned int j = 0; j < model->meshes.size(); j++)
+			{
+				const Mesh& mesh = model->meshes[j];
+				vec3 boundsMin, boundsMax;
+
+				BoundingVolumes::ComputeBounds(mesh.vertices.data(), mesh.vertexCount, boundsMin, boundsMax);
+				sink = sink + boundsMin.x + boundsMax.x;
+			}
+		}
+
+		double simdBoundsTime = glfwGetTime() - startTime;
+		startTime = glfwGetTime();
+
+		for (unsigned int pass = 0; pass < passes; pass++)
+		{
+			for (unsigned int j = 0; j < model->meshes.size(); j++)
+			{
+				const Mesh& mesh = model->meshes[j];
+				vec3 boundsMin = mesh.vertices[0].meshPosition, boundsMax = mesh.vertices[0].meshPosition;
+
+				for (unsigned int k = 1; k < mesh.vertexCount; k++)
+				{
+					boundsMin = min(boundsMin, mesh.vertices[k].meshPosition);
+					boundsMax = max(boundsMax, mesh.vertices[k].meshPosition);
+				}
+
+				sink = sink + boundsMin.x + boundsMax.x;
+			}
+		}
+
+		double scalarBoundsTime = glfwGetTime() - startTime;
+
+		// Builds every triangle hierarchy again on this thread alone, the model built its own on several threads
+		startTime = glfwGetTime();
+
+		for (unsigned int j = 0; j < model->meshTriangles.size(); j++)
+		{
+			const MeshTriangles& triangles = model->meshTriangles[j];
+			unsigned int meshTriangleCount = static_cast<unsigned int>(triangles.indices.size() / 3);
+
+			vector<vec3> triangleMins(meshTriangleCount), triangleMaxs(meshTriangleCount);
+
+			for (unsigned int k = 0; k < meshTriangleCount; k++)
+			{
+				const vec3& a = triangles.positions[triangles.indices[k * 3]];
+				const vec3& b = triangles.positions[triangles.indices[k * 3 + 1]];
+				const vec3& c = triangles.positions[triangles.indices[k * 3 + 2]];
+
+				triangleMins[k] = min(min(a, b), c);
+				triangleMaxs[k] = max(max(a, b), c);
+			}
+
+			BoundingVolumeHierarchy bvh;
+			bvh.Build(triangleMins, triangleMaxs);
+		}
+
+		double buildTime = glfwGetTime() - startTime;
+
+		// Rays, frustums and spheres are all aimed at random points inside the model's box
+		vec3 center = model->boundingSphere.center;
+		float radius = std::max(model->boundingSphere.radius, 0.01f);
+
+		auto RandomPointInBounds = [&]()
+		{
+			return model->boundsMin + (model->boundsMax - model->boundsMin) * vec3(unit(random), unit(random), unit(random));
+		};
+
+		auto RandomPointAround = [&]()
+		{
+			vec3 direction = vec3(unit(random), unit(random), unit(random)) * 2.0f - 1.0f;
+
+			if (dot(direction, direction) < 1e-6f)
+				direction = vec3(0.0f, 0.0f, 1.0f);
+
+			return center + normalize(direction) * radius * 3.0f;
+		};
+
+		vector<Ray> rays;
+		vector<Frustum> frustums;
+		vector<vec3> sphereCenters;
+
+		for (unsigned int j = 0; j < queryCount; j++)
+		{
+			vec3 origin = RandomPointAround();
+			vec3 target = RandomPointInBounds();
+
+			rays.push_back(Ray(origin, normalize(target - origin)));
+
+			// A narrow view of part of the model, like a camera close to it would have
+			frustums.push_back(Frustum(perspective(radians(20.0f), 1.0f, radius * 0.1f, radius * 10.0f) *
+				lookAt(RandomPointAround(), RandomPointInBounds(), vec3(0.0f, 1.0f, 0.0f))));
+
+			sphereCenters.push_back(RandomPointInBounds());
+		}
+
+		float sphereRadius = radius * 0.05f;
+
+		vector<float> hitDistances(queryCount);
+		vector<unsigned int> results;
+		size_t bvhFrustumResults = 0, bvhSphereResults = 0;
+
+		startTime = glfwGetTime();
+
+		for (unsigned int j = 0; j < queryCount; j++)
+		{
+			ModelRayHit hit;
+			hitDistances[j] = model->CastRay(rays[j], hit) ? hit.distance : -1.0f;
+		}
+
+		double bvhRayTime = glfwGetTime() - startTime;
+		startTime = glfwGetTime();
+
+		for (unsigned int j = 0; j < queryCount; j++)
+		{
+			for (unsigned int k = 0; k < model->meshTriangles.size(); k++)
+			{
+				results.clear();
+				model->meshTriangles[k].bvh.QueryFrustum(frustums[j], results);
+				bvhFrustumResults += results.size();
+			}
+		}
+
+		double bvhFrustumTime = glfwGetTime() - startTime;
+		startTime = glfwGetTime();
+
+		for (unsigned int j = 0; j < queryCount; j++)
+		{
+			for (unsigned int k = 0; k < model->meshTriangles.size(); k++)
+			{
+				results.clear();
+				model->meshTriangles[k].bvh.QuerySphere(sphereCenters[j], sphereRadius, results);
+				bvhSphereResults += results.size();
+			}
+		}
+
+		double bvhSphereTime = glfwGetTime() - startTime;
+
+		unsigned int agreeingRays = 0;
+		size_t allFrustumResults = 0, allSphereResults = 0;
+
+		startTime = glfwGetTime();
+
+		for (unsigned int j = 0; j < queryCount; j++)
+		{
+			float closestDistance = FLT_MAX;
+
+			for (unsigned int k = 0; k < model->meshTriangles.size(); k++)
+			{
+				const MeshTriangles& triangles = model->meshTriangles[k];
+
+				for (unsigned int l = 0; l + 2 < triangles.indices.size(); l += 3)
+				{
+					float distance;
+
+					if (BoundingVolumes::RayIntersectsTriangle(rays[j], triangles.positions[triangles.indices[l]],
+						triangles.positions[triangles.indices[l + 1]], triangles.positions[triangles.indices[l + 2]], distance))
+					{
+						closestDistance = std::min(closestDistance, distance);
+					}
+				}
+			}
+
+			float expectedDistance = closestDistance == FLT_MAX ? -1.0f : closestDistance;
+
+			if (fabsf(expectedDistance - hitDistances[j]) <= 1e-4f * std::max(1.0f, fabsf(expectedDistance)))
+				agreeingRays++;
+		}
+
+		double allRayTime = glfwGetTime() - startTime;
+
+		// Testing every triangle's box, which is what the hierarchies answer as well
+		auto ForEveryTriangleBox = [&](const function<bool(const vec3&, const vec3&)>& test)
+		{
+			size_t count = 0;
+
+			for (unsigned int k = 0; k < model->meshTriangles.size(); k++)
+			{
+				const MeshTriangles& triangles = model->meshTriangles[k];
+
+				for (unsigned int l = 0; l + 2 < triangles.indices.size(); l += 3)
+				{
+					const vec3& a = triangles.positions[triangles.indices[l]];
+					const vec3& b = triangles.positions[triangles.indices[l + 1]];
+					const vec3& c = triangles.positions[triangles.indices[l + 2]];
+
+					if (test(min(min(a, b), c), max(max(a, b), c)))
+						count++;
+				}
+			}
+
+			return count;
+		};
+
+		startTime = glfwGetTime();
+
+		for (unsigned int j = 0; j < queryCount; j++)
+		{
+			allFrustumResults += ForEveryTriangleBox([&](const vec3& boxMin, const vec3& boxMax)
+			{
+				return frustums[j].IntersectsBox(boxMin, boxMax);
+			});
+		}
+
+		double allFrustumTime = glfwGetTime() - startTime;
+		startTime = glfwGetTime();
+
+		for (unsigned int j = 0; j < queryCount; j++)
+		{
+			allSphereResults += ForEveryTriangleBox([&](const vec3& boxMin, const vec3& boxMax)
+			{
+				return BoundingVolumes::SphereIntersectsBox(sphereCenters[j], sphereRadius, boxMin, boxMax);
+			});
+		}
+
+		double allSphereTime = glfwGetTime() - startTime;
+
+		double vertexPasses = static_cast<double>(vertexCount) * passes;
+
+		cout << "  " << BENCHMARK_MODELS[i] << ", " << triangleCount << " triangles in " << model->meshes.size() <<
+			" meshes" << endl;
+
+		cout << fixed << setprecision(2) << "    bounds   " << setw(10) << simdBoundsTime * 1e9 / vertexPasses <<
+			" ns per vertex with SSE, " << scalarBoundsTime * 1e9 / vertexPasses << " without" << endl;
+
+		cout << "    build    " << setw(10) << buildTime * 1000.0 << " ms for every triangle hierarchy" << endl;
+
+		cout << setprecision(4) << "    rays     " << setw(10) << bvhRayTime * 1000.0 / queryCount << " ms each, " <<
+			allRayTime * 1000.0 / queryCount << " testing every triangle (" << agreeingRays << " of " << queryCount <<
+			" agree)" << endl;
+
+		cout << "    frustums " << setw(10) << bvhFrustumTime * 1000.0 / queryCount << " ms each, " <<
+			allFrustumTime * 1000.0 / queryCount << " testing every triangle (" << bvhFrustumResults << " and " <<
+			allFrustumResults << " triangles found)" << endl;
+
+		cout << "    spheres  " << setw(10) << bvhSphereTime * 1000.0 / queryCount << " ms each, " <<
+			allSphereTime * 1000.0 / queryCount << " testing every triangle (" << bvhSphereResults << " and " <<
+			allSphereResults << " triangles found)" << endl;
+
+		cout << defaultfloat;
+
+		delete model;
+	}
+
+	MeshCache::enabled = cacheEnabled;
+	MeshOptimizer::reportStatistics = reportStatistics;
+	Model::buildTriangleBVHs = triangleBVHs;
+}
+
+double ModelImportBenchmark::MeasureDrawTime(Model* model, ShaderProgram* shaderProgram, unsigned int drawCount)
+{
+	unsigned int query;
+	glGenQueries(1, &query);
+
+	GLStateCache::Enable(GL_DEPTH_TEST);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	glBeginQuery(GL_TIME_ELAPSED, query);
+
+	for (unsigned int i = 0; i < drawCount; i++)
+	{
+		model->DrawModel(shaderProgram, mat4(1.0f));
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+
+	// Blocks until the GPU is done with every draw
+	GLuint64 elapsedTime = 0;
+	glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsedTime);
+
+	glDeleteQueries(1, &query);
+
+	return elapsedTime / 1e9;
+}
+
+ModelImportTimings ModelImportBenchmark::MeasureModel(const char* filePath, unsigned int repetitions, double& wallTime)
+{
+	ModelImportTimings bestTimings = { 0.0, 0.0, 0.0, 0.0 };
+	wallTime = 0.0;
+
+	for (unsigned int i = 0; i < repetitions; i++)
+	{
+		double startTime = glfwGetTime();
+
+		Model* model = new Model(filePath);
+
+		// Wait for the driver too, otherwise the uploads would only be queued and not actually measured
+		glFinish();
+
+		double loadTime = glfwGetTime() - startTime;
+
+		if (i == 0 || loadTime < wallTime)
+		{
+			wallTime = loadTime;
+			bestTimings = model->importTimings;
+		}
+
+		delete model;
+	}
+
+	return bestTimings;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#ifndef MODEL_IMPORT_BENCHMARK_H
+#define MODEL_IMPORT_BENCHMARK_H
+
+#include "Model.h"
+
+using namespace std;
+
+/* Loads the same models over and over with a growing number of import threads and prints how long every step took, so we
+can see how well mesh conversion and texture decoding scale with the number of cores. The mesh cache is turned off while
+it runs, otherwise every load after the first one would skip Assimp completely */
+
+class ModelImportBenchmark
+{
+public:
+	// Needs a current OpenGL context, every model is deleted again right after it's loaded
+	static void Run(unsigned int repetitions = 3);
+
+	/* Loads every model with full float vertices and with compact vertices, and prints the size of their buffers and how
+	long the GPU takes to draw them drawCount times (measured with a GL_TIME_ELAPSED query) */
+	static void CompareVertexFormats(unsigned int drawCount = 100);
+
+	/* Times computing the mesh bounds with and without SSE, building every mesh's triangle hierarchy, and queryCount ray
+	casts, frustum queries and sphere queries against the triangles with the hierarchies and by testing every triangle.
+	Only needs the CPU side of the models, but creating them still needs an OpenGL context */
+	static void MeasureBoundingVolumes(unsigned int queryCount = 10000);
+
+private:
+	ModelImportBenchmark() { }
+
+	// Loads the model repetitions times and keeps the fastest wall clock time of every step
+	static ModelImportTimings MeasureModel(const char* filePath, unsigned int repetitions, double& wallTime);
+
+	// GPU time of drawing the model drawCount times (in seconds)
+	static double MeasureDrawTime(Model* model, ShaderProgram* shaderProgram, unsigned int drawCount);
+};
+
+#endif
@@ -10,9 +10,11 @@ uniform mat4 modelMatrix;
 uniform mat4 projectionMatrix;
 uniform mat4 viewMatrix;
 
+#include "MeshVertex.glsl"
+
 void main()
 {
 	textureCoords = modelTextureCoordinate;
 
-	gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(modelPosition, 1.0);
+	gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(MeshPosition(modelPosition), 1.0);
 }
\ No newline at end of file
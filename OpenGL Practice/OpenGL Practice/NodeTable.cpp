@@ -0,0 +1,117 @@
+#include "NodeTable.h"
+
+#include <algorithm>
+
+NodeTable::NodeTable()
+{
+	dirtyCount = 0;
+	firstDirtyNode = 0;
+}
+
+unsigned int NodeTable::AddNode(const string& name_, int parent_, const mat4& localTransform_)
+{
+	unsigned int node = static_cast<unsigned int>(parents.size());
+
+	parents.push_back(parent_);
+	subtreeEnds.push_back(node + 1);
+	localTransforms.push_back(localTransform_);
+	worldTransforms.push_back(localTransform_);
+	dirtyFlags.push_back(1);
+	names.push_back(name_);
+
+	// Depth first, so the new node is the last descendant so far of every one of its ancestors
+	for (int ancestor = parent_; ancestor >= 0; ancestor = parents[ancestor])
+	{
+		subtreeEnds[ancestor] = node + 1;
+	}
+
+	if (dirtyCount++ == 0)
+		firstDirtyNode = node;
+
+	return node;
+}
+
+void NodeTable::Clear()
+{
+	parents.clear();
+	subtreeEnds.clear();
+	localTransforms.clear();
+	worldTransforms.clear();
+	dirtyFlags.clear();
+	names.clear();
+
+	dirtyCount = 0;
+	firstDirtyNode = 0;
+}
+
+unsigned int NodeTable::GetNodeCount() const
+{
+	return static_cast<unsigned int>(parents.size());
+}
+
+int NodeTable::FindNode(const string& name_) const
+{
+	for (unsigned int i = 0; i < names.size(); i++)
+	{
+		if (names[i] == name_)
+			return static_cast<int>(i);
+	}
+
+	return -1;
+}
+
+void NodeTable::SetLocalTransform(unsigned int node_, const mat4& localTransform_)
+{
+	localTransforms[node_] = localTransform_;
+
+	if (dirtyFlags[node_])
+		return;
+
+	dirtyFlags[node_] = 1;
+
+	firstDirtyNode = dirtyCount == 0 ? node_ : std::min(firstDirtyNode, node_);
+	dirtyCount++;
+}
+
+bool NodeTable::HasDirtyNodes() const
+{
+	return dirtyCount > 0;
+}
+
+unsigned int NodeTable::UpdateWorldTransforms()
+{
+	if (dirtyCount == 0)
+		return 0;
+
+	unsigned int nodeCount = GetNodeCount();
+	unsigned int updatedCount = 0;
+
+	for (unsigned int i = firstDirtyNode; i < nodeCount;)
+	{
+		if (!dirtyFlags[i])
+		{
+			i++;
+			continue;
+		}
+
+		/* Every node below a dirty node moves with it, and they all directly follow it. Their parents come before them, so
+		each parent's world transform is already up to date by the time its children are recomputed */
+		unsigned int subtreeEnd = subtreeEnds[i];
+
+		for (unsigned int j = i; j < subtreeEnd; j++)
+		{
+			int parent = parents[j];
+
+			worldTransforms[j] = parent < 0 ? localTransforms[j] : worldTransforms[parent] * localTransforms[j];
+			dirtyFlags[j] = 0;
+		}
+
+		updatedCount += subtreeEnd - i;
+		i = subtreeEnd;
+	}
+
+	dirtyCount = 0;
+	firstDirtyNode = 0;
+
+	return updatedCount;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#ifndef NODE_TABLE_H
+#define NODE_TABLE_H
+
+#include <glm.hpp>
+
+#include <vector>
+#include <string>
+
+using namespace std;
+using namespace glm;
+
+/* The node hierarchy of a model (Assimp's aiNode tree), kept as a table instead of a tree of objects. Every property of the
+nodes lives in its own array (a structure of arrays), so updating the transforms only walks through the parent indices and
+matrices one after the other without touching the names or anything else.
+
+The nodes are stored depth first: a node's parent always comes before it, and all of a node's descendants directly follow
+it up to subtreeEnds. A node's world transform is its parent's world transform times its own local transform. Changing a
+local transform only marks the node as dirty, and UpdateWorldTransforms recomputes the dirty nodes together with everything
+below them in one pass, skipping every subtree where nothing changed */
+
+class NodeTable
+{
+public:
+	NodeTable();
+
+	/* Appends a node and returns its index, parent_ is -1 for the root. Nodes have to be added depth first (a node and
+	then all its descendants), the order Assimp's hierarchy is walked in */
+	unsigned int AddNode(const string& name_, int parent_, const mat4& localTransform_);
+
+	void Clear();
+
+	unsigned int GetNodeCount() const;
+
+	// Returns the index of the first node with the name, or -1 if there isn't one
+	int FindNode(const string& name_) const;
+
+	// The world transform follows with the next UpdateWorldTransforms
+	void SetLocalTransform(unsigned int node_, const mat4& localTransform_);
+
+	bool HasDirtyNodes() const;
+
+	/* Recomputes the world transform of every dirty node and every node below it, returns how many were recomputed (0 if
+	nothing changed since the last update) */
+	unsigned int UpdateWorldTransforms();
+
+	// One entry per node in every array
+	vector<int> parents;
+
+	// One past the node's last descendant, the node's subtree is [node, subtreeEnd)
+	vector<unsigned int> subtreeEnds;
+
+	vector<mat4> localTransforms;
+
+	// Only up to date after UpdateWorldTransforms
+	vector<mat4> worldTransforms;
+
+	// vector<bool> packs the flags into bits, which turns every read and write into a mask
+	vector<unsigned char> dirtyFlags;
+
+	vector<string> names;
+
+private:
+	// Nodes marked dirty since the last update, and the first of them so the update can start there
+	unsigned int dirtyCount;
+	unsigned int firstDirtyNode;
+};
+
+#endif
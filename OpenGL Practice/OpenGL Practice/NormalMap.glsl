@@ -0,0 +1,9 @@
+// Normal maps are stored as BC5 (see TextureCompressor.h), which only keeps the X and Y of the normal in red and green.
+// A tangent space normal always points away from the surface, so Z is the positive root that makes it unit length
+vec3 SampleNormalMap(sampler2D normalMap, vec2 textureCoords)
+{
+    vec2 normalXY = texture(normalMap, textureCoords).rg * 2.0 - 1.0;
+    float normalZ = sqrt(max(1.0 - dot(normalXY, normalXY), 0.0));
+
+    return normalize(vec3(normalXY, normalZ));
+}
@@ -1,5 +1,6 @@
 #include "NormalMapping.h"
 #include "Camera.h"
+#include "TextureCache.h"
 
 NormalMapping* NormalMapping::normalMappingInstance = 0;
 
@@ -27,10 +28,10 @@ NormalMapping::NormalMapping() : normalMappingShaderProgram(new ShaderProgram())
 
 NormalMapping::~NormalMapping()
 {
-    glDeleteVertexArrays(1, &quadVAO);
-    glDeleteBuffers(1, &quadVBO);
-    glDeleteTextures(1, &diffuseMap);
-    glDeleteTextures(1, &normalMap);
+    GLStateCache::DeleteVertexArrays(1, &quadVAO);
+    GLStateCache::DeleteBuffers(1, &quadVBO);
+    TextureCache::ReleaseTexture(diffuseMap);
+    TextureCache::ReleaseTexture(normalMap);
 }
 
 NormalMapping* NormalMapping::Instance()
@@ -46,15 +47,15 @@ NormalMapping* NormalMapping::Instance()
 
 void NormalMapping::InitializeNormalMapping()
 {
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::Enable(GL_DEPTH_TEST);
 
 	normalMappingShaderProgram->InitializeShaderProgram(new VertexShaderLoader("NormalMappingVertexShader.glsl"),
 		new FragmentShaderLoader("NormalMappingFragmentShader.glsl"));
 
-    diffuseMap = LoadTexture("Textures/Brick wall.jpg");
-    normalMap = LoadTexture("Textures/Brick wall normal.jpg");
+    diffuseMap = LoadTexture("Textures/Brick wall.jpg", TEXTURE_COMPRESSION_COLOR);
+    normalMap = LoadTexture("Textures/Brick wall normal.jpg", TEXTURE_COMPRESSION_NORMAL);
 
-    glUseProgram(normalMappingShaderProgram->shaderProgram);
+    GLStateCache::UseProgram(normalMappingShaderProgram->shaderProgram);
 
     glUniform1i(glGetUniformLocation(normalMappingShaderProgram->shaderProgram, "diffuseMap"), 0);
     glUniform1i(glGetUniformLocation(normalMappingShaderProgram->shaderProgram, "normalMap"), 1);
@@ -67,17 +68,7 @@ void NormalMapping::RenderNormalMapping()
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // configure view/projection matrices
-    mat4 projectionMatrix = perspective(radians(Camera::fieldOfView), float(1280 / 960), 0.1f, 100.0f);
-    mat4 viewMatrix = lookAt(Camera::cameraPosition, Camera::cameraPosition + Camera::cameraFront, Camera::cameraUp);
-
-    glUseProgram(normalMappingShaderProgram->shaderProgram);
-
-    glUniformMatrix4fv(glGetUniformLocation(normalMappingShaderProgram->shaderProgram, "projectionMatrix"), 1,
-        GL_FALSE, value_ptr(projectionMatrix));
-
-    glUniformMatrix4fv(glGetUniformLocation(normalMappingShaderProgram->shaderProgram, "viewMatrix"), 1,
-        GL_FALSE, value_ptr(viewMatrix));
+    GLStateCache::UseProgram(normalMappingShaderProgram->shaderProgram);
 
     // Render normal-mapped quad
     glm::mat4 model = glm::mat4(1.0f);
@@ -88,17 +79,14 @@ void NormalMapping::RenderNormalMapping()
     glUniformMatrix4fv(glGetUniformLocation(normalMappingShaderProgram->shaderProgram, "modelMatrix"), 1, 
         GL_FALSE, value_ptr(model));
 
-    glUniform3fv(glGetUniformLocation(normalMappingShaderProgram->shaderProgram, "viewPosition"), 1, 
-        value_ptr(Camera::cameraPosition));
-
     glUniform3fv(glGetUniformLocation(normalMappingShaderProgram->shaderProgram, "lightPosition"), 1, 
         value_ptr(lightPosition));
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, diffuseMap);
+    GLStateCache::ActiveTexture(GL_TEXTURE0);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, diffuseMap);
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, normalMap);
+    GLStateCache::ActiveTexture(GL_TEXTURE1);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, normalMap);
 
     RenderQuad();
 
@@ -113,43 +101,10 @@ void NormalMapping::RenderNormalMapping()
     RenderQuad();
 }
 
-unsigned int NormalMapping::LoadTexture(char const* path_)
+unsigned int NormalMapping::LoadTexture(char const* path_, TextureCompression compression_)
 {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(path_, &width, &height, &nrComponents, 0);
-
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        // Use GL_CLAMP_TO_EDGE to prevent semi-transparent borders, due to interpolation it takes texels from next repeat
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path_ << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
+    // Textures with an alpha channel clamp to the edge to prevent semi-transparent borders
+    return TextureCache::LoadTexture(path_, TextureLoadOptions(false, false, 0, true, true, compression_));
 }
 
 void NormalMapping::RenderQuad()
@@ -227,8 +182,8 @@ void NormalMapping::RenderQuad()
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
 
-        glBindVertexArray(quadVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        GLStateCache::BindVertexArray(quadVAO);
+        GLStateCache::BindBuffer(GL_ARRAY_BUFFER, quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
 
         glEnableVertexAttribArray(0);
@@ -243,7 +198,7 @@ void NormalMapping::RenderQuad()
         glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(11 * sizeof(float)));
     }
 
-    glBindVertexArray(quadVAO);
+    GLStateCache::BindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    GLStateCache::BindVertexArray(0);
 }
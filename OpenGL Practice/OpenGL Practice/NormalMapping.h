@@ -10,6 +10,7 @@
 #include <gtc/type_ptr.hpp>
 
 #include "ShaderProgram.h"
+#include "TextureCompressor.h"
 
 using namespace std;
 using namespace glm;
@@ -27,7 +28,7 @@ public:
 private:
 	NormalMapping();
 
-	unsigned int LoadTexture(char const* path_);
+	unsigned int LoadTexture(char const* path_, TextureCompression compression_);
 
 	void RenderQuad();
 
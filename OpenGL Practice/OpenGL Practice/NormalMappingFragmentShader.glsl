@@ -16,7 +16,8 @@ uniform sampler2D diffuseMap;
 uniform sampler2D normalMap;
 
 uniform vec3 lightPosition;
-uniform vec3 viewPosition;
+
+#include "NormalMap.glsl"
 
 void main()
 {
@@ -25,11 +26,8 @@ void main()
 
 	// With TBN matrix, update the normal mapping code to include the tangent-to-world space transformation
 
-	// Obtain normal from normal map in range from 0 to 1
-    vec3 normal = texture(normalMap, normalMapping_fs.textureCoords).rgb;
-
-    // Transform normal vector to range from -1 to 1 (set the normal to be in tangent space here)
-    normal = normalize(normal * 2.0 - 1.0);
+	// Obtain normal from normal map in range from 0 to 1, transformed to range from -1 to 1 (in tangent space here)
+    vec3 normal = SampleNormalMap(normalMap, normalMapping_fs.textureCoords);
 
 	// Get the diffuse color
 	vec3 color = texture(diffuseMap, normalMapping_fs.textureCoords).rgb;
@@ -16,12 +16,10 @@ out SHADER_OUT
 
 } normalMapping_vs;
 
-uniform mat4 projectionMatrix;
-uniform mat4 viewMatrix;
+#include "FrameUniforms.glsl"
 uniform mat4 modelMatrix;
 
 uniform vec3 lightPosition;
-uniform vec3 viewPosition;
 
 void main()
 {
@@ -44,8 +42,8 @@ void main()
 	mat3 TBN = transpose(mat3(T, B, N));
 
 	normalMapping_vs.tangentLightPosition = TBN * lightPosition;
-	normalMapping_vs.tangentViewPosition = TBN * viewPosition;
+	normalMapping_vs.tangentViewPosition = TBN * frame.cameraPosition.xyz;
 	normalMapping_vs.tangentFragPosition = TBN * normalMapping_vs.fragPos;
 
-	gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(position, 1.0);
+	gl_Position = frame.viewProjection * modelMatrix * vec4(position, 1.0);
 }
\ No newline at end of file
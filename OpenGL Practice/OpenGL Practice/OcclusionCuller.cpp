@@ -0,0 +1,381 @@
+#include "OcclusionCuller.h"
+
+#include <glfw3.h>
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+// Same check as the instance culler, every x64 CPU has SSE2
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_CULLER_SSE
+#include <emmintrin.h>
+#endif
+
+OcclusionCuller::OcclusionCuller(unsigned int width_, unsigned int height_)
+{
+	useSIMD = true;
+
+	width = (std::max(width_, 4u) + 3) & ~3u;
+	height = std::max(height_, 1u);
+
+	viewProjectionMatrix = mat4(1.0f);
+
+	// Halve the size until a single texel covers the whole screen
+	unsigned int levelWidth = width;
+	unsigned int levelHeight = height;
+
+	while (true)
+	{
+		levelWidths.push_back(levelWidth);
+		levelHeights.push_back(levelHeight);
+		depthLevels.push_back(vector<float>(levelWidth * levelHeight, 1.0f));
+
+		if (levelWidth == 1 && levelHeight == 1)
+			break;
+
+		levelWidth = (levelWidth + 1) / 2;
+		levelHeight = (levelHeight + 1) / 2;
+	}
+
+	statistics = { 0, 0, 0, 0.0, 0.0 };
+}
+
+void OcclusionCuller::BeginFrame(const mat4& viewProjectionMatrix_)
+{
+	viewProjectionMatrix = viewProjectionMatrix_;
+
+	fill(depthLevels[0].begin(), depthLevels[0].end(), 1.0f);
+
+	statistics = { 0, 0, 0, 0.0, 0.0 };
+}
+
+void OcclusionCuller::RasterizeOccluder(const OccluderMesh& occluder_, const mat4& modelMatrix_)
+{
+	double startTime = glfwGetTime();
+
+	mat4 modelViewProjection = viewProjectionMatrix * modelMatrix_;
+
+	unsigned int vertexCount = static_cast<unsigned int>(occluder_.positions.size());
+
+	screenPositions.resize(vertexCount);
+	inFrontFlags.resize(vertexCount);
+
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		vec4 clipPosition = modelViewProjection * vec4(occluder_.positions[i], 1.0f);
+
+		// OpenGL's near plane is where z = -w
+		inFrontFlags[i] = clipPosition.w > 0.0f && clipPosition.z >= -clipPosition.w;
+
+		if (!inFrontFlags[i])
+			continue;
+
+		vec3 ndcPosition = vec3(clipPosition) / clipPosition.w;
+
+		screenPositions[i] = vec3((ndcPosition.x * 0.5f + 0.5f) * width, (ndcPosition.y * 0.5f + 0.5f) * height,
+			ndcPosition.z * 0.5f + 0.5f);
+	}
+
+	for (unsigned int i = 0; i + 2 < occluder_.indices.size(); i += 3)
+	{
+		unsigned int a = occluder_.indices[i];
+		unsigned int b = occluder_.indices[i + 1];
+		unsigned int c = occluder_.indices[i + 2];
+
+		/* Clipping a triangle against the near plane would give it parts that aren't there, so it's left out instead. An
+		occluder that's missing a few triangles only hides a little less than it could */
+		if (!inFrontFlags[a] || !inFrontFlags[b] || !inFrontFlags[c])
+			continue;
+
+		RasterizeTriangle(screenPositions[a], screenPositions[b], screenPositions[c]);
+		statistics.occluderTriangles++;
+	}
+
+	statistics.rasterizeTime += glfwGetTime() - startTime;
+}
+
+void OcclusionCuller::RasterizeModel(const Model& model_, const mat4& modelMatrix_)
+{
+	for (unsigned int i = 0; i < model_.occluderMeshes.size(); i++)
+	{
+		RasterizeOccluder(model_.occluderMeshes[i], modelMatrix_ * model_.nodes.worldTransforms[model_.meshNodes[i]]);
+	}
+}
+
+void OcclusionCuller::RasterizeTriangle(const vec3& a_, const vec3& b_, const vec3& c_)
+{
+	vec3 a = a_;
+	vec3 b = b_;
+	vec3 c = c_;
+
+	// Twice the triangle's area, negative if it's clockwise on the screen
+	float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+
+	// Also skips triangles with a NaN, which fail every comparison
+	if (!(area != 0.0f))
+		return;
+
+	// Occluders are rasterized from both sides, clockwise triangles are turned around so the edge tests stay the same
+	if (area < 0.0f)
+	{
+		swap(b, c);
+		area = -area;
+	}
+
+	// Only the pixels whose centers are inside the triangle's rectangle on the screen
+	float minX = std::max(ceil(std::min(std::min(a.x, b.x), c.x) - 0.5f), 0.0f);
+	float minY = std::max(ceil(std::min(std::min(a.y, b.y), c.y) - 0.5f), 0.0f);
+	float maxX = std::min(floor(std::max(std::max(a.x, b.x), c.x) - 0.5f), static_cast<float>(width - 1));
+	float maxY = std::min(floor(std::max(std::max(a.y, b.y), c.y) - 0.5f), static_cast<float>(height - 1));
+
+	if (minX > maxX || minY > maxY)
+		return;
+
+	/* Every edge function is positive on the inside of its edge and grows by a fixed step from one pixel to the next. The
+	edge opposite a vertex is 0 on the edge and the whole area at that vertex, which makes it the vertex's barycentric
+	weight (times the area) */
+	float edgeStepsX[3] = { b.y - c.y, c.y - a.y, a.y - b.y };
+	float edgeStepsY[3] = { c.x - b.x, a.x - c.x, b.x - a.x };
+	float edgeOffsets[3] = { b.x * c.y - b.y * c.x, c.x * a.y - c.y * a.x, a.x * b.y - a.y * b.x };
+
+	// The depth is a plane on the screen as well (the depth buffer stores z / w, which is linear in screen space)
+	float depthStepX = (a.z * edgeStepsX[0] + b.z * edgeStepsX[1] + c.z * edgeStepsX[2]) / area;
+	float depthStepY = (a.z * edgeStepsY[0] + b.z * edgeStepsY[1] + c.z * edgeStepsY[2]) / area;
+	float depthOffset = (a.z * edgeOffsets[0] + b.z * edgeOffsets[1] + c.z * edgeOffsets[2]) / area;
+
+	unsigned int firstX = static_cast<unsigned int>(minX);
+	unsigned int lastX = static_cast<unsigned int>(maxX);
+	unsigned int firstY = static_cast<unsigned int>(minY);
+	unsigned int lastY = static_cast<unsigned int>(maxY);
+
+	float* depthBuffer = depthLevels[0].data();
+
+#ifdef OCCLUSION_CULLER_SSE
+	if (useSIMD)
+	{
+		/* Starts at a multiple of 4 so every row is covered by whole registers. The pixels left and right of the rectangle
+		are outside the triangle, so the edge tests keep them as they are */
+		firstX &= ~3u;
+
+		__m128 pixelOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+		__m128 zero = _mm_setzero_ps();
+
+		__m128 edgeSteps[3], edgeStartXs[3];
+
+		for (unsigned int i = 0; i < 3; i++)
+		{
+			edgeSteps[i] = _mm_set1_ps(edgeStepsX[i] * 4.0f);
+			edgeStartXs[i] = _mm_mul_ps(_mm_set1_ps(edgeStepsX[i]), _mm_add_ps(_mm_set1_ps(static_cast<float>(firstX)),
+				pixelOffsets));
+		}
+
+		__m128 depthStep = _mm_set1_ps(depthStepX * 4.0f);
+		__m128 depthStartX = _mm_mul_ps(_mm_set1_ps(depthStepX), _mm_add_ps(_mm_set1_ps(static_cast<float>(firstX)),
+			pixelOffsets));
+
+		for (unsigned int y = firstY; y <= lastY; y++)
+		{
+			float pixelY = y + 0.5f;
+			float* row = depthBuffer + y * width;
+
+			__m128 edge0 = _mm_add_ps(edgeStartXs[0], _mm_set1_ps(edgeStepsY[0] * pixelY + edgeOffsets[0]));
+			__m128 edge1 = _mm_add_ps(edgeStartXs[1], _mm_set1_ps(edgeStepsY[1] * pixelY + edgeOffsets[1]));
+			__m128 edge2 = _mm_add_ps(edgeStartXs[2], _mm_set1_ps(edgeStepsY[2] * pixelY + edgeOffsets[2]));
+			__m128 depth = _mm_add_ps(depthStartX, _mm_set1_ps(depthStepY * pixelY + depthOffset));
+
+			for (unsigned int x = firstX; x <= lastX; x += 4)
+			{
+				__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)),
+					_mm_cmpge_ps(edge2, zero));
+
+				// Keeps the closer depth inside the triangle and the old one outside of it, without a branch
+				__m128 oldDepth = _mm_loadu_ps(row + x);
+				__m128 newDepth = _mm_min_ps(oldDepth, depth);
+
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, newDepth), _mm_andnot_ps(inside, oldDepth)));
+
+				edge0 = _mm_add_ps(edge0, edgeSteps[0]);
+				edge1 = _mm_add_ps(edge1, edgeSteps[1]);
+				edge2 = _mm_add_ps(edge2, edgeSteps[2]);
+				depth = _mm_add_ps(depth, depthStep);
+			}
+		}
+
+		return;
+	}
+#endif
+
+	for (unsigned int y = firstY; y <= lastY; y++)
+	{
+		float pixelY = y + 0.5f;
+		float* row = depthBuffer + y * width;
+
+		for (unsigned int x = firstX; x <= lastX; x++)
+		{
+			float pixelX = x + 0.5f;
+
+			float edge0 = edgeStepsX[0] * pixelX + edgeStepsY[0] * pixelY + edgeOffsets[0];
+			float edge1 = edgeStepsX[1] * pixelX + edgeStepsY[1] * pixelY + edgeOffsets[1];
+			float edge2 = edgeStepsX[2] * pixelX + edgeStepsY[2] * pixelY + edgeOffsets[2];
+
+			if (edge0 < 0.0f || edge1 < 0.0f || edge2 < 0.0f)
+				continue;
+
+			row[x] = std::min(row[x], depthStepX * pixelX + depthStepY * pixelY + depthOffset);
+		}
+	}
+}
+
+void OcclusionCuller::BuildHierarchy()
+{
+	double startTime = glfwGetTime();
+
+	for (unsigned int level = 1; level < depthLevels.size(); level++)
+	{
+		const vector<float>& below = depthLevels[level - 1];
+		vector<float>& current = depthLevels[level];
+
+		unsigned int belowWidth = levelWidths[level - 1];
+		unsigned int belowHeight = levelHeights[level - 1];
+
+		for (unsigned int y = 0; y < levelHeights[level]; y++)
+		{
+			// An odd row or column at the end of the level below is covered by the last texel on its own
+			unsigned int y0 = y * 2;
+			unsigned int y1 = std::min(y0 + 1, belowHeight - 1);
+
+			for (unsigned int x = 0; x < levelWidths[level]; x++)
+			{
+				unsigned int x0 = x * 2;
+				unsigned int x1 = std::min(x0 + 1, belowWidth - 1);
+
+				current[y * levelWidths[level] + x] = std::max(std::max(below[y0 * belowWidth + x0],
+					below[y0 * belowWidth + x1]), std::max(below[y1 * belowWidth + x0], below[y1 * belowWidth + x1]));
+			}
+		}
+	}
+
+	statistics.rasterizeTime += glfwGetTime() - startTime;
+}
+
+bool OcclusionCuller::IsBoxVisible(const vec3& boundsMin_, const vec3& boundsMax_, const mat4& modelMatrix_)
+{
+	double startTime = glfwGetTime();
+
+	statistics.testedObjects++;
+
+	mat4 modelViewProjection = viewProjectionMatrix * modelMatrix_;
+
+	vec2 screenMin = vec2(FLT_MAX);
+	vec2 screenMax = vec2(-FLT_MAX);
+	float nearestDepth = FLT_MAX;
+
+	bool visible = true;
+	bool crossesNearPlane = false;
+
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		vec3 corner = vec3(i & 1 ? boundsMax_.x : boundsMin_.x, i & 2 ? boundsMax_.y : boundsMin_.y,
+			i & 4 ? boundsMax_.z : boundsMin_.z);
+
+		vec4 clipPosition = modelViewProjection * vec4(corner, 1.0f);
+
+		// The box's projection isn't bounded by its corners anymore, and the camera might even be inside of it
+		if (clipPosition.w <= 0.0f || clipPosition.z < -clipPosition.w)
+		{
+			crossesNearPlane = true;
+			break;
+		}
+
+		vec3 ndcPosition = vec3(clipPosition) / clipPosition.w;
+
+		screenMin = min(screenMin, vec2(ndcPosition.x, ndcPosition.y));
+		screenMax = max(screenMax, vec2(ndcPosition.x, ndcPosition.y));
+
+		// The depth across a box is the smallest at one of its corners
+		nearestDepth = std::min(nearestDepth, ndcPosition.z * 0.5f + 0.5f);
+	}
+
+	if (!crossesNearPlane)
+	{
+		// The pixels whose centers the box's rectangle covers, or the closest one if it falls between two centers
+		float minX = std::max((screenMin.x * 0.5f + 0.5f) * width - 0.5f, 0.0f);
+		float minY = std::max((screenMin.y * 0.5f + 0.5f) * height - 0.5f, 0.0f);
+		float maxX = std::min((screenMax.x * 0.5f + 0.5f) * width - 0.5f, static_cast<float>(width - 1));
+		float maxY = std::min((screenMax.y * 0.5f + 0.5f) * height - 0.5f, static_cast<float>(height - 1));
+
+		if (minX > maxX || minY > maxY || nearestDepth > 1.0f)
+		{
+			visible = false;
+		}
+		else
+		{
+			unsigned int firstX = static_cast<unsigned int>(floor(minX));
+			unsigned int firstY = static_cast<unsigned int>(floor(minY));
+			unsigned int lastX = static_cast<unsigned int>(ceil(maxX));
+			unsigned int lastY = static_cast<unsigned int>(ceil(maxY));
+
+			// The first level where the rectangle is at most 4 texels across, so every box costs about the same
+			unsigned int level = 0;
+
+			while (level + 1 < depthLevels.size() && ((lastX >> level) - (firstX >> level) > 3 ||
+				(lastY >> level) - (firstY >> level) > 3))
+			{
+				level++;
+			}
+
+			const vector<float>& depths = depthLevels[level];
+			unsigned int levelWidth = levelWidths[level];
+
+			visible = false;
+
+			for (unsigned int y = firstY >> level; y <= (lastY >> level) && !visible; y++)
+			{
+				for (unsigned int x = firstX >> level; x <= (lastX >> level); x++)
+				{
+					// Something in this texel is at least as far away as the front of the box
+					if (depths[y * levelWidth + x] >= nearestDepth)
+					{
+						visible = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	if (!visible)
+		statistics.culledObjects++;
+
+	statistics.testTime += glfwGetTime() - startTime;
+
+	return visible;
+}
+
+bool OcclusionCuller::IsModelVisible(const Model& model_, const mat4& modelMatrix_)
+{
+	return IsBoxVisible(model_.boundsMin, model_.boundsMax, modelMatrix_);
+}
+
+const OcclusionStatistics& OcclusionCuller::GetStatistics() const
+{
+	return statistics;
+}
+
+void OcclusionCuller::PrintStatistics() const
+{
+	cout << "Occlusion culler: " << statistics.culledObjects << " of " << statistics.testedObjects << " objects culled, "
+		<< statistics.occluderTriangles << " occluder triangles rasterized in " << statistics.rasterizeTime * 1000.0 <<
+		" ms, boxes tested in " << statistics.testTime * 1000.0 << " ms" << endl;
+}
+
+unsigned int OcclusionCuller::GetWidth() const
+{
+	return width;
+}
+
+unsigned int OcclusionCuller::GetHeight() const
+{
+	return height;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#ifndef OCCLUSION_CULLER_H
+#define OCCLUSION_CULLER_H
+
+#include "Model.h"
+
+#include <vector>
+
+using namespace std;
+
+// What the occlusion culler did since the last BeginFrame
+struct OcclusionStatistics
+{
+	unsigned int occluderTriangles; // triangles that were rasterized (the ones crossing the near plane are skipped)
+	unsigned int testedObjects;
+	unsigned int culledObjects;
+
+	double rasterizeTime; // rasterizing the occluders and building the depth hierarchy (in seconds)
+	double testTime; // testing the boxes (in seconds)
+};
+
+/* Skips objects that are completely hidden behind others, before their draw calls are even made. A handful of large
+objects (the occluders) are rasterized into a small depth buffer on the CPU every frame, with nothing but their depth:
+no textures, no lighting, and only the coarsest level of detail of their meshes. Four pixels of a row are tested against
+the triangle's edges and written at once with SSE.
+
+The depth buffer is then reduced into a hierarchy where every texel of a level holds the farthest depth of the 2x2
+texels below it. An object's box is projected onto the screen, and its nearest depth is compared against the few
+texels of the level that covers the box's rectangle: if every one of them is closer than the box, so is every occluder
+pixel inside it, and the object can't be seen.
+
+The occluders only cover a pixel if they cover its center, so the result isn't exact along their edges, but at a few
+hundred pixels across that is less than a pixel of the real screen could show.
+
+The culling is only as conservative as the occluders are. A simplified mesh (like the coarsest level of detail
+Model::buildOccluders keeps) can close up gaps and concave parts that the real mesh leaves open, or bulge out past it,
+and an object seen through one of those would be culled and pop in and out. Occluders have to stay inside the shape
+they stand for */
+
+class OcclusionCuller
+{
+public:
+	// The width is rounded up to a multiple of 4, so every row of the depth buffer is a whole number of SSE registers
+	OcclusionCuller(unsigned int width_ = 256, unsigned int height_ = 128);
+
+	// Clears the depth buffer and the statistics, every occluder and box after this is seen from this camera
+	void BeginFrame(const mat4& viewProjectionMatrix_);
+
+	// Rasterizes an occluder's triangles, modelMatrix_ takes its positions into world space
+	void RasterizeOccluder(const OccluderMesh& occluder_, const mat4& modelMatrix_);
+
+	/* Rasterizes every occluder mesh of a model loaded with Model::buildOccluders, with the node transforms as of its last
+	draw (or UpdateNodeTransforms) */
+	void RasterizeModel(const Model& model_, const mat4& modelMatrix_);
+
+	// Builds the depth hierarchy from the occluders rasterized so far, has to run before the frame's first box is tested
+	void BuildHierarchy();
+
+	/* Returns false if the box (in the space modelMatrix_ takes into world space) is completely hidden behind the
+	occluders, or completely off the screen. Boxes that reach past the camera's near plane are always visible */
+	bool IsBoxVisible(const vec3& boundsMin_, const vec3& boundsMax_, const mat4& modelMatrix_);
+
+	// Tests the box around all of a model's meshes
+	bool IsModelVisible(const Model& model_, const mat4& modelMatrix_);
+
+	const OcclusionStatistics& GetStatistics() const;
+
+	void PrintStatistics() const;
+
+	unsigned int GetWidth() const;
+	unsigned int GetHeight() const;
+
+	// Rasterizes with one pixel at a time instead of four (to compare against)
+	bool useSIMD;
+
+private:
+	// The vertices are in screen space: x and y in pixels and z the depth from 0 (near plane) to 1 (far plane)
+	void RasterizeTriangle(const vec3& a_, const vec3& b_, const vec3& c_);
+
+	unsigned int width, height;
+
+	mat4 viewProjectionMatrix;
+
+	// Level 0 is the depth buffer itself, every level after it is half as wide and high (rounded up)
+	vector<vector<float>> depthLevels;
+	vector<unsigned int> levelWidths, levelHeights;
+
+	// Screen space position of every vertex of the occluder being rasterized, and whether it's in front of the near plane
+	vector<vec3> screenPositions;
+	vector<unsigned char> inFrontFlags;
+
+	OcclusionStatistics statistics;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "PBRLighting.h"
 #include "Camera.h"
+#include "TextureCache.h"
 
 PBRLighting* PBRLighting::pbrLightingInstance = NULL;
 
@@ -23,8 +24,7 @@ scale can be described by tiny little perfectly reflective mirrors called microf
 PBRLighting::PBRLighting() : pbrLightingShader(new ShaderProgram()), /*lightColors{vec3(0.0f), vec3(0.0f), vec3(0.0f),
 vec3(0.0f) }, lightPositions{vec3(0.0f), vec3(0.0f), vec3(0.0f), vec3(0.0f)},*/ lightPositions{vec3(0.0f)}, 
 lightColors{vec3(0.0f)}, nrColumns(0), nrRows(0), spacing(0), albedo(0), metallic(0), roughness(0), normal(0), 
-ambientOcclusion(0), projectionMatrix(mat4(0.0f)), viewMatrix(mat4(0.0f)), modelMatrix(mat4(0.0f)), sphereVAO(0), 
-indexCount(0)
+ambientOcclusion(0), modelMatrix(mat4(0.0f)), sphereVAO(0), indexCount(0)
 {
 }
 
@@ -47,7 +47,7 @@ PBRLighting::~PBRLighting()
 		intVariables[i] = NULL;
 	}
 
-	array<mat4, 3> shaderMatrices = { projectionMatrix, viewMatrix, modelMatrix };
+	array<mat4, 1> shaderMatrices = { modelMatrix };
 
 	for (unsigned int i = 0; i < shaderMatrices.size(); i++)
 	{
@@ -71,12 +71,12 @@ PBRLighting* PBRLighting::Instance()
 
 void PBRLighting::InitializePBRLighting()
 {
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::Enable(GL_DEPTH_TEST);
 
 	pbrLightingShader->InitializeShaderProgram(new VertexShaderLoader("PBRLightingVertexShader.glsl"),
 		new FragmentShaderLoader("PBRLightingFragmentShader.glsl"));
 	
-	glUseProgram(pbrLightingShader->shaderProgram);
+	GLStateCache::UseProgram(pbrLightingShader->shaderProgram);
 
 	/* PBR Lighting Part 1
 	glUniform3f(glGetUniformLocation(pbrLightingShader->shaderProgram, "albedo"), 0.5f, 0.0f, 0.0f);
@@ -89,11 +89,11 @@ void PBRLighting::InitializePBRLighting()
 	glUniform1i(glGetUniformLocation(pbrLightingShader->shaderProgram, "roughnessMap"), 3);
 	glUniform1i(glGetUniformLocation(pbrLightingShader->shaderProgram, "aoMap"), 4);
 
-	albedo = LoadTexture("Textures/PBR/rusted_iron/albedo.png");
-	normal = LoadTexture("Textures/PBR/rusted_iron/normal.png");
-	metallic = LoadTexture("Textures/PBR/rusted_iron/metallic.png");
-	roughness = LoadTexture("Textures/PBR/rusted_iron/roughness.png");
-	ambientOcclusion = LoadTexture("Textures/PBR/rusted_iron/ao.png");
+	albedo = LoadTexture("Textures/PBR/rusted_iron/albedo.png", TEXTURE_COMPRESSION_COLOR);
+	normal = LoadTexture("Textures/PBR/rusted_iron/normal.png", TEXTURE_COMPRESSION_NORMAL);
+	metallic = LoadTexture("Textures/PBR/rusted_iron/metallic.png", TEXTURE_COMPRESSION_MASK);
+	roughness = LoadTexture("Textures/PBR/rusted_iron/roughness.png", TEXTURE_COMPRESSION_MASK);
+	ambientOcclusion = LoadTexture("Textures/PBR/rusted_iron/ao.png", TEXTURE_COMPRESSION_MASK);
 
 	// PBR Lighting Part 1
 	/*lightPositions =
@@ -122,12 +122,6 @@ void PBRLighting::InitializePBRLighting()
 	nrRows = 7;
 	nrColumns = 7;
 	spacing = 2.5;
-
-	// Initialize static shader projection matrix uniform before rendering
-	projectionMatrix = perspective(radians(Camera::fieldOfView), float(1280 / 960), 0.1f, 100.0f);
-	
-	glUniformMatrix4fv(glGetUniformLocation(pbrLightingShader->shaderProgram, "projection"), 1, GL_FALSE, 
-		value_ptr(projectionMatrix));
 }
 
 void PBRLighting::RenderPBRLighting()
@@ -135,28 +129,22 @@ void PBRLighting::RenderPBRLighting()
 	glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	glUseProgram(pbrLightingShader->shaderProgram);
-
-	viewMatrix = lookAt(Camera::cameraPosition, Camera::cameraPosition + Camera::cameraFront, Camera::cameraUp);
-	glUniformMatrix4fv(glGetUniformLocation(pbrLightingShader->shaderProgram, "view"), 1, GL_FALSE, value_ptr(viewMatrix));
-	
-	glUniform3fv(glGetUniformLocation(pbrLightingShader->shaderProgram, "cameraPosition"), 1, 
-		value_ptr(Camera::cameraPosition));
+	GLStateCache::UseProgram(pbrLightingShader->shaderProgram);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, albedo);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, albedo);
 
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, normal);
+	GLStateCache::ActiveTexture(GL_TEXTURE1);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, normal);
 
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, metallic);
+	GLStateCache::ActiveTexture(GL_TEXTURE2);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, metallic);
 
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, roughness);
+	GLStateCache::ActiveTexture(GL_TEXTURE3);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, roughness);
 
-	glActiveTexture(GL_TEXTURE4);
-	glBindTexture(GL_TEXTURE_2D, ambientOcclusion);
+	GLStateCache::ActiveTexture(GL_TEXTURE4);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, ambientOcclusion);
 
 	// Render rows and column number of spheres with varying metallic/roughness values scaled by rows and columns respectively
 	modelMatrix = mat4(1.0f);
@@ -217,43 +205,9 @@ void PBRLighting::RenderPBRLighting()
 	}
 }
 
-unsigned int PBRLighting::LoadTexture(const char* path)
+unsigned int PBRLighting::LoadTexture(const char* path, TextureCompression compression)
 {
-	unsigned int textureID;
-	glGenTextures(1, &textureID);
-
-	int width, height, nrComponents;
-	unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
-
-	if (data)
-	{
-		GLenum format;
-		if (nrComponents == 1)
-			format = GL_RED;
-		else if (nrComponents == 3)
-			format = GL_RGB;
-		else if (nrComponents == 4)
-			format = GL_RGBA;
-
-		glBindTexture(GL_TEXTURE_2D, textureID);
-		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		stbi_image_free(data);
-	}
-
-	else
-	{
-		std::cout << "Texture failed to load at path: " << path << std::endl;
-		stbi_image_free(data);
-	}
-
-	return textureID;
+	return TextureCache::LoadTexture(path, TextureLoadOptions(false, false, 0, true, false, compression));
 }
 
 void PBRLighting::RenderSphere()
@@ -340,11 +294,11 @@ void PBRLighting::RenderSphere()
 			}
 		}
 
-		glBindVertexArray(sphereVAO);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		GLStateCache::BindVertexArray(sphereVAO);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, vbo);
 		glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), &data[0], GL_STATIC_DRAW);
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+		GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
 		
 		unsigned int stride = sizeof(vec3) + sizeof(vec2) + sizeof(vec3);
@@ -357,6 +311,6 @@ void PBRLighting::RenderSphere()
 		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
 	}
 
-	glBindVertexArray(sphereVAO);
+	GLStateCache::BindVertexArray(sphereVAO);
 	glDrawElements(GL_TRIANGLE_STRIP, indexCount, GL_UNSIGNED_INT, 0);
 }
\ No newline at end of file
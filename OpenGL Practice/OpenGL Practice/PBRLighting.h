@@ -25,7 +25,7 @@ public:
 private:
 	PBRLighting();
 
-	unsigned int LoadTexture(const char* path);
+	unsigned int LoadTexture(const char* path, TextureCompression compression);
 	void RenderSphere();
 
 	static PBRLighting* pbrLightingInstance;
@@ -39,7 +39,7 @@ private:
 	int nrColumns;
 	float spacing;
 
-	mat4 projectionMatrix, viewMatrix, modelMatrix;
+	mat4 modelMatrix;
 
 	unsigned int sphereVAO;
 	unsigned int indexCount;
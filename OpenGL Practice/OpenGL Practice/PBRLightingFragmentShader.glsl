@@ -9,7 +9,7 @@ in vec3 Normal;
 uniform vec3 lightPositions[4];
 uniform vec3 lightColors[4];
 
-uniform vec3 cameraPosition;
+#include "FrameUniforms.glsl"
 
 // Material parameters (PBR Lighting Part 1)
 //uniform vec3 albedo;
@@ -31,62 +31,7 @@ uniform sampler2D metallicMap;
 uniform sampler2D roughnessMap;
 uniform sampler2D aoMap;
 
-const float PI = 3.14159265359;
-
-vec3 fresnelSchlick(float cosTheta, vec3 F0)
-{
-	/* Calculate the ratio between specular and diffuse reflection, or how much the surface reflects light versus how much 
-	it refracts light */
-
-	/* The Fresnel-Schlick approximation expects a F0 parameter which is known as the surface reflection at zero incidence 
-	or how much the surface reflects if looking directly at the surface */
-
-	return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
-}
-
-vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness)
-{
-    return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
-}
-
-float DistributionGGX(vec3 N, vec3 H, float roughness)
-{
-	float a = roughness*roughness;
-	float a2 = a*a;
-	float NdotH = max(dot(N, H), 0.0);
-	float NdotH2 = NdotH*NdotH;
-	
-	float num = a2;
-	float denom = (NdotH2 * (a2 - 1.0) + 1.0);
-	denom = PI * denom * denom;
-
-	return num / denom;
-}
-
-float GeometrySchlickGGX(float NdotV, float roughness)
-{
-	//float r = (roughness + 1.0);
-	//float k = (r*r) / 8.0;
-
-	// Specular IBL
-	float r = roughness;
-	float k = (r*r) / 2.0;
-
-	float num = NdotV;
-	float denom = NdotV * (1.0 - k) + k;
-
-	return num / denom;
-}
-
-float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness)
-{
-	float NdotV = max(dot(N, V), 0.0);
-	float NdotL = max(dot(N, L), 0.0);
-	float ggx2 = GeometrySchlickGGX(NdotV, roughness);
-	float ggx1 = GeometrySchlickGGX(NdotL, roughness);
-
-	return ggx1 * ggx2;
-}
+#include "PBRFunctions.glsl"
 
 void main()
 {
@@ -102,7 +47,7 @@ void main()
     float ambientOcclusion = texture(aoMap, TexCoords).r;
 
 	vec3 N = normalize(Normal);
-	vec3 V = normalize(cameraPosition - worldPosition);
+	vec3 V = normalize(frame.cameraPosition.xyz - worldPosition);
 	vec3 R = reflect(-V, N); 
 
 	vec3 F0 = vec3(0.04);
@@ -8,8 +8,7 @@ out vec2 TexCoords;
 out vec3 worldPosition;
 out vec3 Normal;
 
-uniform mat4 projection;
-uniform mat4 view;
+#include "FrameUniforms.glsl"
 uniform mat4 model;
 uniform mat3 normalMatrix;
 
@@ -19,5 +18,5 @@ void main()
     worldPosition = vec3(model * vec4(position, 1.0));
     Normal = normalMatrix * normals;   
 
-    gl_Position =  projection * view * vec4(worldPosition, 1.0);
+    gl_Position =  frame.viewProjection * vec4(worldPosition, 1.0);
 }
\ No newline at end of file
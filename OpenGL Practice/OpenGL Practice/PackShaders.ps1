@@ -0,0 +1,111 @@
+# Packs every .glsl file of the project into a single indexed blob, so the game doesn't have to open over a hundred
+# shader files at startup. Runs as a pre-build event and writes two files next to the shaders:
+#
+#   Shaders.pack          the blob itself, read once at startup by ShaderPack
+#   ShaderPackData.inl    the same blob as a constexpr byte array, compiled into the executable when SHADER_PACK_EMBEDDED
+#                         is defined (Release builds)
+#
+# Blob layout (all integers are little endian uint32):
+#   header:  magic 'SPAK', version, entry count
+#   index:   one { name offset, name length, source offset, source length } per shader, sorted by name (ordinal)
+#   data:    the names and sources, each followed by a 0 byte so they can be used as C strings straight from the blob
+#
+# Both files are only rewritten when their contents actually change, so the build doesn't recompile anything needlessly
+
+param(
+    [string]$ShaderDirectory = $PSScriptRoot,
+    [string]$PackFile = "Shaders.pack",
+    [string]$EmbeddedFile = "ShaderPackData.inl"
+)
+
+$ErrorActionPreference = "Stop"
+
+$PackMagic = 0x4B415053
+$PackVersion = 1
+
+function Write-IfChanged([string]$path, [byte[]]$bytes)
+{
+    if (Test-Path $path)
+    {
+        $existing = [System.IO.File]::ReadAllBytes($path)
+
+        if ($existing.Length -eq $bytes.Length -and
+            [System.Convert]::ToBase64String($existing) -eq [System.Convert]::ToBase64String($bytes))
+        {
+            return $false
+        }
+    }
+
+    [System.IO.File]::WriteAllBytes($path, $bytes)
+    return $true
+}
+
+# The index has to be sorted exactly the way ShaderPack compares names (byte by byte), so use an ordinal sort
+[string[]]$names = Get-ChildItem -Path $ShaderDirectory -Filter *.glsl -File | ForEach-Object { $_.Name }
+[System.Array]::Sort($names, [System.StringComparer]::Ordinal)
+
+$stream = New-Object System.IO.MemoryStream
+$writer = New-Object System.IO.BinaryWriter($stream)
+
+$writer.Write([uint32]$PackMagic)
+$writer.Write([uint32]$PackVersion)
+$writer.Write([uint32]$names.Count)
+
+# Leave room for the index, it's filled in once all the offsets are known
+$indexStart = $stream.Position
+$writer.Write((New-Object byte[] ($names.Count * 16)))
+
+$entries = New-Object System.Collections.Generic.List[uint32[]]
+
+foreach ($name in $names)
+{
+    $nameBytes = [System.Text.Encoding]::ASCII.GetBytes($name)
+    $nameOffset = [uint32]$stream.Position
+    $writer.Write($nameBytes)
+    $writer.Write([byte]0)
+
+    $sourceBytes = [System.IO.File]::ReadAllBytes((Join-Path $ShaderDirectory $name))
+    $sourceOffset = [uint32]$stream.Position
+    $writer.Write($sourceBytes)
+    $writer.Write([byte]0)
+
+    $entries.Add([uint32[]]@($nameOffset, $nameBytes.Length, $sourceOffset, $sourceBytes.Length))
+}
+
+$stream.Position = $indexStart
+
+foreach ($entry in $entries)
+{
+    foreach ($value in $entry)
+    {
+        $writer.Write([uint32]$value)
+    }
+}
+
+$writer.Flush()
+$blob = $stream.ToArray()
+
+# The embedded version is the exact same blob written out as a byte array
+$builder = New-Object System.Text.StringBuilder
+[void]$builder.AppendLine("// Generated by PackShaders.ps1 from $($names.Count) shader files, do not edit")
+[void]$builder.AppendLine("alignas(4) static constexpr unsigned char shaderPackData[$($blob.Length)] =")
+[void]$builder.AppendLine("{")
+
+for ($i = 0; $i -lt $blob.Length; $i += 16)
+{
+    $count = [System.Math]::Min(16, $blob.Length - $i)
+    [void]$builder.AppendLine("    0x" + [System.BitConverter]::ToString($blob, $i, $count).Replace("-", ", 0x") + ",")
+}
+
+[void]$builder.AppendLine("};")
+
+$packPath = Join-Path $ShaderDirectory $PackFile
+$embeddedPath = Join-Path $ShaderDirectory $EmbeddedFile
+
+$packChanged = Write-IfChanged $packPath $blob
+$embeddedChanged = Write-IfChanged $embeddedPath ([System.Text.Encoding]::ASCII.GetBytes($builder.ToString()))
+
+if ($packChanged -or $embeddedChanged)
+{
+    Write-Host "PackShaders: packed $($names.Count) shaders ($($blob.Length) bytes)"
+}
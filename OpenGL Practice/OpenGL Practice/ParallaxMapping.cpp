@@ -1,5 +1,6 @@
 #include "ParallaxMapping.h"
 #include "Camera.h"
+#include "TextureCache.h"
 
 ParallaxMapping* ParallaxMapping::parallaxMappingInstance = 0;
 
@@ -33,11 +34,11 @@ ParallaxMapping::~ParallaxMapping()
 
     for (int i = 0; i < textureMaps.size(); i++)
     {
-        glDeleteTextures(1, &textureMaps[i]);
+        TextureCache::ReleaseTexture(textureMaps[i]);
     }
 
-    glDeleteVertexArrays(1, &quadVAO);
-    glDeleteBuffers(1, &quadVBO);
+    GLStateCache::DeleteVertexArrays(1, &quadVAO);
+    GLStateCache::DeleteBuffers(1, &quadVBO);
 }
 
 ParallaxMapping* ParallaxMapping::Instance()
@@ -52,22 +53,22 @@ ParallaxMapping* ParallaxMapping::Instance()
 
 void ParallaxMapping::InitializeParallaxMapping()
 {
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::Enable(GL_DEPTH_TEST);
 
 	parallaxMappingShaderProgram->InitializeShaderProgram(new VertexShaderLoader("ParallaxMappingVertexShader.glsl"),
 		new FragmentShaderLoader("ParallaxMappingFragmentShader.glsl"));
 
     // Parallax Mapping Part 1
-    /*diffuseMap = LoadTexture("Textures/bricks2.jpg");
-    normalMap = LoadTexture("Textures/bricks2_normal.jpg");
-    heightMap = LoadTexture("Textures/bricks2_disp.jpg");*/
+    /*diffuseMap = LoadTexture("Textures/bricks2.jpg", TEXTURE_COMPRESSION_COLOR);
+    normalMap = LoadTexture("Textures/bricks2_normal.jpg", TEXTURE_COMPRESSION_NORMAL);
+    heightMap = LoadTexture("Textures/bricks2_disp.jpg", TEXTURE_COMPRESSION_MASK);*/
 
     // Parallax Mapping Part 2
-    diffuseMap = LoadTexture("Textures/Wood.png");
-    normalMap = LoadTexture("Textures/toy_box_normal.png");
-    heightMap = LoadTexture("Textures/toy_box_disp.png");
+    diffuseMap = LoadTexture("Textures/Wood.png", TEXTURE_COMPRESSION_COLOR);
+    normalMap = LoadTexture("Textures/toy_box_normal.png", TEXTURE_COMPRESSION_NORMAL);
+    heightMap = LoadTexture("Textures/toy_box_disp.png", TEXTURE_COMPRESSION_MASK);
 
-    glUseProgram(parallaxMappingShaderProgram->shaderProgram);
+    GLStateCache::UseProgram(parallaxMappingShaderProgram->shaderProgram);
 
     glUniform1i(glGetUniformLocation(parallaxMappingShaderProgram->shaderProgram, "diffuseMap"), 0);
     glUniform1i(glGetUniformLocation(parallaxMappingShaderProgram->shaderProgram, "normalMap"), 1);
@@ -81,16 +82,7 @@ void ParallaxMapping::RenderParallaxMapping()
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    mat4 projection = perspective(radians(Camera::fieldOfView), float(1280 / 960), 0.1f, 100.0f);
-    mat4 view = lookAt(Camera::cameraPosition, Camera::cameraPosition + Camera::cameraFront, Camera::cameraUp);
-
-    glUseProgram(parallaxMappingShaderProgram->shaderProgram);
-
-    glUniformMatrix4fv(glGetUniformLocation(parallaxMappingShaderProgram->shaderProgram, "projectionMatrix"), 
-        1, GL_FALSE, value_ptr(projection));
-
-    glUniformMatrix4fv(glGetUniformLocation(parallaxMappingShaderProgram->shaderProgram, "viewMatrix"), 1, 
-        GL_FALSE, value_ptr(view));
+    GLStateCache::UseProgram(parallaxMappingShaderProgram->shaderProgram);
 
     // Render a parallax-mapped quad
     mat4 model = mat4(1.0f);
@@ -101,9 +93,6 @@ void ParallaxMapping::RenderParallaxMapping()
     glUniformMatrix4fv(glGetUniformLocation(parallaxMappingShaderProgram->shaderProgram, "modelMatrix"), 1, 
         GL_FALSE, value_ptr(model));
 
-    glUniform3f(glGetUniformLocation(parallaxMappingShaderProgram->shaderProgram, "viewPosition"), Camera::cameraPosition.x,
-        Camera::cameraPosition.y, Camera::cameraPosition.z);
-
     glUniform3f(glGetUniformLocation(parallaxMappingShaderProgram->shaderProgram, "lightPosition"), lightPosition.x,
         lightPosition.y, lightPosition.z);
 
@@ -113,14 +102,14 @@ void ParallaxMapping::RenderParallaxMapping()
     std::cout << heightScale << std::endl;
 
     // Set the texture maps to their respective texture values
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, diffuseMap);
+    GLStateCache::ActiveTexture(GL_TEXTURE0);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, diffuseMap);
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, normalMap);
+    GLStateCache::ActiveTexture(GL_TEXTURE1);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, normalMap);
 
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, heightMap);
+    GLStateCache::ActiveTexture(GL_TEXTURE2);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, heightMap);
 
     RenderQuad();
 
@@ -209,8 +198,8 @@ void ParallaxMapping::RenderQuad()
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
 
-        glBindVertexArray(quadVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        GLStateCache::BindVertexArray(quadVAO);
+        GLStateCache::BindBuffer(GL_ARRAY_BUFFER, quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
 
         glEnableVertexAttribArray(0);
@@ -229,48 +218,13 @@ void ParallaxMapping::RenderQuad()
         glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(11 * sizeof(float)));
     }
 
-    glBindVertexArray(quadVAO);
+    GLStateCache::BindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    GLStateCache::BindVertexArray(0);
 }
 
-unsigned int ParallaxMapping::LoadTexture(char const* path_)
+unsigned int ParallaxMapping::LoadTexture(char const* path_, TextureCompression compression_)
 {
-	unsigned int textureID;
-	glGenTextures(1, &textureID);
-
-	int width, height, nrComponents;
-	unsigned char* data = stbi_load(path_, &width, &height, &nrComponents, 0);
-
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-
-    else
-    {
-        glDeleteTextures(1, &textureID);
-
-        std::cout << "Texture failed to load at path: " << path_ << std::endl;
-        stbi_image_free(data);
-    }
-
-	return textureID;
+	// The height map only has one channel worth keeping, the normal map two
+	return TextureCache::LoadTexture(path_, TextureLoadOptions(false, false, 0, true, false, compression_));
 }
\ No newline at end of file
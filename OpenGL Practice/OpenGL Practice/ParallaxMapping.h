@@ -10,6 +10,7 @@
 #include <gtc/type_ptr.hpp>
 
 #include "ShaderProgram.h"
+#include "TextureCompressor.h"
 
 using namespace std;
 using namespace glm;
@@ -29,7 +30,7 @@ public:
 private:
 	ParallaxMapping();
 
-	unsigned int LoadTexture(char const* path_);
+	unsigned int LoadTexture(char const* path_, TextureCompression compression_);
 
 	void RenderQuad();
 
@@ -16,6 +16,8 @@ uniform sampler2D depthMap;
 
 uniform float heightScale;
 
+#include "NormalMap.glsl"
+
 vec2 ParallaxMapping(vec2 textureCoords, vec3 viewDirection)
 { 
     // Parallax Mapping Part 1
@@ -97,8 +99,7 @@ void main()
     // Use these displaced texture coordinates as the texture coordinates for sampling the diffuse and normal map
 
     // obtain normal from normal map
-    vec3 normal = texture(normalMap, texCoords).rgb;
-    normal = normalize(normal * 2.0 - 1.0);
+    vec3 normal = SampleNormalMap(normalMap, texCoords);
    
     // get diffuse color
     vec3 color = texture(diffuseMap, texCoords).rgb;
@@ -14,12 +14,10 @@ out SHADER_VAR {
     vec3 TangentFragPosition;
 } shaderVar;
 
-uniform mat4 projectionMatrix;
-uniform mat4 viewMatrix;
+#include "FrameUniforms.glsl"
 uniform mat4 modelMatrix;
 
 uniform vec3 lightPosition;
-uniform vec3 viewPosition;
 
 void main()
 {
@@ -33,8 +31,8 @@ void main()
     mat3 TBN = transpose(mat3(T, B, N));
 
     shaderVar.TangentLightPosition = TBN * lightPosition;
-    shaderVar.TangentViewPosition  = TBN * viewPosition;
+    shaderVar.TangentViewPosition  = TBN * frame.cameraPosition.xyz;
     shaderVar.TangentFragPosition  = TBN * shaderVar.FragPosition;
     
-    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(position, 1.0);
+    gl_Position = frame.viewProjection * modelMatrix * vec4(position, 1.0);
 }
\ No newline at end of file
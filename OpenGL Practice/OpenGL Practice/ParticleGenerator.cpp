@@ -1,5 +1,9 @@
 #include "ParticleGenerator.h"
 
+// Uniform names hashed at compile time
+constexpr unsigned int OFFSET_UNIFORM = UniformHash("offset");
+constexpr unsigned int COLOR_UNIFORM = UniformHash("color");
+
 ParticleGenerator::ParticleGenerator(ShaderProgram shader_, Texture2D texture_, unsigned int amount_) : shader(shader_), texture(texture_), amount(amount_)
 {
 	this->InitParticleGenerator();
@@ -38,26 +42,29 @@ void ParticleGenerator::DrawParticles()
     blend mode that gives the particles a very neat glow effect when stacked onto each other */
 
     // use additive blending to give it a 'glow' effect
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE);
+
+    // Blocks only the first time, if the particle shader is still being compiled
+    shader.WaitUntilReady();
+
+    GLStateCache::UseProgram(shader.shaderProgram);
+
+    // Every particle uses the same texture and quad, so they only have to be bound once
+    this->texture.Bind();
+    GLStateCache::BindVertexArray(this->VAO);
 
-    glUseProgram(shader.shaderProgram);
     for (Particle& particle : this->particles)
     {
         if (particle.Life > 0.0f)
         {
-            glUniform2f(glGetUniformLocation(this->shader.shaderProgram, "offset"), particle.Position.x, particle.Position.y);
-            glUniform4f(glGetUniformLocation(this->shader.shaderProgram, "color"), particle.Color.x, particle.Color.y, particle.Color.z, particle.Color.w);
-
-            this->texture.Bind();
-
+            this->shader.SetVec2(OFFSET_UNIFORM, particle.Position);
+            this->shader.SetVec4(COLOR_UNIFORM, particle.Color);
 
-            glBindVertexArray(this->VAO);
             glDrawArrays(GL_TRIANGLES, 0, 6);
-            glBindVertexArray(0);
         }
     }
     // don't forget to reset to default blending mode
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 void ParticleGenerator::InitParticleGenerator()
@@ -78,16 +85,16 @@ void ParticleGenerator::InitParticleGenerator()
 
     glGenVertexArrays(1, &this->VAO);
     glGenBuffers(1, &VBO);
-    glBindVertexArray(this->VAO);
+    GLStateCache::BindVertexArray(this->VAO);
 
     // fill mesh buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLStateCache::BindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(particle_quad), &particle_quad, GL_STATIC_DRAW);
 
     // set mesh attributes
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glBindVertexArray(0);
+    GLStateCache::BindVertexArray(0);
 
     // create this->amount default particle instances
     for (unsigned int i = 0; i < this->amount; ++i) this->particles.push_back(Particle());
@@ -1,5 +1,6 @@
 #include "PointShadows.h"
 #include "Camera.h"
+#include "TextureCache.h"
 
 PointShadows* PointShadows::pointShadowsInstance = 0;
 
@@ -33,8 +34,8 @@ PointShadows::PointShadows()
 
 PointShadows::~PointShadows()
 {
-	glDeleteVertexArrays(1, &cubeVAO);
-	glDeleteBuffers(1, &cubeVBO);
+	GLStateCache::DeleteVertexArrays(1, &cubeVAO);
+	GLStateCache::DeleteBuffers(1, &cubeVBO);
 }
 
 PointShadows* PointShadows::Instance()
@@ -50,8 +51,8 @@ PointShadows* PointShadows::Instance()
 
 void PointShadows::InitializePointShadows()
 {
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE);
+	GLStateCache::Enable(GL_DEPTH_TEST);
+	GLStateCache::Enable(GL_CULL_FACE);
 
 	// Load the point shadow shaders
 	pointShadowShaderProgram[0]->InitializeShaderProgram(vertexShaderLoader[0], fragmentShaderLoader[0]);
@@ -63,37 +64,9 @@ void PointShadows::InitializePointShadows()
 
 void PointShadows::InitializeTexture(const char* path_)
 {
-	glGenTextures(1, &woodTexture);
-
-	int width, height, nrComponents;
-	unsigned char* data = stbi_load(path_, &width, &height, &nrComponents, 0);
-	if (data)
-	{
-		GLenum format;
-		if (nrComponents == 1)
-			format = GL_RED;
-		else if (nrComponents == 3)
-			format = GL_RGB;
-		else if (nrComponents == 4)
-			format = GL_RGBA;
-
-		glBindTexture(GL_TEXTURE_2D, woodTexture);
-		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		// Use GL_CLAMP_TO_EDGE to prevent semi-transparent borders. Due to interpolation it takes texels from next repeat 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		stbi_image_free(data);
-	}
-	else
-	{
-		std::cout << "Texture failed to load at path: " << path_ << std::endl;
-		stbi_image_free(data);
-	}
+	// Use GL_CLAMP_TO_EDGE to prevent semi-transparent borders. Due to interpolation it takes texels from next repeat 
+	woodTexture = TextureCache::LoadTexture(path_, TextureLoadOptions(false, false, 0, true, true,
+		TEXTURE_COMPRESSION_COLOR));
 }
 
 void PointShadows::InitializeDepthCubemapTexture()
@@ -102,7 +75,7 @@ void PointShadows::InitializeDepthCubemapTexture()
 
 	// Create depth cubemap texture
 	glGenTextures(1, &depthCubemap);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, depthCubemap);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, depthCubemap);
 
 	// Assign each of the single cubemap faces a 2D depth-valued texture image
 	for (unsigned int i = 0; i < 6; ++i)
@@ -121,7 +94,7 @@ void PointShadows::InitializeDepthCubemapTexture()
 void PointShadows::InitializeFramebuffers()
 {
 	// Attach depth texture as FBO's depth buffer
-	glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
 
 	/* Since I have a usable geometry shader, that allows us to render to all faces in a single pass, we can directly 
 	attach the cubemap as a framebuffers depth attachment with glFramebufferTexture */
@@ -132,12 +105,12 @@ void PointShadows::InitializeFramebuffers()
 	glDrawBuffer(GL_NONE);
 	glReadBuffer(GL_NONE);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void PointShadows::InitializeTextureUniformShaders()
 {
-	glUseProgram(pointShadowShaderProgram[0]->shaderProgram);
+	GLStateCache::UseProgram(pointShadowShaderProgram[0]->shaderProgram);
 
 	glUniform1i(glGetUniformLocation(pointShadowShaderProgram[0]->shaderProgram, "diffuseTexture"), 0);
 	glUniform1i(glGetUniformLocation(pointShadowShaderProgram[0]->shaderProgram, "depthMap"), 1);
@@ -184,10 +157,10 @@ void PointShadows::ShowPointShadows()
 
 	// Render scene to depth cubemap
 	glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-	glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
 	glClear(GL_DEPTH_BUFFER_BIT);
 
-	glUseProgram(pointShadowShaderProgram[1]->shaderProgram);
+	GLStateCache::UseProgram(pointShadowShaderProgram[1]->shaderProgram);
 
 	for (unsigned int i = 0; i < 6; i++)
 	{
@@ -202,40 +175,27 @@ void PointShadows::ShowPointShadows()
 		value_ptr(lightPosition));
 
 	RenderScene(pointShadowShaderProgram[1]);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Render scene as normal
 	glViewport(0, 0, 1280, 960);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	glUseProgram(pointShadowShaderProgram[0]->shaderProgram);
-
-	glm::mat4 projection = glm::perspective(glm::radians(Camera::fieldOfView), float(1280 / 960), 0.1f, 100.0f);
-
-	glm::mat4 view = lookAt(Camera::cameraPosition, Camera::cameraPosition + Camera::cameraFront, Camera::cameraUp);
-
-	glUniformMatrix4fv(glGetUniformLocation(pointShadowShaderProgram[0]->shaderProgram, "projectionMatrix"), 1, 
-		GL_FALSE, value_ptr(projection));
-
-	glUniformMatrix4fv(glGetUniformLocation(pointShadowShaderProgram[0]->shaderProgram, "viewMatrix"), 1,
-		GL_FALSE, value_ptr(view));
+	GLStateCache::UseProgram(pointShadowShaderProgram[0]->shaderProgram);
 
 	// Set lighting uniforms
 	glUniform3fv(glGetUniformLocation(pointShadowShaderProgram[0]->shaderProgram, "lightPosition"), 1, 
 		value_ptr(lightPosition));
 
-	glUniform3fv(glGetUniformLocation(pointShadowShaderProgram[0]->shaderProgram, "viewPosition"), 1, 
-		value_ptr(Camera::cameraPosition));
-
 	// enable/disable shadows by pressing 'SPACE'
 	glUniform1i(glGetUniformLocation(pointShadowShaderProgram[0]->shaderProgram, "shadows"), shadows);
 
 	glUniform1f(glGetUniformLocation(pointShadowShaderProgram[0]->shaderProgram, "farPlane"), far_plane);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, woodTexture);
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, depthCubemap);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, woodTexture);
+	GLStateCache::ActiveTexture(GL_TEXTURE1);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, depthCubemap);
 
 	RenderScene(pointShadowShaderProgram[0]);
 }
@@ -251,7 +211,7 @@ void PointShadows::RenderScene(ShaderProgram* shaderProgram_)
 
 	/* Disable culling here since we render 'inside' the cube instead of the usual 'outside' which throws off the normal 
 	culling methods */
-	glDisable(GL_CULL_FACE);
+	GLStateCache::Disable(GL_CULL_FACE);
 
 	// A small little hack to invert normals when drawing cube from the inside so lighting still works
 	glUniform1i(glGetUniformLocation(shaderProgram_->shaderProgram, "reverseNormals"), 1);
@@ -260,7 +220,7 @@ void PointShadows::RenderScene(ShaderProgram* shaderProgram_)
 
 	// Disable reverse normals
 	glUniform1i(glGetUniformLocation(shaderProgram_->shaderProgram, "reverseNormals"), 0);
-	glEnable(GL_CULL_FACE);
+	GLStateCache::Enable(GL_CULL_FACE);
 
 	model = glm::mat4(1.0f);
 	model = glm::translate(model, glm::vec3(4.0f, -3.5f, 0.0));
@@ -365,11 +325,11 @@ void PointShadows::RenderCube()
 	glGenBuffers(1, &cubeVBO);
 
 	// Fill buffer
-	glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, cubeVBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
 	// Link vertex attributes
-	glBindVertexArray(cubeVAO);
+	GLStateCache::BindVertexArray(cubeVAO);
 
 	glEnableVertexAttribArray(POSITION);
 	glVertexAttribPointer(POSITION, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
@@ -380,11 +340,11 @@ void PointShadows::RenderCube()
 	glEnableVertexAttribArray(TEXTURE);
 	glVertexAttribPointer(TEXTURE, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+	GLStateCache::BindVertexArray(0);
 
 	// Render cube
-	glBindVertexArray(cubeVAO);
+	GLStateCache::BindVertexArray(cubeVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 36);
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(0);
 }
\ No newline at end of file
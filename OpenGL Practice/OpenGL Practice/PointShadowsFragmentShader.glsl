@@ -12,7 +12,7 @@ uniform sampler2D diffuseTexture;
 uniform samplerCube depthMap;
 
 uniform vec3 lightPosition;
-uniform vec3 viewPosition;
+#include "FrameUniforms.glsl"
 
 uniform float farPlane;
 uniform bool shadows;
@@ -54,7 +54,7 @@ float ShadowCalculation(vec3 fragPosition)
     float shadow = 0.0;
     float bias = 0.15;
     int samples = 20;
-    float viewDistance = length(viewPosition - fragPosition);
+    float viewDistance = length(frame.cameraPosition.xyz - fragPosition);
     float diskRadius = (1.0 + (viewDistance / farPlane)) / 25.0;
 
     for(int i = 0; i < samples; ++i)
@@ -92,7 +92,7 @@ void main()
     vec3 diffuse = diff * lightColor;
 
     // specular
-    vec3 viewDirection = normalize(viewPosition - fs_in.fragPosition);
+    vec3 viewDirection = normalize(frame.cameraPosition.xyz - fs_in.fragPosition);
     vec3 reflectDirection = reflect(-lightDirection, normal);
 
     float spec = 0.0;
@@ -11,8 +11,7 @@ out VS_OUT {
     vec2 texCoords;
 } vs_out;
 
-uniform mat4 projectionMatrix;
-uniform mat4 viewMatrix;
+#include "FrameUniforms.glsl"
 uniform mat4 modelMatrix;
 
 uniform bool reverseNormals;
@@ -38,5 +37,5 @@ void main()
 
     vs_out.texCoords = texCoordinates;
 
-    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(position, 1.0);
+    gl_Position = frame.viewProjection * modelMatrix * vec4(position, 1.0);
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "Postprocessing.h"
 
+// Uniform names hashed at compile time
+constexpr unsigned int TIME_UNIFORM = UniformHash("time");
+
 /* Rendering steps are in order from 1-6:
 
 	1. Bind to multisampled framebuffer
@@ -20,8 +23,11 @@ confuse: inverses the colors of the scene, but also the x and y axis
 chaos: makes use of an edge detection kernel to create interesting visuals and also moves the textured image in a
 circular fashion for an interesting chaotic effect */
 
-Postprocessing::Postprocessing(ShaderProgram shader, unsigned int width, unsigned int height) : PostProcessingShader(shader), Texture(), Width(width), Height(height),
-Confuse(false), Chaos(false), Shake(false)
+/* Every combination of the effects is its own shader variant (the effects are #ifdef'd in the shaders), so we only switch
+programs when an effect turns on or off instead of branching on the effect options for every pixel */
+
+Postprocessing::Postprocessing(ShaderVariantSet shaders, unsigned int width, unsigned int height) : PostProcessingShaders(shaders), Texture(), Width(width), Height(height),
+Confuse(false), Chaos(false), Shake(false), ConfiguredVariants(0)
 {
     // initialize renderbuffer/framebuffer object
     glGenFramebuffers(1, &this->MSFBO);
@@ -29,7 +35,7 @@ Confuse(false), Chaos(false), Shake(false)
     glGenRenderbuffers(1, &this->RBO);
 
     // initialize renderbuffer storage with a multisampled color buffer (don't need a depth/stencil buffer)
-    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
     glBindRenderbuffer(GL_RENDERBUFFER, this->RBO);
 
     glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_RGB, width, height); // allocate storage for render buffer object
@@ -39,21 +45,28 @@ Confuse(false), Chaos(false), Shake(false)
         std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
 
     // Also initialize the FBO/texture to blit multisampled color-buffer to; used for shader operations (for postprocessing effects)
-    glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, this->FBO);
 
     this->Texture.Generate(width, height, NULL);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->Texture.textureID, 0); // attach texture to framebuffer as its color attachment
     
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "ERROR::POSTPROCESSOR: Failed to initialize FBO" << std::endl;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 
-    // initialize render data and uniforms
+    // initialize render data, the uniforms are set on the first render
     this->InitializeRenderData();
+}
+
+void Postprocessing::ConfigureShader(ShaderProgram& shader)
+{
+    // Blocks only if the driver is still compiling this variant
+    shader.WaitUntilReady();
 
-    glUseProgram(PostProcessingShader.shaderProgram);
-    glUniform1i(glGetUniformLocation(PostProcessingShader.shaderProgram, "scene"), 0);
+    // The uniforms a variant doesn't use are compiled out, setting them simply does nothing
+    GLStateCache::UseProgram(shader.shaderProgram);
+    glUniform1i(glGetUniformLocation(shader.shaderProgram, "scene"), 0);
 
     float offset = 1.0f / 300.0f;
 
@@ -70,7 +83,7 @@ Confuse(false), Chaos(false), Shake(false)
         {  offset, -offset  }   // bottom-right    
     };
 
-    glUniform2fv(glGetUniformLocation(this->PostProcessingShader.shaderProgram, "offsets"), 9, (float*)&offsets);
+    glUniform2fv(glGetUniformLocation(shader.shaderProgram, "offsets"), 9, (float*)&offsets);
 
     int edgeKernel[9] =
     {
@@ -79,7 +92,7 @@ Confuse(false), Chaos(false), Shake(false)
         -1, -1, -1
     };
 
-    glUniform1iv(glGetUniformLocation(this->PostProcessingShader.shaderProgram, "edge_kernel"), 9, edgeKernel);
+    glUniform1iv(glGetUniformLocation(shader.shaderProgram, "edge_kernel"), 9, edgeKernel);
 
     float blurKernel[9] =
     {
@@ -88,12 +101,12 @@ Confuse(false), Chaos(false), Shake(false)
         1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f
     };
 
-    glUniform1fv(glGetUniformLocation(this->PostProcessingShader.shaderProgram, "blur_kernel"), 9, blurKernel);
+    glUniform1fv(glGetUniformLocation(shader.shaderProgram, "blur_kernel"), 9, blurKernel);
 }
 
 void Postprocessing::BeginRender()
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 }
@@ -101,28 +114,36 @@ void Postprocessing::BeginRender()
 void Postprocessing::EndRender()
 {
     // now resolve multisampled color-buffer into intermediate FBO to store to texture
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
+    GLStateCache::BindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
+    GLStateCache::BindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
     glBlitFramebuffer(0, 0, this->Width, this->Height, 0, 0, this->Width, this->Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0); // binds both READ and WRITE framebuffer to default framebuffer
+    GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0); // binds both READ and WRITE framebuffer to default framebuffer
 }
 
 void Postprocessing::RenderPostprocessing(float time)
 {
+    // pick the variant that has exactly the active effects compiled in
+    unsigned int effects = (this->Chaos ? CHAOS_EFFECT : 0) | (this->Confuse ? CONFUSE_EFFECT : 0) | (this->Shake ? SHAKE_EFFECT : 0);
+
+    ShaderProgram& shader = this->PostProcessingShaders.GetVariant(effects);
+
+    if (!(this->ConfiguredVariants & (1u << effects)))
+    {
+        this->ConfigureShader(shader);
+        this->ConfiguredVariants |= 1u << effects;
+    }
+
     // set uniforms/options
-    glUseProgram(this->PostProcessingShader.shaderProgram);
-    glUniform1f(glGetUniformLocation(this->PostProcessingShader.shaderProgram, "time"), time);
-    glUniform1i(glGetUniformLocation(this->PostProcessingShader.shaderProgram, "confuse"), this->Confuse);
-    glUniform1i(glGetUniformLocation(this->PostProcessingShader.shaderProgram, "chaos"), this->Chaos);
-    glUniform1i(glGetUniformLocation(this->PostProcessingShader.shaderProgram, "shake"), this->Shake);
+    GLStateCache::UseProgram(shader.shaderProgram);
+    shader.SetFloat(TIME_UNIFORM, time);
 
     // render textured quad
-    glActiveTexture(GL_TEXTURE0);
+    GLStateCache::ActiveTexture(GL_TEXTURE0);
     this->Texture.Bind();
 
-    glBindVertexArray(this->VAO);
+    GLStateCache::BindVertexArray(this->VAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    GLStateCache::BindVertexArray(0);
 }
 
 void Postprocessing::InitializeRenderData()
@@ -145,12 +166,12 @@ void Postprocessing::InitializeRenderData()
     glGenVertexArrays(1, &this->VAO);
     glGenBuffers(1, &VBO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLStateCache::BindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
 
-    glBindVertexArray(this->VAO);
+    GLStateCache::BindVertexArray(this->VAO);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLStateCache::BindVertexArray(0);
 }
\ No newline at end of file
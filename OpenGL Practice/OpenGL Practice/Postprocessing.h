@@ -9,18 +9,28 @@
 #include "Texture2D.h"
 #include "SpriteRenderer.h"
 #include "ShaderProgram.h"
+#include "ShaderVariantSet.h"
+
+// Feature bits of the postprocessing shader variants, in the same order as the features of its variant set ("CHAOS", "CONFUSE", "SHAKE")
+enum PostprocessingEffect
+{
+    CHAOS_EFFECT = 1 << 0,
+    CONFUSE_EFFECT = 1 << 1,
+    SHAKE_EFFECT = 1 << 2
+};
 
 class Postprocessing
 {
 public:
-    ShaderProgram PostProcessingShader;
+    // One program per combination of effects, so the shaders never have to branch on the effect options
+    ShaderVariantSet PostProcessingShaders;
     Texture2D Texture;
     unsigned int Width, Height;
 
     // Postprocessing options
     bool Confuse, Chaos, Shake;
 
-    Postprocessing(ShaderProgram shader, unsigned int width, unsigned int height);
+    Postprocessing(ShaderVariantSet shaders, unsigned int width, unsigned int height);
 
     // Prepares the post processing framebuffer operations before rendering the game
     void BeginRender();
@@ -36,8 +46,15 @@ private:
     unsigned int RBO; // RBO is used for multisampled color buffer
     unsigned int VAO;
 
+    /* The shader uniforms of a variant are only set the first time it's rendered with, so the variants can keep compiling
+    until then. Bit i is set once the variant with feature mask i is configured */
+    unsigned int ConfiguredVariants;
+
     // Initialize quad for rendering postprocessing texture
     void InitializeRenderData();
+
+    // Sets the sampler, offsets and kernel uniforms of a postprocessing shader variant
+    void ConfigureShader(ShaderProgram& shader);
 };
 
 #endif
\ No newline at end of file
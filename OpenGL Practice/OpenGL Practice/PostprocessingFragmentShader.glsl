@@ -9,46 +9,39 @@ uniform sampler2D scene;
 uniform vec2 offsets[9];
 uniform int edge_kernel[9];
 uniform float blur_kernel[9];
-uniform bool chaos;
-uniform bool confuse;
-uniform bool shake;
+
+/* The effects are compiled in with #define CHAOS, CONFUSE and SHAKE (see ShaderVariantSet), so every variant of this shader
+only contains the code of its own effects. Chaos wins over confuse and confuse wins over shake */
 
 void main()
 {
 	color = vec4(0.0f);
+
+#if defined(CHAOS) || defined(SHAKE)
 	vec3 sample[9];
-	
+
 	// Sample from texture offsets by using convolution matrix
-	if(chaos || shake)
+	for(int i = 0; i < 9; i++) 
 	{
-		for(int i = 0; i < 9; i++) 
-		{
-			sample[i] = vec3(texture(scene, TexCoords.st + offsets[i]));
-		}
+		sample[i] = vec3(texture(scene, TexCoords.st + offsets[i]));
 	}
+#endif
 
 	// Process effects
-	if (chaos)
-	{
-		for(int i = 0; i < 9; i++)
-		color += vec4(sample[i] * edge_kernel[i], 0.0f);
-		color.a = 1.0f;
-	}
-
-	else if (confuse)
-	{
-		color = vec4(1.0 - texture(scene, TexCoords).rgb, 1.0);
-	}
-	
-	else if (shake)
-	{
-		for(int i = 0; i < 9; i++)
-		color += vec4(sample[i] * blur_kernel[i], 0.0f);
-		color.a = 1.0f;
-	}
-
-	else
-	{
-		color = texture(scene, TexCoords);
-	}
-}
+#if defined(CHAOS)
+	for(int i = 0; i < 9; i++)
+	color += vec4(sample[i] * edge_kernel[i], 0.0f);
+	color.a = 1.0f;
+
+#elif defined(CONFUSE)
+	color = vec4(1.0 - texture(scene, TexCoords).rgb, 1.0);
+
+#elif defined(SHAKE)
+	for(int i = 0; i < 9; i++)
+	color += vec4(sample[i] * blur_kernel[i], 0.0f);
+	color.a = 1.0f;
+
+#else
+	color = texture(scene, TexCoords);
+#endif
+}
\ No newline at end of file
@@ -4,9 +4,6 @@ layout (location = 0) in vec4 vertex;
 
 out vec2 TexCoords;
 
-uniform bool chaos;
-uniform bool confuse;
-uniform bool shake;
 uniform float time;
 
 void main()
@@ -14,33 +11,27 @@ void main()
 	gl_Position = vec4(vertex.xy, 0.0f, 1.0f);
 	vec2 texture = vertex.zw;
 
-	/* If either chaos or confuse is set to true, the vertex shader will manipulate the texture coordinates to
+	/* If either chaos or confuse is compiled in, the vertex shader will manipulate the texture coordinates to
 	move the scene around (either translate texture coordinates in a circle-like fashion, or inverse them). Because 
 	we set the texture wrapping methods to GL_REPEAT, the chaos effect will cause the scene to repeat itself at various
-	parts of the quad. Additionally if shake is set to true, it will move the vertex positions around by a small amount, as 
+	parts of the quad. Additionally if shake is compiled in, it will move the vertex positions around by a small amount, as 
 	if the screen shakes */
 
-	if (chaos)
-	{
-		float strength = 0.3;
-		vec2 pos = vec2(texture.x + sin(time) * strength, texture.y + cos(time) * strength);
-		TexCoords = pos;
-	}
-
-	else if (confuse)
-	{
-		TexCoords = vec2(1.0 - texture.x, 1.0 - texture.y);
-	}
-
-	else
-	{
-		TexCoords = texture;
-	}
-
-	if (shake)
-	{
-		float strength = 0.01;
-		gl_Position.x += cos(time * 10) * strength;
-		gl_Position.y += cos(time * 15) * strength;
-	}
+#if defined(CHAOS)
+	float strength = 0.3;
+	vec2 pos = vec2(texture.x + sin(time) * strength, texture.y + cos(time) * strength);
+	TexCoords = pos;
+
+#elif defined(CONFUSE)
+	TexCoords = vec2(1.0 - texture.x, 1.0 - texture.y);
+
+#else
+	TexCoords = texture;
+#endif
+
+#if defined(SHAKE)
+	float shakeStrength = 0.01;
+	gl_Position.x += cos(time * 10) * shakeStrength;
+	gl_Position.y += cos(time * 15) * shakeStrength;
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "ProgramBinaryCache.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <filesystem>
+
+// Instantiate static variables
+string ProgramBinaryCache::cacheDirectory = "ShaderCache";
+bool ProgramBinaryCache::enabled = true;
+
+bool ProgramBinaryCache::supportQueried = false;
+bool ProgramBinaryCache::supported = false;
+
+unsigned int ProgramBinaryCache::programsLoaded = 0;
+unsigned int ProgramBinaryCache::programsCompiled = 0;
+
+double ProgramBinaryCache::loadTime = 0.0;
+double ProgramBinaryCache::compileTime = 0.0;
+double ProgramBinaryCache::savedCompileTime = 0.0;
+
+// Every cache file starts with this header, followed by binaryLength bytes of the driver's program binary
+struct ProgramBinaryHeader
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned long long key;
+	unsigned int binaryFormat;
+	unsigned int binaryLength;
+	double compileTime;
+};
+
+// "PBIN" in little endian, bump the version whenever the header changes so old files are ignored
+const unsigned int PROGRAM_BINARY_MAGIC = 0x4E494250;
+const unsigned int PROGRAM_BINARY_VERSION = 1;
+
+/* FNV-1a is a tiny non-cryptographic hash that is good enough to tell different shader sources apart. Each byte is XORed
+into the hash and then multiplied by the FNV prime */
+static unsigned long long HashString(unsigned long long hash, const char* text)
+{
+	if (text != nullptr)
+	{
+		for (const char* c = text; *c != '\0'; c++)
+		{
+			hash ^= static_cast<unsigned char>(*c);
+			hash *= 1099511628211ULL;
+		}
+	}
+
+	// Hash a separator as well so that moving code from one stage to another still changes the key
+	hash ^= 0xFF;
+	hash *= 1099511628211ULL;
+
+	return hash;
+}
+
+unsigned long long ProgramBinaryCache::ComputeKey(const char* vertexSource, const char* fragmentSource,
+	const char* geometrySource, const char* linkSettings)
+{
+	unsigned long long hash = 14695981039346656037ULL; // FNV offset basis
+
+	hash = HashString(hash, vertexSource);
+	hash = HashString(hash, fragmentSource);
+	hash = HashString(hash, geometrySource);
+
+	// Only hashed when there are any, so the keys of every other program stay the same
+	if (linkSettings != nullptr)
+		hash = HashString(hash, linkSettings);
+
+	// The binary only works with the driver that produced it, so the driver strings are part of the key
+	hash = HashString(hash, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+	hash = HashString(hash, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+	hash = HashString(hash, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+
+	return hash;
+}
+
+bool ProgramBinaryCache::IsSupported()
+{
+	if (!supportQueried)
+	{
+		/* The number of binary formats is 0 if the driver can't give us any program binaries at all. On a context without
+		program binary support this query raises GL_INVALID_ENUM and leaves formats untouched */
+		int formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		while (glGetError() != GL_NO_ERROR) {}
+
+		supported = formats > 0;
+		supportQueried = true;
+
+		if (!supported)
+			cout << "PROGRAM_BINARY_CACHE: Driver has no program binary formats, compiling all shaders from source" << endl;
+	}
+
+	return supported;
+}
+
+string ProgramBinaryCache::GetCacheFilePath(unsigned long long key)
+{
+	stringstream path;
+	path << cacheDirectory << "/" << hex << setw(16) << setfill('0') << key << ".bin";
+
+	return path.str();
+}
+
+void ProgramBinaryCache::PrepareProgram(unsigned int program)
+{
+	if (!enabled || !IsSupported())
+		return;
+
+	// Hint the driver that we're going to retrieve the binary, this has to be set before linking the program
+	glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+unsigned int ProgramBinaryCache::LoadProgram(unsigned long long key)
+{
+	if (!enabled || !IsSupported())
+		return 0;
+
+	unsigned int program = glCreateProgram();
+
+	if (!LoadProgramBinary(key, program))
+	{
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
+
+bool ProgramBinaryCache::LoadProgramBinary(unsigned long long key, unsigned int program)
+{
+	if (!enabled || !IsSupported())
+		return false;
+
+	double startTime = glfwGetTime();
+
+	ifstream file(GetCacheFilePath(key), ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	ProgramBinaryHeader header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	// Ignore files from an older cache version or a (very unlikely) hash collision on the file name
+	if (!file || header.magic != PROGRAM_BINARY_MAGIC || header.version != PROGRAM_BINARY_VERSION || header.key != key ||
+		header.binaryLength == 0)
+	{
+		return false;
+	}
+
+	vector<char> binary(header.binaryLength);
+	file.read(binary.data(), header.binaryLength);
+
+	if (!file)
+		return false;
+
+	file.close();
+
+	glProgramBinary(program, header.binaryFormat, binary.data(), header.binaryLength);
+
+	// The driver is allowed to reject a binary at any time, in that case it reports it as a failed link
+	int successfullyLinked = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &successfullyLinked);
+
+	if (!successfullyLinked)
+	{
+		cout << "PROGRAM_BINARY_CACHE: Driver rejected " << GetCacheFilePath(key) << ", compiling from source" << endl;
+
+		// Remove the stale binary, a fresh one gets stored once the source compile finishes
+		error_code errorCode;
+		filesystem::remove(GetCacheFilePath(key), errorCode);
+
+		return false;
+	}
+
+	programsLoaded++;
+	loadTime += glfwGetTime() - startTime;
+	savedCompileTime += header.compileTime;
+
+	return true;
+}
+
+void ProgramBinaryCache::SaveProgram(unsigned long long key, unsigned int program, double compileTime_)
+{
+	programsCompiled++;
+	compileTime += compileTime_;
+
+	if (!enabled || !IsSupported())
+		return;
+
+	int successfullyLinked = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &successfullyLinked);
+
+	// Never store a program that failed to link
+	if (!successfullyLinked)
+		return;
+
+	int binaryLength = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+
+	if (binaryLength <= 0)
+		return;
+
+	vector<char> binary(binaryLength);
+
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(program, binaryLength, &binaryLength, &binaryFormat, binary.data());
+
+	error_code errorCode;
+	filesystem::create_directories(cacheDirectory, errorCode);
+
+	ofstream file(GetCacheFilePath(key), ios::binary | ios::trunc);
+
+	if (!file.is_open())
+	{
+		cout << "PROGRAM_BINARY_CACHE: Failed to write " << GetCacheFilePath(key) << endl;
+		return;
+	}
+
+	ProgramBinaryHeader header;
+	header.magic = PROGRAM_BINARY_MAGIC;
+	header.version = PROGRAM_BINARY_VERSION;
+	header.key = key;
+	header.binaryFormat = binaryFormat;
+	header.binaryLength = static_cast<unsigned int>(binaryLength);
+	header.compileTime = compileTime_;
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(binary.data(), binaryLength);
+}
+
+void ProgramBinaryCache::PrintStatistics()
+{
+	cout << fixed << setprecision(2);
+
+	cout << "PROGRAM_BINARY_CACHE: " << programsLoaded << " program(s) loaded from binaries in " << loadTime * 1000.0
+		<< " ms, " << programsCompiled << " program(s) compiled from source in " << compileTime * 1000.0 << " ms" << endl;
+
+	// Compare the warm start against how long the same programs took when they were compiled from source (cold start)
+	if (programsLoaded > 0)
+	{
+		double coldTime = savedCompileTime + compileTime;
+		double warmTime = loadTime + compileTime;
+
+		cout << "PROGRAM_BINARY_CACHE: Cold start " << coldTime * 1000.0 << " ms, warm start " << warmTime * 1000.0
+			<< " ms (saved " << (coldTime - warmTime) * 1000.0 << " ms)" << endl;
+	}
+
+	cout << defaultfloat;
+}
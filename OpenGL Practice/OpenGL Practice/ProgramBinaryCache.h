@@ -0,0 +1,68 @@
+#pragma once
+
+#ifndef PROGRAM_BINARY_CACHE_H
+#define PROGRAM_BINARY_CACHE_H
+
+#include <glad/glad.h>
+#include <glfw3.h>
+#include <string>
+
+using namespace std;
+
+/* Compiling and linking GLSL source is one of the slowest things we do at startup. Since OpenGL 4.1 (or through the
+ARB_get_program_binary extension) the driver can hand us the final linked program as an opaque binary blob with
+glGetProgramBinary, and give it back to us with glProgramBinary on the next launch, which skips compiling and linking
+completely. The blob is only valid for the exact same driver, so the cache key hashes every stage's source code together
+with the vendor, renderer and version strings of the current context. If the driver rejects the blob anyway (after a
+driver update for example), we simply fall back to compiling from source and store a fresh binary */
+
+class ProgramBinaryCache
+{
+public:
+	/* Hashes all the stage sources (geometry source may be nullptr) together with the driver's identification strings.
+	linkSettings holds anything else that changes how the program is linked (like transform feedback varyings) */
+	static unsigned long long ComputeKey(const char* vertexSource, const char* fragmentSource, const char* geometrySource,
+		const char* linkSettings = nullptr);
+
+	// Creates a linked program from a stored binary, returns 0 if there's no binary or the driver rejected it
+	static unsigned int LoadProgram(unsigned long long key);
+
+	/* Loads a stored binary into an already created program object, returns false if there's no binary or the driver
+	rejected it (the program can still be compiled from source afterwards) */
+	static bool LoadProgramBinary(unsigned long long key, unsigned int program);
+
+	// Stores the binary of a successfully linked program, compileTime is how long the source compile took (in seconds)
+	static void SaveProgram(unsigned long long key, unsigned int program, double compileTime);
+
+	// Programs must ask for a retrievable binary before they're linked
+	static void PrepareProgram(unsigned int program);
+
+	// Returns true if the driver supports at least one program binary format
+	static bool IsSupported();
+
+	// Prints how long the shader programs took this launch compared to compiling them all from source
+	static void PrintStatistics();
+
+	// Directory (relative to the working directory) where the program binaries are stored
+	static string cacheDirectory;
+
+	// Allows turning the cache off completely, so every program is compiled from source like before
+	static bool enabled;
+
+private:
+	ProgramBinaryCache() { }
+
+	static string GetCacheFilePath(unsigned long long key);
+
+	static bool supportQueried, supported;
+
+	static unsigned int programsLoaded, programsCompiled;
+
+	// Time spent this launch on programs loaded from binaries and programs compiled from source (in seconds)
+	static double loadTime, compileTime;
+
+	// How long the programs that were loaded from binaries took to compile the last time they were built from source
+	static double savedCompileTime;
+};
+
+#endif
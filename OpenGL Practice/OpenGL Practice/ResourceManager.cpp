@@ -4,7 +4,8 @@
 #include <sstream>
 #include <fstream>
 
-#include "stb_image.h"
+#include "ShaderPreprocessor.h"
+#include "TextureCache.h"
 
 // Instantiate static variables
 map<string, ShaderProgram> ResourceManager::shaders;
@@ -15,12 +16,30 @@ ShaderProgram ResourceManager::GetShader(string name)
     return shaders[name];
 }
 
-ShaderProgram ResourceManager::LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, string name)
+ShaderProgram ResourceManager::LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, string name,
+    const string& defines)
 {
-    shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
+    shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile, defines);
     return shaders[name];
 }
 
+ShaderProgram ResourceManager::LoadShaderAsync(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, string name,
+    const string& defines)
+{
+    // The program object exists right away so its ID can be handed out, it just isn't linked yet
+    ShaderProgram shader;
+    shader.shaderProgram = glCreateProgram();
+    shader.compileJob = ShaderCompileQueue::Enqueue(shader.shaderProgram, vShaderFile, fShaderFile, gShaderFile, defines);
+
+    shaders[name] = shader;
+    return shaders[name];
+}
+
+void ResourceManager::CompileShaders()
+{
+    ShaderCompileQueue::SubmitAll();
+}
+
 Texture2D ResourceManager::GetTexture(string name)
 {
     return textures[name];
@@ -28,66 +47,45 @@ Texture2D ResourceManager::GetTexture(string name)
 
 Texture2D ResourceManager::LoadTexture(const char* file, bool alpha, string name)
 {
+    // Loading another texture under the same name drops the reference to the old one
+    if (textures.count(name) != 0)
+        TextureCache::ReleaseTexture(textures[name].textureID);
+
     textures[name] = loadTextureFromFile(file, alpha);
     return textures[name];
 }
 
 void ResourceManager::Clear()
 {
+    // Make sure no asynchronously loaded program still holds on to its shader objects
+    ShaderCompileQueue::FinishAll();
+
     // Delete all shaders properly	
     for (pair<string, ShaderProgram> iter : shaders)
     {
         glDeleteProgram(iter.second.shaderProgram);
     }
 
-    // Delete all textures properly
+    // Release all textures properly, the texture cache deletes the ones nothing else uses
     for (pair<string, Texture2D> iter : textures)
     {
-        glDeleteTextures(1, &iter.second.textureID);
+        TextureCache::ReleaseTexture(iter.second.textureID);
     }
+
+    textures.clear();
 }
 
-ShaderProgram ResourceManager::loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile)
+ShaderProgram ResourceManager::loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile,
+    const string& defines)
 {
-    // Retrieve the vertex/fragment source code from filePath
-    string vertexCode;
-    string fragmentCode;
+    // Retrieve the vertex/fragment source code from filePath, with the #includes resolved and the defines injected
+    string vertexCode = ShaderPreprocessor::Process(vShaderFile, defines);
+    string fragmentCode = ShaderPreprocessor::Process(fShaderFile, defines);
     string geometryCode;
 
-    try
-    {
-        // open files
-        ifstream vertexShaderFile(vShaderFile);
-        ifstream fragmentShaderFile(fShaderFile);
-        stringstream vShaderStream, fShaderStream;
-
-        // read file's buffer contents into streams
-        vShaderStream << vertexShaderFile.rdbuf();
-        fShaderStream << fragmentShaderFile.rdbuf();
-
-        // close file handlers
-        vertexShaderFile.close();
-        fragmentShaderFile.close();
-
-        // convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-
-        // if geometry shader path is present, also load a geometry shader
-        if (gShaderFile != nullptr)
-        {
-            ifstream geometryShaderFile(gShaderFile);
-            stringstream gShaderStream;
-            gShaderStream << geometryShaderFile.rdbuf();
-            geometryShaderFile.close();
-            geometryCode = gShaderStream.str();
-        }
-    }
-
-    catch (exception e)
-    {
-        cout << "ERROR::SHADER: Failed to read shader files" << endl;
-    }
+    // if geometry shader path is present, also load a geometry shader
+    if (gShaderFile != nullptr)
+        geometryCode = ShaderPreprocessor::Process(gShaderFile, defines);
 
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
@@ -109,22 +107,27 @@ Texture2D ResourceManager::loadTextureFromFile(const char* file, bool alpha)
         texture.internalFormat = GL_RGBA;
         texture.imageFormat = GL_RGBA;
     }
-    // load image
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(file, &width, &height, &nrChannels, 0);
 
-    if (!data)
+    /* The texture cache decodes and uploads the image (only if nothing else loaded it yet), converted to the channels
+    the sprite renderer expects. Texture2D's sampling is plain linear filtering without mipmaps */
+    unsigned int textureID = TextureCache::LoadTexture(file, TextureLoadOptions(false, false, alpha ? 4 : 3, false, false,
+        TEXTURE_COMPRESSION_COLOR));
+
+    int width, height;
+
+    if (!TextureCache::GetTextureSize(textureID, width, height))
     {
         cout << "Can't find texture path at: " << file << endl;
     }
 
-    else if (data)
+    else
     {
-        // now generate texture
-        texture.Generate(width, height, data);
+        // The texture object Texture2D generated isn't needed, the cached one is used instead
+        GLStateCache::DeleteTextures(1, &texture.textureID);
 
-        // and finally free image data
-        stbi_image_free(data);
+        texture.textureID = textureID;
+        texture.width = width;
+        texture.height = height;
     }
 
     return texture;
@@ -20,9 +20,18 @@ public:
     static map<string, Texture2D> textures;
 
     // Loads (and generates) a shader program from file loading vertex, fragment (and geometry) shader's source code.
-    // If gShaderFile is not nullptr, it also loads a geometry shader
-    static ShaderProgram LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, string name);
+    // If gShaderFile is not nullptr, it also loads a geometry shader. The defines are injected into every stage
+    static ShaderProgram LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, string name,
+        const string& defines = "");
     
+    /* Same as LoadShader, but returns right away. The shader files are read on worker threads and the program is only
+    compiled once CompileShaders is called (or the program is first waited on), so several programs compile in parallel */
+    static ShaderProgram LoadShaderAsync(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, string name,
+        const string& defines = "");
+
+    // Issues the compile and link of every shader loaded with LoadShaderAsync without waiting for the results
+    static void CompileShaders();
+
     // Retrieves a stored sader
     static ShaderProgram GetShader(string name);
 
@@ -41,7 +50,8 @@ private:
     ResourceManager() { }
 
     // loads and generates a shader from file
-    static ShaderProgram loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile = nullptr);
+    static ShaderProgram loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile = nullptr,
+        const string& defines = "");
 
     // loads a single texture from file
     static Texture2D loadTextureFromFile(const char* file, bool alpha);
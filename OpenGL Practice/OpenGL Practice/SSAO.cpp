@@ -41,22 +41,22 @@ SSAO::~SSAO()
 
 	for (unsigned int i = 0; i < VAOs.size(); i++)
 	{
-		glDeleteVertexArrays(1, &VAOs[i]);
+		GLStateCache::DeleteVertexArrays(1, &VAOs[i]);
 	}
 
 	for (unsigned int i = 0; i < VBOs.size(); i++)
 	{
-		glDeleteBuffers(1, &VBOs[i]);
+		GLStateCache::DeleteBuffers(1, &VBOs[i]);
 	}
 
 	for (unsigned int i = 0; i < frameBuffers.size(); i++)
 	{
-		glDeleteFramebuffers(1, &frameBuffers[i]);
+		GLStateCache::DeleteFramebuffers(1, &frameBuffers[i]);
 	}
 
 	for (unsigned int i = 0; i < attachments.size(); i++)
 	{
-		glDeleteFramebuffers(1, &attachments[i]);
+		GLStateCache::DeleteFramebuffers(1, &attachments[i]);
 	}
 
 	glDeleteRenderbuffers(1, &rboDepth);
@@ -82,7 +82,7 @@ SSAO* SSAO::Instance()
 
 void SSAO::InitializeSSAO()
 {
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::Enable(GL_DEPTH_TEST);
 
 	// Geometry pass for SSAO shaders
 	ssaoShaders[0]->InitializeShaderProgram(new VertexShaderLoader("ssaoGeometryVertexShader.glsl"), 
@@ -100,14 +100,16 @@ void SSAO::InitializeSSAO()
 	ssaoShaders[3]->InitializeShaderProgram(new VertexShaderLoader("ssaoVertexShader.glsl"),
 		new FragmentShaderLoader("ssaoBlurFragmentShader.glsl"));
 
-	backpack = new Model("Models/Backpack/backpack.obj");
+	/* The backpack's buffers and textures stream in on the asset loader's thread, it shows up as soon as the buffers are
+	ready and with placeholder textures until the real ones are */
+	backpack = new Model("Models/Backpack/backpack.obj", false, true);
 
 	glGenFramebuffers(1, &gBuffer);
-	glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, gBuffer);
 
 	// position color buffer
 	glGenTextures(1, &gPosition);
-	glBindTexture(GL_TEXTURE_2D, gPosition);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, gPosition);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, 1280, 960, 0, GL_RGBA, GL_FLOAT, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -117,7 +119,7 @@ void SSAO::InitializeSSAO()
 
 	// normal color buffer
 	glGenTextures(1, &gNormal);
-	glBindTexture(GL_TEXTURE_2D, gNormal);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, gNormal);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, 1280, 960, 0, GL_RGBA, GL_FLOAT, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -125,7 +127,7 @@ void SSAO::InitializeSSAO()
 
 	// color + specular color buffer
 	glGenTextures(1, &gAlbedo);
-	glBindTexture(GL_TEXTURE_2D, gAlbedo);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, gAlbedo);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1280, 960, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -148,16 +150,16 @@ void SSAO::InitializeSSAO()
 	// finally check if framebuffer is complete
 	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) cout << "Framebuffer not complete!" << endl;
 	
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Create framebuffer to hold SSAO processing stage
 	glGenFramebuffers(1, &ssaoFBO);  
 	glGenFramebuffers(1, &ssaoBlurFBO);
-	glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
 
 	// SSAO color buffer
 	glGenTextures(1, &ssaoColorBuffer);
-	glBindTexture(GL_TEXTURE_2D, ssaoColorBuffer);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, ssaoColorBuffer);
 
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, 1280, 960, 0, GL_RED, GL_FLOAT, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -168,9 +170,9 @@ void SSAO::InitializeSSAO()
 		cout << "SSAO Framebuffer not complete!" << endl;
 
 	// Blur stage
-	glBindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
 	glGenTextures(1, &ssaoColorBufferBlur);
-	glBindTexture(GL_TEXTURE_2D, ssaoColorBufferBlur);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, ssaoColorBufferBlur);
 
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, 1280, 960, 0, GL_RED, GL_FLOAT, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -181,7 +183,7 @@ void SSAO::InitializeSSAO()
 	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) 
 		cout << "SSAO Blur Framebuffer not complete!" << endl;
 	
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// generate sample kernel (generating random floats between 0.0 and 1.0)
 	uniform_real_distribution<GLfloat> randomFloats(0.0, 1.0);
@@ -209,7 +211,7 @@ void SSAO::InitializeSSAO()
 	}
 	
 	glGenTextures(1, &noiseTexture);
-	glBindTexture(GL_TEXTURE_2D, noiseTexture);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, noiseTexture);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, 4, 4, 0, GL_RGB, GL_FLOAT, &ssaoNoise[0]);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -220,18 +222,18 @@ void SSAO::InitializeSSAO()
 	lightPos = vec3(2.0, 4.0, -2.0);
 	lightColor = vec3(0.2, 0.2, 0.7);
 
-	glUseProgram(ssaoShaders[1]->shaderProgram);
+	GLStateCache::UseProgram(ssaoShaders[1]->shaderProgram);
 	glUniform1i(glGetUniformLocation(ssaoShaders[1]->shaderProgram, "gPosition"), 0);
 	glUniform1i(glGetUniformLocation(ssaoShaders[1]->shaderProgram, "gNormal"), 1);
 	glUniform1i(glGetUniformLocation(ssaoShaders[1]->shaderProgram, "gAlbedo"), 2);
 	glUniform1i(glGetUniformLocation(ssaoShaders[1]->shaderProgram, "ssao"), 3);
 
-	glUseProgram(ssaoShaders[2]->shaderProgram);
+	GLStateCache::UseProgram(ssaoShaders[2]->shaderProgram);
 	glUniform1i(glGetUniformLocation(ssaoShaders[2]->shaderProgram, "gPosition"), 0);
 	glUniform1i(glGetUniformLocation(ssaoShaders[2]->shaderProgram, "gNormal"), 1);
 	glUniform1i(glGetUniformLocation(ssaoShaders[2]->shaderProgram, "texNoise"), 2);
 	
-	glUseProgram(ssaoShaders[3]->shaderProgram);
+	GLStateCache::UseProgram(ssaoShaders[3]->shaderProgram);
 	glUniform1i(glGetUniformLocation(ssaoShaders[3]->shaderProgram, "ssaoInput"), 0);
 }
 
@@ -241,17 +243,12 @@ void SSAO::RenderSSAO()
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// Geometry pass: render scene's geometry/color data into gbuffer
-	glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, gBuffer);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	mat4 projection = perspective(glm::radians(Camera::fieldOfView), float(1280 / 960), 0.1f, 50.0f);
-	mat4 view = lookAt(Camera::cameraPosition, Camera::cameraPosition + Camera::cameraFront, Camera::cameraUp);
 	mat4 model = mat4(1.0f);
 
-	glUseProgram(ssaoShaders[0]->shaderProgram);
-
-	glUniformMatrix4fv(glGetUniformLocation(ssaoShaders[0]->shaderProgram, "projection"), 1, GL_FALSE, value_ptr(projection));
-	glUniformMatrix4fv(glGetUniformLocation(ssaoShaders[0]->shaderProgram, "view"), 1, GL_FALSE, value_ptr(view));
+	GLStateCache::UseProgram(ssaoShaders[0]->shaderProgram);
 
 	// Room cube
 	model = glm::mat4(1.0f);
@@ -271,15 +268,14 @@ void SSAO::RenderSSAO()
 	model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0, 0.0, 0.0));
 	model = glm::scale(model, glm::vec3(1.0f));
 
-	glUniformMatrix4fv(glGetUniformLocation(ssaoShaders[0]->shaderProgram, "model"), 1, GL_FALSE, value_ptr(model));
-	backpack->DrawModel(ssaoShaders[0]);
+	backpack->DrawModel(ssaoShaders[0], model, 0, UniformHash("model"));
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Generate SSAO texture
-	glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
 	glClear(GL_COLOR_BUFFER_BIT);
-	glUseProgram(ssaoShaders[2]->shaderProgram);
+	GLStateCache::UseProgram(ssaoShaders[2]->shaderProgram);
 
 	// Send kernel + rotation 
 	for (unsigned int i = 0; i < 64; ++i)
@@ -288,38 +284,35 @@ void SSAO::RenderSSAO()
 			("samples[" + std::to_string(i) + "]").c_str()), 1, value_ptr(ssaoKernel[i]));
 	}
 
-	glUniformMatrix4fv(glGetUniformLocation(ssaoShaders[2]->shaderProgram, "projection"), 1, GL_FALSE, 
-		value_ptr(projection));
-
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, gPosition);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, gPosition);
 
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, gNormal);
+	GLStateCache::ActiveTexture(GL_TEXTURE1);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, gNormal);
 
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, noiseTexture);
+	GLStateCache::ActiveTexture(GL_TEXTURE2);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, noiseTexture);
 
 	RenderQuad();
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Blur SSAO texture to remove noise
-	glBindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	glUseProgram(ssaoShaders[3]->shaderProgram);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, ssaoColorBuffer);
+	GLStateCache::UseProgram(ssaoShaders[3]->shaderProgram);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, ssaoColorBuffer);
 
 	RenderQuad();
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Lighting pass: traditional deferred Blinn-Phong lighting with added screen-space ambient occlusion
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	
 	// Send light relevant uniforms
-	glUseProgram(ssaoShaders[1]->shaderProgram);
-	vec3 lightPosView = vec3(view * vec4(lightPos, 1.0));
+	GLStateCache::UseProgram(ssaoShaders[1]->shaderProgram);
+	vec3 lightPosView = vec3(FrameUniforms::frameData.view * vec4(lightPos, 1.0));
 
 	glUniform3fv(glGetUniformLocation(ssaoShaders[1]->shaderProgram, "light.Position"), 1, value_ptr(lightPosView));
 	glUniform3fv(glGetUniformLocation(ssaoShaders[1]->shaderProgram, "light.Color"), 1, value_ptr(lightColor));
@@ -331,17 +324,17 @@ void SSAO::RenderSSAO()
 	glUniform1f(glGetUniformLocation(ssaoShaders[1]->shaderProgram, "light.Linear"), linear);
 	glUniform1f(glGetUniformLocation(ssaoShaders[1]->shaderProgram, "light.Quadratic"), quadratic);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, gPosition);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, gPosition);
 
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, gNormal);
+	GLStateCache::ActiveTexture(GL_TEXTURE1);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, gNormal);
 
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, gAlbedo);
+	GLStateCache::ActiveTexture(GL_TEXTURE2);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, gAlbedo);
 
-	glActiveTexture(GL_TEXTURE3); // add extra SSAO texture to lighting pass
-	glBindTexture(GL_TEXTURE_2D, ssaoColorBufferBlur);
+	GLStateCache::ActiveTexture(GL_TEXTURE3); // add extra SSAO texture to lighting pass
+	GLStateCache::BindTexture(GL_TEXTURE_2D, ssaoColorBufferBlur);
 
 	RenderQuad();
 }
@@ -362,8 +355,8 @@ void SSAO::RenderQuad()
 		glGenVertexArrays(1, &quadVAO);
 		glGenBuffers(1, &quadVBO);
 
-		glBindVertexArray(quadVAO);
-		glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+		GLStateCache::BindVertexArray(quadVAO);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, quadVBO);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
 
 		glEnableVertexAttribArray(0);
@@ -372,9 +365,9 @@ void SSAO::RenderQuad()
 		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
 	}
 
-	glBindVertexArray(quadVAO);
+	GLStateCache::BindVertexArray(quadVAO);
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(0);
 }
 
 void SSAO::RenderCube()
@@ -428,21 +421,21 @@ void SSAO::RenderCube()
 		glGenVertexArrays(1, &cubeVAO);
 		glGenBuffers(1, &cubeVBO);
 
-		glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, cubeVBO);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
 
-		glBindVertexArray(cubeVAO);
+		GLStateCache::BindVertexArray(cubeVAO);
 		glEnableVertexAttribArray(0);
 		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
 		glEnableVertexAttribArray(1);
 		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
 		glEnableVertexAttribArray(2);
 		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+		GLStateCache::BindVertexArray(0);
 	}
 
-	glBindVertexArray(cubeVAO);
+	GLStateCache::BindVertexArray(cubeVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 36);
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(0);
 }
\ No newline at end of file
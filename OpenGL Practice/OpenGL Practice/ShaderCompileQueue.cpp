@@ -0,0 +1,243 @@
+#include "ShaderCompileQueue.h"
+#include "ProgramBinaryCache.h"
+#include "ShaderPreprocessor.h"
+#include "FrameUniforms.h"
+
+#include <iostream>
+#include <cstring>
+#include <array>
+
+// The KHR and ARB versions of the parallel shader compile extension share the same enum values
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+// Instantiate static variables
+vector<shared_ptr<ShaderCompileJob>> ShaderCompileQueue::jobs;
+
+bool ShaderCompileQueue::parallelCompileQueried = false;
+bool ShaderCompileQueue::parallelCompileSupported = false;
+
+shared_ptr<ShaderCompileJob> ShaderCompileQueue::Enqueue(unsigned int program, const char* vShaderFile,
+	const char* fShaderFile, const char* gShaderFile, const string& defines)
+{
+	shared_ptr<ShaderCompileJob> job = make_shared<ShaderCompileJob>();
+
+	job->program = program;
+	job->hasGeometryShader = gShaderFile != nullptr;
+
+	job->vertexShader = 0;
+	job->fragmentShader = 0;
+	job->geometryShader = 0;
+
+	job->cacheKey = 0;
+	job->startTime = glfwGetTime();
+
+	job->submitted = false;
+	job->finished = false;
+	job->fromBinaryCache = false;
+
+	// File reading doesn't touch OpenGL, so it can happen on worker threads while the main thread keeps going
+	job->vertexSource = async(launch::async, ReadShaderFile, string(vShaderFile), defines);
+	job->fragmentSource = async(launch::async, ReadShaderFile, string(fShaderFile), defines);
+
+	if (job->hasGeometryShader)
+		job->geometrySource = async(launch::async, ReadShaderFile, string(gShaderFile), defines);
+
+	jobs.push_back(job);
+
+	return job;
+}
+
+void ShaderCompileQueue::SubmitAll()
+{
+	EnableParallelCompile();
+
+	for (unsigned int i = 0; i < jobs.size(); i++)
+	{
+		if (!jobs[i]->submitted)
+			Submit(*jobs[i]);
+	}
+}
+
+bool ShaderCompileQueue::IsComplete(ShaderCompileJob& job)
+{
+	if (job.finished)
+		return true;
+
+	if (!job.submitted)
+		return false;
+
+	// Without the extension there's no way to ask without blocking, so a submitted program counts as complete
+	if (!parallelCompileSupported)
+		return true;
+
+	int completed = GL_FALSE;
+	glGetProgramiv(job.program, GL_COMPLETION_STATUS_KHR, &completed);
+
+	return completed == GL_TRUE;
+}
+
+void ShaderCompileQueue::Finish(ShaderCompileJob& job)
+{
+	if (job.finished)
+		return;
+
+	if (!job.submitted)
+		Submit(job);
+
+	job.finished = true;
+
+	// Point the program's FrameUniforms block (if it has one) to the per-frame camera buffer
+	FrameUniforms::BindProgram(job.program);
+
+	// A program loaded from the binary cache has already been checked by the cache
+	if (job.fromBinaryCache)
+		return;
+
+	// Querying the status is the point where we actually wait for the driver
+	int successfullyCompiled;
+	char infoLog[1024];
+
+	array<unsigned int, 3> stages = { job.vertexShader, job.fragmentShader, job.geometryShader };
+	array<const char*, 3> stageNames = { "VERTEX", "FRAGMENT", "GEOMETRY" };
+
+	for (unsigned int i = 0; i < stages.size(); i++)
+	{
+		if (stages[i] == 0)
+			continue;
+
+		glGetShaderiv(stages[i], GL_COMPILE_STATUS, &successfullyCompiled);
+
+		if (!successfullyCompiled)
+		{
+			glGetShaderInfoLog(stages[i], 1024, NULL, infoLog);
+			cout << "| ERROR::SHADER: Compile-time error: Type: " << stageNames[i] << "\n"
+				<< infoLog << "\n -- --------------------------------------------------- -- " << endl;
+		}
+
+		// Delete the shaders as they're linked into our program now and no longer necessary
+		glDeleteShader(stages[i]);
+	}
+
+	glGetProgramiv(job.program, GL_LINK_STATUS, &successfullyCompiled);
+
+	if (!successfullyCompiled)
+	{
+		glGetProgramInfoLog(job.program, 1024, NULL, infoLog);
+		cout << "| ERROR::Shader: Link-time error: Type: PROGRAM\n"
+			<< infoLog << "\n -- --------------------------------------------------- -- " << endl;
+	}
+
+	ProgramBinaryCache::SaveProgram(job.cacheKey, job.program, glfwGetTime() - job.startTime);
+}
+
+void ShaderCompileQueue::FinishAll()
+{
+	SubmitAll();
+
+	for (unsigned int i = 0; i < jobs.size(); i++)
+	{
+		Finish(*jobs[i]);
+	}
+
+	jobs.clear();
+}
+
+void ShaderCompileQueue::Submit(ShaderCompileJob& job)
+{
+	EnableParallelCompile();
+
+	job.submitted = true;
+
+	// Waits for the worker threads only if they haven't finished reading the files yet
+	string vertexCode = job.vertexSource.get();
+	string fragmentCode = job.fragmentSource.get();
+	string geometryCode = job.hasGeometryShader ? job.geometrySource.get() : string();
+
+	job.cacheKey = ProgramBinaryCache::ComputeKey(vertexCode.c_str(), fragmentCode.c_str(),
+		job.hasGeometryShader ? geometryCode.c_str() : nullptr);
+
+	if (ProgramBinaryCache::LoadProgramBinary(job.cacheKey, job.program))
+	{
+		job.fromBinaryCache = true;
+		return;
+	}
+
+	// Issue the compiles but don't check them yet, the driver is free to work on them in the background
+	job.vertexShader = CompileStage(GL_VERTEX_SHADER, vertexCode);
+	job.fragmentShader = CompileStage(GL_FRAGMENT_SHADER, fragmentCode);
+
+	if (job.hasGeometryShader)
+		job.geometryShader = CompileStage(GL_GEOMETRY_SHADER, geometryCode);
+
+	glAttachShader(job.program, job.vertexShader);
+	glAttachShader(job.program, job.fragmentShader);
+
+	if (job.hasGeometryShader)
+		glAttachShader(job.program, job.geometryShader);
+
+	ProgramBinaryCache::PrepareProgram(job.program);
+	glLinkProgram(job.program);
+}
+
+unsigned int ShaderCompileQueue::CompileStage(GLenum type, const string& source)
+{
+	const char* shaderCode = source.c_str();
+
+	unsigned int shader = glCreateShader(type);
+	glShaderSource(shader, 1, &shaderCode, NULL);
+	glCompileShader(shader);
+
+	return shader;
+}
+
+string ShaderCompileQueue::ReadShaderFile(string filePath, string defines)
+{
+	// The preprocessor doesn't share any state, so resolving the #includes can happen on the worker thread as well
+	return ShaderPreprocessor::Process(filePath, defines);
+}
+
+void ShaderCompileQueue::EnableParallelCompile()
+{
+	if (parallelCompileQueried)
+		return;
+
+	parallelCompileQueried = true;
+
+	int extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+
+	const char* functionName = nullptr;
+
+	for (int i = 0; i < extensionCount; i++)
+	{
+		const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+
+		if (strcmp(extension, "GL_KHR_parallel_shader_compile") == 0)
+		{
+			functionName = "glMaxShaderCompilerThreadsKHR";
+			break;
+		}
+
+		else if (strcmp(extension, "GL_ARB_parallel_shader_compile") == 0)
+		{
+			functionName = "glMaxShaderCompilerThreadsARB";
+		}
+	}
+
+	if (functionName == nullptr)
+		return;
+
+	MaxShaderCompilerThreadsProc maxShaderCompilerThreads =
+		reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress(functionName));
+
+	if (maxShaderCompilerThreads != nullptr)
+	{
+		// 0xFFFFFFFF lets the driver pick as many compiler threads as it wants
+		maxShaderCompilerThreads(0xFFFFFFFF);
+		parallelCompileSupported = true;
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#ifndef SHADER_COMPILE_QUEUE_H
+#define SHADER_COMPILE_QUEUE_H
+
+#include <glad/glad.h>
+#include <glfw3.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+
+using namespace std;
+
+/* Compiling shaders one program at a time means the main thread waits on the driver for every single compile and link.
+Instead, the shader files are read on worker threads, then every glCompileShader and glLinkProgram is issued up front
+without asking for their status. Asking for the status (or the info log) is what forces the driver to finish the work,
+so we only do that when a program is actually needed. With KHR_parallel_shader_compile the driver compiles all the queued
+shaders on its own threads in the meantime, and we can even ask whether a program is done without blocking */
+
+// Holds everything about a program that's still being read, compiled or linked
+struct ShaderCompileJob
+{
+	unsigned int program;
+
+	// Shader source code, read on worker threads
+	future<string> vertexSource, fragmentSource, geometrySource;
+	bool hasGeometryShader;
+
+	// Shader objects created once the compile is submitted to the driver
+	unsigned int vertexShader, fragmentShader, geometryShader;
+
+	unsigned long long cacheKey;
+	double startTime;
+
+	bool submitted; // glCompileShader/glLinkProgram (or glProgramBinary) have been issued
+	bool finished; // the compile/link status has been checked and the shader objects are deleted
+	bool fromBinaryCache;
+};
+
+class ShaderCompileQueue
+{
+public:
+	/* Starts reading the shader files on worker threads for an already created program object (geometry file may be
+	nullptr), the defines are injected into every stage */
+	static shared_ptr<ShaderCompileJob> Enqueue(unsigned int program, const char* vShaderFile, const char* fShaderFile,
+		const char* gShaderFile, const string& defines = "");
+
+	// Issues the compile and link of every queued program without waiting for any of them
+	static void SubmitAll();
+
+	// Returns true once the driver has finished compiling and linking the program, never blocks
+	static bool IsComplete(ShaderCompileJob& job);
+
+	// Blocks until the program is linked, reports any errors and releases the shader objects
+	static void Finish(ShaderCompileJob& job);
+
+	// Finishes every queued program
+	static void FinishAll();
+
+private:
+	ShaderCompileQueue() { }
+
+	static void Submit(ShaderCompileJob& job);
+
+	static unsigned int CompileStage(GLenum type, const string& source);
+
+	static string ReadShaderFile(string filePath, string defines);
+
+	// Asks the driver to use its own compiler threads if KHR_parallel_shader_compile is available
+	static void EnableParallelCompile();
+
+	static vector<shared_ptr<ShaderCompileJob>> jobs;
+
+	static bool parallelCompileQueried, parallelCompileSupported;
+};
+
+#endif
@@ -0,0 +1,136 @@
+#include "ShaderPack.h"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+#ifdef SHADER_PACK_EMBEDDED
+#include "ShaderPackData.inl"
+#endif
+
+// 'SPAK' read as a little endian integer, must match PackShaders.ps1
+static const unsigned int PACK_MAGIC = 0x4B415053;
+static const unsigned int PACK_VERSION = 1;
+
+// Instantiate static variables
+#ifdef _DEBUG
+bool ShaderPack::useLooseFiles = true;
+#else
+bool ShaderPack::useLooseFiles = false;
+#endif
+
+string ShaderPack::packFilePath = "Shaders.pack";
+
+once_flag ShaderPack::loadFlag;
+vector<unsigned char> ShaderPack::packData;
+vector<ShaderPackEntry> ShaderPack::entries;
+
+static unsigned int ReadUInt32(const unsigned char* data)
+{
+	unsigned int value;
+	memcpy(&value, data, sizeof(value));
+
+	return value;
+}
+
+string_view ShaderPack::Find(const string& filePath)
+{
+	if (useLooseFiles)
+		return string_view();
+
+	call_once(loadFlag, Load);
+
+	// Shaders are packed by file name, so "./Shader.glsl" and "Shader.glsl" are the same file
+	string_view name = filePath;
+
+	if (name.substr(0, 2) == "./" || name.substr(0, 2) == ".\\")
+		name.remove_prefix(2);
+
+	vector<ShaderPackEntry>::const_iterator entry = lower_bound(entries.begin(), entries.end(), name,
+		[](const ShaderPackEntry& packEntry, string_view entryName) { return packEntry.name < entryName; });
+
+	if (entry == entries.end() || entry->name != name)
+		return string_view();
+
+	return entry->source;
+}
+
+bool ShaderPack::IsAvailable()
+{
+	if (useLooseFiles)
+		return false;
+
+	call_once(loadFlag, Load);
+
+	return !entries.empty();
+}
+
+void ShaderPack::Load()
+{
+#ifdef SHADER_PACK_EMBEDDED
+	// The blob is part of the executable, so there's nothing to read at all
+	if (Parse(shaderPackData, sizeof(shaderPackData)))
+		return;
+#endif
+
+	ifstream packFile(packFilePath, ios::binary | ios::ate);
+
+	if (!packFile.is_open())
+	{
+		cout << "ERROR::SHADER_PACK: Couldn't open " << packFilePath << ", reading the loose shader files instead" << endl;
+		return;
+	}
+
+	// One read for every shader in the game
+	packData.resize(static_cast<size_t>(packFile.tellg()));
+	packFile.seekg(0);
+	packFile.read(reinterpret_cast<char*>(packData.data()), packData.size());
+
+	if (!Parse(packData.data(), packData.size()))
+	{
+		cout << "ERROR::SHADER_PACK: " << packFilePath << " is damaged, reading the loose shader files instead" << endl;
+
+		packData.clear();
+		entries.clear();
+	}
+}
+
+bool ShaderPack::Parse(const unsigned char* data, size_t size)
+{
+	const size_t headerSize = 3 * sizeof(unsigned int);
+	const size_t indexEntrySize = 4 * sizeof(unsigned int);
+
+	if (size < headerSize || ReadUInt32(data) != PACK_MAGIC || ReadUInt32(data + 4) != PACK_VERSION)
+		return false;
+
+	unsigned int entryCount = ReadUInt32(data + 8);
+
+	if (headerSize + static_cast<size_t>(entryCount) * indexEntrySize > size)
+		return false;
+
+	entries.clear();
+	entries.reserve(entryCount);
+
+	for (unsigned int i = 0; i < entryCount; i++)
+	{
+		const unsigned char* indexEntry = data + headerSize + i * indexEntrySize;
+
+		size_t nameOffset = ReadUInt32(indexEntry);
+		size_t nameLength = ReadUInt32(indexEntry + 4);
+		size_t sourceOffset = ReadUInt32(indexEntry + 8);
+		size_t sourceLength = ReadUInt32(indexEntry + 12);
+
+		// Both the name and the source are followed by a 0 byte that has to be inside the blob as well
+		if (nameOffset + nameLength >= size || sourceOffset + sourceLength >= size)
+			return false;
+
+		ShaderPackEntry entry;
+		entry.name = string_view(reinterpret_cast<const char*>(data + nameOffset), nameLength);
+		entry.source = string_view(reinterpret_cast<const char*>(data + sourceOffset), sourceLength);
+
+		entries.push_back(entry);
+	}
+
+	return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#ifndef SHADER_PACK_H
+#define SHADER_PACK_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <mutex>
+
+using namespace std;
+
+/* Opening, reading and copying over a hundred separate .glsl files at startup adds up. The PackShaders.ps1 pre-build step
+packs every shader into one indexed blob (Shaders.pack), and also writes the same blob as a constexpr byte array that gets
+compiled straight into the executable when SHADER_PACK_EMBEDDED is defined. Looking up a shader then just returns a
+string_view into the blob, nothing is copied. Every source in the blob ends with a 0 byte, so view.data() can be handed to
+OpenGL as a C string. For development, useLooseFiles switches back to reading the .glsl files themselves so shader edits
+show up without rebuilding */
+
+// A single shader of the pack, both views point straight into the blob
+struct ShaderPackEntry
+{
+	string_view name;
+	string_view source;
+};
+
+class ShaderPack
+{
+public:
+	/* Returns the source of a packed shader file, or an empty view if the pack doesn't have it (or useLooseFiles is set).
+	The pack is loaded the first time this is called */
+	static string_view Find(const string& filePath);
+
+	// Returns true if the pack was loaded and has at least one shader
+	static bool IsAvailable();
+
+	// Reads the shaders from the loose .glsl files instead of the pack, on by default in debug builds
+	static bool useLooseFiles;
+
+	// File the pack is read from when it isn't compiled into the executable
+	static string packFilePath;
+
+private:
+	ShaderPack() { }
+
+	// Loads the embedded blob, or reads the pack file into memory
+	static void Load();
+
+	// Builds the index from a blob, returns false if the blob is damaged
+	static bool Parse(const unsigned char* data, size_t size);
+
+	// Loads the pack only once, even if several worker threads ask for shaders at the same time
+	static once_flag loadFlag;
+
+	// Holds the blob read from the pack file (stays empty for the embedded blob)
+	static vector<unsigned char> packData;
+
+	// Sorted by name, so lookups are a binary search
+	static vector<ShaderPackEntry> entries;
+};
+
+#endif
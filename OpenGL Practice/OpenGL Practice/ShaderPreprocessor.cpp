@@ -0,0 +1,143 @@
+#include "ShaderPreprocessor.h"
+#include "ShaderPack.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+
+string ShaderPreprocessor::Process(const string& filePath, const string& defines)
+{
+	string source = ResolveIncludes(ReadFile(filePath), filePath);
+
+	if (defines.empty())
+		return source;
+
+	return InjectDefines(source, defines);
+}
+
+string ShaderPreprocessor::ResolveIncludes(const string& source, const string& filePath)
+{
+	// Most shaders don't include anything, those are returned exactly as they are
+	if (source.find("#include") == string::npos)
+		return source;
+
+	set<string> includedFiles;
+	vector<string> sourceFiles;
+
+	includedFiles.insert(filePath);
+	sourceFiles.push_back(filePath);
+
+	return ResolveIncludes(source, filePath, 0, 0, includedFiles, sourceFiles);
+}
+
+string ShaderPreprocessor::ResolveIncludes(const string& source, const string& filePath, int sourceNumber, int depth,
+	set<string>& includedFiles, vector<string>& sourceFiles)
+{
+	istringstream sourceStream(source);
+	string output;
+	string line;
+
+	int lineNumber = 0;
+
+	while (getline(sourceStream, line))
+	{
+		lineNumber++;
+
+		size_t start = line.find_first_not_of(" \t");
+
+		if (start == string::npos || line.compare(start, 8, "#include") != 0)
+		{
+			output += line + "\n";
+			continue;
+		}
+
+		// Accept both #include "file" and #include <file>, the file is always looked up next to the including file
+		size_t nameStart = line.find_first_of("\"<", start + 8);
+		size_t nameEnd = nameStart != string::npos ? line.find_first_of("\">", nameStart + 1) : string::npos;
+
+		if (nameEnd == string::npos)
+		{
+			cout << "ERROR::SHADER::PREPROCESSOR: Malformed #include in " << filePath << " line " << lineNumber << endl;
+			output += "\n";
+			continue;
+		}
+
+		string includeName = line.substr(nameStart + 1, nameEnd - nameStart - 1);
+		string includePath = (filesystem::path(filePath).parent_path() / includeName).generic_string();
+
+		if (depth + 1 > MAX_INCLUDE_DEPTH)
+		{
+			cout << "ERROR::SHADER::PREPROCESSOR: #include nested too deeply in " << filePath << " line " << lineNumber
+				<< endl;
+			output += "\n";
+			continue;
+		}
+
+		// A file that was already included is skipped, the empty line keeps the line numbers of this file intact
+		if (!includedFiles.insert(includePath).second)
+		{
+			output += "\n";
+			continue;
+		}
+
+		int includeNumber = static_cast<int>(sourceFiles.size());
+		sourceFiles.push_back(includePath);
+
+		output += "#line 1 " + to_string(includeNumber) + "\n";
+		output += ResolveIncludes(ReadFile(includePath), includePath, includeNumber, depth + 1, includedFiles, sourceFiles);
+		output += "#line " + to_string(lineNumber + 1) + " " + to_string(sourceNumber) + "\n";
+	}
+
+	return output;
+}
+
+string ShaderPreprocessor::InjectDefines(const string& source, const string& defines)
+{
+	size_t versionPosition = source.find("#version");
+
+	// Without a #version line the defines can simply go first
+	if (versionPosition == string::npos)
+		return defines + source;
+
+	size_t lineEnd = source.find('\n', versionPosition);
+
+	if (lineEnd == string::npos)
+		return source + "\n" + defines;
+
+	return source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1);
+}
+
+string ShaderPreprocessor::MakeDefines(const vector<string>& names)
+{
+	string defines;
+
+	for (unsigned int i = 0; i < names.size(); i++)
+	{
+		defines += "#define " + names[i] + "\n";
+	}
+
+	return defines;
+}
+
+string ShaderPreprocessor::ReadFile(const string& filePath)
+{
+	// Prefer the shader pack, files that aren't packed (or loose file mode) are read from disk
+	string_view packedSource = ShaderPack::Find(filePath);
+
+	if (!packedSource.empty())
+		return string(packedSource);
+
+	ifstream shaderFile(filePath);
+
+	if (!shaderFile.is_open())
+	{
+		cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << filePath << endl;
+		return string();
+	}
+
+	stringstream shaderStream;
+	shaderStream << shaderFile.rdbuf();
+
+	return shaderStream.str();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <string>
+#include <vector>
+#include <set>
+
+using namespace std;
+
+/* GLSL has no #include of its own, so a lot of the shaders used to copy the same functions around (all the PBR shaders
+carry their own DistributionGGX, GeometrySmith etc.). Every shader file now goes through this preprocessor before it's
+compiled: #include "file.glsl" lines are replaced by the contents of that file (every file is only included once, so
+include cycles can't happen), and a set of #defines can be injected right after the #version line to build specialized
+variants of the same shader. The preprocessor doesn't keep any state, so it can run on the shader loading worker threads */
+
+class ShaderPreprocessor
+{
+public:
+	// Reads a shader file, resolves all of its #includes and injects the #defines (e.g. "#define SHADOWS\n")
+	static string Process(const string& filePath, const string& defines = "");
+
+	// Replaces every #include "file" line of the source code with the processed contents of that file
+	static string ResolveIncludes(const string& source, const string& filePath);
+
+	// Inserts the #defines right after the #version line of the source code (GLSL requires #version to come first)
+	static string InjectDefines(const string& source, const string& defines);
+
+	// Turns a list of names into "#define NAME\n" lines
+	static string MakeDefines(const vector<string>& names);
+
+	/* Reads a whole file into a string (from the shader pack if it's available), prints an error and returns an empty
+	string if it can't be read */
+	static string ReadFile(const string& filePath);
+
+private:
+	ShaderPreprocessor() { }
+
+	// Includes nested deeper than this are treated as an error
+	static const int MAX_INCLUDE_DEPTH = 16;
+
+	/* includedFiles remembers which files were already pasted in, and every file gets its own source string number
+	so the #line directives point compile errors at the right file and line */
+	static string ResolveIncludes(const string& source, const string& filePath, int sourceNumber, int depth,
+		set<string>& includedFiles, vector<string>& sourceFiles);
+};
+
+#endif
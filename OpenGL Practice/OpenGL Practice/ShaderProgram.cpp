@@ -1,5 +1,6 @@
 #include "ShaderProgram.h"
 #include "Window.h"
+#include "ProgramBinaryCache.h"
 
 //unsigned int ShaderProgram::shaderProgram = NULL;
 
@@ -45,6 +46,8 @@ ShaderProgram::ShaderProgram()
 		glm::vec3(0.0f, 0.0f, 0.0f)};
 
 	shaderProgram = NULL;
+
+	uniforms = make_shared<UniformTable>();
 }
 
 ShaderProgram::~ShaderProgram()
@@ -55,6 +58,30 @@ ShaderProgram::~ShaderProgram()
 void ShaderProgram::InitializeShaderProgram(VertexShaderLoader* vertexShader_, FragmentShaderLoader* fragmentShader_,
 	GeometryShader* geometryShader_)
 {
+	double startTime = glfwGetTime();
+
+	// The same sources linked with different varyings are a different program, so the varyings are part of the key
+	string varyingNames;
+
+	for (unsigned int i = 0; i < transformFeedbackVaryings.size(); i++)
+	{
+		varyingNames += transformFeedbackVaryings[i] + '\n';
+	}
+
+	// Try the program binary cache first, if the exact same sources were linked before we don't need to compile anything
+	unsigned long long cacheKey = ProgramBinaryCache::ComputeKey(vertexShader_->GetVertexShaderCode(),
+		fragmentShader_->GetFragmentShaderCode(), geometryShader_ != nullptr ? geometryShader_->GetGeometryShaderCode() : nullptr,
+		varyingNames.empty() ? nullptr : varyingNames.c_str());
+
+	shaderProgram = ProgramBinaryCache::LoadProgram(cacheKey);
+
+	if (shaderProgram != 0)
+	{
+		uniforms->Reflect(shaderProgram);
+		FrameUniforms::BindProgram(shaderProgram);
+		return;
+	}
+
 	// Create a shader program that will render both the vertex and fragment shaders to the window
 	shaderProgram = glCreateProgram();
 
@@ -75,7 +102,22 @@ void ShaderProgram::InitializeShaderProgram(VertexShaderLoader* vertexShader_, F
 		glAttachShader(shaderProgram, geometryShader_->geometryShader);
 	}
 
+	if (!transformFeedbackVaryings.empty())
+	{
+		// ShaderProgram has a member called vector, so the type needs its namespace here
+		std::vector<const char*> varyings;
+
+		for (unsigned int i = 0; i < transformFeedbackVaryings.size(); i++)
+		{
+			varyings.push_back(transformFeedbackVaryings[i].c_str());
+		}
+
+		glTransformFeedbackVaryings(shaderProgram, static_cast<GLsizei>(varyings.size()), varyings.data(),
+			GL_INTERLEAVED_ATTRIBS);
+	}
+
 	// Link the attached vertex and fragment shaders together into one shader program
+	ProgramBinaryCache::PrepareProgram(shaderProgram);
 	glLinkProgram(shaderProgram);
 
 	int successfullyCompiled; // An integer that checks if the shader program compilation was successful
@@ -92,6 +134,15 @@ void ShaderProgram::InitializeShaderProgram(VertexShaderLoader* vertexShader_, F
 	// Delete the shaders as they're linked into our program now and no longer necessary
 	DeleteShaders(vertexShader_, fragmentShader_, geometryShader_);
 
+	// Look up every uniform location once, so setting uniforms later never has to ask the driver
+	uniforms->Reflect(shaderProgram);
+
+	// Point the program's FrameUniforms block (if it has one) to the per-frame camera buffer
+	FrameUniforms::BindProgram(shaderProgram);
+
+	// Store the linked program so the next launch can skip compiling it
+	ProgramBinaryCache::SaveProgram(cacheKey, shaderProgram, glfwGetTime() - startTime);
+
 	/*timer = glfwGetTime(); // Gets the time in seconds using the GLFW library
 	moveRight = ((timer) / 5.0f) + 0.1f;
 
@@ -151,6 +202,20 @@ void ShaderProgram::Compile(const char* vertexSource, const char* fragmentSource
 {
 	unsigned int sVertex, sFragment, gShader;
 
+	double startTime = glfwGetTime();
+
+	// Try the program binary cache first, if the exact same sources were linked before we don't need to compile anything
+	unsigned long long cacheKey = ProgramBinaryCache::ComputeKey(vertexSource, fragmentSource, geometrySource);
+
+	shaderProgram = ProgramBinaryCache::LoadProgram(cacheKey);
+
+	if (shaderProgram != 0)
+	{
+		uniforms->Reflect(shaderProgram);
+		FrameUniforms::BindProgram(shaderProgram);
+		return;
+	}
+
 	// vertex Shader
 	sVertex = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(sVertex, 1, &vertexSource, NULL);
@@ -179,6 +244,9 @@ void ShaderProgram::Compile(const char* vertexSource, const char* fragmentSource
 
 	if (geometrySource != nullptr)
 		glAttachShader(shaderProgram, gShader);
+
+	// Ask for a retrievable binary before linking so it can be stored in the program binary cache
+	ProgramBinaryCache::PrepareProgram(shaderProgram);
 	glLinkProgram(shaderProgram);
 	CheckCompileErrors(shaderProgram, "PROGRAM");
 
@@ -187,6 +255,78 @@ void ShaderProgram::Compile(const char* vertexSource, const char* fragmentSource
 	glDeleteShader(sFragment);
 	if (geometrySource != nullptr)
 		glDeleteShader(gShader);
+
+	// Look up every uniform location once, so setting uniforms later never has to ask the driver
+	uniforms->Reflect(shaderProgram);
+
+	// Point the program's FrameUniforms block (if it has one) to the per-frame camera buffer
+	FrameUniforms::BindProgram(shaderProgram);
+
+	// Store the linked program so the next launch can skip compiling it
+	ProgramBinaryCache::SaveProgram(cacheKey, shaderProgram, glfwGetTime() - startTime);
+}
+
+bool ShaderProgram::IsReady() const
+{
+	if (compileJob == nullptr)
+		return true;
+
+	return ShaderCompileQueue::IsComplete(*compileJob);
+}
+
+void ShaderProgram::WaitUntilReady()
+{
+	if (compileJob != nullptr && !compileJob->finished)
+	{
+		ShaderCompileQueue::Finish(*compileJob);
+	}
+
+	// The uniforms can only be read once the program is linked, copies of this program share the same table
+	if (!uniforms->reflected && shaderProgram != 0)
+		uniforms->Reflect(shaderProgram);
+}
+
+int ShaderProgram::GetUniformLocation(unsigned int nameHash)
+{
+	if (!uniforms->reflected)
+		WaitUntilReady();
+
+	return uniforms->GetLocation(nameHash);
+}
+
+void ShaderProgram::SetInt(unsigned int nameHash, int value)
+{
+	glUniform1i(GetUniformLocation(nameHash), value);
+}
+
+void ShaderProgram::SetFloat(unsigned int nameHash, float value)
+{
+	glUniform1f(GetUniformLocation(nameHash), value);
+}
+
+void ShaderProgram::SetVec2(unsigned int nameHash, const glm::vec2& value)
+{
+	glUniform2fv(GetUniformLocation(nameHash), 1, glm::value_ptr(value));
+}
+
+void ShaderProgram::SetVec3(unsigned int nameHash, const glm::vec3& value)
+{
+	glUniform3fv(GetUniformLocation(nameHash), 1, glm::value_ptr(value));
+}
+
+void ShaderProgram::SetVec4(unsigned int nameHash, const glm::vec4& value)
+{
+	glUniform4fv(GetUniformLocation(nameHash), 1, glm::value_ptr(value));
+}
+
+void ShaderProgram::SetMat3(unsigned int nameHash, const glm::mat3& value)
+{
+	glUniformMatrix3fv(GetUniformLocation(nameHash), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void ShaderProgram::SetMat4(unsigned int nameHash, const glm::mat4& value)
+{
+	glUniformMatrix4fv(GetUniformLocation(nameHash), 1, GL_FALSE, glm::value_ptr(value));
 }
 
 void ShaderProgram::CheckCompileErrors(unsigned int object, string type)
@@ -330,13 +470,14 @@ void ShaderProgram::InitializeCubeDepthTesting(float aspect_ratio, float near_pl
 void ShaderProgram::DeleteShaders(VertexShaderLoader* vertexShader_, FragmentShaderLoader* fragmentShader_,
 	GeometryShader* geometryShader_)
 {
-	// Delete the vertex and fragment shaders after the shader objects have been linked with the shader program
-	glDeleteShader(vertexShader_->vertexShader);
-	glDeleteShader(fragmentShader_->fragmentShader);
+	/* The shader objects are shared with every other program that uses the same files, so instead of deleting them we
+	just tell the shader stage cache that this program is done with them */
+	ShaderStageCache::ReleaseShader(vertexShader_->vertexShader);
+	ShaderStageCache::ReleaseShader(fragmentShader_->fragmentShader);
 
 	if (geometryShader_ != nullptr)
 	{
-		glDeleteShader(geometryShader_->geometryShader);
+		ShaderStageCache::ReleaseShader(geometryShader_->geometryShader);
 	}
 }
 
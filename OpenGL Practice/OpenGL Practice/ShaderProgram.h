@@ -9,6 +9,10 @@
 #include "Color.h"
 #include "Lighting.h"
 #include "FrameBuffer.h"
+#include "ShaderCompileQueue.h"
+#include "UniformTable.h"
+#include "GLStateCache.h"
+#include "FrameUniforms.h"
 
 // Include the GLM header files (OpenGL Mathematics Library)
 #include <glm.hpp>
@@ -42,10 +46,39 @@ public:
 	void DeleteShaders(VertexShaderLoader* vertexShader_, FragmentShaderLoader* fragmentShader_, 
 		GeometryShader* geometryShader_);
 
+	// Returns true once an asynchronously loaded program has finished linking (never blocks)
+	bool IsReady() const;
+
+	// Blocks until an asynchronously loaded program has finished linking, does nothing for programs compiled right away
+	void WaitUntilReady();
+
+	/* Typed uniform setters keyed by the hash of the uniform's name. The program has to be in use (glUseProgram) just
+	like with glUniform*, and the name should be hashed at compile time, e.g.
+	constexpr unsigned int MODEL_MATRIX = UniformHash("modelMatrix"); */
+	int GetUniformLocation(unsigned int nameHash);
+
+	void SetInt(unsigned int nameHash, int value);
+	void SetFloat(unsigned int nameHash, float value);
+	void SetVec2(unsigned int nameHash, const glm::vec2& value);
+	void SetVec3(unsigned int nameHash, const glm::vec3& value);
+	void SetVec4(unsigned int nameHash, const glm::vec4& value);
+	void SetMat3(unsigned int nameHash, const glm::mat3& value);
+	void SetMat4(unsigned int nameHash, const glm::mat4& value);
+
 	float visibilityTextureValue;
 
 	unsigned int shaderProgram;
 
+	// Set when the program was loaded with ResourceManager::LoadShaderAsync, shared between all copies of this program
+	shared_ptr<ShaderCompileJob> compileJob;
+
+	// Every active uniform's location, read once after linking and shared between all copies of this program
+	shared_ptr<UniformTable> uniforms;
+
+	/* Outputs of the last vertex processing stage that transform feedback writes to a buffer (interleaved, in this
+	order). They're part of linking, so they have to be set before InitializeShaderProgram */
+	vector<string> transformFeedbackVaryings;
+
 private:
 	Color* color;
 	Lighting* lighting;
@@ -0,0 +1,132 @@
+#include "ShaderStageCache.h"
+#include "ShaderPack.h"
+
+#include <iostream>
+
+// Instantiate static variables
+unordered_map<string, string_view> ShaderStageCache::sources;
+unordered_map<string, string> ShaderStageCache::processedSources;
+unordered_map<string, ShaderStage> ShaderStageCache::stages;
+unordered_map<unsigned int, string> ShaderStageCache::stageKeys;
+
+string_view ShaderStageCache::GetSource(const string& filePath)
+{
+	unordered_map<string, string_view>::iterator cachedSource = sources.find(filePath);
+
+	if (cachedSource != sources.end())
+		return cachedSource->second;
+
+	// A packed shader that doesn't include anything can be used exactly as it is in the pack
+	string_view packedSource = ShaderPack::Find(filePath);
+
+	if (!packedSource.empty() && packedSource.find("#include") == string_view::npos)
+		return sources.emplace(filePath, packedSource).first->second;
+
+	// unordered_map never moves its elements, so the view (and its data()) stays valid
+	const string& sourceCode = processedSources.emplace(filePath, ShaderPreprocessor::Process(filePath)).first->second;
+
+	return sources.emplace(filePath, string_view(sourceCode)).first->second;
+}
+
+unsigned int ShaderStageCache::AcquireShader(GLenum type, const string& filePath, const string& defines)
+{
+	string key = filePath + "|" + defines;
+
+	unordered_map<string, ShaderStage>::iterator cachedStage = stages.find(key);
+
+	if (cachedStage != stages.end())
+	{
+		cachedStage->second.referenceCount++;
+		return cachedStage->second.shader;
+	}
+
+	string_view source = GetSource(filePath);
+
+	ShaderStage stage;
+	stage.type = type;
+	stage.referenceCount = 1;
+
+	if (defines.empty())
+		stage.shader = CompileShader(type, source, filePath);
+
+	else
+		stage.shader = CompileShader(type, ShaderPreprocessor::InjectDefines(string(source), defines), filePath);
+
+	stages[key] = stage;
+	stageKeys[stage.shader] = key;
+
+	return stage.shader;
+}
+
+void ShaderStageCache::ReleaseShader(unsigned int shader)
+{
+	unordered_map<unsigned int, string>::iterator stageKey = stageKeys.find(shader);
+
+	if (stageKey == stageKeys.end())
+		return;
+
+	ShaderStage& stage = stages[stageKey->second];
+
+	if (stage.referenceCount > 0)
+		stage.referenceCount--;
+}
+
+void ShaderStageCache::PurgeUnusedShaders()
+{
+	unordered_map<string, ShaderStage>::iterator stage = stages.begin();
+
+	while (stage != stages.end())
+	{
+		if (stage->second.referenceCount == 0)
+		{
+			glDeleteShader(stage->second.shader);
+			stageKeys.erase(stage->second.shader);
+			stage = stages.erase(stage);
+		}
+
+		else
+		{
+			stage++;
+		}
+	}
+}
+
+void ShaderStageCache::Clear()
+{
+	for (pair<const string, ShaderStage>& stage : stages)
+	{
+		glDeleteShader(stage.second.shader);
+	}
+
+	stages.clear();
+	stageKeys.clear();
+	sources.clear();
+	processedSources.clear();
+}
+
+unsigned int ShaderStageCache::CompileShader(GLenum type, string_view source, const string& filePath)
+{
+	const char* shaderCode = source.data();
+	int shaderLength = static_cast<int>(source.size());
+
+	unsigned int shader = glCreateShader(type);
+	glShaderSource(shader, 1, &shaderCode, &shaderLength);
+	glCompileShader(shader);
+
+	int successfullyCompiled; // An integer that checks if the shader compilation was successful
+	char compilationInformationLog[512];
+
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &successfullyCompiled);
+
+	// If the compilation failed, then return a log compilation error and explain the error
+	if (!successfullyCompiled)
+	{
+		string typeName = type == GL_VERTEX_SHADER ? "VERTEX" : type == GL_FRAGMENT_SHADER ? "FRAGMENT" : "GEOMETRY";
+
+		glGetShaderInfoLog(shader, 512, NULL, compilationInformationLog);
+		cout << "ERROR::SHADER::" << typeName << "::COMPILATION_FAILED (" << filePath << ")\n"
+			<< compilationInformationLog << endl;
+	}
+
+	return shader;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#ifndef SHADER_STAGE_CACHE_H
+#define SHADER_STAGE_CACHE_H
+
+#include <glad/glad.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "ShaderPreprocessor.h"
+
+using namespace std;
+
+/* Many programs share the exact same shader stage (all the SSAO passes use ssaoVertexShader.glsl for example), and
+Main.cpp and the Window class even create the same set of shader loaders twice. Since a compiled shader object can be
+attached to as many programs as we want, every unique stage (file path + injected #defines) is read from disk and
+compiled exactly once and then handed out to every program that needs it */
+
+// A single compiled shader stage shared by every program that uses it
+struct ShaderStage
+{
+	unsigned int shader;
+	GLenum type;
+
+	// Number of programs that currently use this stage
+	unsigned int referenceCount;
+};
+
+class ShaderStageCache
+{
+public:
+	/* Returns the source code of a shader file with its #includes resolved, the file is only read the first time. The
+	view always ends in a 0 byte, so data() can be used as a C string. Packed shaders without #includes point straight into
+	the shader pack, so they're never copied */
+	static string_view GetSource(const string& filePath);
+
+	/* Returns the compiled shader object for a file and a set of #defines (e.g. "#define SHADOWS\n"), compiling it only
+	the first time it's asked for. Every call adds a reference that has to be released with ReleaseShader */
+	static unsigned int AcquireShader(GLenum type, const string& filePath, const string& defines = "");
+
+	// Removes one reference from a shader, the shader object stays alive so later programs can still reuse it
+	static void ReleaseShader(unsigned int shader);
+
+	// Deletes every shader object that isn't used by any program anymore
+	static void PurgeUnusedShaders();
+
+	// Deletes every shader object and forgets all the cached sources
+	static void Clear();
+
+private:
+	ShaderStageCache() { }
+
+	static unsigned int CompileShader(GLenum type, string_view source, const string& filePath);
+
+	// Shader sources keyed by file path
+	static unordered_map<string, string_view> sources;
+
+	// Sources that had to be read from disk or had #includes resolved, the views in sources point into these
+	static unordered_map<string, string> processedSources;
+
+	// Compiled stages keyed by file path + defines
+	static unordered_map<string, ShaderStage> stages;
+
+	// Looks up the key of a stage from its shader object ID
+	static unordered_map<unsigned int, string> stageKeys;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include "ShaderVariantSet.h"
+#include "ResourceManager.h"
+
+ShaderVariantSet::ShaderVariantSet()
+{
+
+}
+
+ShaderVariantSet::ShaderVariantSet(const string& vertexPath_, const string& fragmentPath_, const vector<string>& features_,
+	const string& name_) : vertexPath(vertexPath_), fragmentPath(fragmentPath_), name(name_), features(features_)
+{
+
+}
+
+void ShaderVariantSet::LoadAllVariants()
+{
+	for (unsigned int featureMask = 0; featureMask < GetVariantCount(); featureMask++)
+	{
+		if (variants.find(featureMask) != variants.end())
+			continue;
+
+		variants[featureMask] = ResourceManager::LoadShaderAsync(vertexPath.c_str(), fragmentPath.c_str(), nullptr,
+			GetVariantName(featureMask), GetDefines(featureMask));
+	}
+}
+
+ShaderProgram& ShaderVariantSet::GetVariant(unsigned int featureMask)
+{
+	// Ignore bits that don't belong to any feature
+	featureMask &= GetVariantCount() - 1;
+
+	map<unsigned int, ShaderProgram>::iterator variant = variants.find(featureMask);
+
+	if (variant != variants.end())
+		return variant->second;
+
+	// Not loaded up front, so it has to be compiled now
+	variants[featureMask] = ResourceManager::LoadShader(vertexPath.c_str(), fragmentPath.c_str(), nullptr,
+		GetVariantName(featureMask), GetDefines(featureMask));
+
+	return variants[featureMask];
+}
+
+string ShaderVariantSet::GetDefines(unsigned int featureMask) const
+{
+	vector<string> enabledFeatures;
+
+	for (unsigned int i = 0; i < features.size(); i++)
+	{
+		if (featureMask & (1u << i))
+			enabledFeatures.push_back(features[i]);
+	}
+
+	return ShaderPreprocessor::MakeDefines(enabledFeatures);
+}
+
+unsigned int ShaderVariantSet::GetVariantCount() const
+{
+	return 1u << features.size();
+}
+
+string ShaderVariantSet::GetVariantName(unsigned int featureMask) const
+{
+	string variantName = name + "[";
+
+	for (unsigned int i = 0; i < features.size(); i++)
+	{
+		if (!(featureMask & (1u << i)))
+			continue;
+
+		if (variantName.back() != '[')
+			variantName += "|";
+
+		variantName += features[i];
+	}
+
+	return variantName + "]";
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#ifndef SHADER_VARIANT_SET_H
+#define SHADER_VARIANT_SET_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "ShaderProgram.h"
+
+using namespace std;
+
+/* Instead of one shader that checks a bunch of bool uniforms for every single pixel, a variant set compiles a separate
+program for every combination of its features, with "#define FEATURE" injected for each feature that's turned on. The
+shader then uses #ifdef FEATURE so every variant only contains the code it actually needs, and at draw time we simply
+pick the program that matches the features we want. Feature i of the list is bit i of the feature mask */
+
+class ShaderVariantSet
+{
+public:
+	ShaderVariantSet();
+	ShaderVariantSet(const string& vertexPath_, const string& fragmentPath_, const vector<string>& features_, const string& name_);
+
+	// Queues every feature combination with ResourceManager::LoadShaderAsync so they all compile in parallel
+	void LoadAllVariants();
+
+	// Returns the program with exactly the features in featureMask compiled in, it's compiled right away if it wasn't loaded yet
+	ShaderProgram& GetVariant(unsigned int featureMask);
+
+	// Builds the #define lines of a feature mask
+	string GetDefines(unsigned int featureMask) const;
+
+	unsigned int GetVariantCount() const;
+
+private:
+	// Name of a variant in the resource manager, e.g. "postprocessing[CHAOS|SHAKE]"
+	string GetVariantName(unsigned int featureMask) const;
+
+	string vertexPath, fragmentPath;
+	string name;
+
+	vector<string> features;
+
+	map<unsigned int, ShaderProgram> variants;
+};
+
+#endif
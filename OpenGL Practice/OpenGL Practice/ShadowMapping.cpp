@@ -1,5 +1,6 @@
 #include "ShadowMapping.h"
 #include "Camera.h"
+#include "TextureCache.h"
 
 /* Shadows are a result of the absence of light due to occlusion. When a light sources light rays do not hit an object 
 because it gets occluded (blocked) by some other object, the object is in shadow */
@@ -28,8 +29,8 @@ ShadowMapping::ShadowMapping()
 
 ShadowMapping::~ShadowMapping()
 {
-	glDeleteVertexArrays(1, &planeVAO);
-	glDeleteBuffers(1, &planeVBO);
+	GLStateCache::DeleteVertexArrays(1, &planeVAO);
+	GLStateCache::DeleteBuffers(1, &planeVBO);
 }
 
 ShadowMapping* ShadowMapping::Instance()
@@ -45,7 +46,7 @@ ShadowMapping* ShadowMapping::Instance()
 
 void ShadowMapping::InitializePlaneVertices()
 {
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::Enable(GL_DEPTH_TEST);
 
 	shadowMappingShaderProgram[0]->InitializeShaderProgram(new VertexShaderLoader("SimpleDepthVertexShader.glsl"),
 		new FragmentShaderLoader("SimpleDepthFragmentShader.glsl"));
@@ -72,8 +73,8 @@ void ShadowMapping::InitializePlaneVertices()
 	glGenVertexArrays(1, &planeVAO);
 	glGenBuffers(1, &planeVBO);
 
-	glBindVertexArray(planeVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, planeVBO);
+	GLStateCache::BindVertexArray(planeVAO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, planeVBO);
 
 	glBufferData(GL_ARRAY_BUFFER, sizeof(planeVertices), &planeVertices, GL_STATIC_DRAW);
 
@@ -88,43 +89,14 @@ void ShadowMapping::InitializePlaneVertices()
 	glVertexAttribPointer(vertexAttributes.textureAttribute, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), 
 		(void*)(6 * sizeof(float)));
 
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(0);
 }
 
 void ShadowMapping::InitializeTexture(char const* path)
 {
-	glGenTextures(1, &woodTexture);
-
-	int width, height, nrComponents;
-	unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
-	if (data)
-	{
-		GLenum format;
-		if (nrComponents == 1)
-			format = GL_RED;
-		else if (nrComponents == 3)
-			format = GL_RGB;
-		else if (nrComponents == 4)
-			format = GL_RGBA;
-
-		glBindTexture(GL_TEXTURE_2D, woodTexture);
-		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		// for this tutorial: use GL_CLAMP_TO_EDGE to prevent semi-transparent borders. Due to interpolation it takes 
-		// texels from next repeat 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		stbi_image_free(data);
-	}
-	else
-	{
-		std::cout << "Texture failed to load at path: " << path << std::endl;
-		stbi_image_free(data);
-	}
+	// The same wood texture as the point shadows, so it's only resident once
+	woodTexture = TextureCache::LoadTexture(path, TextureLoadOptions(false, false, 0, true, true,
+		TEXTURE_COMPRESSION_COLOR));
 }
 
 void ShadowMapping::InitializeFramebuffers()
@@ -136,7 +108,7 @@ void ShadowMapping::InitializeFramebuffers()
 	// Create 2D texture that will be used as framebuffer's depth buffer
 	// Because we only care about depth values we specify the textures formats as GL_DEPTH_COMPONENT
 	glGenTextures(1, &depthMap);
-	glBindTexture(GL_TEXTURE_2D, depthMap);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, depthMap);
 
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -153,7 +125,7 @@ void ShadowMapping::InitializeFramebuffers()
 
 	glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMap, 0);
 
 	/* A framebuffer object however is not complete without a color buffer so we need to explicitly tell OpenGL were not
@@ -161,15 +133,15 @@ void ShadowMapping::InitializeFramebuffers()
 	glReadbuffer */
 	glDrawBuffer(GL_NONE);
 	glReadBuffer(GL_NONE);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Use the shadow mapping shaders (Shadow Mapping Part 2)
-	glUseProgram(shadowMappingShaderProgram[2]->shaderProgram);
+	GLStateCache::UseProgram(shadowMappingShaderProgram[2]->shaderProgram);
 	glUniform1i(glGetUniformLocation(shadowMappingShaderProgram[2]->shaderProgram, "diffuseTexture"), 0);
 	glUniform1i(glGetUniformLocation(shadowMappingShaderProgram[2]->shaderProgram, "shadowMap"), 1);
 
 	// Use the quad depth shaders
-	glUseProgram(shadowMappingShaderProgram[1]->shaderProgram);
+	GLStateCache::UseProgram(shadowMappingShaderProgram[1]->shaderProgram);
 	glUniform1i(glGetUniformLocation(shadowMappingShaderProgram[1]->shaderProgram, "depthMap"), 0);
 
 	// lighting info
@@ -209,18 +181,18 @@ void ShadowMapping::UseShaderProgram()
 	space as visible from the light source; exactly what we need to render the depth map. */
 	glm::mat4 lightSpaceMatrix = lightProjection * lightView;
 
-	glUseProgram(shadowMappingShaderProgram[0]->shaderProgram);
+	GLStateCache::UseProgram(shadowMappingShaderProgram[0]->shaderProgram);
 
 	glUniformMatrix4fv(glGetUniformLocation(shadowMappingShaderProgram[0]->shaderProgram, "lightSpaceMatrix"), 1,
 		GL_FALSE, glm::value_ptr(lightSpaceMatrix));
 
 	glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-	glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
 	glClear(GL_DEPTH_BUFFER_BIT);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, woodTexture);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, woodTexture);
 	RenderScene(shadowMappingShaderProgram[0]);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Reset viewport
 
@@ -233,31 +205,19 @@ void ShadowMapping::UseShaderProgram()
 	// 2. Render scene as normal with the generated depth/shadow mapping
 
 	// Shadow Mapping Part 2
-	glUseProgram(shadowMappingShaderProgram[2]->shaderProgram);
-
-	glm::mat4 projection = glm::perspective(glm::radians(Camera::fieldOfView), float(1280 / 960), 0.1f, 100.0f);
-	glm::mat4 view = glm::lookAt(Camera::cameraPosition, Camera::cameraPosition + Camera::cameraFront, Camera::cameraUp);
-
-	glUniformMatrix4fv(glGetUniformLocation(shadowMappingShaderProgram[2]->shaderProgram, "projection"), 1, 
-		GL_FALSE, value_ptr(projection));
-
-	glUniformMatrix4fv(glGetUniformLocation(shadowMappingShaderProgram[2]->shaderProgram, "view"), 1, GL_FALSE, 
-		value_ptr(view));
+	GLStateCache::UseProgram(shadowMappingShaderProgram[2]->shaderProgram);
 
 	// set light uniforms
-	glUniform3fv(glGetUniformLocation(shadowMappingShaderProgram[2]->shaderProgram, "viewPosition"), 1, 
-		value_ptr(Camera::cameraPosition));
-
 	glUniform3fv(glGetUniformLocation(shadowMappingShaderProgram[2]->shaderProgram, "lightPosition"), 1, 
 		value_ptr(lightPosition));
 
 	glUniformMatrix4fv(glGetUniformLocation(shadowMappingShaderProgram[2]->shaderProgram, "lightSpaceMatrix"), 1, 
 		GL_FALSE, value_ptr(lightSpaceMatrix));
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, woodTexture);
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, depthMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, woodTexture);
+	GLStateCache::ActiveTexture(GL_TEXTURE1);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, depthMap);
 
 	// Peter panning is when objects seem slightly detached from their shadows
 	// To fix peter panning we cull all front faces during the shadow map generation by enabling GL_CULL_FACE first
@@ -266,12 +226,12 @@ void ShadowMapping::UseShaderProgram()
 	glCullFace(GL_BACK); // Reset original culling face
 
 	// Render the depth map to quad for visual debugging
-	glUseProgram(shadowMappingShaderProgram[1]->shaderProgram);
+	GLStateCache::UseProgram(shadowMappingShaderProgram[1]->shaderProgram);
 	glUniform1f(glGetUniformLocation(shadowMappingShaderProgram[1]->shaderProgram, "nearPlane"), near_plane);
 	glUniform1f(glGetUniformLocation(shadowMappingShaderProgram[1]->shaderProgram, "farPlane"), far_plane);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, depthMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, depthMap);
 	//RenderQuad(); // Commented out for Shadow Mapping Part 2
 }
 
@@ -280,7 +240,7 @@ void ShadowMapping::RenderScene(ShaderProgram* shaderProgram_)
 	// floor
 	glm::mat4 model = glm::mat4(1.0f);
 	glUniformMatrix4fv(glGetUniformLocation(shaderProgram_->shaderProgram, "modelMatrix"), 1, GL_FALSE, value_ptr(model));
-	glBindVertexArray(planeVAO);
+	GLStateCache::BindVertexArray(planeVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 6);
 
 	// cubes
@@ -356,10 +316,10 @@ void ShadowMapping::RenderCube()
 	glGenVertexArrays(1, &cubeVAO);
 	glGenBuffers(1, &cubeVBO);
 
-	glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, cubeVBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
-	glBindVertexArray(cubeVAO);
+	GLStateCache::BindVertexArray(cubeVAO);
 	glEnableVertexAttribArray(vertexAttributes.positionAttribute);
 	glVertexAttribPointer(vertexAttributes.positionAttribute, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
 
@@ -371,12 +331,12 @@ void ShadowMapping::RenderCube()
 	glVertexAttribPointer(vertexAttributes.textureAttribute, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
 		(void*)(6 * sizeof(float)));
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+	GLStateCache::BindVertexArray(0);
 
-	glBindVertexArray(cubeVAO);
+	GLStateCache::BindVertexArray(cubeVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 36);
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(0);
 }
 
 void ShadowMapping::RenderQuad()
@@ -395,8 +355,8 @@ void ShadowMapping::RenderQuad()
 	glGenVertexArrays(1, &quadVAO);
 	glGenBuffers(1, &quadVBO);
 
-	glBindVertexArray(quadVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+	GLStateCache::BindVertexArray(quadVAO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, quadVBO);
 
 	glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
 
@@ -405,7 +365,7 @@ void ShadowMapping::RenderQuad()
 	glEnableVertexAttribArray(1);
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
 
-	glBindVertexArray(quadVAO);
+	GLStateCache::BindVertexArray(quadVAO);
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(0);
 }
@@ -14,7 +14,7 @@ uniform sampler2D diffuseTexture;
 uniform sampler2D shadowMap;
 
 uniform vec3 lightPosition;
-uniform vec3 viewPosition;
+#include "FrameUniforms.glsl"
 
 // Shadow Mapping Part 2
 float ShadowCalculation(vec4 fragPositionLightSpace_)
@@ -116,7 +116,7 @@ void main()
 	vec3 diffuse = diff * lightColor;
 
 	// specular
-	vec3 viewDir = normalize(viewPosition - fs_in.fragPosition);
+	vec3 viewDir = normalize(frame.cameraPosition.xyz - fs_in.fragPosition);
 	float spec = 0.0;
 	vec3 halfwayDir = normalize(lightDir + viewDir);
 	spec = pow(max(dot(normal, halfwayDir), 0.0), 64.0);
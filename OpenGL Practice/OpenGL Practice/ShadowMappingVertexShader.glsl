@@ -14,8 +14,7 @@ out VS_OUT {
 	vec4 fragPositionLightSpace;
 } vs_out;
 
-uniform mat4 projection;
-uniform mat4 view;
+#include "FrameUniforms.glsl"
 uniform mat4 modelMatrix;
 uniform mat4 lightSpaceMatrix;
 void main()
@@ -25,5 +24,5 @@ void main()
     vs_out.texCoords = texCoordinates;
     vs_out.fragPositionLightSpace = lightSpaceMatrix * vec4(vs_out.fragPosition, 1.0);
 
-    gl_Position = projection * view * modelMatrix * vec4(position, 1.0);
+    gl_Position = frame.viewProjection * modelMatrix * vec4(position, 1.0);
 }
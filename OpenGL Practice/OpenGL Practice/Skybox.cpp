@@ -35,8 +35,8 @@ Skybox::Skybox()
 
 Skybox::~Skybox()
 {
-	glDeleteVertexArrays(1, &skyboxVAO);
-	glDeleteBuffers(1, &skyboxVBO);
+	GLStateCache::DeleteVertexArrays(1, &skyboxVAO);
+	GLStateCache::DeleteBuffers(1, &skyboxVBO);
 
 	skyboxTexture = NULL;
 	skyboxData = NULL;
@@ -102,8 +102,8 @@ void Skybox::SetSkyboxObject()
 	glGenVertexArrays(1, &skyboxVAO);
 	glGenBuffers(1, &skyboxVBO);
 
-	glBindVertexArray(skyboxVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, skyboxVBO);
+	GLStateCache::BindVertexArray(skyboxVAO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, skyboxVBO);
 
 	glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
 
@@ -125,7 +125,7 @@ void Skybox::SetSkyboxTexture()
 {
 	// Generate the texture in OpenGL first before binding it
 	glGenTextures(1, &skyboxTexture);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture); // Bind to a cube map texture
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture); // Bind to a cube map texture
 
 	for (unsigned int i = 0; i < skyboxTextures.size(); i++)
 	{
@@ -179,13 +179,13 @@ void Skybox::UseShaderProgramForSkybox(float aspect_ratio, float near_plane, flo
 		glm::value_ptr(viewMatrix));*/
 
 	// Bind the vertex array object using its ID
-	glBindVertexArray(skyboxVAO);
+	GLStateCache::BindVertexArray(skyboxVAO);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture);
 
 	glDrawArrays(GL_TRIANGLES, 0, 36);
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(0);
 }
 
 void Skybox::SetCubeObject()
@@ -243,10 +243,10 @@ void Skybox::SetCubeObject()
 	glGenBuffers(1, &cubeVBO);
 
 	// Bind the vertex array object using its ID
-	glBindVertexArray(cubeVAO);
+	GLStateCache::BindVertexArray(cubeVAO);
 
 	// This binds the buffers more than once at the same time as long as they're different buffer types
-	glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, cubeVBO);
 
 	// Copies the previously defined vertex data into the buffer's memory
 	glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), &cubeVertices, GL_STATIC_DRAW);
@@ -271,7 +271,7 @@ void Skybox::SetCubeTexture()
 	glGenTextures(1, &cubeTexture);
 
 	// Then, we need to bind the textures to configure the currently bound texture on subsequent texture commands
-	glBindTexture(GL_TEXTURE_2D, cubeTexture);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, cubeTexture);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -324,11 +324,11 @@ void Skybox::UseShaderProgramForCube(float aspect_ratio, float near_plane, float
 	glUniformMatrix4fv(glGetUniformLocation(ShaderProgram::shaderProgram, "modelMatrix"), 1,
 		GL_FALSE, glm::value_ptr(modelMatrix));*/
 
-	glBindVertexArray(cubeVAO);
+	GLStateCache::BindVertexArray(cubeVAO);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture);
 
 	glDrawArrays(GL_TRIANGLES, 0, 36);
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(0);
 }
@@ -1,5 +1,6 @@
 ﻿#include "SpecularIBL.h"
 #include "Camera.h"
+#include "TextureCache.h"
 
 SpecularIBL* SpecularIBL::specularIBLinstance = 0;
 
@@ -37,7 +38,7 @@ specific sample occurs over the total sample set */
 
 SpecularIBL::SpecularIBL() : specularIBLshaders{new ShaderProgram(), new ShaderProgram(), new ShaderProgram(),
 new ShaderProgram(), new ShaderProgram(), new ShaderProgram() }, cubeVAO(0), cubeVBO(0), sphereVAO(0), indexCount(0),
-quadVAO(0), quadVBO(0), projection(mat4(0.0f)), brdfLUTTexture(0), maxMipLevels(0), prefilterMap(0), irradianceMap(0),
+quadVAO(0), quadVBO(0), brdfLUTTexture(0), maxMipLevels(0), prefilterMap(0), irradianceMap(0),
 captureViews{ mat4(0.0f), mat4(0.0f),mat4(0.0f),mat4(0.0f),mat4(0.0f),mat4(0.0f) }, captureFBO(0), 
 captureProjection(mat4(0.0f)), captureRBO(0), data(0), envCubemap(0), hdrTexture(0), lightColors{ vec3(0.0f), vec3(0.0f),
 vec3(0.0f), vec3(0.0f) }, lightPositions{ vec3(0.0f), vec3(0.0f), vec3(0.0f), vec3(0.0f) }, nrColumns(0), nrRows(0), 
@@ -56,9 +57,9 @@ SpecularIBL::~SpecularIBL()
 		delete specularIBLshaders[i];
 	}
 
-	array<mat4, 2> mat4Variables =
+	array<mat4, 1> mat4Variables =
 	{
-		captureProjection, projection
+		captureProjection
 	};
 
 	for (unsigned int i = 0; i < mat4Variables.size(); i++)
@@ -113,15 +114,15 @@ SpecularIBL* SpecularIBL::Instance()
 
 void SpecularIBL::InitializeSpecularIBL()
 {
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::Enable(GL_DEPTH_TEST);
 
 	/* The xyww trick here that ensures the depth value of the rendered cube fragments always end up at 1.0, the maximum
 	depth value. We would need to change the depth comparison function to GL_LEQUAL */
-	glDepthFunc(GL_LEQUAL);
+	GLStateCache::DepthFunc(GL_LEQUAL);
 
 	// OpenGL gives us the option to properly filter across cubemap faces by enabling GL_TEXTURE_CUBE_MAP_SEAMLESS
 	// Enable seamless cubemap sampling for lower mip levels in the pre-filter map
-	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+	GLStateCache::Enable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
 	// PBR shader
 	specularIBLshaders[0]->InitializeShaderProgram(new VertexShaderLoader("PBRLightingVertexShader.glsl"), 
@@ -147,7 +148,7 @@ void SpecularIBL::InitializeSpecularIBL()
 	specularIBLshaders[5]->InitializeShaderProgram(new VertexShaderLoader("DiffuseIrradianceBackgroundVertexShader.glsl"),
 		new FragmentShaderLoader("DiffuseIrradianceBackgroundFragmentShader.glsl"));
 
-	glUseProgram(specularIBLshaders[0]->shaderProgram);
+	GLStateCache::UseProgram(specularIBLshaders[0]->shaderProgram);
 	glUniform1i(glGetUniformLocation(specularIBLshaders[0]->shaderProgram, "irradianceMap"), 0);
 	glUniform1i(glGetUniformLocation(specularIBLshaders[0]->shaderProgram, "prefilterMap"), 1);
 	glUniform1i(glGetUniformLocation(specularIBLshaders[0]->shaderProgram, "brdfLUT"), 2);
@@ -163,45 +164,45 @@ void SpecularIBL::InitializeSpecularIBL()
 	//glUniform3f(glGetUniformLocation(specularIBLshaders[0]->shaderProgram, "albedo"), 0.5f, 0.0f, 0.0f);
 	//glUniform1f(glGetUniformLocation(specularIBLshaders[0]->shaderProgram, "ambientOcclusion"), 1.0f);
 
-	glUseProgram(specularIBLshaders[5]->shaderProgram);
+	GLStateCache::UseProgram(specularIBLshaders[5]->shaderProgram);
 	glUniform1i(glGetUniformLocation(specularIBLshaders[5]->shaderProgram, "environmentMap"), 0);
 
 	// Load PBR material textures (Specular IBL Part 2 textures)
 	
 	// rusted iron
-	ironAlbedoMap = LoadTexture("Textures/PBR/rusted_iron/albedo.png");
-	ironNormalMap = LoadTexture("Textures/PBR/rusted_iron/normal.png");
-	ironMetallicMap = LoadTexture("Textures/PBR/rusted_iron/metallic.png");
-	ironRoughnessMap = LoadTexture("Textures/PBR/rusted_iron/roughness.png");
-	ironAOMap = LoadTexture("Textures/PBR/rusted_iron/ao.png");
+	ironAlbedoMap = LoadTexture("Textures/PBR/rusted_iron/albedo.png", TEXTURE_COMPRESSION_COLOR);
+	ironNormalMap = LoadTexture("Textures/PBR/rusted_iron/normal.png", TEXTURE_COMPRESSION_NORMAL);
+	ironMetallicMap = LoadTexture("Textures/PBR/rusted_iron/metallic.png", TEXTURE_COMPRESSION_MASK);
+	ironRoughnessMap = LoadTexture("Textures/PBR/rusted_iron/roughness.png", TEXTURE_COMPRESSION_MASK);
+	ironAOMap = LoadTexture("Textures/PBR/rusted_iron/ao.png", TEXTURE_COMPRESSION_MASK);
 
 	// gold
-	goldAlbedoMap = LoadTexture("Textures/PBR/gold/albedo.png");
-	goldNormalMap = LoadTexture("Textures/PBR/gold/normal.png");
-	goldMetallicMap = LoadTexture("Textures/PBR/gold/metallic.png");
-	goldRoughnessMap = LoadTexture("Textures/PBR/gold/roughness.png");
-	goldAOMap = LoadTexture("Textures/PBR/gold/ao.png");
+	goldAlbedoMap = LoadTexture("Textures/PBR/gold/albedo.png", TEXTURE_COMPRESSION_COLOR);
+	goldNormalMap = LoadTexture("Textures/PBR/gold/normal.png", TEXTURE_COMPRESSION_NORMAL);
+	goldMetallicMap = LoadTexture("Textures/PBR/gold/metallic.png", TEXTURE_COMPRESSION_MASK);
+	goldRoughnessMap = LoadTexture("Textures/PBR/gold/roughness.png", TEXTURE_COMPRESSION_MASK);
+	goldAOMap = LoadTexture("Textures/PBR/gold/ao.png", TEXTURE_COMPRESSION_MASK);
 
 	// grass
-	grassAlbedoMap = LoadTexture("Textures/PBR/grass/albedo.png");
-	grassNormalMap = LoadTexture("Textures/PBR/grass/normal.png");
-	grassMetallicMap = LoadTexture("Textures/PBR/grass/metallic.png");
-	grassRoughnessMap = LoadTexture("Textures/PBR/grass/roughness.png");
-	grassAOMap = LoadTexture("Textures/PBR/grass/ao.png");
+	grassAlbedoMap = LoadTexture("Textures/PBR/grass/albedo.png", TEXTURE_COMPRESSION_COLOR);
+	grassNormalMap = LoadTexture("Textures/PBR/grass/normal.png", TEXTURE_COMPRESSION_NORMAL);
+	grassMetallicMap = LoadTexture("Textures/PBR/grass/metallic.png", TEXTURE_COMPRESSION_MASK);
+	grassRoughnessMap = LoadTexture("Textures/PBR/grass/roughness.png", TEXTURE_COMPRESSION_MASK);
+	grassAOMap = LoadTexture("Textures/PBR/grass/ao.png", TEXTURE_COMPRESSION_MASK);
 
 	// plastic
-	plasticAlbedoMap = LoadTexture("Textures/PBR/plastic/albedo.png");
-	plasticNormalMap = LoadTexture("Textures/PBR/plastic/normal.png");
-	plasticMetallicMap = LoadTexture("Textures/PBR/plastic/metallic.png");
-	plasticRoughnessMap = LoadTexture("Textures/PBR/plastic/roughness.png");
-	plasticAOMap = LoadTexture("Textures/PBR/plastic/ao.png");
+	plasticAlbedoMap = LoadTexture("Textures/PBR/plastic/albedo.png", TEXTURE_COMPRESSION_COLOR);
+	plasticNormalMap = LoadTexture("Textures/PBR/plastic/normal.png", TEXTURE_COMPRESSION_NORMAL);
+	plasticMetallicMap = LoadTexture("Textures/PBR/plastic/metallic.png", TEXTURE_COMPRESSION_MASK);
+	plasticRoughnessMap = LoadTexture("Textures/PBR/plastic/roughness.png", TEXTURE_COMPRESSION_MASK);
+	plasticAOMap = LoadTexture("Textures/PBR/plastic/ao.png", TEXTURE_COMPRESSION_MASK);
 
 	// wall
-	wallAlbedoMap = LoadTexture("Textures/PBR/wall/albedo.png");
-	wallNormalMap = LoadTexture("Textures/PBR/wall/normal.png");
-	wallMetallicMap = LoadTexture("Textures/PBR/wall/metallic.png");
-	wallRoughnessMap = LoadTexture("Textures/PBR/wall/roughness.png");
-	wallAOMap = LoadTexture("Textures/PBR/wall/ao.png");
+	wallAlbedoMap = LoadTexture("Textures/PBR/wall/albedo.png", TEXTURE_COMPRESSION_COLOR);
+	wallNormalMap = LoadTexture("Textures/PBR/wall/normal.png", TEXTURE_COMPRESSION_NORMAL);
+	wallMetallicMap = LoadTexture("Textures/PBR/wall/metallic.png", TEXTURE_COMPRESSION_MASK);
+	wallRoughnessMap = LoadTexture("Textures/PBR/wall/roughness.png", TEXTURE_COMPRESSION_MASK);
+	wallAOMap = LoadTexture("Textures/PBR/wall/ao.png", TEXTURE_COMPRESSION_MASK);
 
 	lightPositions = 
 	{
@@ -227,13 +228,13 @@ void SpecularIBL::InitializeSpecularIBL()
 	glGenFramebuffers(1, &captureFBO);
 	glGenRenderbuffers(1, &captureRBO);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, captureFBO);
 	glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
 	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 512, 512);
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, captureRBO);
 
 	// Load the HDR environment map for PBR
-	stbi_set_flip_vertically_on_load(true);
+	stbi_set_flip_vertically_on_load_thread(true);
 
 	int width, height, nrComponents;
 	data = stbi_loadf("Textures/HDR/newport_loft.hdr", &width, &height, &nrComponents, 0);
@@ -241,7 +242,7 @@ void SpecularIBL::InitializeSpecularIBL()
 	if (data)
 	{
 		glGenTextures(1, &hdrTexture);
-		glBindTexture(GL_TEXTURE_2D, hdrTexture);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, hdrTexture);
 
 		// Specify the texture's data value to be float
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, data);
@@ -261,7 +262,7 @@ void SpecularIBL::InitializeSpecularIBL()
 
 	// Setup cubemap to render to and attach to framebuffer for PBR
 	glGenTextures(1, &envCubemap);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
 	for (unsigned int i = 0; i < 6; ++i)
 	{
@@ -292,18 +293,18 @@ void SpecularIBL::InitializeSpecularIBL()
 	};
 
 	// Convert HDR equirectangular environment map to cubemap equivalent for PBR
-	glUseProgram(specularIBLshaders[1]->shaderProgram);
+	GLStateCache::UseProgram(specularIBLshaders[1]->shaderProgram);
 	glUniform1i(glGetUniformLocation(specularIBLshaders[1]->shaderProgram, "equirectangularMap"), 0);
 
 	glUniformMatrix4fv(glGetUniformLocation(specularIBLshaders[1]->shaderProgram, "projection"), 1, GL_FALSE, 
 		value_ptr(captureProjection));
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, hdrTexture);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, hdrTexture);
 
 	// Configure the viewport to the capture dimensions
 	glViewport(0, 0, 512, 512);
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, captureFBO);
 
 	for (unsigned int i = 0; i < 6; ++i)
 	{
@@ -315,15 +316,15 @@ void SpecularIBL::InitializeSpecularIBL()
 
 		RenderCube();
 	}
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Then let OpenGL generate mipmaps from first mip face
-	glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 	glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
 
 	// Create an irradiance cubemap, and re-scale capture FBO to irradiance scale for PBR
 	glGenTextures(1, &irradianceMap);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
 
 	for (unsigned int i = 0; i < 6; ++i)
 	{
@@ -336,22 +337,22 @@ void SpecularIBL::InitializeSpecularIBL()
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, captureFBO);
 	glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
 	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 32, 32);
 
 	// Solve diffuse integral by convolution to create an irradiance cubemap for PBR
-	glUseProgram(specularIBLshaders[2]->shaderProgram);
+	GLStateCache::UseProgram(specularIBLshaders[2]->shaderProgram);
 	glUniform1i(glGetUniformLocation(specularIBLshaders[2]->shaderProgram, "environmentMap"), 0);
 
 	glUniformMatrix4fv(glGetUniformLocation(specularIBLshaders[2]->shaderProgram, "projection"), 1, GL_FALSE, 
 		value_ptr(captureProjection));
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
 	glViewport(0, 0, 32, 32); // Configure the viewport to the capture dimensions
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, captureFBO);
 
 	for (unsigned int i = 0; i < 6; ++i)
 	{
@@ -363,11 +364,11 @@ void SpecularIBL::InitializeSpecularIBL()
 
 		RenderCube();
 	}
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Create a pre-filter cubemap, and re-scale capture FBO to pre-filter scale for PBR
 	glGenTextures(1, &prefilterMap);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
 
 	for (unsigned int i = 0; i < 6; ++i)
 	{
@@ -386,16 +387,16 @@ void SpecularIBL::InitializeSpecularIBL()
 	glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
 
 	// Run a quasi monte-carlo simulation on the environment lighting to create a prefilter cubemap for PBR
-	glUseProgram(specularIBLshaders[3]->shaderProgram);
+	GLStateCache::UseProgram(specularIBLshaders[3]->shaderProgram);
 	glUniform1i(glGetUniformLocation(specularIBLshaders[3]->shaderProgram, "environmentMap"), 0);
 
 	glUniformMatrix4fv(glGetUniformLocation(specularIBLshaders[3]->shaderProgram, "projection"), 1, GL_FALSE, 
 		value_ptr(captureProjection));
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, captureFBO);
 
 	maxMipLevels = 5;
 
@@ -425,13 +426,13 @@ void SpecularIBL::InitializeSpecularIBL()
 			RenderCube();
 		}
 	}
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Generate a 2D LUT from the BRDF equations used for PBR
 	glGenTextures(1, &brdfLUTTexture);
 
 	// Pre-allocate enough memory for the LUT texture
-	glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, brdfLUTTexture);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, 512, 512, 0, GL_RG, GL_FLOAT, 0);
 
 	// Set wrapping mode to GL_CLAMP_TO_EDGE for the LUT texture
@@ -441,28 +442,17 @@ void SpecularIBL::InitializeSpecularIBL()
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 	// Then re-configure capture framebuffer object and render screen-space quad with BRDF shader
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, captureFBO);
 	glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
 	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 512, 512);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, brdfLUTTexture, 0);
 
 	glViewport(0, 0, 512, 512);
-	glUseProgram(specularIBLshaders[4]->shaderProgram);
+	GLStateCache::UseProgram(specularIBLshaders[4]->shaderProgram);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	RenderQuad();
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-	// initialize static shader uniforms before rendering
-	projection = perspective(radians(Camera::fieldOfView), float(1280 / 960), 0.1f, 100.0f);
-
-	glUseProgram(specularIBLshaders[0]->shaderProgram);
-	glUniformMatrix4fv(glGetUniformLocation(specularIBLshaders[0]->shaderProgram, "projection"), 1, GL_FALSE, 
-		value_ptr(projection));
-
-	glUseProgram(specularIBLshaders[5]->shaderProgram);
-	glUniformMatrix4fv(glGetUniformLocation(specularIBLshaders[5]->shaderProgram, "projection"), 1, GL_FALSE,
-		value_ptr(projection));
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void SpecularIBL::RenderSpecularIBL()
@@ -471,35 +461,30 @@ void SpecularIBL::RenderSpecularIBL()
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// Render the scene that supplies the convoluted irradiance map to the final shader
-	glUseProgram(specularIBLshaders[0]->shaderProgram);
-	
-	mat4 view = lookAt(Camera::cameraPosition, Camera::cameraPosition + Camera::cameraFront, Camera::cameraUp);
-
-	glUniformMatrix4fv(glGetUniformLocation(specularIBLshaders[0]->shaderProgram, "view"), 1, GL_FALSE, value_ptr(view));
-	glUniform3fv(glGetUniformLocation(specularIBLshaders[0]->shaderProgram, "camPos"), 1, value_ptr(Camera::cameraPosition));
+	GLStateCache::UseProgram(specularIBLshaders[0]->shaderProgram);
 
 	// Bind pre-computed IBL data
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
 
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE1);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
 
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
+	GLStateCache::ActiveTexture(GL_TEXTURE2);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, brdfLUTTexture);
 
 	// Specular IBL Part 2 texture
 	// rusted iron
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, ironAlbedoMap);
-	glActiveTexture(GL_TEXTURE4);
-	glBindTexture(GL_TEXTURE_2D, ironNormalMap);
-	glActiveTexture(GL_TEXTURE5);
-	glBindTexture(GL_TEXTURE_2D, ironMetallicMap);
-	glActiveTexture(GL_TEXTURE6);
-	glBindTexture(GL_TEXTURE_2D, ironRoughnessMap);
-	glActiveTexture(GL_TEXTURE7);
-	glBindTexture(GL_TEXTURE_2D, ironAOMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE3);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, ironAlbedoMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE4);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, ironNormalMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE5);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, ironMetallicMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE6);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, ironRoughnessMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE7);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, ironAOMap);
 
 	mat4 model = mat4(1.0f);
 	model = translate(model, vec3(-5.0, 0.0, 2.0));
@@ -513,16 +498,16 @@ void SpecularIBL::RenderSpecularIBL()
 	RenderSphere();
 
 	// gold
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, goldAlbedoMap);
-	glActiveTexture(GL_TEXTURE4);
-	glBindTexture(GL_TEXTURE_2D, goldNormalMap);
-	glActiveTexture(GL_TEXTURE5);
-	glBindTexture(GL_TEXTURE_2D, goldMetallicMap);
-	glActiveTexture(GL_TEXTURE6);
-	glBindTexture(GL_TEXTURE_2D, goldRoughnessMap);
-	glActiveTexture(GL_TEXTURE7);
-	glBindTexture(GL_TEXTURE_2D, goldAOMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE3);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, goldAlbedoMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE4);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, goldNormalMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE5);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, goldMetallicMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE6);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, goldRoughnessMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE7);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, goldAOMap);
 
 	model = mat4(1.0f);
 	model = translate(model, vec3(-3.0, 0.0, 2.0));
@@ -536,16 +521,16 @@ void SpecularIBL::RenderSpecularIBL()
 	RenderSphere();
 
 	// grass
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, grassAlbedoMap);
-	glActiveTexture(GL_TEXTURE4);
-	glBindTexture(GL_TEXTURE_2D, grassNormalMap);
-	glActiveTexture(GL_TEXTURE5);
-	glBindTexture(GL_TEXTURE_2D, grassMetallicMap);
-	glActiveTexture(GL_TEXTURE6);
-	glBindTexture(GL_TEXTURE_2D, grassRoughnessMap);
-	glActiveTexture(GL_TEXTURE7);
-	glBindTexture(GL_TEXTURE_2D, grassAOMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE3);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, grassAlbedoMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE4);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, grassNormalMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE5);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, grassMetallicMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE6);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, grassRoughnessMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE7);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, grassAOMap);
 
 	model = mat4(1.0f);
 	model = translate(model, vec3(-1.0, 0.0, 2.0));
@@ -559,16 +544,16 @@ void SpecularIBL::RenderSpecularIBL()
 	RenderSphere();
 
 	// plastic
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, plasticAlbedoMap);
-	glActiveTexture(GL_TEXTURE4);
-	glBindTexture(GL_TEXTURE_2D, plasticNormalMap);
-	glActiveTexture(GL_TEXTURE5);
-	glBindTexture(GL_TEXTURE_2D, plasticMetallicMap);
-	glActiveTexture(GL_TEXTURE6);
-	glBindTexture(GL_TEXTURE_2D, plasticRoughnessMap);
-	glActiveTexture(GL_TEXTURE7);
-	glBindTexture(GL_TEXTURE_2D, plasticAOMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE3);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, plasticAlbedoMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE4);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, plasticNormalMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE5);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, plasticMetallicMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE6);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, plasticRoughnessMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE7);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, plasticAOMap);
 
 	model = mat4(1.0f);
 	model = translate(model, vec3(1.0, 0.0, 2.0));
@@ -582,16 +567,16 @@ void SpecularIBL::RenderSpecularIBL()
 	RenderSphere();
 
 	// wall
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, wallAlbedoMap);
-	glActiveTexture(GL_TEXTURE4);
-	glBindTexture(GL_TEXTURE_2D, wallNormalMap);
-	glActiveTexture(GL_TEXTURE5);
-	glBindTexture(GL_TEXTURE_2D, wallMetallicMap);
-	glActiveTexture(GL_TEXTURE6);
-	glBindTexture(GL_TEXTURE_2D, wallRoughnessMap);
-	glActiveTexture(GL_TEXTURE7);
-	glBindTexture(GL_TEXTURE_2D, wallAOMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE3);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, wallAlbedoMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE4);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, wallNormalMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE5);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, wallMetallicMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE6);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, wallRoughnessMap);
+	GLStateCache::ActiveTexture(GL_TEXTURE7);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, wallAOMap);
 
 	model = mat4(1.0f);
 	model = translate(model, vec3(3.0, 0.0, 2.0));
@@ -661,11 +646,10 @@ void SpecularIBL::RenderSpecularIBL()
 	}
 
 	// render skybox (render as last to prevent overdraw)
-	glUseProgram(specularIBLshaders[5]->shaderProgram);
-	glUniformMatrix4fv(glGetUniformLocation(specularIBLshaders[5]->shaderProgram, "view"), 1, GL_FALSE, value_ptr(view));
+	GLStateCache::UseProgram(specularIBLshaders[5]->shaderProgram);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
 	//glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap); // display irradiance map
 	//glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap); // display prefilter map
@@ -677,38 +661,10 @@ void SpecularIBL::RenderSpecularIBL()
 	//RenderQuad();
 }
 
-unsigned int SpecularIBL::LoadTexture(const char* path)
+unsigned int SpecularIBL::LoadTexture(const char* path, TextureCompression compression)
 {
-	unsigned int textureID;
-	glGenTextures(1, &textureID);
-
-	int width, height, nrComponents;
-	unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
-	if (data)
-	{
-		GLenum format;
-		if (nrComponents == 1) format = GL_RED;
-		else if (nrComponents == 3) format = GL_RGB;
-		else if (nrComponents == 4) format = GL_RGBA;
-
-		glBindTexture(GL_TEXTURE_2D, textureID);
-		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		stbi_image_free(data);
-	}
-	else
-	{
-		std::cout << "Texture failed to load at path: " << path << std::endl;
-		stbi_image_free(data);
-	}
-
-	return textureID;
+	// The PBR lighting technique loads the same rusted iron maps, they're only decoded once
+	return TextureCache::LoadTexture(path, TextureLoadOptions(false, false, 0, true, false, compression));
 }
 
 void SpecularIBL::RenderSphere()
@@ -788,10 +744,10 @@ void SpecularIBL::RenderSphere()
 				data.push_back(uv[i].y);
 			}
 		}
-		glBindVertexArray(sphereVAO);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		GLStateCache::BindVertexArray(sphereVAO);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, vbo);
 		glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), &data[0], GL_STATIC_DRAW);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+		GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
 		unsigned int stride = (3 + 2 + 3) * sizeof(float);
 		glEnableVertexAttribArray(0);
@@ -802,7 +758,7 @@ void SpecularIBL::RenderSphere()
 		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
 	}
 
-	glBindVertexArray(sphereVAO);
+	GLStateCache::BindVertexArray(sphereVAO);
 	glDrawElements(GL_TRIANGLE_STRIP, indexCount, GL_UNSIGNED_INT, 0);
 }
 
@@ -859,23 +815,23 @@ void SpecularIBL::RenderCube()
 		glGenVertexArrays(1, &cubeVAO);
 		glGenBuffers(1, &cubeVBO);
 
-		glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, cubeVBO);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
 
-		glBindVertexArray(cubeVAO);
+		GLStateCache::BindVertexArray(cubeVAO);
 		glEnableVertexAttribArray(0);
 		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
 		glEnableVertexAttribArray(1);
 		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
 		glEnableVertexAttribArray(2);
 		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+		GLStateCache::BindVertexArray(0);
 	}
 
-	glBindVertexArray(cubeVAO);
+	GLStateCache::BindVertexArray(cubeVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 36);
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(0);
 }
 
 void SpecularIBL::RenderQuad()
@@ -893,8 +849,8 @@ void SpecularIBL::RenderQuad()
 
 		glGenVertexArrays(1, &quadVAO);
 		glGenBuffers(1, &quadVBO);
-		glBindVertexArray(quadVAO);
-		glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+		GLStateCache::BindVertexArray(quadVAO);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, quadVBO);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
 		glEnableVertexAttribArray(0);
 		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
@@ -902,7 +858,7 @@ void SpecularIBL::RenderQuad()
 		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
 	}
 
-	glBindVertexArray(quadVAO);
+	GLStateCache::BindVertexArray(quadVAO);
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-	glBindVertexArray(0);
+	GLStateCache::BindVertexArray(0);
 }
@@ -12,6 +12,7 @@
 #include "stb_image.h"
 
 #include "ShaderProgram.h"
+#include "TextureCompressor.h"
 
 class SpecularIBL
 {
@@ -26,7 +27,7 @@ public:
 private:
 	SpecularIBL();
 
-	unsigned int LoadTexture(const char* path);
+	unsigned int LoadTexture(const char* path, TextureCompression compression);
 	void RenderSphere();
 	void RenderCube();
 	void RenderQuad();
@@ -57,8 +58,6 @@ private:
 	unsigned int maxMipLevels;
 	unsigned int brdfLUTTexture;
 
-	mat4 projection;
-
 	unsigned int sphereVAO, indexCount, cubeVAO, cubeVBO, quadVAO, quadVBO;
 
     unsigned int ironAlbedoMap, ironNormalMap, ironMetallicMap, ironRoughnessMap, ironAOMap;
@@ -1,5 +1,9 @@
 #include "SpriteRenderer.h"
 
+// Uniform names hashed at compile time
+constexpr unsigned int MODEL_MATRIX_UNIFORM = UniformHash("modelMatrix");
+constexpr unsigned int SPRITE_COLOR_UNIFORM = UniformHash("spriteColor");
+
 SpriteRenderer::SpriteRenderer(ShaderProgram shader_)
 {
 	shader = shader_;
@@ -9,7 +13,7 @@ SpriteRenderer::SpriteRenderer(ShaderProgram shader_)
 
 SpriteRenderer::~SpriteRenderer()
 {
-	glDeleteVertexArrays(1, &quadVAO);
+	GLStateCache::DeleteVertexArrays(1, &quadVAO);
 }
 
 void SpriteRenderer::InitializeRenderData()
@@ -32,10 +36,10 @@ void SpriteRenderer::InitializeRenderData()
 	glGenVertexArrays(1, &quadVAO);
 	glGenBuffers(1, &VBO);
 
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, VBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
 
-	glBindVertexArray(quadVAO);
+	GLStateCache::BindVertexArray(quadVAO);
 
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
@@ -43,13 +47,16 @@ void SpriteRenderer::InitializeRenderData()
 	glEnableVertexAttribArray(1);
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+	GLStateCache::BindVertexArray(0);
 }
 
 void SpriteRenderer::DrawSprite(Texture2D texture, vec2 position, vec2 size, float rotate_, vec3 color)
 {
-	glUseProgram(shader.shaderProgram);
+	// Blocks only the first time, if the sprite shader is still being compiled
+	shader.WaitUntilReady();
+
+	GLStateCache::UseProgram(shader.shaderProgram);
 
 	/* When trying to position objects somewhere in a scene with rotation and scaling transformations, it is advised to first scale, then rotate, 
 	and finally translate the object. Because multiplying matrices occurs from right to left, we transform the matrix in reverse order: translate, 
@@ -67,14 +74,14 @@ void SpriteRenderer::DrawSprite(Texture2D texture, vec2 position, vec2 size, flo
 
 	modelMatrix = scale(modelMatrix, glm::vec3(size, 1.0f));
 
-	glUniformMatrix4fv(glGetUniformLocation(shader.shaderProgram, "modelMatrix"), 1, GL_FALSE, value_ptr(modelMatrix));
-	glUniform3f(glGetUniformLocation(shader.shaderProgram, "spriteColor"), color.x, color.y, color.z);
+	shader.SetMat4(MODEL_MATRIX_UNIFORM, modelMatrix);
+	shader.SetVec3(SPRITE_COLOR_UNIFORM, color);
 
-	glActiveTexture(GL_TEXTURE0);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
 	texture.Bind();
 
-	// Draw quad
-	glBindVertexArray(quadVAO);
+	/* Draw quad. The VAO is left bound, so the cache skips binding it again for the rest of the sprites drawn in a
+	row (every tile of a level, the paddle, the ball and the power ups) */
+	GLStateCache::BindVertexArray(quadVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 6);
-	glBindVertexArray(0);
 }
\ No newline at end of file
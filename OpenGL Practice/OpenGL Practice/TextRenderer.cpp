@@ -7,34 +7,39 @@
 
 #include "ResourceManager.h"
 
+// Uniform names hashed at compile time
+constexpr unsigned int TEXT_COLOR_UNIFORM = UniformHash("textColor");
 
-TextRenderer::TextRenderer(unsigned int width, unsigned int height)
-{
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    // load and configure shader
-    this->TextShader = ResourceManager::LoadShader("Text2DVertexShader.glsl", "Text2DFragmentShader.glsl", nullptr, "text");
 
-    glUseProgram(this->TextShader.shaderProgram);
+TextRenderer::TextRenderer(unsigned int width, unsigned int height) : Width(width), Height(height), ShaderConfigured(false)
+{
+    GLStateCache::Enable(GL_BLEND);
+    GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glUniformMatrix4fv(glGetUniformLocation(this->TextShader.shaderProgram, "projection"), 1, GL_FALSE,
-        value_ptr(ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f)));
+    // load shader (asynchronously, unless the game already queued it), it gets configured on the first draw
+    if (ResourceManager::shaders.count("text") > 0)
+    {
+        this->TextShader = ResourceManager::GetShader("text");
+    }
 
-    glUniform1i(glGetUniformLocation(this->TextShader.shaderProgram, "text"), 0);
+    else
+    {
+        this->TextShader = ResourceManager::LoadShaderAsync("Text2DVertexShader.glsl", "Text2DFragmentShader.glsl", nullptr, "text");
+        ResourceManager::CompileShaders();
+    }
 
     // configure VAO/VBO for texture quads
     glGenVertexArrays(1, &this->VAO);
     glGenBuffers(1, &this->VBO);
 
-    glBindVertexArray(this->VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    GLStateCache::BindVertexArray(this->VAO);
+    GLStateCache::BindBuffer(GL_ARRAY_BUFFER, this->VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLStateCache::BindVertexArray(0);
 }
 
 void TextRenderer::Load(string font, unsigned int fontSize)
@@ -73,7 +78,7 @@ void TextRenderer::Load(string font, unsigned int fontSize)
         // generate texture
         unsigned int texture;
         glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
+        GLStateCache::BindTexture(GL_TEXTURE_2D, texture);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, face->glyph->bitmap.width, face->glyph->bitmap.rows, 0,
             GL_RED, GL_UNSIGNED_BYTE, face->glyph->bitmap.buffer);
 
@@ -93,20 +98,41 @@ void TextRenderer::Load(string font, unsigned int fontSize)
         Characters.insert(pair<char, CharacterStruct>(c, character));
     }
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLStateCache::BindTexture(GL_TEXTURE_2D, 0);
 
     // destroy FreeType once we're finished
     FT_Done_Face(face);
     FT_Done_FreeType(ft);
 }
 
+void TextRenderer::ConfigureShader()
+{
+    // Blocks only if the driver is still compiling the text shader
+    this->TextShader.WaitUntilReady();
+
+    GLStateCache::UseProgram(this->TextShader.shaderProgram);
+
+    glUniformMatrix4fv(glGetUniformLocation(this->TextShader.shaderProgram, "projection"), 1, GL_FALSE,
+        value_ptr(ortho(0.0f, static_cast<float>(this->Width), static_cast<float>(this->Height), 0.0f)));
+
+    glUniform1i(glGetUniformLocation(this->TextShader.shaderProgram, "text"), 0);
+
+    this->ShaderConfigured = true;
+}
+
 void TextRenderer::RenderText(string text, float x, float y, float scale, vec3 color)
 {
+    if (!this->ShaderConfigured)
+        this->ConfigureShader();
+
     // activate corresponding render state	
-    glUseProgram(this->TextShader.shaderProgram);
-    glUniform3fv(glGetUniformLocation(TextShader.shaderProgram, "textColor"), 1, value_ptr(color));
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(this->VAO);
+    GLStateCache::UseProgram(this->TextShader.shaderProgram);
+    this->TextShader.SetVec3(TEXT_COLOR_UNIFORM, color);
+    GLStateCache::ActiveTexture(GL_TEXTURE0);
+    GLStateCache::BindVertexArray(this->VAO);
+
+    // Every glyph's quad is written to the same VBO, so it stays bound for the whole string
+    GLStateCache::BindBuffer(GL_ARRAY_BUFFER, this->VBO);
 
     // iterate through all characters
     string::const_iterator c;
@@ -137,14 +163,10 @@ void TextRenderer::RenderText(string text, float x, float y, float scale, vec3 c
         };
 
         // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
+        GLStateCache::BindTexture(GL_TEXTURE_2D, ch.TextureID);
 
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-
-        // Use glBufferSubData instead of glBufferData
+        // update content of VBO memory, use glBufferSubData instead of glBufferData
         glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
 
         // render quad
         glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -152,7 +174,4 @@ void TextRenderer::RenderText(string text, float x, float y, float scale, vec3 c
         // now advance cursors for next glyph
         x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
     }
-
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
@@ -36,6 +36,14 @@ public:
 
 private:
     unsigned int VAO, VBO;
+
+    // Screen size used for the text projection matrix
+    unsigned int Width, Height;
+
+    // The shader uniforms are only set on the first draw, so the text shader can keep compiling until then
+    bool ShaderConfigured;
+
+    void ConfigureShader();
 };
 
 #endif
\ No newline at end of file
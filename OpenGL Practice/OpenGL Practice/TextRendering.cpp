@@ -22,12 +22,12 @@ TextRendering::~TextRendering()
 	ft = NULL;
 	face = NULL;
 
-	glDeleteTextures(1, &texture);
+	GLStateCache::DeleteTextures(1, &texture);
 
 	projection = mat4(NULL);
 
-	glDeleteVertexArrays(1, &VAO);
-	glDeleteBuffers(1, &VBO);
+	GLStateCache::DeleteVertexArrays(1, &VAO);
+	GLStateCache::DeleteBuffers(1, &VBO);
 }
 
 TextRendering* TextRendering::Instance()
@@ -43,10 +43,10 @@ TextRendering* TextRendering::Instance()
 
 void TextRendering::InitializeTextRendering()
 {
-	glEnable(GL_CULL_FACE);
+	GLStateCache::Enable(GL_CULL_FACE);
 
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GLStateCache::Enable(GL_BLEND);
+	GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// Initialize the text rendering shader
 	textRenderingShader->InitializeShaderProgram(new VertexShaderLoader("TextRenderingVertexShader.glsl"),
@@ -60,7 +60,7 @@ void TextRendering::InitializeTextRendering()
 	This means that the point (0.0, 0.0) now corresponds to the bottom-left corner */
 	projection = ortho(0.0f, 800.0f, 0.0f, 600.0f);
 
-	glUseProgram(textRenderingShader->shaderProgram);
+	GLStateCache::UseProgram(textRenderingShader->shaderProgram);
 	glUniformMatrix4fv(glGetUniformLocation(textRenderingShader->shaderProgram, "projection"), 1, GL_FALSE, 
 		value_ptr(projection));
 
@@ -97,7 +97,7 @@ void TextRendering::InitializeTextRendering()
 
 		// generate texture
 		glGenTextures(1, &texture);
-		glBindTexture(GL_TEXTURE_2D, texture);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, texture);
 
 		/* The bitmap generated from the glyph is a grayscale 8-bit image where each color is represented by a single byte. 
 		For this reason wed like to store each byte of the bitmap buffer as the textures single color value. We accomplish 
@@ -130,8 +130,8 @@ void TextRendering::InitializeTextRendering()
 	glGenVertexArrays(1, &VAO);
 	glGenBuffers(1, &VBO);
 
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	GLStateCache::BindVertexArray(VAO);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, VBO);
 
 	/* The 2D quad requires 6 vertices of 4 floats each, so we reserve 6 * 4 floats of memory. Because well be updating the 
 	content of the VBOs memory quite often well allocate the memory with GL_DYNAMIC_DRAW */
@@ -140,8 +140,8 @@ void TextRendering::InitializeTextRendering()
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+	GLStateCache::BindVertexArray(0);
 }
 
 void TextRendering::ShowTextRendering()
@@ -159,12 +159,12 @@ that we use to update the content of the memory managed by the VBO using glBuffe
 void TextRendering::RenderText(ShaderProgram* shaderProgram, string text, float x, float y, float scale, vec3 color)
 {
 	// activate corresponding render state
-	glUseProgram(shaderProgram->shaderProgram);
+	GLStateCache::UseProgram(shaderProgram->shaderProgram);
 
 	glUniform3f(glGetUniformLocation(shaderProgram->shaderProgram, "textColor"), color.x, color.y, color.z);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindVertexArray(VAO);
+	GLStateCache::ActiveTexture(GL_TEXTURE0);
+	GLStateCache::BindVertexArray(VAO);
 
 	// iterate through all characters
 	string::const_iterator c;
@@ -193,12 +193,12 @@ void TextRendering::RenderText(ShaderProgram* shaderProgram, string text, float
 		};
 
 		// render glyph texture over quad
-		glBindTexture(GL_TEXTURE_2D, ch.TextureID);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, ch.TextureID);
 
 		// update content of VBO memory
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, VBO);
 		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
 
 		// render quad
 		glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -208,8 +208,8 @@ void TextRendering::RenderText(ShaderProgram* shaderProgram, string text, float
 		x += (ch.Advance >> 6) * scale; // bitshift by 6 (2^6 = 64)
 	}
 
-	glBindVertexArray(0);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::BindVertexArray(0);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0);
 }
 
 /* The text rendering technique with TrueType fonts using the FreeType library is flexible, scalable, and works with many 
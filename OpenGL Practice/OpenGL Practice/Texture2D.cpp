@@ -1,4 +1,5 @@
 #include "Texture2D.h"
+#include "GLStateCache.h"
 
 Texture2D::Texture2D() : width(0), height(0), internalFormat(GL_RGB), imageFormat(GL_RGB), wrapS(GL_REPEAT), wrapT(GL_REPEAT), filterMin(GL_LINEAR), filterMax(GL_LINEAR)
 {
@@ -11,7 +12,7 @@ void Texture2D::Generate(unsigned int width_, unsigned int height_, unsigned cha
 	this->height = height_;
 
 	// Create texture
-	glBindTexture(GL_TEXTURE_2D, this->textureID);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, this->textureID);
 	glTexImage2D(GL_TEXTURE_2D, 0, this->internalFormat, width, height, 0, this->imageFormat, GL_UNSIGNED_BYTE, data);
 
 	// Set the texture wrap and filter modes
@@ -22,10 +23,10 @@ void Texture2D::Generate(unsigned int width_, unsigned int height_, unsigned cha
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->filterMax);
 	
 	// Unbind texture
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Texture2D::Bind() const
 {
-	glBindTexture(GL_TEXTURE_2D, this->textureID);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, this->textureID);
 }
\ No newline at end of file
@@ -0,0 +1,350 @@
+#include "TextureCache.h"
+#include "GLStateCache.h"
+
+#include <iostream>
+#include <filesystem>
+#include <cctype>
+
+#include "stb_image.h"
+
+// Instantiate static variables
+unordered_map<string, unsigned int> TextureCache::textureIDs;
+unordered_map<unsigned int, TextureCache::CachedTexture> TextureCache::textures;
+
+bool TextureCache::enabled = true;
+
+unsigned int TextureCache::cacheHits = 0;
+unsigned int TextureCache::cacheMisses = 0;
+
+unsigned int TextureCache::LoadTexture(const string& filePath, const TextureLoadOptions& options)
+{
+	unsigned int textureID = AcquireTexture(filePath, options);
+
+	if (textureID != 0)
+		return textureID;
+
+	DecodedImage image;
+
+	if (!DecodeImage(filePath, options, image))
+	{
+		cout << "Texture failed to load at path: " << filePath << endl;
+		return 0;
+	}
+
+	return AddTexture(filePath, options, image);
+}
+
+unsigned int TextureCache::AcquireTexture(const string& filePath, const TextureLoadOptions& options)
+{
+	if (!enabled)
+		return 0;
+
+	auto found = textureIDs.find(GetKey(filePath, options));
+
+	if (found == textureIDs.end())
+		return 0;
+
+	textures[found->second].referenceCount++;
+	cacheHits++;
+
+	return found->second;
+}
+
+bool TextureCache::DecodeImage(const string& filePath, const TextureLoadOptions& options, DecodedImage& image)
+{
+	// Encoded on an earlier launch, the source image doesn't have to be decoded at all
+	if (TextureCompressor::LoadCompressedTexture(filePath, options, image.compressed))
+	{
+		image.data = nullptr;
+		image.width = image.compressed.width;
+		image.height = image.compressed.height;
+		image.nrComponents = image.compressed.nrComponents;
+
+		return true;
+	}
+
+	// The flip setting is per thread once it's set this way, so a load on another thread can't change it halfway through
+	stbi_set_flip_vertically_on_load_thread(options.flipVertically);
+
+	image.data = stbi_load(filePath.c_str(), &image.width, &image.height, &image.nrComponents, options.desiredChannels);
+
+	if (image.data == nullptr)
+		return false;
+
+	// stb_image reports the channels of the file, not the ones it converted the pixels to
+	if (options.desiredChannels != 0)
+		image.nrComponents = options.desiredChannels;
+
+	// The pixels aren't needed anymore once they're encoded, the blocks are uploaded instead
+	if (TextureCompressor::CompressImage(filePath, options, image.data, image.width, image.height, image.nrComponents,
+		image.compressed))
+	{
+		stbi_image_free(image.data);
+		image.data = nullptr;
+	}
+
+	/* glGenerateMipmap would filter the sRGB values as they are and stall the render thread while it does, so the levels
+	are built here on the decoding thread */
+	else if (options.generateMipmaps && MipGenerator::enabled)
+	{
+		MipGenerator::GenerateMipChain(image.data, image.width, image.height, image.nrComponents, MipOptions(options.sRGB ||
+			options.compression == TEXTURE_COMPRESSION_COLOR, options.compression == TEXTURE_COMPRESSION_NORMAL,
+			options.clampAlphaEdges && image.nrComponents == 4), image.mipmaps);
+	}
+
+	return true;
+}
+
+void TextureCache::FreeImage(DecodedImage& image)
+{
+	if (image.data != nullptr)
+		stbi_image_free(image.data);
+
+	image.data = nullptr;
+	image.mipmaps = MipChain();
+	image.compressed = CompressedTexture();
+}
+
+unsigned int TextureCache::AddTexture(const string& filePath, const TextureLoadOptions& options, DecodedImage& image)
+{
+	string key = GetKey(filePath, options);
+
+	auto found = textureIDs.find(key);
+
+	// Another load got there first (two meshes decoding the same file at once)
+	if (enabled && found != textureIDs.end())
+	{
+		FreeImage(image);
+
+		textures[found->second].referenceCount++;
+		cacheHits++;
+
+		return found->second;
+	}
+
+	unsigned int textureID = UploadTexture(options, image);
+	FreeImage(image);
+
+	return AdoptTexture(filePath, options, textureID, image.width, image.height);
+}
+
+unsigned int TextureCache::AdoptTexture(const string& filePath, const TextureLoadOptions& options, unsigned int textureID,
+	int width, int height)
+{
+	string key = GetKey(filePath, options);
+
+	auto found = textureIDs.find(key);
+
+	// Two loads of the same file finished one after the other, keep the first one
+	if (enabled && found != textureIDs.end() && found->second != textureID)
+	{
+		GLStateCache::DeleteTextures(1, &textureID);
+
+		textures[found->second].referenceCount++;
+		cacheHits++;
+
+		return found->second;
+	}
+
+	CachedTexture texture;
+	texture.key = key;
+	texture.referenceCount = 1;
+	texture.width = width;
+	texture.height = height;
+
+	textures[textureID] = texture;
+
+	// With the cache turned off every load gets its own texture, so it's never looked up by its key
+	if (enabled)
+		textureIDs[key] = textureID;
+
+	cacheMisses++;
+
+	return textureID;
+}
+
+void TextureCache::AddReference(unsigned int textureID)
+{
+	auto found = textures.find(textureID);
+
+	if (found != textures.end())
+		found->second.referenceCount++;
+}
+
+void TextureCache::ReleaseTexture(unsigned int textureID)
+{
+	auto found = textures.find(textureID);
+
+	if (found == textures.end())
+		return;
+
+	if (--found->second.referenceCount > 0)
+		return;
+
+	auto key = textureIDs.find(found->second.key);
+
+	if (key != textureIDs.end() && key->second == textureID)
+		textureIDs.erase(key);
+
+	textures.erase(found);
+
+	GLStateCache::DeleteTextures(1, &textureID);
+}
+
+bool TextureCache::GetTextureSize(unsigned int textureID, int& width, int& height)
+{
+	auto found = textures.find(textureID);
+
+	if (found == textures.end())
+		return false;
+
+	width = found->second.width;
+	height = found->second.height;
+
+	return true;
+}
+
+void TextureCache::PrintStatistics()
+{
+	if (cacheHits + cacheMisses == 0)
+		return;
+
+	cout << "TEXTURE_CACHE: " << cacheMisses << " textures decoded, " << cacheHits << " loads shared a resident texture, " <<
+		textures.size() << " textures resident" << endl;
+}
+
+string TextureCache::GetKey(const string& filePath, const TextureLoadOptions& options)
+{
+	// "Models/Backpack/../Backpack/diffuse.jpg" and "Models/Backpack/diffuse.jpg" are the same file
+	error_code errorCode;
+	filesystem::path canonicalPath = filesystem::weakly_canonical(filesystem::path(filePath), errorCode);
+
+	if (errorCode)
+		canonicalPath = filesystem::path(filePath).lexically_normal();
+
+	string key = canonicalPath.generic_string();
+
+#ifdef _WIN32
+	// Windows paths aren't case sensitive ("Backpack.obj" and "backpack.obj" are the same model)
+	for (unsigned int i = 0; i < key.size(); i++)
+	{
+		key[i] = static_cast<char>(tolower(static_cast<unsigned char>(key[i])));
+	}
+#endif
+
+	key += '|';
+	key += options.flipVertically ? 'F' : '-';
+	key += options.sRGB ? 'S' : '-';
+	key += static_cast<char>('0' + options.desiredChannels);
+	key += options.generateMipmaps ? 'M' : '-';
+	key += options.clampAlphaEdges ? 'C' : '-';
+	key += static_cast<char>('0' + options.compression);
+
+	return key;
+}
+
+unsigned int TextureCache::UploadTexture(const TextureLoadOptions& options, const DecodedImage& image, bool useStateCache)
+{
+	GLenum internalFormat = GL_RGB;
+	GLenum dataFormat = GL_RGB;
+
+	int nrComponents = image.nrComponents;
+
+	if (nrComponents == 1)
+	{
+		internalFormat = dataFormat = GL_RED;
+	}
+
+	else if (nrComponents == 2)
+	{
+		internalFormat = dataFormat = GL_RG;
+	}
+
+	else if (nrComponents == 3)
+	{
+		internalFormat = options.sRGB ? GL_SRGB : GL_RGB;
+		dataFormat = GL_RGB;
+	}
+
+	else if (nrComponents == 4)
+	{
+		internalFormat = options.sRGB ? GL_SRGB_ALPHA : GL_RGBA;
+		dataFormat = GL_RGBA;
+	}
+
+	unsigned int textureID;
+	glGenTextures(1, &textureID);
+
+	if (useStateCache)
+		GLStateCache::BindTexture(GL_TEXTURE_2D, textureID);
+
+	else
+		glBindTexture(GL_TEXTURE_2D, textureID);
+
+	const CompressedTexture& compressed = image.compressed;
+
+	if (compressed.format != 0)
+	{
+		/* Every mip level was encoded ahead of time, the driver can't generate mipmaps for compressed textures. Without
+		mipmaps only the first level is uploaded and the texture stops there */
+		unsigned int levelCount = options.generateMipmaps ? static_cast<unsigned int>(compressed.levels.size()) : 1;
+
+		for (unsigned int i = 0; i < levelCount; i++)
+		{
+			const MipLevel& level = compressed.levels[i];
+
+			glCompressedTexImage2D(GL_TEXTURE_2D, i, TextureCompressor::GetInternalFormat(compressed.format, options.sRGB),
+				level.width, level.height, 0, static_cast<GLsizei>(level.size), &compressed.data[level.offset]);
+		}
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+	}
+
+	else
+	{
+		// Rows of RGB levels with odd widths aren't a multiple of 4 bytes long, the default unpack alignment
+		GLint unpackAlignment;
+		glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, image.width, image.height, 0, dataFormat, GL_UNSIGNED_BYTE,
+			image.data);
+
+		for (unsigned int i = 0; i < image.mipmaps.levels.size(); i++)
+		{
+			const MipLevel& level = image.mipmaps.levels[i];
+
+			glTexImage2D(GL_TEXTURE_2D, i + 1, internalFormat, level.width, level.height, 0, dataFormat, GL_UNSIGNED_BYTE,
+				&image.mipmaps.data[level.offset]);
+		}
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+	}
+
+	// Use GL_CLAMP_TO_EDGE to prevent semi-transparent borders, due to interpolation it takes texels from next repeat
+	GLenum wrap = (options.clampAlphaEdges && dataFormat == GL_RGBA) ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+
+	if (options.generateMipmaps)
+	{
+		// Only when the mip generator is turned off, every other texture brought its own levels
+		if (compressed.format == 0 && image.mipmaps.levels.empty())
+			glGenerateMipmap(GL_TEXTURE_2D);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	}
+
+	else
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	}
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	if (!useStateCache)
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+	return textureID;
+}
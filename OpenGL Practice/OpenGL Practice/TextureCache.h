@@ -0,0 +1,122 @@
+#pragma once
+
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <string>
+#include <unordered_map>
+
+#include <glad/glad.h>
+
+#include "TextureCompressor.h"
+
+using namespace std;
+
+/* Every technique, every model and the resource manager used to load their own copy of each image, so the backpack's
+textures were decoded and uploaded once for SSAO and once more for deferred shading, and Wood.png was resident once for
+every technique that uses it. The texture cache is the one place where image files become GL textures. A texture is
+identified by its canonical file path together with the options it was loaded with (the same file loaded as sRGB and as
+linear are two different textures), and it's only decoded the first time it's asked for.
+
+Every load adds a reference and every ReleaseTexture removes one, the GL texture is deleted once nobody references it
+anymore. The cache isn't thread safe, it has to be used from the thread that owns the OpenGL context (DecodeImage and
+UploadTexture are the exceptions, they never touch the cache) */
+
+// How an image file is turned into a texture, textures loaded from the same file with different options aren't shared
+struct TextureLoadOptions
+{
+	TextureLoadOptions(bool flipVertically_ = false, bool sRGB_ = false, int desiredChannels_ = 0,
+		bool generateMipmaps_ = true, bool clampAlphaEdges_ = false,
+		TextureCompression compression_ = TEXTURE_COMPRESSION_NONE) : flipVertically(flipVertically_), sRGB(sRGB_),
+		desiredChannels(desiredChannels_), generateMipmaps(generateMipmaps_), clampAlphaEdges(clampAlphaEdges_),
+		compression(compression_) { }
+
+	bool flipVertically; // flip the image so its first row ends up at the bottom, like OpenGL expects
+	bool sRGB; // color textures are stored as sRGB and converted to linear when sampled
+	int desiredChannels; // convert the image to this many channels, 0 keeps the channels of the file
+	bool generateMipmaps; // trilinear filtering with mipmaps, otherwise plain linear filtering
+	bool clampAlphaEdges; // textures with an alpha channel clamp to the edge instead of repeating
+	TextureCompression compression; // what the texture is used for, decides its block compressed format
+};
+
+// An image file ready to be uploaded, either its decoded pixels or (if it's compressed) its encoded blocks
+struct DecodedImage
+{
+	DecodedImage() : data(nullptr), width(0), height(0), nrComponents(0) { }
+
+	unsigned char* data;
+	int width, height, nrComponents;
+
+	// Every level below data, built on the CPU for uncompressed textures that use mipmaps (empty otherwise)
+	MipChain mipmaps;
+
+	// compressed.format is 0 for images that are uploaded uncompressed
+	CompressedTexture compressed;
+};
+
+class TextureCache
+{
+public:
+	// Returns the texture of the image file, decoding and uploading it only if it isn't resident yet. 0 if it failed to load
+	static unsigned int LoadTexture(const string& filePath, const TextureLoadOptions& options = TextureLoadOptions());
+
+	// Returns the texture with a new reference if it's already resident, 0 otherwise (nothing is loaded)
+	static unsigned int AcquireTexture(const string& filePath, const TextureLoadOptions& options = TextureLoadOptions());
+
+	/* Decodes the image file (freed by AddTexture or FreeImage), returns false if it couldn't be read. Compressed textures
+	are read from the texture compressor's cache file, or encoded (and cached) right after decoding. Thread safe, it never
+	touches the cache, so images can be decoded on worker threads */
+	static bool DecodeImage(const string& filePath, const TextureLoadOptions& options, DecodedImage& image);
+
+	/* Uploads an image decoded with DecodeImage and adds it to the cache, then frees the image. If the same texture
+	became resident in the meantime, that one gets the reference instead and the image is thrown away */
+	static unsigned int AddTexture(const string& filePath, const TextureLoadOptions& options, DecodedImage& image);
+
+	static void FreeImage(DecodedImage& image);
+
+	/* Adds a texture that was already uploaded somewhere else (the asset loader's shared context) with one reference. If
+	the same texture became resident in the meantime, that one gets the reference and the given texture is deleted */
+	static unsigned int AdoptTexture(const string& filePath, const TextureLoadOptions& options, unsigned int textureID,
+		int width, int height);
+
+	/* Creates the GL texture, with the formats and sampling the options ask for. The state cache only knows about the main
+	thread's context, so any other thread has to pass false and the texture is bound without it */
+	static unsigned int UploadTexture(const TextureLoadOptions& options, const DecodedImage& image,
+		bool useStateCache = true);
+
+	// The canonical path followed by the options, so every distinct texture has its own key
+	static string GetKey(const string& filePath, const TextureLoadOptions& options);
+
+	// Adds one more reference to a texture the cache already has
+	static void AddReference(unsigned int textureID);
+
+	// Removes one reference, the texture is deleted once the last one is gone
+	static void ReleaseTexture(unsigned int textureID);
+
+	// Size in pixels of a texture loaded through the cache, returns false for any other texture
+	static bool GetTextureSize(unsigned int textureID, int& width, int& height);
+
+	// Prints how many loads were served by textures that were already resident
+	static void PrintStatistics();
+
+	// Allows turning off the sharing, so every load decodes and uploads its own texture like before (references still work)
+	static bool enabled;
+
+private:
+	TextureCache() { }
+
+	struct CachedTexture
+	{
+		string key;
+		unsigned int referenceCount;
+		int width, height;
+	};
+
+	// Key of every resident texture to its ID, and the ID of every texture to its entry
+	static unordered_map<string, unsigned int> textureIDs;
+	static unordered_map<unsigned int, CachedTexture> textures;
+
+	static unsigned int cacheHits, cacheMisses;
+};
+
+#endif
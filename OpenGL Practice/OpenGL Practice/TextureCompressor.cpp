@@ -0,0 +1,1147 @@
+#include "TextureCompressor.h"
+#include "TextureCache.h"
+#include "MeshCache.h"
+#include "MappedFile.h"
+
+#include <glfw3.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <cfloat>
+
+// The compressed formats aren't part of core OpenGL 3.3 (except RGTC), so GLAD's core header doesn't always have them
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+#ifndef GL_COMPRESSED_RED_RGTC1
+#define GL_COMPRESSED_RED_RGTC1 0x8DBB
+#endif
+
+#ifndef GL_COMPRESSED_RG_RGTC2
+#define GL_COMPRESSED_RG_RGTC2 0x8DBD
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+#ifndef GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+
+// Instantiate static variables
+string TextureCompressor::cacheDirectory = "CompressedTextures";
+bool TextureCompressor::enabled = true;
+
+bool TextureCompressor::initialized = false;
+bool TextureCompressor::supportsS3TC = false;
+bool TextureCompressor::supportsS3TCsRGB = false;
+bool TextureCompressor::supportsBPTC = false;
+
+atomic<unsigned int> TextureCompressor::texturesEncoded(0);
+atomic<unsigned int> TextureCompressor::texturesLoaded(0);
+atomic<unsigned long long> TextureCompressor::uncompressedBytes(0);
+atomic<unsigned long long> TextureCompressor::compressedBytes(0);
+atomic<long long> TextureCompressor::encodeMicroseconds(0);
+
+// Bump whenever the encoders change, so every cache file is encoded again
+const unsigned int TEXTURE_COMPRESSOR_VERSION = 2;
+
+// Every KTX 1 file starts with these 12 bytes
+static const unsigned char KTX_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+/* The header of a KTX 1 file. Compressed textures have no type or format, only the internal format. It's followed by
+bytesOfKeyValueData bytes of key and value pairs (where we keep the source stamp), and then every mip level as its size
+in bytes followed by its blocks */
+struct KTXHeader
+{
+	unsigned char identifier[12];
+	unsigned int endianness;
+	unsigned int glType;
+	unsigned int glTypeSize;
+	unsigned int glFormat;
+	unsigned int glInternalFormat;
+	unsigned int glBaseInternalFormat;
+	unsigned int pixelWidth;
+	unsigned int pixelHeight;
+	unsigned int pixelDepth;
+	unsigned int numberOfArrayElements;
+	unsigned int numberOfFaces;
+	unsigned int numberOfMipmapLevels;
+	unsigned int bytesOfKeyValueData;
+};
+
+// Written by the creator of the file in its own byte order, a reader with the other order sees 0x01020304
+const unsigned int KTX_ENDIANNESS = 0x04030201;
+
+static unsigned int GetBlockSize(GLenum format)
+{
+	return (format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || format == GL_COMPRESSED_RED_RGTC1) ? 8 : 16;
+}
+
+static GLenum GetBaseInternalFormat(GLenum format)
+{
+	switch (format)
+	{
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		return GL_RGB;
+
+	case GL_COMPRESSED_RED_RGTC1:
+		return GL_RED;
+
+	case GL_COMPRESSED_RG_RGTC2:
+		return GL_RG;
+
+	default:
+		return GL_RGBA;
+	}
+}
+
+// "size:write time:version" of the source image, a cache file whose stamp differs is out of date
+static bool GetSourceStamp(const string& filePath, string& stamp)
+{
+	unsigned long long sourceSize;
+	long long sourceWriteTime;
+
+	if (!MeshCache::GetSourceStamp(filePath, sourceSize, sourceWriteTime))
+		return false;
+
+	stringstream text;
+	text << sourceSize << ":" << sourceWriteTime << ":" << TEXTURE_COMPRESSOR_VERSION;
+
+	stamp = text.str();
+	return true;
+}
+
+/* The colors of a block are spread along a line in color space most of the time, so both encoders look for that line first.
+It's the principal axis of the colors (the eigenvector of their covariance with the largest eigenvalue), found by
+multiplying a vector with the covariance matrix a few times. channelCount is 3 for BC1 and 4 for BC7 */
+static void FindPrincipalAxis(const float pixels[16][4], unsigned int channelCount, float mean[4], float axis[4])
+{
+	for (unsigned int c = 0; c < 4; c++)
+	{
+		mean[c] = 0.0f;
+
+		for (unsigned int i = 0; i < 16; i++)
+		{
+			mean[c] += pixels[i][c];
+		}
+
+		mean[c] /= 16.0f;
+	}
+
+	float covariance[4][4] = {};
+
+	for (unsigned int i = 0; i < 16; i++)
+	{
+		for (unsigned int a = 0; a < channelCount; a++)
+		{
+			for (unsigned int b = 0; b < channelCount; b++)
+			{
+				covariance[a][b] += (pixels[i][a] - mean[a]) * (pixels[i][b] - mean[b]);
+			}
+		}
+	}
+
+	// Start along the grey diagonal, most blocks are closer to it than to any single channel
+	for (unsigned int c = 0; c < 4; c++)
+	{
+		axis[c] = c < channelCount ? 1.0f : 0.0f;
+	}
+
+	for (unsigned int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[4] = {};
+
+		for (unsigned int a = 0; a < channelCount; a++)
+		{
+			for (unsigned int b = 0; b < channelCount; b++)
+			{
+				next[a] += covariance[a][b] * axis[b];
+			}
+		}
+
+		float length = 0.0f;
+
+		for (unsigned int c = 0; c < channelCount; c++)
+		{
+			length = std::max(length, fabsf(next[c]));
+		}
+
+		// Every color in the block is the same, any axis will do
+		if (length < 1e-6f)
+			return;
+
+		for (unsigned int c = 0; c < channelCount; c++)
+		{
+			axis[c] = next[c] / length;
+		}
+	}
+}
+
+// The two ends of the colors along the axis
+static void FindAxisEndpoints(const float pixels[16][4], unsigned int channelCount, const float mean[4],
+	const float axis[4], float endpoint0[4], float endpoint1[4])
+{
+	float axisLength = 0.0f;
+
+	for (unsigned int c = 0; c < channelCount; c++)
+	{
+		axisLength += axis[c] * axis[c];
+	}
+
+	float minimum = 0.0f, maximum = 0.0f;
+
+	for (unsigned int i = 0; i < 16; i++)
+	{
+		float t = 0.0f;
+
+		for (unsigned int c = 0; c < channelCount; c++)
+		{
+			t += (pixels[i][c] - mean[c]) * axis[c];
+		}
+
+		t /= std::max(axisLength, 1e-6f);
+
+		minimum = std::min(minimum, t);
+		maximum = std::max(maximum, t);
+	}
+
+	for (unsigned int c = 0; c < 4; c++)
+	{
+		endpoint0[c] = std::clamp(mean[c] + axis[c] * minimum, 0.0f, 255.0f);
+		endpoint1[c] = std::clamp(mean[c] + axis[c] * maximum, 0.0f, 255.0f);
+	}
+}
+
+/* Once every texel has an index, the endpoints that fit those indices best can be solved for directly. Every texel is
+(1 - t) * endpoint0 + t * endpoint1 with t given by its index, which is a least squares problem with two unknowns per
+channel. Returns false if all the texels use the same index (there's nothing to solve then) */
+static bool SolveEndpoints(const float pixels[16][4], unsigned int channelCount, const float weights[16],
+	float endpoint0[4], float endpoint1[4])
+{
+	float a = 0.0f, b = 0.0f, c = 0.0f;
+	float d0[4] = {}, d1[4] = {};
+
+	for (unsigned int i = 0; i < 16; i++)
+	{
+		float t = weights[i];
+
+		a += (1.0f - t) * (1.0f - t);
+		b += (1.0f - t) * t;
+		c += t * t;
+
+		for (unsigned int channel = 0; channel < channelCount; channel++)
+		{
+			d0[channel] += (1.0f - t) * pixels[i][channel];
+			d1[channel] += t * pixels[i][channel];
+		}
+	}
+
+	float determinant = a * c - b * b;
+
+	if (fabsf(determinant) < 1e-6f)
+		return false;
+
+	for (unsigned int channel = 0; channel < channelCount; channel++)
+	{
+		endpoint0[channel] = std::clamp((c * d0[channel] - b * d1[channel]) / determinant, 0.0f, 255.0f);
+		endpoint1[channel] = std::clamp((a * d1[channel] - b * d0[channel]) / determinant, 0.0f, 255.0f);
+	}
+
+	return true;
+}
+
+static unsigned short PackColor565(const float color[4])
+{
+	unsigned int r = static_cast<unsigned int>(color[0] * 31.0f / 255.0f + 0.5f);
+	unsigned int g = static_cast<unsigned int>(color[1] * 63.0f / 255.0f + 0.5f);
+	unsigned int b = static_cast<unsigned int>(color[2] * 31.0f / 255.0f + 0.5f);
+
+	return static_cast<unsigned short>((r << 11) | (g << 5) | b);
+}
+
+// Repeats the high bits in the low ones, exactly like the GPU expands the color
+static void UnpackColor565(unsigned short packed, float color[4])
+{
+	unsigned int r = (packed >> 11) & 31;
+	unsigned int g = (packed >> 5) & 63;
+	unsigned int b = packed & 31;
+
+	color[0] = static_cast<float>((r << 3) | (r >> 2));
+	color[1] = static_cast<float>((g << 2) | (g >> 4));
+	color[2] = static_cast<float>((b << 3) | (b >> 2));
+	color[3] = 255.0f;
+}
+
+// Picks the closest of the four colors between the endpoints for every texel, returns the total squared error
+static float ChooseBC1Indices(const float pixels[16][4], unsigned short color0, unsigned short color1,
+	unsigned int indices[16])
+{
+	float palette[4][4];
+	UnpackColor565(color0, palette[0]);
+	UnpackColor565(color1, palette[1]);
+
+	for (unsigned int c = 0; c < 3; c++)
+	{
+		palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+		palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+	}
+
+	float totalError = 0.0f;
+
+	for (unsigned int i = 0; i < 16; i++)
+	{
+		float bestError = FLT_MAX;
+
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			float error = 0.0f;
+
+			for (unsigned int c = 0; c < 3; c++)
+			{
+				float difference = pixels[i][c] - palette[j][c];
+				error += difference * difference;
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				indices[i] = j;
+			}
+		}
+
+		totalError += bestError;
+	}
+
+	return totalError;
+}
+
+/* BC1 stores two RGB565 endpoints and a 2 bit index per texel that picks one of the endpoints or one of the two colors a
+third of the way between them. The first endpoint has to be the larger number, otherwise the GPU decodes the block in
+the 3 color mode that has a transparent texel (BC3's color block is always decoded with 4 colors) */
+static void EncodeBC1Block(const float pixels[16][4], unsigned char* output)
+{
+	float mean[4], axis[4], endpoint0[4], endpoint1[4];
+	FindPrincipalAxis(pixels, 3, mean, axis);
+	FindAxisEndpoints(pixels, 3, mean, axis, endpoint0, endpoint1);
+
+	// Move the endpoints slightly inwards, the extremes are rarely worth spending an index on
+	for (unsigned int c = 0; c < 3; c++)
+	{
+		float inset = (endpoint1[c] - endpoint0[c]) / 16.0f;
+
+		endpoint0[c] += inset;
+		endpoint1[c] -= inset;
+	}
+
+	unsigned short color0 = PackColor565(endpoint1);
+	unsigned short color1 = PackColor565(endpoint0);
+
+	if (color0 < color1)
+		swap(color0, color1);
+
+	unsigned int indices[16];
+	float error = ChooseBC1Indices(pixels, color0, color1, indices);
+
+	// Index 0 is color0, 1 is color1, 2 is one third of the way to color1 and 3 two thirds
+	static const float indexWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+	float weights[16];
+
+	for (unsigned int i = 0; i < 16; i++)
+	{
+		weights[i] = indexWeights[indices[i]];
+	}
+
+	float refined0[4], refined1[4];
+
+	if (color0 != color1 && SolveEndpoints(pixels, 3, weights, refined0, refined1))
+	{
+		unsigned short refinedColor0 = PackColor565(refined0);
+		unsigned short refinedColor1 = PackColor565(refined1);
+
+		if (refinedColor0 < refinedColor1)
+			swap(refinedColor0, refinedColor1);
+
+		unsigned int refinedIndices[16];
+		float refinedError = ChooseBC1Indices(pixels, refinedColor0, refinedColor1, refinedIndices);
+
+		if (refinedError < error)
+		{
+			color0 = refinedColor0;
+			color1 = refinedColor1;
+			memcpy(indices, refinedIndices, sizeof(indices));
+		}
+	}
+
+	unsigned int indexBits = 0;
+
+	// Equal endpoints decode in the 3 color mode, where only index 0 is safe
+	for (unsigned int i = 0; i < 16; i++)
+	{
+		indexBits |= (color0 == color1 ? 0 : indices[i]) << (i * 2);
+	}
+
+	output[0] = static_cast<unsigned char>(color0 & 0xFF);
+	output[1] = static_cast<unsigned char>(color0 >> 8);
+	output[2] = static_cast<unsigned char>(color1 & 0xFF);
+	output[3] = static_cast<unsigned char>(color1 >> 8);
+
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		output[4 + i] = static_cast<unsigned char>((indexBits >> (i * 8)) & 0xFF);
+	}
+}
+
+/* BC4 stores a single channel as two 8 bit endpoints and a 3 bit index per texel. With the first endpoint larger than
+the second, the indices pick one of the endpoints or one of the six values evenly spaced between them */
+static void EncodeBC4Block(const float values[16], unsigned char* output)
+{
+	float minimum = values[0], maximum = values[0];
+
+	for (unsigned int i = 1; i < 16; i++)
+	{
+		minimum = std::min(minimum, values[i]);
+		maximum = std::max(maximum, values[i]);
+	}
+
+	unsigned int value0 = static_cast<unsigned int>(maximum + 0.5f);
+	unsigned int value1 = static_cast<unsigned int>(minimum + 0.5f);
+
+	unsigned long long indexBits = 0;
+
+	if (value0 != value1)
+	{
+		for (unsigned int i = 0; i < 16; i++)
+		{
+			// Steps from the first endpoint towards the second, 0 is value0 and 7 is value1
+			float step = (static_cast<float>(value0) - values[i]) * 7.0f / static_cast<float>(value0 - value1);
+			unsigned int position = static_cast<unsigned int>(std::clamp(step + 0.5f, 0.0f, 7.0f));
+
+			// The endpoints are indices 0 and 1, the values between them 2 to 7
+			unsigned int index = position == 0 ? 0 : (position == 7 ? 1 : position + 1);
+
+			indexBits |= static_cast<unsigned long long>(index) << (i * 3);
+		}
+	}
+
+	output[0] = static_cast<unsigned char>(value0);
+	output[1] = static_cast<unsigned char>(value1);
+
+	for (unsigned int i = 0; i < 6; i++)
+	{
+		output[2 + i] = static_cast<unsigned char>((indexBits >> (i * 8)) & 0xFF);
+	}
+}
+
+// BC3 is a BC4 block for the alpha followed by a BC1 block for the color
+static void EncodeBC3Block(const float pixels[16][4], unsigned char* output)
+{
+	float alpha[16];
+
+	for (unsigned int i = 0; i < 16; i++)
+	{
+		alpha[i] = pixels[i][3];
+	}
+
+	EncodeBC4Block(alpha, output);
+	EncodeBC1Block(pixels, output + 8);
+}
+
+// BC5 is two BC4 blocks, one for red and one for green
+static void EncodeBC5Block(const float pixels[16][4], unsigned char* output)
+{
+	float red[16], green[16];
+
+	for (unsigned int i = 0; i < 16; i++)
+	{
+		red[i] = pixels[i][0];
+		green[i] = pixels[i][1];
+	}
+
+	EncodeBC4Block(red, output);
+	EncodeBC4Block(green, output + 8);
+}
+
+// Writes values into a block from the least significant bit of the first byte onwards, like BC7 is laid out
+class BlockBitWriter
+{
+public:
+	BlockBitWriter(unsigned char* bytes_) : bytes(bytes_), position(0) { }
+
+	void Write(unsigned int value, unsigned int bitCount)
+	{
+		for (unsigned int i = 0; i < bitCount; i++, position++)
+		{
+			if ((value >> i) & 1)
+				bytes[position / 8] |= static_cast<unsigned char>(1 << (position % 8));
+		}
+	}
+
+private:
+	unsigned char* bytes;
+	unsigned int position;
+};
+
+// How far between the endpoints each of BC7's 16 indices is, out of 64
+static const unsigned int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/* Rounds an endpoint to 7 bits per channel plus the shared lowest bit (the p-bit), trying both values of the p-bit and
+keeping the one that ends up closer */
+static void QuantizeBC7Endpoint(const float endpoint[4], unsigned int quantized[4], unsigned int& pBit)
+{
+	float bestError = FLT_MAX;
+
+	for (unsigned int p = 0; p < 2; p++)
+	{
+		unsigned int candidate[4];
+		float error = 0.0f;
+
+		for (unsigned int c = 0; c < 4; c++)
+		{
+			candidate[c] = static_cast<unsigned int>(std::clamp((endpoint[c] - p) / 2.0f + 0.5f, 0.0f, 127.0f));
+
+			float difference = endpoint[c] - static_cast<float>((candidate[c] << 1) | p);
+			error += difference * difference;
+		}
+
+		if (error < bestError)
+		{
+			bestError = error;
+			pBit = p;
+			memcpy(quantized, candidate, sizeof(candidate));
+		}
+	}
+}
+
+static float ChooseBC7Indices(const float pixels[16][4], const unsigned int quantized0[4], unsigned int pBit0,
+	const unsigned int quantized1[4], unsigned int pBit1, unsigned int indices[16])
+{
+	float palette[16][4];
+
+	for (unsigned int c = 0; c < 4; c++)
+	{
+		unsigned int value0 = (quantized0[c] << 1) | pBit0;
+		unsigned int value1 = (quantized1[c] << 1) | pBit1;
+
+		for (unsigned int j = 0; j < 16; j++)
+		{
+			palette[j][c] = static_cast<float>(((64 - BC7_WEIGHTS[j]) * value0 + BC7_WEIGHTS[j] * value1 + 32) >> 6);
+		}
+	}
+
+	float totalError = 0.0f;
+
+	for (unsigned int i = 0; i < 16; i++)
+	{
+		float bestError = FLT_MAX;
+
+		for (unsigned int j = 0; j < 16; j++)
+		{
+			float error = 0.0f;
+
+			for (unsigned int c = 0; c < 4; c++)
+			{
+				float difference = pixels[i][c] - palette[j][c];
+				error += difference * difference;
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				indices[i] = j;
+			}
+		}
+
+		totalError += bestError;
+	}
+
+	return totalError;
+}
+
+/* BC7 has eight modes, we only use mode 6: the whole block is one line between two RGBA endpoints with 7 bits per channel
+and a p-bit each, and every texel has a 4 bit index along it. It's the best mode for smooth color and alpha, and one
+mode keeps the encoder simple. The layout is the mode (bit 6 set), the eight 7 bit endpoint channels (R0 R1 G0 G1 B0 B1
+A0 A1), both p-bits and the indices. The first texel's index only has 3 bits, its top bit is implied to be 0 */
+static void EncodeBC7Block(const float pixels[16][4], unsigned char* output)
+{
+	float mean[4], axis[4], endpoint0[4], endpoint1[4];
+	FindPrincipalAxis(pixels, 4, mean, axis);
+	FindAxisEndpoints(pixels, 4, mean, axis, endpoint0, endpoint1);
+
+	unsigned int quantized0[4], quantized1[4], pBit0, pBit1;
+	QuantizeBC7Endpoint(endpoint0, quantized0, pBit0);
+	QuantizeBC7Endpoint(endpoint1, quantized1, pBit1);
+
+	unsigned int indices[16];
+	float error = ChooseBC7Indices(pixels, quantized0, pBit0, quantized1, pBit1, indices);
+
+	float weights[16];
+
+	for (unsigned int i = 0; i < 16; i++)
+	{
+		weights[i] = BC7_WEIGHTS[indices[i]] / 64.0f;
+	}
+
+	float refined0[4], refined1[4];
+
+	if (SolveEndpoints(pixels, 4, weights, refined0, refined1))
+	{
+		unsigned int refinedQuantized0[4], refinedQuantized1[4], refinedPBit0, refinedPBit1;
+		QuantizeBC7Endpoint(refined0, refinedQuantized0, refinedPBit0);
+		QuantizeBC7Endpoint(refined1, refinedQuantized1, refinedPBit1);
+
+		unsigned int refinedIndices[16];
+		float refinedError = ChooseBC7Indices(pixels, refinedQuantized0, refinedPBit0, refinedQuantized1, refinedPBit1,
+			refinedIndices);
+
+		if (refinedError < error)
+		{
+			memcpy(quantized0, refinedQuantized0, sizeof(quantized0));
+			memcpy(quantized1, refinedQuantized1, sizeof(quantized1));
+			pBit0 = refinedPBit0;
+			pBit1 = refinedPBit1;
+			memcpy(indices, refinedIndices, sizeof(indices));
+		}
+	}
+
+	// The first index has no room for its top bit, swapping the endpoints mirrors every index so it fits
+	if (indices[0] >= 8)
+	{
+		for (unsigned int c = 0; c < 4; c++)
+		{
+			swap(quantized0[c], quantized1[c]);
+		}
+
+		swap(pBit0, pBit1);
+
+		for (unsigned int i = 0; i < 16; i++)
+		{
+			indices[i] = 15 - indices[i];
+		}
+	}
+
+	memset(output, 0, 16);
+
+	BlockBitWriter writer(output);
+	writer.Write(1 << 6, 7);
+
+	for (unsigned int c = 0; c < 4; c++)
+	{
+		writer.Write(quantized0[c], 7);
+		writer.Write(quantized1[c], 7);
+	}
+
+	writer.Write(pBit0, 1);
+	writer.Write(pBit1, 1);
+
+	writer.Write(indices[0], 3);
+
+	for (unsigned int i = 1; i < 16; i++)
+	{
+		writer.Write(indices[i], 4);
+	}
+}
+
+void TextureCompressor::Initialize()
+{
+	if (initialized)
+		return;
+
+	initialized = true;
+
+	int extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+
+	for (int i = 0; i < extensionCount; i++)
+	{
+		const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+
+		if (strcmp(extension, "GL_EXT_texture_compression_s3tc") == 0)
+			supportsS3TC = true;
+
+		// The sRGB variants of the S3TC formats come with the sRGB texture extension
+		else if (strcmp(extension, "GL_EXT_texture_sRGB") == 0 || strcmp(extension, "GL_EXT_texture_compression_s3tc_srgb") == 0)
+			supportsS3TCsRGB = true;
+
+		else if (strcmp(extension, "GL_ARB_texture_compression_bptc") == 0)
+			supportsBPTC = true;
+	}
+
+	if (!supportsS3TC)
+		cout << "TEXTURE_COMPRESSOR: S3TC isn't supported, color textures are uploaded uncompressed" << endl;
+}
+
+bool TextureCompressor::LoadCompressedTexture(const string& filePath, const TextureLoadOptions& options,
+	CompressedTexture& texture)
+{
+	if (!enabled || !initialized || options.compression == TEXTURE_COMPRESSION_NONE)
+		return false;
+
+	string sourceStamp;
+
+	if (!GetSourceStamp(filePath, sourceStamp))
+		return false;
+
+	MappedFile file;
+
+	if (!file.Open(GetCacheFilePath(filePath, options)))
+		return false;
+
+	const unsigned char* bytes = file.GetData();
+	size_t size = file.GetSize();
+
+	KTXHeader header;
+
+	if (size < sizeof(header))
+		return false;
+
+	memcpy(&header, bytes, sizeof(header));
+
+	if (memcmp(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0 || header.endianness != KTX_ENDIANNESS ||
+		header.numberOfFaces != 1 || header.numberOfMipmapLevels == 0 || !IsFormatSupported(header.glInternalFormat,
+		options.sRGB))
+		return false;
+
+	size_t offset = sizeof(header);
+
+	if (header.bytesOfKeyValueData > size - offset)
+		return false;
+
+	bool upToDate = false;
+	int nrComponents = 0;
+
+	size_t keyValueEnd = offset + header.bytesOfKeyValueData;
+
+	while (offset + sizeof(unsigned int) <= keyValueEnd)
+	{
+		unsigned int pairSize;
+		memcpy(&pairSize, bytes + offset, sizeof(unsigned int));
+		offset += sizeof(unsigned int);
+
+		if (pairSize > keyValueEnd - offset)
+			return false;
+
+		string pair(reinterpret_cast<const char*>(bytes + offset), pairSize);
+		size_t separator = pair.find('\0');
+
+		if (separator != string::npos)
+		{
+			string key = pair.substr(0, separator);
+			string value = pair.substr(separator + 1);
+
+			// The value's terminating zero is part of the pair
+			if (!value.empty() && value.back() == '\0')
+				value.pop_back();
+
+			if (key == "SourceStamp")
+				upToDate = value == sourceStamp;
+
+			else if (key == "SourceChannels")
+				nrComponents = atoi(value.c_str());
+		}
+
+		offset += (pairSize + 3) & ~3u;
+	}
+
+	if (!upToDate)
+		return false;
+
+	offset = keyValueEnd;
+
+	texture.format = header.glInternalFormat;
+	texture.width = static_cast<int>(header.pixelWidth);
+	texture.height = static_cast<int>(header.pixelHeight);
+	texture.nrComponents = nrComponents;
+	texture.levels.clear();
+	texture.data.clear();
+
+	int levelWidth = texture.width, levelHeight = texture.height;
+
+	for (unsigned int i = 0; i < header.numberOfMipmapLevels; i++)
+	{
+		if (size - offset < sizeof(unsigned int))
+			return false;
+
+		unsigned int imageSize;
+		memcpy(&imageSize, bytes + offset, sizeof(unsigned int));
+		offset += sizeof(unsigned int);
+
+		if (imageSize > size - offset)
+			return false;
+
+		MipLevel level;
+		level.width = levelWidth;
+		level.height = levelHeight;
+		level.offset = texture.data.size();
+		level.size = imageSize;
+
+		texture.levels.push_back(level);
+		texture.data.insert(texture.data.end(), bytes + offset, bytes + offset + imageSize);
+
+		// Blocks are 8 or 16 bytes, so the padding after every level is always 0
+		offset += (imageSize + 3) & ~3u;
+
+		levelWidth = std::max(levelWidth / 2, 1);
+		levelHeight = std::max(levelHeight / 2, 1);
+	}
+
+	texturesLoaded++;
+	compressedBytes += texture.data.size();
+
+	return true;
+}
+
+bool TextureCompressor::CompressImage(const string& filePath, const TextureLoadOptions& options, const unsigned char* data,
+	int width, int height, int nrComponents, CompressedTexture& texture)
+{
+	if (!enabled || !initialized || options.compression == TEXTURE_COMPRESSION_NONE || width <= 0 || height <= 0)
+		return false;
+
+	double startTime = glfwGetTime();
+
+	/* Expand the image to RGBA the same way OpenGL expands an uncompressed RED, RG or RGB texture, so the compressed
+	texture samples the same values the uncompressed one did */
+	vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+	bool hasAlpha = false;
+
+	for (size_t i = 0; i < static_cast<size_t>(width) * height; i++)
+	{
+		unsigned char* texel = &pixels[i * 4];
+		const unsigned char* source = data + i * nrComponents;
+
+		texel[0] = source[0];
+		texel[1] = nrComponents >= 2 ? source[1] : 0;
+		texel[2] = nrComponents >= 3 ? source[2] : 0;
+		texel[3] = nrComponents >= 4 ? source[3] : 255;
+
+		hasAlpha = hasAlpha || texel[3] != 255;
+	}
+
+	GLenum format = ChooseFormat(options.compression, hasAlpha);
+
+	if (format == 0 || !IsFormatSupported(format, options.sRGB))
+		return false;
+
+	texture.format = format;
+	texture.width = width;
+	texture.height = height;
+	texture.nrComponents = nrComponents;
+	texture.levels.clear();
+	texture.data.clear();
+
+	/* Every level down to 1x1 is encoded, whether the texture uses mipmaps is decided when it's uploaded. Color textures
+	hold sRGB values even when they're not uploaded as sRGB (the shaders convert them), so they're always filtered as
+	linear colors */
+	MipChain mipmaps;
+	MipGenerator::GenerateMipChain(pixels.data(), width, height, 4, MipOptions(options.compression ==
+		TEXTURE_COMPRESSION_COLOR, options.compression == TEXTURE_COMPRESSION_NORMAL, options.clampAlphaEdges &&
+		nrComponents == 4), mipmaps);
+
+	EncodeLevel(pixels.data(), width, height, texture);
+	uncompressedBytes += pixels.size();
+
+	for (unsigned int i = 0; i < mipmaps.levels.size(); i++)
+	{
+		const MipLevel& level = mipmaps.levels[i];
+
+		EncodeLevel(&mipmaps.data[level.offset], level.width, level.height, texture);
+		uncompressedBytes += level.size;
+	}
+
+	texturesEncoded++;
+	compressedBytes += texture.data.size();
+	encodeMicroseconds += static_cast<long long>((glfwGetTime() - startTime) * 1000000.0);
+
+	SaveCompressedTexture(filePath, options, texture);
+
+	return true;
+}
+
+GLenum TextureCompressor::GetInternalFormat(GLenum format, bool sRGB)
+{
+	if (!sRGB)
+		return format;
+
+	switch (format)
+	{
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+
+	// Single and two channel formats have no sRGB variant, they're never color textures anyway
+	default:
+		return format;
+	}
+}
+
+void TextureCompressor::PrintStatistics()
+{
+	if (texturesEncoded + texturesLoaded == 0)
+		return;
+
+	cout << "TEXTURE_COMPRESSOR: " << texturesEncoded << " textures encoded in " << encodeMicroseconds / 1000 << " ms, " <<
+		texturesLoaded << " loaded from the cache, " << compressedBytes / 1024 << " KB of compressed textures";
+
+	// Only the encoded textures know how large they were uncompressed
+	if (texturesEncoded > 0)
+		cout << " (encoded ones were " << uncompressedBytes / 1024 << " KB uncompressed)";
+
+	cout << endl;
+}
+
+GLenum TextureCompressor::ChooseFormat(TextureCompression compression, bool hasAlpha)
+{
+	switch (compression)
+	{
+	case TEXTURE_COMPRESSION_COLOR:
+		if (hasAlpha)
+			return supportsBPTC ? GL_COMPRESSED_RGBA_BPTC_UNORM : (supportsS3TC ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0);
+
+		return supportsS3TC ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : 0;
+
+	// RGTC has been core since OpenGL 3.0
+	case TEXTURE_COMPRESSION_NORMAL:
+		return GL_COMPRESSED_RG_RGTC2;
+
+	case TEXTURE_COMPRESSION_MASK:
+		return GL_COMPRESSED_RED_RGTC1;
+
+	default:
+		return 0;
+	}
+}
+
+bool TextureCompressor::IsFormatSupported(GLenum format, bool sRGB)
+{
+	switch (format)
+	{
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		return supportsS3TC && (!sRGB || supportsS3TCsRGB);
+
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		return supportsBPTC;
+
+	// An sRGB texture can't be stored in a format without an sRGB variant
+	case GL_COMPRESSED_RED_RGTC1:
+	case GL_COMPRESSED_RG_RGTC2:
+		return !sRGB;
+
+	default:
+		return false;
+	}
+}
+
+void TextureCompressor::EncodeLevel(const unsigned char* pixels, int width, int height, CompressedTexture& texture)
+{
+	unsigned int blockSize = GetBlockSize(texture.format);
+	int blocksWide = (width + 3) / 4;
+	int blocksHigh = (height + 3) / 4;
+
+	MipLevel level;
+	level.width = width;
+	level.height = height;
+	level.offset = texture.data.size();
+	level.size = static_cast<size_t>(blocksWide) * blocksHigh * blockSize;
+
+	texture.data.resize(level.offset + level.size);
+	texture.levels.push_back(level);
+
+	unsigned char* output = &texture.data[level.offset];
+
+	for (int blockY = 0; blockY < blocksHigh; blockY++)
+	{
+		for (int blockX = 0; blockX < blocksWide; blockX++)
+		{
+			// Levels smaller than a block (and the edges of odd sizes) repeat their last row and column
+			float block[16][4];
+
+			for (int y = 0; y < 4; y++)
+			{
+				int sourceY = std::min(blockY * 4 + y, height - 1);
+
+				for (int x = 0; x < 4; x++)
+				{
+					int sourceX = std::min(blockX * 4 + x, width - 1);
+					const unsigned char* texel = pixels + (static_cast<size_t>(sourceY) * width + sourceX) * 4;
+
+					for (unsigned int c = 0; c < 4; c++)
+					{
+						block[y * 4 + x][c] = texel[c];
+					}
+				}
+			}
+
+			switch (texture.format)
+			{
+			case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+				EncodeBC1Block(block, output);
+				break;
+
+			case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+				EncodeBC3Block(block, output);
+				break;
+
+			case GL_COMPRESSED_RGBA_BPTC_UNORM:
+				EncodeBC7Block(block, output);
+				break;
+
+			case GL_COMPRESSED_RG_RGTC2:
+				EncodeBC5Block(block, output);
+				break;
+
+			case GL_COMPRESSED_RED_RGTC1:
+			{
+				float red[16];
+
+				for (unsigned int i = 0; i < 16; i++)
+				{
+					red[i] = block[i][0];
+				}
+
+				EncodeBC4Block(red, output);
+				break;
+			}
+			}
+
+			output += blockSize;
+		}
+	}
+}
+
+string TextureCompressor::GetCacheFilePath(const string& filePath, const TextureLoadOptions& options)
+{
+	/* FNV-1a of the path and everything that changes the encoded blocks, the mip filter and the edges included. sRGB and
+	mipmaps only change how the blocks are uploaded, so textures that only differ in those share a file */
+	string variant = filePath;
+	variant += '|';
+	variant += static_cast<char>('0' + options.compression);
+	variant += options.flipVertically ? 'F' : '-';
+	variant += static_cast<char>('0' + options.desiredChannels);
+	variant += options.clampAlphaEdges ? 'C' : '-';
+	variant += static_cast<char>('0' + MipGenerator::filter);
+
+	unsigned long long hash = 14695981039346656037ULL;
+
+	for (unsigned int i = 0; i < variant.size(); i++)
+	{
+		hash ^= static_cast<unsigned char>(variant[i]);
+		hash *= 1099511628211ULL;
+	}
+
+	stringstream path;
+	path << cacheDirectory << "/" << filesystem::path(filePath).stem().string() << "_" << hex << setw(16) <<
+		setfill('0') << hash << ".ktx";
+
+	return path.str();
+}
+
+// Every pair is its byte size, then "key\0value\0", padded to 4 bytes
+static unsigned int GetKeyValueSize(const string& key, const string& value)
+{
+	unsigned int pairSize = static_cast<unsigned int>(key.size() + value.size() + 2);
+	return sizeof(unsigned int) + ((pairSize + 3) & ~3u);
+}
+
+static void WriteKeyValue(ofstream& file, const string& key, const string& value)
+{
+	string pair = key + '\0' + value + '\0';
+	unsigned int pairSize = static_cast<unsigned int>(pair.size());
+
+	static const char zeros[4] = { 0, 0, 0, 0 };
+
+	file.write(reinterpret_cast<const char*>(&pairSize), sizeof(unsigned int));
+	file.write(pair.data(), pairSize);
+	file.write(zeros, (4 - pairSize % 4) % 4);
+}
+
+void TextureCompressor::SaveCompressedTexture(const string& filePath, const TextureLoadOptions& options,
+	const CompressedTexture& texture)
+{
+	string sourceStamp;
+
+	if (!GetSourceStamp(filePath, sourceStamp))
+		return;
+
+	string sourceChannels = to_string(texture.nrComponents);
+
+	// The header needs the size of the key and value pairs before they're written
+	unsigned int keyValueBytes = GetKeyValueSize("SourceStamp", sourceStamp) + GetKeyValueSize("SourceChannels",
+		sourceChannels);
+
+	KTXHeader header;
+	memcpy(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER));
+	header.endianness = KTX_ENDIANNESS;
+	header.glType = 0;
+	header.glTypeSize = 1;
+	header.glFormat = 0;
+	header.glInternalFormat = texture.format;
+	header.glBaseInternalFormat = GetBaseInternalFormat(texture.format);
+	header.pixelWidth = static_cast<unsigned int>(texture.width);
+	header.pixelHeight = static_cast<unsigned int>(texture.height);
+	header.pixelDepth = 0;
+	header.numberOfArrayElements = 0;
+	header.numberOfFaces = 1;
+	header.numberOfMipmapLevels = static_cast<unsigned int>(texture.levels.size());
+	header.bytesOfKeyValueData = keyValueBytes;
+
+	string cacheFilePath = GetCacheFilePath(filePath, options);
+
+	error_code errorCode;
+	filesystem::create_directories(cacheDirectory, errorCode);
+
+	ofstream file(cacheFilePath, ios::binary | ios::trunc);
+
+	if (!file.is_open())
+	{
+		cout << "TEXTURE_COMPRESSOR: Failed to write " << cacheFilePath << endl;
+		return;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	WriteKeyValue(file, "SourceStamp", sourceStamp);
+	WriteKeyValue(file, "SourceChannels", sourceChannels);
+
+	for (unsigned int i = 0; i < texture.levels.size(); i++)
+	{
+		unsigned int imageSize = static_cast<unsigned int>(texture.levels[i].size);
+
+		file.write(reinterpret_cast<const char*>(&imageSize), sizeof(unsigned int));
+		file.write(reinterpret_cast<const char*>(&texture.data[texture.levels[i].offset]), imageSize);
+	}
+
+	if (!file)
+	{
+		cout << "TEXTURE_COMPRESSOR: Failed to write " << cacheFilePath << endl;
+
+		file.close();
+		filesystem::remove(cacheFilePath, errorCode);
+	}
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#ifndef TEXTURE_COMPRESSOR_H
+#define TEXTURE_COMPRESSOR_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <atomic>
+
+#include "MipGenerator.h"
+
+using namespace std;
+
+/* Every image used to be uploaded as plain 8 bit pixels, so a 2048x2048 albedo map took 16 MB of video memory (21 MB with
+its mipmaps) and every sample fetched 4 bytes per texel. Block compressed formats store every 4x4 block of texels in 8 or 16
+bytes that the GPU decodes while sampling, which is 4 to 8 times less memory and bandwidth for a small loss in quality.
+
+The texture compressor encodes an image on the CPU into the format that suits what the texture is used for:
+
+	color   BC1 (DXT1) without alpha, BC7 with alpha (BC3/DXT5 if the driver has no BPTC)
+	normal  BC5 (RGTC2), only the X and Y of the normal are stored and the shader reconstructs Z
+	mask    BC4 (RGTC1), a single channel like roughness, metallic, ambient occlusion or height
+
+Encoding is far too slow to do on every start, so the whole mip chain is encoded once and written to a KTX file in the
+cache directory. Later loads read the blocks from that file and hand them straight to glCompressedTexImage2D, without
+decoding the source image at all. Like the mesh cache, a file is rebuilt whenever the source image's size or last write
+time changes or the compressor version is bumped */
+
+// What a texture is used for, which decides its compressed format. NONE uploads the pixels uncompressed like before
+enum TextureCompression
+{
+	TEXTURE_COMPRESSION_NONE,
+	TEXTURE_COMPRESSION_COLOR,
+	TEXTURE_COMPRESSION_NORMAL,
+	TEXTURE_COMPRESSION_MASK
+};
+
+struct TextureLoadOptions;
+
+// Every mip level of a texture in a block compressed format, format is 0 if the texture isn't compressed
+struct CompressedTexture
+{
+	CompressedTexture() : format(0), width(0), height(0), nrComponents(0) { }
+
+	// Always the linear format, the sRGB variant is picked when the texture is uploaded
+	GLenum format;
+
+	int width, height;
+
+	// Channels of the source image, so the texture is sampled with the same wrapping as the uncompressed one
+	int nrComponents;
+
+	// Where every mip level's blocks are in data
+	vector<MipLevel> levels;
+	vector<unsigned char> data;
+};
+
+class TextureCompressor
+{
+public:
+	// Checks which compressed formats the driver supports, call once on the main thread after GLAD is loaded
+	static void Initialize();
+
+	/* Reads the encoded texture from its cache file, returns false if there's no file or it's out of date. Thread safe,
+	textures are loaded on worker threads and on the asset loader's thread */
+	static bool LoadCompressedTexture(const string& filePath, const TextureLoadOptions& options,
+		CompressedTexture& texture);
+
+	/* Builds the mip chain of a decoded image with the mip generator, encodes every level and writes the cache file.
+	Returns false if the image can't be compressed with the options (the driver lacks the format, or there's no sRGB
+	variant of it), the pixels are uploaded uncompressed then. Thread safe */
+	static bool CompressImage(const string& filePath, const TextureLoadOptions& options, const unsigned char* data,
+		int width, int height, int nrComponents, CompressedTexture& texture);
+
+	// The format a texture is uploaded with, the sRGB variant of the compressed format for sRGB textures
+	static GLenum GetInternalFormat(GLenum format, bool sRGB);
+
+	// Prints how many textures were encoded and loaded from the cache, and how much memory compression saved
+	static void PrintStatistics();
+
+	// Directory (relative to the working directory) where the cache files are stored
+	static string cacheDirectory;
+
+	// Allows turning compression off completely, every texture is uploaded uncompressed like before
+	static bool enabled;
+
+private:
+	TextureCompressor() { }
+
+	// The format a texture with this role is encoded in, 0 if the driver doesn't support any format for it
+	static GLenum ChooseFormat(TextureCompression compression, bool hasAlpha);
+
+	static bool IsFormatSupported(GLenum format, bool sRGB);
+
+	// Encodes one RGBA8 mip level and appends its blocks to the texture
+	static void EncodeLevel(const unsigned char* pixels, int width, int height, CompressedTexture& texture);
+
+	static string GetCacheFilePath(const string& filePath, const TextureLoadOptions& options);
+
+	static void SaveCompressedTexture(const string& filePath, const TextureLoadOptions& options,
+		const CompressedTexture& texture);
+
+	static bool initialized;
+	static bool supportsS3TC, supportsS3TCsRGB, supportsBPTC;
+
+	// Updated from several threads at once
+	static atomic<unsigned int> texturesEncoded, texturesLoaded;
+	static atomic<unsigned long long> uncompressedBytes, compressedBytes;
+	static atomic<long long> encodeMicroseconds;
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include "UniformTable.h"
+
+#include <iostream>
+
+// A hash of 0 marks an empty slot, so a name that happens to hash to 0 is stored as 1 instead
+static unsigned int ToSlotHash(unsigned int nameHash)
+{
+	return nameHash == 0 ? 1 : nameHash;
+}
+
+unsigned int UniformHashNumber(unsigned int hash, unsigned int number)
+{
+	// Write the digits back to front into a small buffer, 10 digits are enough for any unsigned int
+	char digits[11];
+	int position = 10;
+
+	digits[position] = '\0';
+
+	do
+	{
+		digits[--position] = static_cast<char>('0' + number % 10);
+		number /= 10;
+	} while (number != 0);
+
+	return UniformHashContinue(hash, &digits[position]);
+}
+
+unsigned int UniformArrayHash(unsigned int arrayHash, unsigned int index, const char* member)
+{
+	unsigned int hash = UniformHashContinue(arrayHash, "[");
+	hash = UniformHashNumber(hash, index);
+	hash = UniformHashContinue(hash, "]");
+
+	if (member != nullptr)
+	{
+		hash = UniformHashContinue(hash, ".");
+		hash = UniformHashContinue(hash, member);
+	}
+
+	return hash;
+}
+
+UniformTable::UniformTable()
+{
+	reflected = false;
+	mask = 0;
+}
+
+void UniformTable::Reflect(unsigned int program)
+{
+	slots.clear();
+	mask = 0;
+
+	reflected = true;
+
+	int uniformCount = 0;
+	int maxNameLength = 0;
+
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	if (uniformCount == 0)
+		return;
+
+	// Every array element gets its own slot, so count them first to size the table
+	vector<string> names;
+	vector<int> sizes;
+
+	vector<char> nameBuffer(maxNameLength + 1);
+	unsigned int slotCount = 0;
+
+	for (int i = 0; i < uniformCount; i++)
+	{
+		int nameLength = 0, size = 0;
+		GLenum type;
+
+		glGetActiveUniform(program, i, static_cast<int>(nameBuffer.size()), &nameLength, &size, &type, nameBuffer.data());
+
+		names.push_back(string(nameBuffer.data(), nameLength));
+		sizes.push_back(size);
+
+		// Arrays of plain types are stored both as "name" and as every "name[i]"
+		slotCount += size > 1 ? size + 1 : 1;
+	}
+
+	// Keep the table at most half full so lookups almost never need to probe more than one slot
+	unsigned int tableSize = 16;
+
+	while (tableSize < slotCount * 2)
+	{
+		tableSize *= 2;
+	}
+
+	slots.assign(tableSize, UniformSlot{ 0, -1 });
+	mask = tableSize - 1;
+
+	for (unsigned int i = 0; i < names.size(); i++)
+	{
+		int location = glGetUniformLocation(program, names[i].c_str());
+
+		// Uniforms inside a uniform block don't have a location, they're set through their buffer instead
+		if (location == -1)
+			continue;
+
+		// Arrays of plain types are reported once as "name[0]"
+		string baseName = names[i];
+		size_t bracket = baseName.size() >= 3 ? baseName.rfind("[0]") : string::npos;
+
+		if (bracket == string::npos || bracket != baseName.size() - 3)
+		{
+			Insert(UniformHash(baseName.c_str()), location, baseName);
+			continue;
+		}
+
+		baseName.erase(bracket);
+		Insert(UniformHash(baseName.c_str()), location, baseName);
+
+		for (int element = 0; element < sizes[i]; element++)
+		{
+			string elementName = baseName + "[" + to_string(element) + "]";
+
+			Insert(UniformHash(elementName.c_str()), glGetUniformLocation(program, elementName.c_str()), elementName);
+		}
+	}
+}
+
+int UniformTable::GetLocation(unsigned int nameHash) const
+{
+	if (slots.empty())
+		return -1;
+
+	nameHash = ToSlotHash(nameHash);
+
+	unsigned int slot = nameHash & mask;
+
+	// Linear probing, the table always has empty slots so this stops at the first empty one
+	while (slots[slot].nameHash != 0)
+	{
+		if (slots[slot].nameHash == nameHash)
+			return slots[slot].location;
+
+		slot = (slot + 1) & mask;
+	}
+
+	return -1;
+}
+
+void UniformTable::Insert(unsigned int nameHash, int location, const string& name)
+{
+	nameHash = ToSlotHash(nameHash);
+
+	unsigned int slot = nameHash & mask;
+
+	while (slots[slot].nameHash != 0)
+	{
+		// Two different names with the same hash would silently share a location, so at least let us know
+		if (slots[slot].nameHash == nameHash)
+		{
+			if (slots[slot].location != location)
+				cout << "ERROR::UNIFORM_TABLE: Hash collision on uniform " << name << endl;
+
+			return;
+		}
+
+		slot = (slot + 1) & mask;
+	}
+
+	slots[slot].nameHash = nameHash;
+	slots[slot].location = location;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#ifndef UNIFORM_TABLE_H
+#define UNIFORM_TABLE_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <string>
+
+using namespace std;
+
+/* Calling glGetUniformLocation every frame means building a string and asking the driver to search the program's
+uniforms by name each time. Instead, every active uniform of a program is read once right after it's linked (with
+glGetActiveUniform) and stored in a small open addressing hash table keyed by the FNV-1a hash of its name. Uniform names
+written in the code are hashed at compile time, so setting a uniform every frame is just a couple of array lookups */
+
+// 32-bit FNV-1a, continues hashing from an existing hash so names can be hashed piece by piece
+constexpr unsigned int UniformHashContinue(unsigned int hash, const char* name)
+{
+	while (*name != '\0')
+	{
+		hash ^= static_cast<unsigned char>(*name++);
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+// Hashes a whole uniform name, use with constexpr so the hash is computed at compile time
+constexpr unsigned int UniformHash(const char* name)
+{
+	return UniformHashContinue(2166136261u, name);
+}
+
+// Continues a hash with the decimal digits of a number, e.g. hashing "TextureDiffuse" and then 1 gives "TextureDiffuse1"
+unsigned int UniformHashNumber(unsigned int hash, unsigned int number);
+
+/* Hashes an array element like "lights[3].Position" without building the string, arrayHash is the hash of "lights" and
+member may be nullptr for arrays of plain types like "offsets[3]" */
+unsigned int UniformArrayHash(unsigned int arrayHash, unsigned int index, const char* member = nullptr);
+
+// A single slot of the hash table, a hash of 0 marks an empty slot
+struct UniformSlot
+{
+	unsigned int nameHash;
+	int location;
+};
+
+class UniformTable
+{
+public:
+	UniformTable();
+
+	// Reads every active uniform of a linked program into the table, replacing whatever was stored before
+	void Reflect(unsigned int program);
+
+	// Returns the location of a uniform, or -1 (which glUniform* silently ignores) if the program doesn't use it
+	int GetLocation(unsigned int nameHash) const;
+
+	bool reflected;
+
+private:
+	void Insert(unsigned int nameHash, int location, const string& name);
+
+	vector<UniformSlot> slots;
+
+	// slots.size() - 1, the table size is always a power of two
+	unsigned int mask;
+};
+
+#endif
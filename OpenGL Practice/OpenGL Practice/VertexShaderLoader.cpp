@@ -4,32 +4,21 @@
 
 #include "VertexShaderLoader.h"
 
-VertexShaderLoader::VertexShaderLoader(const char* vertexShaderPath_)
+VertexShaderLoader::VertexShaderLoader(const char* vertexShaderPath_, const std::string& defines_) :
+	vertexShaderPath(vertexShaderPath_), defines(defines_)
 {
-	// Make sure the vertex shader file ifstream will throw an exception error
-	vertexShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+	/* The shader stage cache only reads each file once, so creating the same vertex shader loader in several places
+	doesn't read the file from disk again */
+	vShaderCode = ShaderStageCache::GetSource(vertexShaderPath).data();
 
-	try
+	// Keep our own copy of the source only if it differs from the file because of the injected defines
+	if (!defines.empty())
 	{
-		// Open the vertex shader file
-		vertexShaderFile.open(vertexShaderPath_);
-
-		// Read the vertex shader's file buffer contents into a stream of the vertex shader file
-		vertexShaderStream << vertexShaderFile.rdbuf();
-
-		// Close the vertex shader's file handlers
-		vertexShaderFile.close();
-
-		// Convert the vertex shader stream into a vertex shader string
-		vertexShaderCode = vertexShaderStream.str();
+		vertexShaderCode = ShaderPreprocessor::InjectDefines(string(ShaderStageCache::GetSource(vertexShaderPath)), defines);
+		vShaderCode = vertexShaderCode.c_str();
 	}
 
-	catch (std::ifstream::failure error)
-	{
-		std::cout << "ERROR::SHADER::VERTEX::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
-	}
-
-	vShaderCode = vertexShaderCode.c_str();
+	vertexShader = NULL;
 
 	/*vertices =
 	{
@@ -119,25 +108,14 @@ VertexShaderLoader::~VertexShaderLoader()
 
 void VertexShaderLoader::InitializeVertexShaderLoader()
 {
-	// Create a shader object ID to use it when we create the shader
-	vertexShader = glCreateShader(GL_VERTEX_SHADER); // Create a vertex shader using OpenGL's version of it
-
-	// Attach the shader source code (the GLSL one) to the shader object and compile it
-	glShaderSource(vertexShader, 1, &vShaderCode, NULL);
-	glCompileShader(vertexShader);
-
-	int successfullyCompiled; // An integer that checks if the vertex shader compilation was successful
-	char compilationInformationLog[512]; // Gives information about its compilation in a log file (maybe?)
-
-	// Returns a successful compilation of the vertex shader if it can compile successfully
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &successfullyCompiled);
+	/* Get the compiled vertex shader from the shader stage cache, it's only compiled the first time any program asks for
+	this file (with these defines), every other program reuses the same shader object */
+	vertexShader = ShaderStageCache::AcquireShader(GL_VERTEX_SHADER, vertexShaderPath, defines);
+}
 
-	// If the compilation failed, then return a log compilation error and explain the error
-	if (!successfullyCompiled)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, compilationInformationLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << compilationInformationLog << std::endl;
-	}
+const char* VertexShaderLoader::GetVertexShaderCode() const
+{
+	return vShaderCode;
 }
 
 //void VertexShaderLoader::InitializeVertexObjects()
@@ -241,7 +219,7 @@ void VertexShaderLoader::InitializeVertexShaderLoader()
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 	// Flip the image vertically
-	stbi_set_flip_vertically_on_load(true);
+	stbi_set_flip_vertically_on_load_thread(true);
 
 	data = stbi_load("Textures/container2.png", &width, &height, &nrChannels, 0);
 
@@ -551,7 +529,7 @@ void VertexShaderLoader::InitializeVertexShaderLoader()
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 	// Flip the image vertically
-	stbi_set_flip_vertically_on_load(true);
+	stbi_set_flip_vertically_on_load_thread(true);
 
 	data = stbi_load("Textures/marble.jpg", &width, &height, &nrChannels, 0);
 
@@ -9,6 +9,7 @@
 #include <list>
 #include <array>
 #include "stb_image.h"
+#include "ShaderStageCache.h"
 
 // Include the GLM header files (OpenGL Mathematics Library)
 #include <glm.hpp>
@@ -18,9 +19,13 @@
 class VertexShaderLoader
 {
 public:
-	VertexShaderLoader(const char* vertexShaderPath_);
+	// defines_ holds extra #define lines that are injected right after the shader's #version line
+	VertexShaderLoader(const char* vertexShaderPath_, const std::string& defines_ = "");
 	~VertexShaderLoader();
 	void InitializeVertexShaderLoader();
+
+	// Returns the GLSL source code that was read from the vertex shader file
+	const char* GetVertexShaderCode() const;
 	//void InitializeVertexObjects();
 	//void InitializeCubeDepthTestingVertices();
 	//void InitializeFloorDepthTestingVertices();
@@ -37,9 +42,9 @@ private:
 	//unsigned int planeVAO, planeVBO;
 
 	//unsigned int EBO;
+	std::string vertexShaderPath;
+	std::string defines;
 	std::string vertexShaderCode;
-	std::ifstream vertexShaderFile;
-	std::stringstream vertexShaderStream;
 	const char* vShaderCode;
 	/*unsigned char* data;
 
@@ -121,8 +121,20 @@ void Window::InitializeOpenGLwindow(int width, int height, const char* title, GL
 		//return -1;
 	}
 
+	// Nothing is known about the state of the new context yet, so the state cache has to issue every first change
+	GLStateCache::Invalidate();
+
 	glViewport(0, 0, 1280, 960);
 
+	// Create the per-frame camera buffer before any program gets linked against it
+	FrameUniforms::Initialize(1280, 960);
+
+	// Decides which block compressed formats textures can be stored in, before the first texture is loaded
+	TextureCompressor::Initialize();
+
+	// Textures can be streamed in on the loader thread from here on, its context shares everything with this window's
+	AssetLoader::Initialize(openGLwindow);
+
 	glfwSetKeyCallback(openGLwindow, KeyCallback);
 	glfwSetFramebufferSizeCallback(openGLwindow, FrameBufferSizeCallback);
 }
@@ -166,8 +178,29 @@ void Window::WindowStillRunning()
 	DebuggingTime::Instance()->InitializeDebugging();
 	RenderText::Instance()->InitializeTextRendering();*/
 
+	// Prints how long the models take to import with 1, 2, 4... threads
+	//ModelImportBenchmark::Run();
+
+	// Prints how much memory and GPU time the compact vertex layout saves on every bundled model
+	//ModelImportBenchmark::CompareVertexFormats();
+
+	// Prints how much the bounding volume hierarchies speed up ray casts, frustum and sphere queries on the bundled models
+	//ModelImportBenchmark::MeasureBoundingVolumes();
+
+	// Prints how long culling 10 thousand to 10 million instances takes with and without SIMD and threads
+	//InstanceCullingBenchmark::Run();
+
 	breakout.InitializeGame();
 
+	// Report what the shader, mesh and texture caches saved during startup
+	ProgramBinaryCache::PrintStatistics();
+	MeshCache::PrintStatistics();
+	TextureCache::PrintStatistics();
+	TextureCompressor::PrintStatistics();
+
+	// Startup is done, so free the shared shader stages that no program holds on to anymore
+	ShaderStageCache::PurgeUnusedShaders();
+
 	/* While we don't want to close the GLFW window, process the input of our window, add our own background color
 	for the window, clear the color buffer bit to render our color to the window, swap the window's buffers,
 	process any events waiting for us to do something to it */
@@ -181,6 +214,12 @@ void Window::WindowStillRunning()
 
 		glfwPollEvents(); // Waits for any input by the user and processes it in real-time
 
+		// Hand out the textures the loader thread finished since the last frame
+		AssetLoader::Update();
+
+		// Upload the camera matrices, camera position and time once for every program that renders this frame
+		FrameUniforms::Update(currentFrame, deltaTime);
+
 		// Tell GLFW to hide the mouse cursor and capture it
 
 		/* Capturing a cursor means that, once the application has focus, the mouse cursor stays within the center of the 
@@ -423,6 +462,9 @@ void Window::WindowStillRunning()
 		breakout.RenderGame();
 
 		glfwSwapBuffers(openGLwindow); // Removing this will throw an exception error
+
+		// Close this frame's state change counters
+		GLStateCache::EndFrame();
 	}
 
 	/*for (int i = 0; i < vertexShaderLoader.size(); i++)
@@ -454,7 +496,15 @@ void Window::WindowStillRunning()
 	//DebuggingTime::Instance()->~Debugging();
 	//RenderText::Instance()->~TextRendering();
 
+	// Report how many redundant state changes the state cache saved us
+	GLStateCache::PrintStatistics();
+
+	// The loader's context has to go before GLFW does
+	AssetLoader::Shutdown();
+
 	ResourceManager::Clear();
+	ShaderStageCache::Clear();
+	FrameUniforms::Clear();
 
 	// Close all GLFW-related stuff and perhaps terminate the whole program, maybe?
 	glfwTerminate();
@@ -497,6 +547,8 @@ void Window::CallSpecularIBLViewport()
 void Window::FrameBufferSizeCallback(GLFWwindow* window, int width, int height)
 {
 	glViewport(0, 0, width, height);
+
+	FrameUniforms::SetScreenSize(width, height);
 }
 
 void Window::KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mode)
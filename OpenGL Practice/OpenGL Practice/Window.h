@@ -35,6 +35,9 @@
 #include "TextRendering.h"
 #include "Game.h"
 #include "ResourceManager.h"
+#include "ProgramBinaryCache.h"
+#include "ModelImportBenchmark.h"
+#include "InstanceCullingBenchmark.h"
 
 class Blending;
 
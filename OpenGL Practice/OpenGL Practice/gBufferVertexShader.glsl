@@ -9,17 +9,17 @@ out vec2 TexCoords;
 out vec3 Normal;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "FrameUniforms.glsl"
+#include "MeshVertex.glsl"
 
 void main()
 {
-    vec4 worldPos = model * vec4(position, 1.0);
+    vec4 worldPos = model * vec4(MeshPosition(position), 1.0);
     FragPos = worldPos.xyz; 
     TexCoords = textureCoords;
     
     mat3 normalMatrix = transpose(inverse(mat3(model)));
-    Normal = normalMatrix * normals;
+    Normal = normalMatrix * MeshNormal(normals);
 
-    gl_Position = projection * view * worldPos;
+    gl_Position = frame.viewProjection * worldPos;
 }
\ No newline at end of file
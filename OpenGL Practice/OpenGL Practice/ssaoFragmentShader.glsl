@@ -18,7 +18,7 @@ float bias = 0.025;
 // tile noise texture over screen based on screen dimensions divided by noise size
 const vec2 noiseScale = vec2(1280.0/4.0, 960.0/4.0); 
 
-uniform mat4 projection;
+#include "FrameUniforms.glsl"
 
 void main()
 {
@@ -50,10 +50,10 @@ void main()
         
         /* We want to transform sample to screen-space so we can sample the position/depth value of sample as if we were 
         rendering its position directly to the screen. As the vector is currently in view-space, well transform it to 
-        clip-space first using the projection matrix uniform */
+        clip-space first using the projection matrix of the frame uniforms */
 
         vec4 offset = vec4(samplePos, 1.0);
-        offset = projection * offset; // from view to clip-space
+        offset = frame.projection * offset; // from view to clip-space
         offset.xyz /= offset.w; // perspective divide
         offset.xyz = offset.xyz * 0.5 + 0.5; // transform to range 0.0 - 1.0
         
@@ -11,17 +11,17 @@ out vec3 Normal;
 uniform bool invertedNormals;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "FrameUniforms.glsl"
+#include "MeshVertex.glsl"
 
 void main()
 {
-    vec4 viewPos = view * model * vec4(position, 1.0);
+    vec4 viewPos = frame.view * model * vec4(MeshPosition(position), 1.0);
     FragPos = viewPos.xyz; 
     texCoords = textureCoords;
     
-    mat3 normalMatrix = transpose(inverse(mat3(view * model)));
-    Normal = normalMatrix * (invertedNormals ? -normals : normals);
+    mat3 normalMatrix = transpose(inverse(mat3(frame.view * model)));
+    Normal = normalMatrix * (invertedNormals ? -MeshNormal(normals) : MeshNormal(normals));
     
-    gl_Position = projection * viewPos;
+    gl_Position = frame.projection * viewPos;
 }
\ No newline at end of file